@@ -1,47 +1,53 @@
 #include "aht10.h"
+#include "i2c_async.h"
 #include "pico/stdlib.h"
+#include "timeseries.h"
 #include <stdio.h>
 
 // Envia comandos para o AHT10
-static void enviar_comandos(aht10_t *sensor, const uint8_t *comandos, size_t tamanho) {
-    i2c_write_blocking(sensor->i2c_port, sensor->address, comandos, tamanho, false);
+static bool enviar_comandos(aht10_t *sensor, const uint8_t *comandos, size_t tamanho) {
+    int result = i2c_async_write(sensor->i2c_port, sensor->address, comandos, tamanho);
+    return result == (int)tamanho;
 }
 
 // Reset por software
-void aht10_soft_reset(aht10_t *sensor) {
+bool aht10_soft_reset(aht10_t *sensor) {
     uint8_t cmd[3] = {
         AHT10_CMD_SOFT_RESET,
         AHT10_CMD_SOFT_RESET_ARG,
         AHT10_CMD_SOFT_RESET_ARG2
     };
-    enviar_comandos(sensor, cmd, sizeof(cmd));
+    bool ok = enviar_comandos(sensor, cmd, sizeof(cmd));
     sleep_ms(20);
+    return ok;
 }
 
 // Calibra o sensor
-static void calibrar_aht10(aht10_t *sensor) {
+static bool calibrar_aht10(aht10_t *sensor) {
     uint8_t cmd[3] = {
         AHT10_CMD_CALIBRATION,
         AHT10_CMD_CALIBRATION_ARG,
         AHT10_CMD_CALIBRATION_ARG2
     };
-    enviar_comandos(sensor, cmd, sizeof(cmd));
+    bool ok = enviar_comandos(sensor, cmd, sizeof(cmd));
     sleep_ms(10);
+    return ok;
 }
 
 // Envia comando de medição
-static void enviar_comando_medicao(aht10_t *sensor) {
+static bool enviar_comando_medicao(aht10_t *sensor) {
     uint8_t cmd[3] = {
         AHT10_CMD_MEASURE,
         AHT10_CMD_MEASURE_ARG,
         AHT10_CMD_MEASURE_ARG2
     };
-    enviar_comandos(sensor, cmd, sizeof(cmd));
+    return enviar_comandos(sensor, cmd, sizeof(cmd));
 }
 
 // Lê 6 bytes de dados do sensor
-static void ler_dados_aht10(aht10_t *sensor, uint8_t *buf) {
-    i2c_read_blocking(sensor->i2c_port, sensor->address, buf, 6, false);
+static bool ler_dados_aht10(aht10_t *sensor, uint8_t *buf) {
+    int result = i2c_async_read(sensor->i2c_port, sensor->address, buf, 6);
+    return result == 6;
 }
 
 // Processa os dados brutos do sensor
@@ -55,53 +61,177 @@ static void processar_dados_aht10(aht10_t *sensor, uint8_t *buf) {
                                       buf[5];
 }
 
-// Obtém temperatura em Celsius
-static float obter_temperatura_celsius(aht10_t *sensor) {
-    return ((sensor->amostragem_temperatura * 200.0f) / (1 << 20)) - 50.0f;
+// Obtém temperatura em centésimos de °C: raw * 20000 / 2^20 - 5000,
+// reduzido para raw * 625 / 2^15 (cabe em 32 bits) e arredondado
+static int32_t obter_temperatura_centi(aht10_t *sensor) {
+    uint32_t centi = (sensor->amostragem_temperatura * 625u + (1u << 14)) >> 15;
+    return (int32_t)centi - 5000;
 }
 
-// Obtém umidade relativa em %
-static float obter_umidade_relativa(aht10_t *sensor) {
-    return (sensor->amostragem_umidade * 100.0f) / (1 << 20);
+// Obtém umidade relativa em centésimos de %: raw * 10000 / 2^20
+static int32_t obter_umidade_centi(aht10_t *sensor) {
+    return (int32_t)((sensor->amostragem_umidade * 625u + (1u << 15)) >> 16);
 }
 
 // Inicializa o sensor AHT10
-void aht10_init(aht10_t *sensor, i2c_inst_t *i2c_port, uint8_t address) {
+bool aht10_init(aht10_t *sensor, i2c_inst_t *i2c_port, uint8_t address) {
     sensor->i2c_port = i2c_port;
     sensor->address = address;
     sensor->leitura_disponivel = false;
     sensor->amostragem_temperatura = 0;
     sensor->amostragem_umidade = 0;
+    sensor->medicao_em_andamento = false;
+    sensor->inicio_medicao_ms = 0;
     
-    // Reset e calibração (sequência importante!)
-    aht10_soft_reset(sensor);
+    // Reset e calibração (sequência importante!). Sem ACK no reset o
+    // sensor está ausente: não gasta o barramento com a calibração
+    if (!aht10_soft_reset(sensor)) {
+        return false;
+    }
     sleep_ms(20);
-    calibrar_aht10(sensor);
+    if (!calibrar_aht10(sensor)) {
+        return false;
+    }
     sleep_ms(10);
+    return true;
 }
 
-// Lê temperatura e umidade do sensor
-bool aht10_read_temperature_humidity(aht10_t *sensor, float *temperature, float *humidity) {
+// Dispara uma conversão sem aguardar o resultado
+bool aht10_start_measurement(aht10_t *sensor) {
     sensor->leitura_disponivel = false;
-    
-    // Envia comando de medição
-    enviar_comando_medicao(sensor);
-    
-    // Aguarda 80ms para medição completar
-    sleep_ms(80);
-    
-    // Lê dados
+    sensor->medicao_em_andamento = false;
+
+    if (!enviar_comando_medicao(sensor)) {
+        return false;
+    }
+
+    sensor->medicao_em_andamento = true;
+    sensor->inicio_medicao_ms = to_ms_since_boot(get_absolute_time());
+    return true;
+}
+
+// Lê apenas o byte de status e verifica o bit de busy
+bool aht10_measurement_ready(aht10_t *sensor) {
+    if (!sensor->medicao_em_andamento) {
+        return false;
+    }
+
+    uint8_t status = 0;
+    if (i2c_async_read(sensor->i2c_port, sensor->address, &status, 1) != 1) {
+        return false;
+    }
+
+    return (status & AHT10_STATUS_BUSY) == 0;
+}
+
+// Coleta o resultado de uma conversão já disparada.
+// Retorna false se não há conversão pendente, se o sensor ainda está
+// ocupado ou em caso de erro no barramento.
+bool aht10_collect(aht10_t *sensor, int32_t *temperature_centi, int32_t *humidity_centi) {
+    if (!sensor->medicao_em_andamento) {
+        return false;
+    }
+
     uint8_t buf[6];
-    ler_dados_aht10(sensor, buf);
-    
+    if (!ler_dados_aht10(sensor, buf)) {
+        sensor->medicao_em_andamento = false;
+        return false;
+    }
+
+    if (buf[0] & AHT10_STATUS_BUSY) {
+        // Conversão ainda em andamento: mantém pendente para nova tentativa
+        return false;
+    }
+
+    sensor->medicao_em_andamento = false;
+
     // Processa dados brutos
     processar_dados_aht10(sensor, buf);
-    
-    // Converte para valores reais
-    *temperature = obter_temperatura_celsius(sensor);
-    *humidity = obter_umidade_relativa(sensor);
-    
+
+    // Converte para valores em centésimos (sem ponto flutuante)
+    *temperature_centi = obter_temperatura_centi(sensor);
+    *humidity_centi = obter_umidade_centi(sensor);
+
     sensor->leitura_disponivel = true;
-    
-    return sensor->leitura_disponivel;
+
+    return true;
+}
+
+// Tempo restante (ms) até o fim nominal da conversão em andamento
+uint32_t aht10_ms_until_ready(const aht10_t *sensor, uint32_t now_ms) {
+    if (!sensor->medicao_em_andamento) {
+        return 0;
+    }
+
+    uint32_t elapsed = now_ms - sensor->inicio_medicao_ms;
+    if (elapsed >= AHT10_MEASUREMENT_TIME_MS) {
+        return 0;
+    }
+    return AHT10_MEASUREMENT_TIME_MS - elapsed;
 }
+
+// Lê temperatura e umidade do sensor (versão bloqueante)
+bool aht10_read_temperature_humidity(aht10_t *sensor, int32_t *temperature_centi, int32_t *humidity_centi) {
+    if (!aht10_start_measurement(sensor)) {
+        return false;
+    }
+
+    // Aguarda o tempo nominal e depois consulta o bit de busy
+    sleep_ms(AHT10_MEASUREMENT_TIME_MS);
+
+    for (int tentativa = 0; tentativa < 5; tentativa++) {
+        if (aht10_collect(sensor, temperature_centi, humidity_centi)) {
+            return true;
+        }
+        if (!sensor->medicao_em_andamento) {
+            return false;  // Erro de barramento
+        }
+        sleep_ms(10);
+    }
+
+    sensor->medicao_em_andamento = false;
+    return false;
+}
+
+// ============= DRIVER PARA O REGISTRO =============
+
+static const sensor_metric_desc_t AHT10_METRICS[] = {
+    { .key = "temp", .label = "Temp", .unit = "C", .decimals = 1, .ts_metric = TS_METRIC_TEMPERATURE },
+    { .key = "humidity", .label = "Umid", .unit = "%", .decimals = 1, .ts_metric = TS_METRIC_HUMIDITY },
+};
+
+static bool aht10_driver_init(void *dev) {
+    aht10_t *sensor = (aht10_t *)dev;
+    return aht10_init(sensor, sensor->i2c_port, sensor->address);
+}
+
+static bool aht10_driver_start(void *dev) {
+    return aht10_start_measurement((aht10_t *)dev);
+}
+
+static sensor_sched_result_t aht10_driver_collect(void *dev, bool last_attempt, int32_t *values) {
+    aht10_t *sensor = (aht10_t *)dev;
+
+    if (aht10_collect(sensor, &values[0], &values[1])) {
+        return SENSOR_SCHED_OK;
+    }
+
+    // Ainda convertendo: o escalonador tenta de novo em SENSOR_SCHED_RETRY_MS
+    if (sensor->medicao_em_andamento && !last_attempt) {
+        return SENSOR_SCHED_RETRY;
+    }
+
+    sensor->medicao_em_andamento = false;
+    return SENSOR_SCHED_FAIL;
+}
+
+const sensor_driver_t aht10_driver = {
+    .name = "AHT10",
+    .period_ms = AHT10_SAMPLE_PERIOD_MS,
+    .conversion_ms = AHT10_MEASUREMENT_TIME_MS,
+    .metric_count = 2,
+    .metrics = AHT10_METRICS,
+    .init = aht10_driver_init,
+    .start = aht10_driver_start,
+    .collect = aht10_driver_collect,
+};
@@ -3,6 +3,7 @@
 
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "sensor_driver.h"
 
 // Endereço I2C do AHT10
 #define AHT10_I2C_ADDR  0x38
@@ -20,6 +21,16 @@
 #define AHT10_CMD_SOFT_RESET_ARG    0x00
 #define AHT10_CMD_SOFT_RESET_ARG2   0x00
 
+// Byte de status (primeiro byte de qualquer leitura)
+#define AHT10_STATUS_BUSY           0x80  // Conversão em andamento
+#define AHT10_STATUS_CALIBRATED     0x08  // Calibração carregada
+
+// Tempo típico de conversão após o comando de medição
+#define AHT10_MEASUREMENT_TIME_MS   80
+
+// Período de amostragem: temperatura e umidade variam devagar
+#define AHT10_SAMPLE_PERIOD_MS      2000
+
 // Estrutura do sensor
 typedef struct {
     i2c_inst_t *i2c_port;
@@ -27,11 +38,26 @@ typedef struct {
     bool leitura_disponivel;
     uint32_t amostragem_temperatura;
     uint32_t amostragem_umidade;
+    bool medicao_em_andamento;     // Comando de medição enviado, aguardando coleta
+    uint32_t inicio_medicao_ms;    // Instante do disparo da conversão
 } aht10_t;
 
-// Funções públicas
-void aht10_init(aht10_t *sensor, i2c_inst_t *i2c_port, uint8_t address);
-bool aht10_read_temperature_humidity(aht10_t *sensor, float *temperature, float *humidity);
-void aht10_soft_reset(aht10_t *sensor);
+// Funções públicas (temperatura e umidade em centésimos: 2345 = 23.45).
+// O init retorna false se o sensor não confirmar (NACK) o reset ou a calibração.
+bool aht10_init(aht10_t *sensor, i2c_inst_t *i2c_port, uint8_t address);
+bool aht10_read_temperature_humidity(aht10_t *sensor, int32_t *temperature_centi, int32_t *humidity_centi);
+bool aht10_soft_reset(aht10_t *sensor);
+
+// API não bloqueante: dispara a conversão, consulta o bit de busy e coleta
+// o resultado quando pronto. Entre o disparo e a coleta o chamador fica livre
+// para atender outros sensores ou bloquear num timer do FreeRTOS.
+bool aht10_start_measurement(aht10_t *sensor);
+bool aht10_measurement_ready(aht10_t *sensor);
+bool aht10_collect(aht10_t *sensor, int32_t *temperature_centi, int32_t *humidity_centi);
+uint32_t aht10_ms_until_ready(const aht10_t *sensor, uint32_t now_ms);
+
+// Driver para o registro de sensores (dev = aht10_t com porta e endereço
+// preenchidos); grandezas na ordem temperatura, umidade
+extern const sensor_driver_t aht10_driver;
 
 #endif // AHT10_H
@@ -1,9 +1,11 @@
 #include "bh1750.h"
+#include "i2c_async.h"
 #include "pico/stdlib.h"
+#include "timeseries.h"
 
 // Envia um comando para o BH1750
 static bool bh1750_send_cmd(bh1750_t *sensor, uint8_t cmd) {
-    int result = i2c_write_blocking(sensor->i2c_port, sensor->address, &cmd, 1, false);
+    int result = i2c_async_write(sensor->i2c_port, sensor->address, &cmd, 1);
     return result == 1;
 }
 
@@ -34,19 +36,20 @@ bool bh1750_init(bh1750_t *sensor, i2c_inst_t *i2c_port, uint8_t address) {
 }
 
 // Lê o valor de luminosidade em lux
-bool bh1750_read_light(bh1750_t *sensor, float *lux) {
+bool bh1750_read_light(bh1750_t *sensor, int32_t *lux_centi) {
     uint8_t data[2];
     
     // Lê 2 bytes do sensor
-    int result = i2c_read_blocking(sensor->i2c_port, sensor->address, data, 2, false);
+    int result = i2c_async_read(sensor->i2c_port, sensor->address, data, 2);
     
     if (result != 2) {
         return false;
     }
     
-    // Combina os bytes e calcula o valor em lux
-    uint16_t raw_value = (data[0] << 8) | data[1];
-    *lux = raw_value / 1.2f;  // Fórmula de conversão para modo de alta resolução
+    // Combina os bytes e calcula o valor em centésimos de lux:
+    // raw / 1.2 lux (modo de alta resolução) = raw * 250 / 3 centésimos
+    uint32_t raw_value = ((uint32_t)data[0] << 8) | data[1];
+    *lux_centi = (int32_t)((raw_value * 250u + 1u) / 3u);
     
     return true;
 }
@@ -60,3 +63,43 @@ void bh1750_power_down(bh1750_t *sensor) {
 void bh1750_power_on(bh1750_t *sensor) {
     bh1750_send_cmd(sensor, BH1750_POWER_ON);
 }
+
+// ============= DRIVER PARA O REGISTRO =============
+
+static const sensor_metric_desc_t BH1750_METRICS[] = {
+    { .key = "lux", .label = "Luz", .unit = "lux", .decimals = 1, .ts_metric = TS_METRIC_LUX },
+};
+
+static bool bh1750_driver_init(void *dev) {
+    bh1750_t *sensor = (bh1750_t *)dev;
+    uint8_t address = sensor->address;
+    if (bh1750_init(sensor, sensor->i2c_port, address)) {
+        return true;
+    }
+
+    // Pino ADDR no outro nível
+    uint8_t alternate = (address == BH1750_ADDR_LOW) ? BH1750_ADDR_HIGH : BH1750_ADDR_LOW;
+    return bh1750_init(sensor, sensor->i2c_port, alternate);
+}
+
+// Modo contínuo: o sensor converte sozinho a cada ~120 ms, basta ler
+static bool bh1750_driver_start(void *dev) {
+    (void)dev;
+    return true;
+}
+
+static sensor_sched_result_t bh1750_driver_collect(void *dev, bool last_attempt, int32_t *values) {
+    (void)last_attempt;
+    return bh1750_read_light((bh1750_t *)dev, &values[0]) ? SENSOR_SCHED_OK : SENSOR_SCHED_FAIL;
+}
+
+const sensor_driver_t bh1750_driver = {
+    .name = "BH1750",
+    .period_ms = BH1750_SAMPLE_PERIOD_MS,
+    .conversion_ms = 0,
+    .metric_count = 1,
+    .metrics = BH1750_METRICS,
+    .init = bh1750_driver_init,
+    .start = bh1750_driver_start,
+    .collect = bh1750_driver_collect,
+};
@@ -3,6 +3,7 @@
 
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "sensor_driver.h"
 
 // Endereços I2C possíveis do BH1750
 #define BH1750_ADDR_LOW  0x23  // Quando ADDR pin está em LOW ou flutuante
@@ -25,10 +26,17 @@ typedef struct {
     uint8_t address;
 } bh1750_t;
 
+// Período de amostragem: luz lida rápido porque controla os LEDs
+#define BH1750_SAMPLE_PERIOD_MS     200
+
 // Funções públicas
 bool bh1750_init(bh1750_t *sensor, i2c_inst_t *i2c_port, uint8_t address);
-bool bh1750_read_light(bh1750_t *sensor, float *lux);
+bool bh1750_read_light(bh1750_t *sensor, int32_t *lux_centi);  // Centésimos de lux
 void bh1750_power_down(bh1750_t *sensor);
 void bh1750_power_on(bh1750_t *sensor);
 
+// Driver para o registro de sensores (dev = bh1750_t com porta e endereço
+// preenchidos; o init tenta também o endereço alternativo)
+extern const sensor_driver_t bh1750_driver;
+
 #endif // BH1750_H
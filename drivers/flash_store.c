@@ -0,0 +1,61 @@
+#include "flash_store.h"
+#include <string.h>
+#include "pico/flash.h"
+
+// Fim do binário gravado (definido pelo linker script do SDK)
+extern char __flash_binary_end;
+
+static bool flash_store_ok = false;
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *src;
+    size_t len;
+} flash_op_t;
+
+// Executadas com interrupções desligadas e sem acesso XIP concorrente
+static void do_program(void *param) {
+    const flash_op_t *op = (const flash_op_t *)param;
+    flash_range_program(FLASH_STORE_OFFSET + op->offset, op->src, op->len);
+}
+
+static void do_erase(void *param) {
+    const flash_op_t *op = (const flash_op_t *)param;
+    flash_range_erase(FLASH_STORE_OFFSET + op->offset, op->len);
+}
+
+static bool in_region(uint32_t offset, size_t len) {
+    return flash_store_ok && offset <= FLASH_STORE_SIZE && len <= FLASH_STORE_SIZE - offset;
+}
+
+bool flash_store_init(void) {
+    uintptr_t binary_end = (uintptr_t)&__flash_binary_end - XIP_BASE;
+    flash_store_ok = (binary_end <= FLASH_STORE_OFFSET);
+    return flash_store_ok;
+}
+
+bool flash_store_read(uint32_t offset, void *dst, size_t len) {
+    if (!in_region(offset, len)) return false;
+
+    // Leitura direta pelo mapeamento XIP
+    memcpy(dst, (const void *)(uintptr_t)(XIP_BASE + FLASH_STORE_OFFSET + offset), len);
+    return true;
+}
+
+bool flash_store_program(uint32_t offset, const void *src, size_t len) {
+    if (!in_region(offset, len) || offset % FLASH_PAGE_SIZE != 0 || len % FLASH_PAGE_SIZE != 0) {
+        return false;
+    }
+
+    flash_op_t op = { offset, (const uint8_t *)src, len };
+    return flash_safe_execute(do_program, &op, FLASH_STORE_TIMEOUT_MS) == PICO_OK;
+}
+
+bool flash_store_erase(uint32_t offset, size_t len) {
+    if (!in_region(offset, len) || offset % FLASH_SECTOR_SIZE != 0 || len % FLASH_SECTOR_SIZE != 0) {
+        return false;
+    }
+
+    flash_op_t op = { offset, NULL, len };
+    return flash_safe_execute(do_erase, &op, FLASH_STORE_TIMEOUT_MS) == PICO_OK;
+}
@@ -0,0 +1,24 @@
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+// Região reservada no fim da flash para o log de amostras. O programa
+// é gravado a partir do início; flash_store_init recusa a região se o
+// binário crescer até ela.
+#ifndef FLASH_STORE_SIZE
+#define FLASH_STORE_SIZE    (256u * 1024u)
+#endif
+#define FLASH_STORE_OFFSET  (PICO_FLASH_SIZE_BYTES - FLASH_STORE_SIZE)
+
+// Tempo máximo para obter acesso exclusivo à flash
+#define FLASH_STORE_TIMEOUT_MS 100
+
+// Funções públicas (offsets relativos ao início da região)
+bool flash_store_init(void);
+bool flash_store_read(uint32_t offset, void *dst, size_t len);
+bool flash_store_program(uint32_t offset, const void *src, size_t len);
+bool flash_store_erase(uint32_t offset, size_t len);
+
+#endif // FLASH_STORE_H
@@ -0,0 +1,240 @@
+#include "i2c_async.h"
+
+#include <string.h>
+
+#include "i2c_async_backend.h"
+#include "sensor_trace.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Fila de cada barramento (I2C0 e I2C1); a transferência em si fica com
+// o backend (i2c_async_backend.h)
+typedef struct {
+    i2c_inst_t *i2c;
+    bool ready;
+
+    // Fila circular de transações pendentes
+    i2c_async_txn_t *queue[I2C_ASYNC_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+
+    i2c_async_txn_t *current;
+
+    i2c_async_stats_t stats;
+} i2c_bus_t;
+
+static i2c_bus_t s_buses[2];
+
+static i2c_bus_t *bus_from_inst(i2c_inst_t *i2c) {
+    if (!i2c) return NULL;
+    return &s_buses[i2c_get_index(i2c)];
+}
+
+static void bus_start(i2c_bus_t *bus, i2c_async_txn_t *txn) {
+    bus->current = txn;
+    i2c_async_backend_start(bus->i2c, txn);
+}
+
+// Retira a próxima transação da fila e inicia (chamado com interrupções bloqueadas)
+static void bus_start_next(i2c_bus_t *bus) {
+    bus->current = NULL;
+    if (bus->count == 0) {
+        i2c_async_backend_idle(bus->i2c);
+        return;
+    }
+
+    i2c_async_txn_t *txn = bus->queue[bus->head];
+    bus->head = (uint8_t)((bus->head + 1) % I2C_ASYNC_QUEUE_LEN);
+    bus->count--;
+    bus_start(bus, txn);
+}
+
+// Conclusão vinda do backend (na interrupção)
+void i2c_async_backend_done(i2c_inst_t *i2c, bool ok) {
+    i2c_bus_t *bus = bus_from_inst(i2c);
+    i2c_async_txn_t *txn = bus->current;
+    if (!txn) {
+        return;
+    }
+
+    if (ok) {
+        txn->result = (int)(txn->tx_len + txn->rx_len);
+    } else {
+        txn->result = PICO_ERROR_GENERIC;
+        bus->stats.errors++;
+    }
+    txn->done = true;
+    bus->stats.completed++;
+
+    BaseType_t higher_priority_woken = pdFALSE;
+    if (txn->owner) {
+        vTaskNotifyGiveIndexedFromISR((TaskHandle_t)txn->owner, I2C_ASYNC_NOTIFY_INDEX, &higher_priority_woken);
+    }
+
+    bus_start_next(bus);
+    portYIELD_FROM_ISR(higher_priority_woken);
+}
+
+// ============= API PÚBLICA =============
+
+bool i2c_async_init(i2c_inst_t *i2c) {
+    i2c_bus_t *bus = bus_from_inst(i2c);
+    if (!bus) return false;
+    if (bus->ready) return true;
+
+    if (!i2c_async_backend_init(i2c)) {
+        return false;
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->i2c = i2c;
+    bus->ready = true;
+    return true;
+}
+
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    i2c_bus_t *bus = bus_from_inst(i2c);
+    if (!bus || !bus->ready || !txn) return false;
+    if (txn->tx_len + txn->rx_len == 0 || txn->tx_len + txn->rx_len > I2C_ASYNC_MAX_LEN) return false;
+
+    txn->done = false;
+    txn->result = PICO_ERROR_GENERIC;
+
+    bool accepted = true;
+    taskENTER_CRITICAL();
+    if (!bus->current) {
+        bus_start(bus, txn);
+    } else if (bus->count < I2C_ASYNC_QUEUE_LEN) {
+        bus->queue[(bus->head + bus->count) % I2C_ASYNC_QUEUE_LEN] = txn;
+        bus->count++;
+        if (bus->count > bus->stats.max_depth) {
+            bus->stats.max_depth = bus->count;
+        }
+    } else {
+        accepted = false;
+        bus->stats.queue_full++;
+    }
+    if (accepted) {
+        bus->stats.submitted++;
+    }
+    taskEXIT_CRITICAL();
+
+    return accepted;
+}
+
+bool i2c_async_cancel(i2c_inst_t *i2c, i2c_async_txn_t *txn) {
+    i2c_bus_t *bus = bus_from_inst(i2c);
+    if (!bus || !bus->ready || !txn) return false;
+
+    bool removed = false;
+    taskENTER_CRITICAL();
+    if (txn->done) {
+        // Concluiu enquanto o chamador desistia
+    } else if (bus->current == txn) {
+        i2c_async_backend_abort(bus->i2c);
+        removed = true;
+        bus_start_next(bus);
+    } else {
+        for (uint8_t i = 0; i < bus->count; i++) {
+            uint8_t idx = (uint8_t)((bus->head + i) % I2C_ASYNC_QUEUE_LEN);
+            if (bus->queue[idx] != txn) continue;
+
+            // Compacta a fila a partir da posição removida
+            for (uint8_t j = i; j + 1 < bus->count; j++) {
+                uint8_t a = (uint8_t)((bus->head + j) % I2C_ASYNC_QUEUE_LEN);
+                uint8_t b = (uint8_t)((bus->head + j + 1) % I2C_ASYNC_QUEUE_LEN);
+                bus->queue[a] = bus->queue[b];
+            }
+            bus->count--;
+            removed = true;
+            break;
+        }
+    }
+    if (removed) {
+        txn->result = PICO_ERROR_GENERIC;
+        txn->done = true;
+        bus->stats.timeouts++;
+    }
+    taskEXIT_CRITICAL();
+
+    return removed;
+}
+
+bool i2c_async_get_stats(i2c_inst_t *i2c, i2c_async_stats_t *out) {
+    i2c_bus_t *bus = bus_from_inst(i2c);
+    if (!bus || !out) return false;
+
+    taskENTER_CRITICAL();
+    *out = bus->stats;
+    taskEXIT_CRITICAL();
+    return bus->ready;
+}
+
+// Submete a transação e dorme até a conclusão ou timeout
+static int i2c_async_transfer(i2c_inst_t *i2c, uint8_t addr,
+                              const uint8_t *tx, size_t tx_len,
+                              uint8_t *rx, size_t rx_len) {
+    i2c_async_txn_t txn = {
+        .address = addr,
+        .tx = tx,
+        .tx_len = tx_len,
+        .rx = rx,
+        .rx_len = rx_len,
+        .owner = xTaskGetCurrentTaskHandle(),
+    };
+
+    // Descarta conclusões antigas que tenham chegado após um timeout
+    (void)ulTaskNotifyTakeIndexed(I2C_ASYNC_NOTIFY_INDEX, pdTRUE, 0);
+
+    if (!i2c_async_submit(i2c, &txn)) {
+        return PICO_ERROR_GENERIC;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    while (!txn.done) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= pdMS_TO_TICKS(I2C_ASYNC_TIMEOUT_MS)) {
+            if (i2c_async_cancel(i2c, &txn)) {
+                return PICO_ERROR_GENERIC;
+            }
+            break;  // Concluiu durante o cancelamento
+        }
+        (void)ulTaskNotifyTakeIndexed(I2C_ASYNC_NOTIFY_INDEX, pdTRUE,
+                                      pdMS_TO_TICKS(I2C_ASYNC_TIMEOUT_MS) - elapsed);
+    }
+
+    return txn.result;
+}
+
+// Com o scheduler rodando todo acesso a um barramento inicializado passa pela
+// fila: misturar acessos bloqueantes do SDK com o DMA corromperia a transação
+static bool i2c_async_usable(i2c_inst_t *i2c) {
+    i2c_bus_t *bus = bus_from_inst(i2c);
+    if (!bus || !bus->ready) return false;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) return true;
+    bus->stats.fallback_blocking++;
+    return false;
+}
+
+int i2c_async_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+    if (!i2c_async_usable(i2c)) {
+        return i2c_write_blocking(i2c, addr, src, len, false);
+    }
+    return i2c_async_transfer(i2c, addr, src, len, NULL, 0);
+}
+
+int i2c_async_read(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len) {
+    int result;
+    if (!i2c_async_usable(i2c)) {
+        result = i2c_read_blocking(i2c, addr, dst, len, false);
+    } else {
+        result = i2c_async_transfer(i2c, addr, NULL, 0, dst, len);
+    }
+
+    // Quadro bruto para o replay no host (comando TRACE ON)
+    if (result == (int)len && sensor_trace_is_enabled()) {
+        sensor_trace_record((uint8_t)i2c_get_index(i2c), addr, dst, len);
+    }
+    return result;
+}
@@ -0,0 +1,70 @@
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+// Transações por barramento aguardando na fila
+#define I2C_ASYNC_QUEUE_LEN     8
+
+// Maior transferência suportada (flush completo do SSD1306 = 1025 bytes)
+#define I2C_ASYNC_MAX_LEN       1040
+
+// Índice da notificação de task usado para sinalizar conclusão
+// (o índice 0 continua livre para as próprias tasks)
+#define I2C_ASYNC_NOTIFY_INDEX  1
+
+// Tempo máximo de espera por uma transação antes de cancelá-la
+#define I2C_ASYNC_TIMEOUT_MS    100
+
+// Transação enfileirada. Pertence ao chamador até ser concluída.
+typedef struct {
+    uint8_t address;
+    const uint8_t *tx;      // Bytes a escrever (pode ser NULL)
+    size_t tx_len;
+    uint8_t *rx;            // Destino da leitura após a escrita (pode ser NULL)
+    size_t rx_len;
+    void *owner;            // Task notificada na conclusão
+    volatile bool done;
+    volatile int result;    // Bytes transferidos ou PICO_ERROR_GENERIC
+} i2c_async_txn_t;
+
+// Contadores por barramento
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t errors;
+    uint32_t timeouts;
+    uint32_t queue_full;
+    uint32_t max_depth;
+    uint32_t fallback_blocking;
+} i2c_async_stats_t;
+
+#ifdef USE_FREERTOS
+
+// Funções públicas
+bool i2c_async_init(i2c_inst_t *i2c);
+bool i2c_async_submit(i2c_inst_t *i2c, i2c_async_txn_t *txn);
+bool i2c_async_cancel(i2c_inst_t *i2c, i2c_async_txn_t *txn);
+bool i2c_async_get_stats(i2c_inst_t *i2c, i2c_async_stats_t *out);
+
+// Equivalentes a i2c_write_blocking/i2c_read_blocking (sem nostop): a task
+// chamadora dorme até a conclusão via DMA. Antes do scheduler iniciar, ou se
+// o barramento não foi inicializado, caem no acesso bloqueante do SDK.
+int i2c_async_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len);
+int i2c_async_read(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len);
+
+#else
+
+// Sem FreeRTOS (ex.: test_aht10) o acesso é sempre bloqueante
+static inline int i2c_async_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+    return i2c_write_blocking(i2c, addr, src, len, false);
+}
+
+static inline int i2c_async_read(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len) {
+    return i2c_read_blocking(i2c, addr, dst, len, false);
+}
+
+#endif // USE_FREERTOS
+
+#endif // I2C_ASYNC_H
@@ -0,0 +1,27 @@
+#ifndef I2C_ASYNC_BACKEND_H
+#define I2C_ASYNC_BACKEND_H
+
+#include "i2c_async.h"
+
+// Hardware por trás da fila de transações (i2c_async.c). No firmware é o
+// DMA com a interrupção do controlador (i2c_async_dma.c); no host, um
+// barramento simulado. A fila chama start/abort/idle com interrupções
+// bloqueadas e no máximo uma transação em andamento por barramento.
+
+// Reserva os canais de DMA e instala a interrupção do barramento
+bool i2c_async_backend_init(i2c_inst_t *i2c);
+
+// Inicia a transação; o fim chega por i2c_async_backend_done()
+void i2c_async_backend_start(i2c_inst_t *i2c, const i2c_async_txn_t *txn);
+
+// Interrompe a transação em andamento sem concluí-la (cancelamento)
+void i2c_async_backend_abort(i2c_inst_t *i2c);
+
+// Fila vazia: libera o controlador para os acessos bloqueantes do SDK
+void i2c_async_backend_idle(i2c_inst_t *i2c);
+
+// Chamada pelo backend, na interrupção, ao fim da transação em andamento
+// (ok = false em NACK ou perda de arbitragem)
+void i2c_async_backend_done(i2c_inst_t *i2c, bool ok);
+
+#endif // I2C_ASYNC_BACKEND_H
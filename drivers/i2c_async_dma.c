@@ -0,0 +1,162 @@
+#include "i2c_async_backend.h"
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+// Estado do DMA de cada barramento (I2C0 e I2C1)
+typedef struct {
+    i2c_inst_t *i2c;
+    uint dma_tx;
+    uint dma_rx;
+
+    const i2c_async_txn_t *current;
+    bool aborted;
+
+    // Palavras de comando para o registrador DATA_CMD (bit 8 = leitura,
+    // bit 9 = STOP, bit 10 = RESTART). Escritas de 16 bits pelo DMA são
+    // replicadas no barramento APB, e o controlador só usa os bits [10:0].
+    uint16_t cmd[I2C_ASYNC_MAX_LEN];
+} i2c_dma_bus_t;
+
+static i2c_dma_bus_t s_dma[2];
+
+static i2c_dma_bus_t *dma_from_inst(i2c_inst_t *i2c) {
+    return &s_dma[i2c_get_index(i2c)];
+}
+
+static void bus_irq(i2c_dma_bus_t *bus) {
+    i2c_hw_t *hw = i2c_get_hw(bus->i2c);
+    uint32_t status = hw->intr_stat;
+    const i2c_async_txn_t *txn = bus->current;
+
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK ou perda de arbitragem: o STOP que segue conclui a transação
+        (void)hw->clr_tx_abrt;
+        dma_channel_abort(bus->dma_tx);
+        dma_channel_abort(bus->dma_rx);
+        bus->aborted = true;
+    }
+
+    if ((status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) == 0) {
+        return;
+    }
+    (void)hw->clr_stop_det;
+
+    if (!txn) {
+        // STOP tardio de uma transação cancelada
+        return;
+    }
+
+    // Após o STOP os últimos bytes ainda podem estar saindo do FIFO para o DMA
+    while (!bus->aborted && txn->rx_len && dma_channel_is_busy(bus->dma_rx)) {
+        tight_loop_contents();
+    }
+    hw->dma_cr = 0;
+
+    bus->current = NULL;
+    i2c_async_backend_done(bus->i2c, !bus->aborted);
+}
+
+static void i2c0_async_irq_handler(void) {
+    bus_irq(&s_dma[0]);
+}
+
+static void i2c1_async_irq_handler(void) {
+    bus_irq(&s_dma[1]);
+}
+
+// ============= BACKEND =============
+
+bool i2c_async_backend_init(i2c_inst_t *i2c) {
+    int tx = dma_claim_unused_channel(false);
+    int rx = dma_claim_unused_channel(false);
+    if (tx < 0 || rx < 0) {
+        return false;
+    }
+
+    i2c_dma_bus_t *bus = dma_from_inst(i2c);
+    bus->i2c = i2c;
+    bus->dma_tx = (uint)tx;
+    bus->dma_rx = (uint)rx;
+    bus->current = NULL;
+
+    i2c_get_hw(i2c)->intr_mask = 0;
+
+    uint irq = (i2c_get_index(i2c) == 0) ? I2C0_IRQ : I2C1_IRQ;
+    irq_set_exclusive_handler(irq, (i2c_get_index(i2c) == 0) ? i2c0_async_irq_handler : i2c1_async_irq_handler);
+    irq_set_enabled(irq, true);
+    return true;
+}
+
+// Programa o controlador e os canais de DMA para a transação
+void i2c_async_backend_start(i2c_inst_t *i2c, const i2c_async_txn_t *txn) {
+    i2c_dma_bus_t *bus = dma_from_inst(i2c);
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+
+    bus->current = txn;
+    bus->aborted = false;
+
+    // O endereço alvo só pode ser alterado com o controlador desabilitado
+    hw->enable = 0;
+    hw->tar = txn->address;
+    hw->enable = 1;
+
+    size_t n = 0;
+    for (size_t i = 0; i < txn->tx_len; i++) {
+        uint16_t word = txn->tx[i];
+        if (i == txn->tx_len - 1 && txn->rx_len == 0) {
+            word |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+        bus->cmd[n++] = word;
+    }
+    for (size_t i = 0; i < txn->rx_len; i++) {
+        uint16_t word = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == 0 && txn->tx_len > 0) {
+            word |= I2C_IC_DATA_CMD_RESTART_BITS;
+        }
+        if (i == txn->rx_len - 1) {
+            word |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+        bus->cmd[n++] = word;
+    }
+
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | (txn->rx_len ? I2C_IC_DMA_CR_RDMAE_BITS : 0);
+
+    if (txn->rx_len) {
+        dma_channel_config rx_cfg = dma_channel_get_default_config(bus->dma_rx);
+        channel_config_set_transfer_data_size(&rx_cfg, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_cfg, false);
+        channel_config_set_write_increment(&rx_cfg, true);
+        channel_config_set_dreq(&rx_cfg, i2c_get_dreq(i2c, false));
+        dma_channel_configure(bus->dma_rx, &rx_cfg, txn->rx, &hw->data_cmd, txn->rx_len, true);
+    }
+
+    dma_channel_config tx_cfg = dma_channel_get_default_config(bus->dma_tx);
+    channel_config_set_transfer_data_size(&tx_cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&tx_cfg, true);
+    channel_config_set_write_increment(&tx_cfg, false);
+    channel_config_set_dreq(&tx_cfg, i2c_get_dreq(i2c, true));
+    dma_channel_configure(bus->dma_tx, &tx_cfg, &hw->data_cmd, bus->cmd, n, true);
+}
+
+void i2c_async_backend_abort(i2c_inst_t *i2c) {
+    i2c_dma_bus_t *bus = dma_from_inst(i2c);
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+
+    dma_channel_abort(bus->dma_tx);
+    dma_channel_abort(bus->dma_rx);
+    hw->dma_cr = 0;
+    hw->intr_mask = 0;
+    hw->enable = 0;  // Descarta FIFOs e libera o barramento
+    hw->enable = 1;
+    bus->current = NULL;
+}
+
+// Interrupções desligadas para não interferir nos acessos bloqueantes do
+// SDK, que consultam os mesmos flags
+void i2c_async_backend_idle(i2c_inst_t *i2c) {
+    i2c_get_hw(i2c)->intr_mask = 0;
+}
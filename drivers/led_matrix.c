@@ -75,9 +75,9 @@ void led_matrix_clear(led_matrix_t *matrix) {
     led_matrix_set_intensity(matrix, LED_INTENSITY_OFF);
 }
 
-// Converte valor de luminosidade (lux) para nível de intensidade dos LEDs
+// Converte valor de luminosidade (centésimos de lux) para nível de intensidade dos LEDs
 // Lógica inversa: quanto mais luz ambiente, MENOS intensidade nos LEDs
-led_intensity_t led_matrix_get_intensity_from_lux(float lux) {
+led_intensity_t led_matrix_get_intensity_from_lux(int32_t lux_centi) {
     // Thresholds de luminosidade
     // Ambientes típicos:
     // - Escuro (noite): 0-10 lux
@@ -86,13 +86,13 @@ led_intensity_t led_matrix_get_intensity_from_lux(float lux) {
     // - Luz solar indireta: 500-10000 lux
     // - Luz solar direta: 10000+ lux
     
-    if (lux < 50) {
+    if (lux_centi < 50 * 100) {
         // Muito escuro - LEDs no máximo
         return LED_INTENSITY_HIGH;
-    } else if (lux < 200) {
+    } else if (lux_centi < 200 * 100) {
         // Pouca luz - LEDs médio
         return LED_INTENSITY_MEDIUM;
-    } else if (lux < 500) {
+    } else if (lux_centi < 500 * 100) {
         // Luz moderada - LEDs fraco
         return LED_INTENSITY_LOW;
     } else {
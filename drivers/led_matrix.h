@@ -27,6 +27,6 @@ typedef struct {
 void led_matrix_init(led_matrix_t *matrix, uint gpio_pin);
 void led_matrix_set_intensity(led_matrix_t *matrix, led_intensity_t intensity);
 void led_matrix_clear(led_matrix_t *matrix);
-led_intensity_t led_matrix_get_intensity_from_lux(float lux);
+led_intensity_t led_matrix_get_intensity_from_lux(int32_t lux_centi);  // Centésimos de lux
 
 #endif // LED_MATRIX_H
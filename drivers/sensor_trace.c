@@ -0,0 +1,114 @@
+#include "sensor_trace.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+
+static sensor_trace_frame_t g_frames[SENSOR_TRACE_DEPTH];
+static uint32_t g_head = 0;       // Próxima escrita
+static uint32_t g_tail = 0;       // Próxima leitura
+static uint32_t g_dropped = 0;
+static volatile bool g_enabled = false;
+static critical_section_t g_trace_lock;
+
+void sensor_trace_set_enabled(bool enabled) {
+    if (!critical_section_is_initialized(&g_trace_lock)) {
+        critical_section_init(&g_trace_lock);
+    }
+
+    critical_section_enter_blocking(&g_trace_lock);
+    g_head = 0;
+    g_tail = 0;
+    g_dropped = 0;
+    g_enabled = enabled;
+    critical_section_exit(&g_trace_lock);
+}
+
+bool sensor_trace_is_enabled(void) {
+    return g_enabled;
+}
+
+void sensor_trace_record(uint8_t bus, uint8_t addr, const uint8_t *data, size_t len) {
+    if (!g_enabled) return;
+    if (len > SENSOR_TRACE_FRAME_MAX) len = SENSOR_TRACE_FRAME_MAX;
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    critical_section_enter_blocking(&g_trace_lock);
+    if (g_head - g_tail >= SENSOR_TRACE_DEPTH) {
+        g_dropped++;
+    } else {
+        sensor_trace_frame_t *f = &g_frames[g_head % SENSOR_TRACE_DEPTH];
+        f->t_ms = now_ms;
+        f->bus = bus;
+        f->addr = addr;
+        f->len = (uint8_t)len;
+        memcpy(f->data, data, len);
+        g_head++;
+    }
+    critical_section_exit(&g_trace_lock);
+}
+
+size_t sensor_trace_drain(sensor_trace_frame_t *out, size_t max) {
+    if (!critical_section_is_initialized(&g_trace_lock)) return 0;
+
+    size_t n = 0;
+    critical_section_enter_blocking(&g_trace_lock);
+    while (n < max && g_tail != g_head) {
+        out[n++] = g_frames[g_tail % SENSOR_TRACE_DEPTH];
+        g_tail++;
+    }
+    critical_section_exit(&g_trace_lock);
+    return n;
+}
+
+uint32_t sensor_trace_dropped(void) {
+    return g_dropped;
+}
+
+// ============= FORMATO TEXTO =============
+
+int sensor_trace_format(const sensor_trace_frame_t *frame, char *buffer, size_t size) {
+    int len = snprintf(buffer, size, "TRC %lu %u %02x ",
+                       (unsigned long)frame->t_ms, frame->bus, frame->addr);
+    for (uint8_t i = 0; i < frame->len && len > 0 && (size_t)len < size; i++) {
+        len += snprintf(buffer + len, size - (size_t)len, "%02x", frame->data[i]);
+    }
+    return len;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool sensor_trace_parse(const char *line, sensor_trace_frame_t *frame) {
+    // Aceita prefixos do terminal serial antes de "TRC "
+    const char *p = strstr(line, "TRC ");
+    if (!p) return false;
+
+    unsigned long t_ms;
+    unsigned int bus, addr;
+    int consumed = 0;
+    if (sscanf(p, "TRC %lu %u %x %n", &t_ms, &bus, &addr, &consumed) != 3 || consumed == 0) {
+        return false;
+    }
+    p += consumed;
+
+    memset(frame, 0, sizeof(*frame));
+    frame->t_ms = (uint32_t)t_ms;
+    frame->bus = (uint8_t)bus;
+    frame->addr = (uint8_t)addr;
+    while (frame->len < SENSOR_TRACE_FRAME_MAX) {
+        int hi = hex_value(p[0]);
+        int lo = (hi >= 0) ? hex_value(p[1]) : -1;
+        if (lo < 0) break;
+        frame->data[frame->len++] = (uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+    return frame->len > 0;
+}
@@ -0,0 +1,45 @@
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Gravação dos quadros brutos lidos no I2C, para reproduzir no host
+// (tools/replay) o que os sensores entregaram em campo. Cada quadro vira
+// uma linha de texto na UART:
+//
+//   TRC <t_ms> <barramento> <endereço hex> <bytes hex>
+//   TRC 123456 1 23 0a3f
+//
+// O mesmo formato é lido pelo replay, então basta salvar o log serial.
+
+#define SENSOR_TRACE_FRAME_MAX 8    // Maior leitura gravada (AHT10 = 6 bytes)
+#define SENSOR_TRACE_DEPTH     32   // Quadros aguardando a UART
+#define SENSOR_TRACE_LINE_MAX  48   // Linha formatada, com terminador
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t bus;
+    uint8_t addr;
+    uint8_t len;
+    uint8_t data[SENSOR_TRACE_FRAME_MAX];
+} sensor_trace_frame_t;
+
+// Liga/desliga a gravação (desligada no boot; custo zero quando desligada)
+void sensor_trace_set_enabled(bool enabled);
+bool sensor_trace_is_enabled(void);
+
+// Registra uma leitura bem-sucedida (chamado pelo i2c_async). Com a fila
+// cheia o quadro é descartado e contado em sensor_trace_dropped().
+void sensor_trace_record(uint8_t bus, uint8_t addr, const uint8_t *data, size_t len);
+
+// Retira até max quadros na ordem de gravação
+size_t sensor_trace_drain(sensor_trace_frame_t *out, size_t max);
+uint32_t sensor_trace_dropped(void);
+
+// Conversão entre quadro e linha de texto
+int sensor_trace_format(const sensor_trace_frame_t *frame, char *buffer, size_t size);
+bool sensor_trace_parse(const char *line, sensor_trace_frame_t *frame);
+
+#endif // SENSOR_TRACE_H
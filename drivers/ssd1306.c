@@ -1,4 +1,5 @@
 #include "ssd1306.h"
+#include "i2c_async.h"
 #include <string.h>
 
 // Font 5x8 simples
@@ -104,7 +105,16 @@ static const uint8_t font[96][5] = {
 // Envia um comando para o SSD1306
 static void ssd1306_send_cmd(ssd1306_t *display, uint8_t cmd) {
     uint8_t buf[2] = {0x00, cmd};
-    i2c_write_blocking(display->i2c_port, display->address, buf, 2, false);
+    i2c_async_write(display->i2c_port, display->address, buf, 2);
+}
+
+// Envia uma sequência de comandos numa única transação (Co = 0)
+static void ssd1306_send_cmds(ssd1306_t *display, const uint8_t *cmds, size_t count) {
+    uint8_t buf[8];
+    if (count + 1 > sizeof(buf)) return;
+    buf[0] = 0x00;
+    memcpy(buf + 1, cmds, count);
+    i2c_async_write(display->i2c_port, display->address, buf, count + 1);
 }
 
 // Inicializa o display SSD1306
@@ -150,21 +160,15 @@ void ssd1306_clear(ssd1306_t *display) {
 
 // Atualiza o display com o conteúdo do buffer
 void ssd1306_show(ssd1306_t *display) {
-    ssd1306_send_cmd(display, SSD1306_SET_COL_ADDR);
-    ssd1306_send_cmd(display, 0);
-    ssd1306_send_cmd(display, SSD1306_WIDTH - 1);
+    const uint8_t window[] = {
+        SSD1306_SET_COL_ADDR, 0, SSD1306_WIDTH - 1,
+        SSD1306_SET_PAGE_ADDR, 0, (SSD1306_HEIGHT / 8) - 1
+    };
+    ssd1306_send_cmds(display, window, sizeof(window));
     
-    ssd1306_send_cmd(display, SSD1306_SET_PAGE_ADDR);
-    ssd1306_send_cmd(display, 0);
-    ssd1306_send_cmd(display, (SSD1306_HEIGHT / 8) - 1);
-    
-    // Envia o buffer
-    for (int i = 0; i < sizeof(display->buffer); i += 16) {
-        uint8_t buf[17];
-        buf[0] = 0x40; // Co = 0, D/C = 1
-        memcpy(buf + 1, display->buffer + i, 16);
-        i2c_write_blocking(display->i2c_port, display->address, buf, 17, false);
-    }
+    // Envia o buffer inteiro numa só transação (prefixo + 1024 bytes via DMA)
+    display->data_prefix = 0x40; // Co = 0, D/C = 1
+    i2c_async_write(display->i2c_port, display->address, &display->data_prefix, 1 + sizeof(display->buffer));
 }
 
 // Desenha um pixel no buffer
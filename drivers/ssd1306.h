@@ -34,6 +34,7 @@ typedef struct {
     uint8_t address;
     uint8_t width;
     uint8_t height;
+    uint8_t data_prefix;  // Byte de controle 0x40, contíguo ao buffer para o flush
     uint8_t buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
 } ssd1306_t;
 
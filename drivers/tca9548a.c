@@ -0,0 +1,127 @@
+#include "tca9548a.h"
+#include "i2c_async.h"
+#include "sensor_registry.h"
+#include <stdio.h>
+#include <string.h>
+
+// Escreve a máscara de canais; o cache só é confiável após um ACK
+static bool tca9548a_write_mask(tca9548a_t *mux, uint8_t mask) {
+    if (mux->cache_valid && mux->selected == mask) {
+        mux->stats.cache_hits++;
+        return true;
+    }
+
+    if (i2c_async_write(mux->i2c_port, mux->address, &mask, 1) != 1) {
+        // Estado do chip desconhecido: a próxima seleção escreve de novo
+        mux->cache_valid = false;
+        mux->selected = 0;
+        mux->stats.errors++;
+        return false;
+    }
+
+    mux->selected = mask;
+    mux->cache_valid = true;
+    mux->stats.switches++;
+    return true;
+}
+
+// Inicializa o multiplexador com todos os canais desabilitados
+bool tca9548a_init(tca9548a_t *mux, i2c_inst_t *i2c_port, uint8_t address) {
+    memset(mux, 0, sizeof(*mux));
+    mux->i2c_port = i2c_port;
+    mux->address = address;
+    return tca9548a_write_mask(mux, 0);
+}
+
+bool tca9548a_select(tca9548a_t *mux, uint8_t channel) {
+    if (channel >= TCA9548A_CHANNELS) {
+        return false;
+    }
+    return tca9548a_write_mask(mux, (uint8_t)(1u << channel));
+}
+
+bool tca9548a_disable(tca9548a_t *mux) {
+    return tca9548a_write_mask(mux, 0);
+}
+
+void tca9548a_invalidate(tca9548a_t *mux) {
+    mux->cache_valid = false;
+    mux->selected = 0;
+}
+
+bool tca9548a_probe(tca9548a_t *mux, uint8_t channel, uint8_t address) {
+    if (!tca9548a_select(mux, channel)) {
+        return false;
+    }
+    uint8_t data;
+    return i2c_async_read(mux->i2c_port, address, &data, 1) >= 0;
+}
+
+// ============= SENSOR ATRÁS DO MUX =============
+
+static bool mux_sensor_init(void *dev) {
+    tca9548a_sensor_t *sensor = (tca9548a_sensor_t *)dev;
+    if (!tca9548a_select(sensor->mux, sensor->channel)) {
+        return false;
+    }
+    return sensor->inner->init ? sensor->inner->init(sensor->dev) : true;
+}
+
+static bool mux_sensor_start(void *dev) {
+    tca9548a_sensor_t *sensor = (tca9548a_sensor_t *)dev;
+    if (!tca9548a_select(sensor->mux, sensor->channel)) {
+        return false;
+    }
+    return sensor->inner->start(sensor->dev);
+}
+
+static sensor_sched_result_t mux_sensor_collect(void *dev, bool last_attempt, int32_t *values) {
+    tca9548a_sensor_t *sensor = (tca9548a_sensor_t *)dev;
+    if (!tca9548a_select(sensor->mux, sensor->channel)) {
+        return SENSOR_SCHED_FAIL;
+    }
+    return sensor->inner->collect(sensor->dev, last_attempt, values);
+}
+
+int tca9548a_sensor_register(tca9548a_sensor_t *sensor, tca9548a_t *mux, uint8_t channel,
+                             const sensor_driver_t *inner, void *dev, bool keep_series) {
+    if (channel >= TCA9548A_CHANNELS || !inner || inner->metric_count > SENSOR_DRIVER_MAX_METRICS) {
+        return -1;
+    }
+
+    memset(sensor, 0, sizeof(*sensor));
+    sensor->mux = mux;
+    sensor->channel = channel;
+    sensor->inner = inner;
+    sensor->dev = dev;
+
+    unsigned bus = i2c_get_index(mux->i2c_port);
+    snprintf(sensor->name, sizeof(sensor->name), "%s@%u.%u", inner->name, bus, channel);
+
+    for (uint8_t m = 0; m < inner->metric_count; m++) {
+        sensor_metric_desc_t *desc = &sensor->metrics[m];
+        *desc = inner->metrics[m];
+
+        snprintf(sensor->keys[m], sizeof(sensor->keys[m]), "%s@%u.%u", desc->key, bus, channel);
+        // Rótulo do display: até 4 letras do original + canal ("Temp3")
+        snprintf(sensor->labels[m], sizeof(sensor->labels[m]), "%.4s%u", desc->label, channel);
+        desc->key = sensor->keys[m];
+        desc->label = sensor->labels[m];
+        if (!keep_series) {
+            desc->ts_metric = SENSOR_METRIC_NO_SERIES;
+        }
+    }
+
+    sensor->driver = *inner;
+    sensor->driver.name = sensor->name;
+    sensor->driver.metrics = sensor->metrics;
+    sensor->driver.init = mux_sensor_init;
+    sensor->driver.start = mux_sensor_start;
+    sensor->driver.collect = mux_sensor_collect;
+
+    int index = sensor_registry_add(&sensor->driver, sensor);
+    if (index >= 0) {
+        sensor_registry_set_route(index, &mux->selected, (uint8_t)(1u << channel));
+    }
+    return index;
+}
@@ -0,0 +1,71 @@
+#ifndef TCA9548A_H
+#define TCA9548A_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "sensor_driver.h"
+
+// Endereço I2C base do TCA9548A (A2..A0 em LOW); vai até 0x77
+#define TCA9548A_ADDR_BASE  0x70
+
+// Canais por multiplexador
+#define TCA9548A_CHANNELS   8
+
+// Contadores do multiplexador
+typedef struct {
+    uint32_t switches;      // Escritas de seleção de canal
+    uint32_t cache_hits;    // Seleções atendidas pelo cache, sem tráfego no barramento
+    uint32_t errors;        // Escritas de seleção sem ACK
+} tca9548a_stats_t;
+
+// Estrutura do multiplexador. "selected" é a máscara de canais habilitada
+// no chip, conhecida enquanto cache_valid; só este driver escreve nele.
+typedef struct {
+    i2c_inst_t *i2c_port;
+    uint8_t address;
+    uint8_t selected;
+    bool cache_valid;
+    tca9548a_stats_t stats;
+} tca9548a_t;
+
+// Funções públicas
+bool tca9548a_init(tca9548a_t *mux, i2c_inst_t *i2c_port, uint8_t address);  // Desabilita todos os canais
+bool tca9548a_select(tca9548a_t *mux, uint8_t channel);                       // Só escreve se o canal mudou
+bool tca9548a_disable(tca9548a_t *mux);
+void tca9548a_invalidate(tca9548a_t *mux);  // Força a próxima seleção (ex.: após reset do barramento)
+
+// Verifica se há um dispositivo respondendo no endereço, no canal dado
+bool tca9548a_probe(tca9548a_t *mux, uint8_t channel, uint8_t address);
+
+// Tamanhos dos nomes gerados para um sensor atrás do mux
+#define TCA9548A_SENSOR_NAME_LEN   16
+#define TCA9548A_METRIC_KEY_LEN    16
+#define TCA9548A_METRIC_LABEL_LEN  7
+
+// Sensor atrás de um canal do mux: envolve o driver do sensor (AHT10,
+// BH1750...) num driver que seleciona o canal antes de cada acesso. Como
+// vários sensores iguais compartilham o endereço, nome e chaves ganham o
+// sufixo "@<barramento>.<canal>" (ex.: "AHT10@0.3", "temp@0.3").
+typedef struct {
+    tca9548a_t *mux;
+    uint8_t channel;
+    const sensor_driver_t *inner;
+    void *dev;
+
+    // Driver e descrições próprios desta instância
+    sensor_driver_t driver;
+    sensor_metric_desc_t metrics[SENSOR_DRIVER_MAX_METRICS];
+    char name[TCA9548A_SENSOR_NAME_LEN];
+    char keys[SENSOR_DRIVER_MAX_METRICS][TCA9548A_METRIC_KEY_LEN];
+    char labels[SENSOR_DRIVER_MAX_METRICS][TCA9548A_METRIC_LABEL_LEN];
+} tca9548a_sensor_t;
+
+// Registra o sensor (dev = estado do driver interno) no registro de
+// sensores, com a rota do canal para o escalonador agrupar os acessos.
+// Com keep_series = false as grandezas não alimentam séries/detector
+// (só um sensor de cada grandeza pode ser o principal).
+// Retorna o índice no registro ou -1.
+int tca9548a_sensor_register(tca9548a_sensor_t *sensor, tca9548a_t *mux, uint8_t channel,
+                             const sensor_driver_t *inner, void *dev, bool keep_series);
+
+#endif // TCA9548A_H
@@ -23,6 +23,7 @@
 #define configUSE_EVENT_GROUPS                  1
 #define configUSE_TIME_SLICING                  1
 #define configUSE_NEWLIB_REENTRANT              1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2   // Índice 1: conclusão de I2C assíncrono
 
 #define INCLUDE_xEventGroupSetBits              1
 #define INCLUDE_xEventGroupSetBitsFromISR       1
@@ -55,5 +56,7 @@
 #define INCLUDE_vTaskDelay                      1
 #define INCLUDE_vTaskDelayUntil                 1
 #define INCLUDE_vTaskDelete                     1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
 
 #endif // FREERTOS_CONFIG_H
@@ -0,0 +1,85 @@
+#ifndef ADAPTIVE_RATE_H
+#define ADAPTIVE_RATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Grandezas avaliadas juntas por um sensor (AHT10: temperatura e umidade)
+ */
+#define ADAPTIVE_MAX_CHANNELS 2
+
+/**
+ * @brief Limites de atividade de uma grandeza (valores em centésimos)
+ *
+ * Qualquer limite ultrapassado faz o sensor voltar ao período mínimo.
+ */
+typedef struct {
+    int32_t delta;              // Desvio em relação à âncora que conta como mudança
+    uint8_t delta_shift;        // Soma |âncora| >> delta_shift ao desvio (0 = só absoluto)
+    int32_t max_rate_per_s;     // Variação por segundo entre amostras (0 = ignorada)
+    int32_t max_noise;          // Média exponencial de |diferença| entre amostras (0 = ignorada)
+} adaptive_channel_config_t;
+
+/**
+ * @brief Parâmetros de um sensor
+ */
+typedef struct {
+    uint32_t min_period_ms;     // Período com sinal em movimento (taxa máxima)
+    uint32_t max_period_ms;     // Período com sinal estável
+    uint8_t calm_samples;       // Amostras calmas seguidas antes de dobrar o período
+    uint8_t channels;
+    adaptive_channel_config_t channel[ADAPTIVE_MAX_CHANNELS];
+} adaptive_config_t;
+
+/**
+ * @brief Contadores por sensor
+ */
+typedef struct {
+    uint32_t samples;
+    uint32_t triggers;          // Amostras que devolveram o sensor ao período mínimo
+    uint32_t slowdowns;         // Vezes em que o período dobrou
+} adaptive_stats_t;
+
+/**
+ * @brief Estado do controle de período de um sensor
+ *
+ * Com o sinal estável, o período dobra a cada calm_samples amostras até
+ * max_period_ms; na primeira amostra fora dos limites volta de imediato
+ * a min_period_ms. A âncora só é reposicionada nessas subidas, então uma
+ * deriva lenta também acaba detectada. O(1) por amostra, sem float.
+ */
+typedef struct {
+    adaptive_config_t cfg;
+    bool enabled;
+    bool primed;
+    uint8_t calm;
+    uint32_t period_ms;
+    uint32_t last_t_ms;
+    int32_t anchor[ADAPTIVE_MAX_CHANNELS];
+    int32_t last[ADAPTIVE_MAX_CHANNELS];
+    int32_t noise_q4[ADAPTIVE_MAX_CHANNELS];
+    adaptive_stats_t stats;
+} adaptive_rate_t;
+
+/**
+ * @brief Inicializa no período mínimo, com a adaptação habilitada
+ */
+void adaptive_rate_init(adaptive_rate_t *a, const adaptive_config_t *cfg);
+
+/**
+ * @brief Liga/desliga a adaptação; desligada, o período fica no mínimo
+ */
+void adaptive_rate_set_enabled(adaptive_rate_t *a, bool enabled);
+
+/**
+ * @brief Avalia uma amostra e devolve o período até a próxima
+ *
+ * @param values Uma amostra por canal (cfg.channels), em centésimos
+ * @param active Atividade detectada fora daqui (ex.: marca do detector
+ *        de anomalias); força o período mínimo
+ * @return Novo período em ms
+ */
+uint32_t adaptive_rate_update(adaptive_rate_t *a, uint32_t t_ms, const int32_t *values, bool active);
+
+#endif // ADAPTIVE_RATE_H
@@ -0,0 +1,98 @@
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "timeseries.h"
+
+/**
+ * @brief Marcas atribuídas a uma amostra (máscara de bits)
+ */
+#define ANOMALY_FLAG_ZSCORE   (1u << 0)  // Afastada da média além de z_limit desvios
+#define ANOMALY_FLAG_RATE     (1u << 1)  // Variação por segundo acima do limite
+#define ANOMALY_FLAG_REJECTED (1u << 2)  // Descartada: o último valor aceito é mantido
+
+/**
+ * @brief Parâmetros de detecção de uma grandeza (valores em centésimos)
+ */
+typedef struct {
+    uint8_t alpha_shift;        // Peso da EWMA = 1 / 2^alpha_shift
+    uint8_t z_limit;            // Desvios padrão tolerados
+    int32_t min_stddev;         // Piso do desvio, para séries muito estáveis
+    int32_t max_rate_per_s;     // Variação máxima por segundo (0 = sem limite)
+    uint16_t warmup;            // Amostras sem teste de z enquanto a média converge
+    uint8_t max_rejects;        // Rejeições seguidas até aceitar um novo patamar
+    bool reject;                // false = apenas marca, sem descartar
+} anomaly_config_t;
+
+/**
+ * @brief Contadores por grandeza
+ */
+typedef struct {
+    uint32_t samples;
+    uint32_t flagged_zscore;
+    uint32_t flagged_rate;
+    uint32_t rejected;
+    uint32_t rebaselines;       // Novos patamares aceitos após max_rejects
+} anomaly_stats_t;
+
+/**
+ * @brief Estado incremental de uma grandeza
+ *
+ * Média e variância exponenciais em ponto fixo (Q8) e o último valor
+ * aceito para o limite de taxa. Cada amostra custa O(1) e o resultado
+ * depende só da sequência (instante, valor), então um trace gravado
+ * reproduz exatamente as mesmas decisões no host.
+ */
+typedef struct {
+    anomaly_config_t cfg;
+    int64_t mean_q8;
+    int64_t var_q8;
+    uint32_t count;             // Amostras aceitas desde o último patamar
+    int32_t last_value;
+    uint32_t last_t_ms;
+    uint8_t consecutive_rejects;
+    anomaly_stats_t stats;
+} anomaly_metric_t;
+
+/**
+ * @brief Detector das grandezas do monitor, indexado por ts_metric_t
+ */
+typedef struct {
+    anomaly_metric_t metric[TS_METRIC_COUNT];
+} anomaly_detector_t;
+
+/**
+ * @brief Inicializa o detector com os parâmetros padrão de cada grandeza
+ */
+void anomaly_detector_init(anomaly_detector_t *det);
+
+/**
+ * @brief Inicializa uma grandeza com parâmetros próprios
+ */
+void anomaly_metric_init(anomaly_metric_t *m, const anomaly_config_t *cfg);
+
+/**
+ * @brief Avalia uma amostra e atualiza o estado
+ *
+ * @param out_value Valor a publicar: a própria amostra ou, se rejeitada,
+ *        o último valor aceito
+ * @return Marcas ANOMALY_FLAG_* (0 = amostra normal)
+ */
+uint8_t anomaly_metric_check(anomaly_metric_t *m, uint32_t t_ms, int32_t value, int32_t *out_value);
+
+/**
+ * @brief anomaly_metric_check() para a grandeza indicada
+ */
+uint8_t anomaly_detector_check(anomaly_detector_t *det, ts_metric_t metric,
+                               uint32_t t_ms, int32_t value, int32_t *out_value);
+
+/**
+ * @brief Obtém uma cópia dos contadores de uma grandeza
+ * @return false se a grandeza for inválida
+ */
+bool anomaly_detector_get_stats(const anomaly_detector_t *det, ts_metric_t metric, anomaly_stats_t *out);
+
+#endif // ANOMALY_DETECTOR_H
@@ -0,0 +1,37 @@
+#ifndef APP_CONTROL_H
+#define APP_CONTROL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_context.h"
+
+/**
+ * @brief Maior período fixo aceito por "RATE <ms>"
+ */
+#define APP_CONTROL_RATE_MAX_MS 60000
+
+/**
+ * @brief Liga/desliga a matriz de LEDs e publica o novo estado
+ *
+ * Toma o mutex dos dados: chamar só de uma task, nunca de callback do lwIP.
+ */
+void app_control_set_led(const app_context_t *ctx, bool on);
+
+/**
+ * @brief Interpreta "<ms>" ou "AUTO" (0) como período de amostragem
+ *
+ * @return false se o texto não for um período entre 1 e APP_CONTROL_RATE_MAX_MS
+ */
+bool app_control_parse_rate(const char *arg, uint32_t *period_ms);
+
+/**
+ * @brief Executa um comando de controle remoto (mesma sintaxe da UART)
+ *
+ * Aceita "LED ON", "LED OFF", "RATE <ms>" e "RATE AUTO", sem diferenciar
+ * maiúsculas.
+ *
+ * @return true se o comando foi reconhecido e aplicado
+ */
+bool app_control_execute(const app_context_t *ctx, const char *command);
+
+#endif // APP_CONTROL_H
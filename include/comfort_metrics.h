@@ -0,0 +1,43 @@
+#ifndef COMFORT_METRICS_H
+#define COMFORT_METRICS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Faixa de temperatura coberta pela tabela de pressão de saturação
+ *
+ * Fora dela os cálculos usam o extremo mais próximo.
+ */
+#define COMFORT_TABLE_MIN_C  (-40)
+#define COMFORT_TABLE_MAX_C  80
+
+/**
+ * @brief Métricas de conforto derivadas de temperatura e umidade
+ *
+ * Todas em centésimos, como as grandezas medidas.
+ */
+typedef struct {
+    int32_t dew_point_centi;       // Ponto de orvalho (°C)
+    int32_t abs_humidity_centi;    // Umidade absoluta (g/m³)
+    int32_t heat_index_centi;      // Índice de calor NOAA (°C)
+} comfort_metrics_t;
+
+/**
+ * @brief Pressão de vapor de saturação sobre água (Magnus, WMO)
+ *
+ * Interpolação linear numa tabela de 1 °C, sem exp().
+ *
+ * @param temp_centi Temperatura em centésimos de °C
+ * @return Pressão em centésimos de Pa
+ */
+uint32_t comfort_saturation_pressure(int32_t temp_centi);
+
+/**
+ * @brief Calcula ponto de orvalho, umidade absoluta e índice de calor
+ *
+ * Só inteiros: a tabela substitui exp()/log() e o índice de calor é a
+ * regressão polinomial da NOAA em ponto fixo.
+ */
+void comfort_metrics_compute(int32_t temp_centi, int32_t humidity_centi, comfort_metrics_t *out);
+
+#endif // COMFORT_METRICS_H
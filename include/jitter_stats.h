@@ -0,0 +1,49 @@
+#ifndef JITTER_STATS_H
+#define JITTER_STATS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Compartimentos do histograma de atrasos
+ *
+ * Valores de 0 a 7 µs têm um compartimento cada; acima disso, cada
+ * potência de dois é dividida em 4, o que limita o erro de um percentil
+ * a 25% do valor. Atrasos acima de 2^21 µs (~2 s) caem no último.
+ */
+#define JITTER_STATS_BINS 80
+
+/**
+ * @brief Atrasos em relação ao agendado, em µs
+ *
+ * Memória fixa e O(1) por amostra; os percentis saem do histograma.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bins[JITTER_STATS_BINS];
+} jitter_stats_t;
+
+/**
+ * @brief Zera as estatísticas
+ */
+void jitter_stats_reset(jitter_stats_t *js);
+
+/**
+ * @brief Registra um atraso
+ */
+void jitter_stats_add(jitter_stats_t *js, uint32_t delay_us);
+
+/**
+ * @brief Atraso médio em µs (0 sem amostras)
+ */
+uint32_t jitter_stats_mean_us(const jitter_stats_t *js);
+
+/**
+ * @brief Percentil do atraso em µs (limite superior do compartimento)
+ * @param permille Percentil em milésimos (990 = p99)
+ */
+uint32_t jitter_stats_percentile_us(const jitter_stats_t *js, uint32_t permille);
+
+#endif // JITTER_STATS_H
@@ -0,0 +1,89 @@
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Sub-intervalos por janela (resolução da janela = duração / buckets)
+ */
+#ifndef ROLLING_STATS_BUCKETS
+#define ROLLING_STATS_BUCKETS 20
+#endif
+
+/**
+ * @brief Resultado de uma janela (mesma escala inteira dos valores inseridos)
+ */
+typedef struct {
+    uint32_t count;
+    int32_t mean;
+    int32_t min;
+    int32_t max;
+    int64_t variance;      // Escala ao quadrado
+} rolling_result_t;
+
+/**
+ * @brief Agregado de um sub-intervalo
+ */
+typedef struct {
+    uint32_t index;        // Número do sub-intervalo (contínuo desde o primeiro)
+    uint32_t count;
+    int64_t sum;
+    int64_t sum_sq;
+    int32_t min;
+    int32_t max;
+} rolling_bucket_t;
+
+/**
+ * @brief Fila monotônica de sub-intervalos (índices) para min ou max
+ */
+typedef struct {
+    uint32_t items[ROLLING_STATS_BUCKETS];
+    uint8_t head;
+    uint8_t size;
+} rolling_deque_t;
+
+/**
+ * @brief Janela deslizante de duração fixa
+ *
+ * Somas acumuladas dão média e variância; filas monotônicas sobre os
+ * sub-intervalos fechados dão mínimo e máximo. Cada amostra custa
+ * O(1), independente da duração da janela.
+ */
+typedef struct {
+    uint32_t bucket_ms;
+    bool started;
+    uint32_t current_start_ms;                       // Início do sub-intervalo atual
+    rolling_bucket_t current;
+    rolling_bucket_t closed[ROLLING_STATS_BUCKETS];  // Por índice % ROLLING_STATS_BUCKETS
+    uint32_t total_count;                            // Somas dos sub-intervalos fechados na janela
+    int64_t total_sum;
+    int64_t total_sum_sq;
+    rolling_deque_t min_q;
+    rolling_deque_t max_q;
+} rolling_window_t;
+
+/**
+ * @brief Inicializa uma janela vazia
+ * @param window_ms Duração da janela (arredondada para múltiplo de ROLLING_STATS_BUCKETS ms)
+ */
+void rolling_window_init(rolling_window_t *w, uint32_t window_ms);
+
+/**
+ * @brief Insere uma amostra (instantes não decrescentes; a volta do
+ *        contador de ms após ~49 dias é tratada)
+ */
+void rolling_window_add(rolling_window_t *w, uint32_t t_ms, int32_t value);
+
+/**
+ * @brief Descarta sub-intervalos que saíram da janela até now_ms
+ */
+void rolling_window_advance(rolling_window_t *w, uint32_t now_ms);
+
+/**
+ * @brief Calcula o resultado atual (count = 0 se a janela estiver vazia)
+ */
+void rolling_window_result(const rolling_window_t *w, rolling_result_t *out);
+
+#endif // ROLLING_STATS_H
@@ -1,7 +1,10 @@
 #ifndef RTOS_TASKS_H
 #define RTOS_TASKS_H
 
+#include "anomaly_detector.h"
 #include "app_context.h"
+#include "sensor_scheduler.h"
+#include "sample_log.h"
 
 #include "FreeRTOS.h"
 #include "semphr.h"
@@ -9,11 +12,18 @@
 typedef struct {
     const app_context_t *ctx;
     SemaphoreHandle_t sensor_mutex;
+    sensor_scheduler_t *scheduler;
+    anomaly_detector_t *detector;
 } rtos_task_params_t;
 
 void task_sensors(void *param);
 void task_display(void *param);
 void task_uart(void *param);
 void task_web(void *param);
+void task_storage(void *param);
+
+// Acesso ao log persistente mantido por task_storage
+size_t task_storage_latest(sample_log_entry_t *out, size_t max_entries);
+bool task_storage_get_stats(sample_log_stats_t *out, uint16_t *boot_id);
 
 #endif // RTOS_TASKS_H
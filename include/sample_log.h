@@ -0,0 +1,115 @@
+#ifndef SAMPLE_LOG_H
+#define SAMPLE_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "series_codec.h"
+
+/**
+ * @brief Geometria da flash: programação por página, apagamento por setor
+ */
+#define SAMPLE_LOG_PAGE_SIZE   256u
+#define SAMPLE_LOG_SECTOR_SIZE 4096u
+#define SAMPLE_LOG_PAGES_PER_SECTOR (SAMPLE_LOG_SECTOR_SIZE / SAMPLE_LOG_PAGE_SIZE)
+
+/**
+ * @brief Cabeçalho gravado no início de cada página (bloco) do log
+ */
+#define SAMPLE_LOG_HEADER_SIZE 16u
+
+/**
+ * @brief Bytes de amostras por página (comprimidas com series_codec)
+ */
+#define SAMPLE_LOG_PAYLOAD_SIZE (SAMPLE_LOG_PAGE_SIZE - SAMPLE_LOG_HEADER_SIZE)
+
+/**
+ * @brief Máximo de amostras em uma página
+ */
+#define SAMPLE_LOG_PAGE_MAX_ENTRIES 255u
+
+/**
+ * @brief Amostra persistida (valores em centésimos, como na série temporal)
+ */
+typedef struct {
+    uint16_t boot_id;            // Boot em que a amostra foi registrada
+    uint32_t t_ms;               // ms desde aquele boot
+    bool temp_humidity_valid;
+    int16_t temperature_centi;
+    uint16_t humidity_centi;
+    bool luminosity_valid;
+    uint32_t luminosity_centi;
+} sample_log_entry_t;
+
+/**
+ * @brief Acesso à região de flash reservada (offsets relativos à região)
+ *
+ * Permite usar a flash do Pico ou, em testes, um arquivo que simula
+ * a região (inclusive cortes de energia no meio de uma gravação).
+ */
+typedef struct {
+    bool (*read)(void *ctx, uint32_t offset, void *dst, size_t len);
+    bool (*program)(void *ctx, uint32_t offset, const void *src, size_t len);
+    bool (*erase)(void *ctx, uint32_t offset, size_t len);
+    void *ctx;
+    uint32_t size;               // Tamanho da região (múltiplo de setor, >= 2 setores)
+} sample_log_flash_t;
+
+/**
+ * @brief Contadores do log
+ */
+typedef struct {
+    uint32_t entries_appended;
+    uint32_t pages_written;
+    uint32_t sectors_erased;
+    uint32_t pages_corrupt;      // Páginas com CRC inválido encontradas
+    uint32_t recovery_pages_read;
+    uint32_t write_errors;
+} sample_log_stats_t;
+
+/**
+ * @brief Log circular de amostras em flash
+ *
+ * Cada página é gravada uma única vez por ciclo de apagamento e os
+ * setores são reutilizados em ordem, o que distribui o desgaste de
+ * forma uniforme. As amostras são comprimidas em RAM até a página
+ * encher (~50-65 amostras por página com as séries da task_storage,
+ * contra 20 sem compressão).
+ */
+typedef struct {
+    const sample_log_flash_t *flash;
+    uint32_t head;               // Offset da próxima página a gravar
+    uint32_t next_seq;           // Sequência da próxima página
+    uint16_t boot_id;
+    uint8_t page[SAMPLE_LOG_PAGE_SIZE];
+    series_encoder_t enc;        // Amostras da página atual, ainda em RAM
+    sample_log_stats_t stats;
+} sample_log_t;
+
+/**
+ * @brief Recupera o ponto de escrita a partir dos cabeçalhos
+ *
+ * Lê a primeira página de cada setor para achar o setor mais novo e
+ * depois apenas os cabeçalhos desse setor. Páginas parcialmente
+ * gravadas (corte de energia) são ignoradas.
+ *
+ * @return false se a região for inválida
+ */
+bool sample_log_init(sample_log_t *log, const sample_log_flash_t *flash);
+
+/**
+ * @brief Acrescenta uma amostra; grava a página quando ela enche
+ *
+ * O campo boot_id da amostra é ignorado (usa o boot atual).
+ * @return false se a gravação da página falhar
+ */
+bool sample_log_append(sample_log_t *log, const sample_log_entry_t *entry);
+
+/**
+ * @brief Copia as amostras mais recentes (incluindo as ainda em RAM)
+ * @return Número de amostras em out, da mais antiga para a mais nova
+ */
+size_t sample_log_latest(sample_log_t *log, sample_log_entry_t *out, size_t max_entries);
+
+#endif // SAMPLE_LOG_H
@@ -3,27 +3,41 @@
 
 #include "pico/stdlib.h"
 #include "led_matrix.h"
+#include "anomaly_detector.h"
+#include "comfort_metrics.h"
+#include "rolling_stats.h"
+#include "sensor_units.h"
+#include "timeseries.h"
 
 #ifdef USE_FREERTOS
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 #endif
 
 /**
  * @brief Estrutura que armazena todos os dados dos sensores
  * 
  * Esta estrutura centraliza os dados coletados pelos sensores
- * para serem consumidos pelo display e pelo web server.
+ * para serem consumidos pelo display e pelo web server. As grandezas
+ * ficam em centésimos (SENSOR_SCALE); a conversão para texto é feita
+ * só na apresentação, com sensor_units_format().
  */
 typedef struct {
     // Dados do sensor BH1750 (luminosidade)
-    float luminosity_lux;
+    int32_t luminosity_centi;      // Centésimos de lux
     bool luminosity_valid;
     
     // Dados do sensor AHT10 (temperatura e umidade)
-    float temperature_c;
-    float humidity_percent;
+    int32_t temperature_centi;     // Centésimos de °C
+    int32_t humidity_centi;        // Centésimos de %
     bool temp_humidity_valid;
+
+    // Derivadas de temperatura/umidade, calculadas uma vez por amostra do AHT10
+    comfort_metrics_t comfort;
+
+    // Marcas ANOMALY_FLAG_* da última amostra de cada grandeza (por ts_metric_t)
+    uint8_t anomaly_flags[TS_METRIC_COUNT];
     
     // Estado da matriz de LEDs
     bool led_matrix_enabled;
@@ -31,46 +45,255 @@ typedef struct {
     
     // Timestamp da última atualização (em ms desde o boot)
     uint32_t last_update_ms;
+
+    // Instante da última atualização de cada grupo de campos (ms desde o boot)
+    uint32_t luminosity_update_ms;
+    uint32_t temp_humidity_update_ms;
+    uint32_t led_update_ms;
+
+    // Instante da captura (disparo da conversão) de cada amostra, em µs desde o boot
+    uint64_t luminosity_capture_us;
+    uint64_t temp_humidity_capture_us;
+
+    // Versão do snapshot (cresce a cada commit) e campos alterados nele
+    uint32_t version;
+    uint32_t changed_fields;
 } sensor_data_t;
 
+/**
+ * @brief Grupos de campos que uma transação pode alterar (máscara de bits)
+ */
+typedef enum {
+    SENSOR_FIELD_LUMINOSITY    = 1u << 0,
+    SENSOR_FIELD_TEMP_HUMIDITY = 1u << 1,
+    SENSOR_FIELD_LED           = 1u << 2
+} sensor_field_t;
+
+#define SENSOR_FIELD_ALL (SENSOR_FIELD_LUMINOSITY | SENSOR_FIELD_TEMP_HUMIDITY | SENSOR_FIELD_LED)
+
+/**
+ * @brief Transação de escrita: acumula os campos de um ciclo inteiro
+ *
+ * Preparada localmente pelo escritor, sem lock; só o commit toca no
+ * estado compartilhado.
+ */
+typedef struct {
+    sensor_data_t staged;
+    uint32_t dirty;
+    uint32_t now_ms;
+} sensor_txn_t;
+
+/**
+ * @brief Número de amostras mantidas no histórico circular
+ */
+#define SENSOR_HISTORY_LEN 64
+
+/**
+ * @brief Amostra do histórico com número de sequência e timestamp
+ *
+ * Os números de sequência começam em 1 e crescem a cada publicação;
+ * um consumidor guarda o último que leu (cursor) para retomar depois.
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t timestamp_ms;
+    sensor_data_t data;
+} sensor_sample_t;
+
+/**
+ * @brief Janelas de estatística por grandeza
+ */
+#define SENSOR_STATS_WINDOW_COUNT 3
+
+/**
+ * @brief Duração das janelas em segundos (ajustável na compilação)
+ */
+#ifndef SENSOR_STATS_WINDOWS_S
+#define SENSOR_STATS_WINDOWS_S { 60, 300, 3600 }
+#endif
+
+/**
+ * @brief Estatísticas deslizantes publicadas a cada commit
+ *
+ * Valores inteiros escalados por TIMESERIES_SCALE (variância pela
+ * escala ao quadrado), indexados por ts_metric_t e pela janela.
+ */
+typedef struct {
+    uint32_t window_s[SENSOR_STATS_WINDOW_COUNT];
+    rolling_result_t metric[TS_METRIC_COUNT][SENSOR_STATS_WINDOW_COUNT];
+    uint32_t updated_ms;
+} sensor_stats_t;
+
 /**
  * @brief Inicializa a estrutura de dados dos sensores
  */
 void sensor_data_init(void);
 
 /**
- * @brief Atualiza os dados dos sensores
- * @param data Ponteiro para estrutura com os novos dados
+ * @brief Inicia uma transação de escrita
+ *
+ * Não toma lock: apenas zera a transação e registra o instante atual,
+ * usado como timestamp de todos os campos alterados nela.
+ */
+void sensor_data_begin(sensor_txn_t *txn);
+
+/**
+ * @brief Prepara a atualização da luminosidade
+ * @param lux_centi Luminosidade em centésimos de lux
+ * @param valid Se a leitura é válida
+ */
+void sensor_txn_set_luminosity(sensor_txn_t *txn, int32_t lux_centi, bool valid);
+
+/**
+ * @brief Prepara a atualização de temperatura e umidade
+ * @param temp_centi Temperatura em centésimos de °C
+ * @param humidity_centi Umidade em centésimos de %
+ * @param valid Se a leitura é válida
+ */
+void sensor_txn_set_temp_humidity(sensor_txn_t *txn, int32_t temp_centi, int32_t humidity_centi, bool valid);
+
+/**
+ * @brief Prepara a atualização do estado da matriz de LEDs
+ * @param enabled Se a matriz está habilitada
+ * @param intensity Nível de intensidade atual
+ */
+void sensor_txn_set_led_state(sensor_txn_t *txn, bool enabled, led_intensity_t intensity);
+
+/**
+ * @brief Registra o instante de captura da amostra de um grupo
+ *
+ * Chamar depois do setter do valor, que usa o início da transação como
+ * padrão. Só LUMINOSITY e TEMP_HUMIDITY têm instante de captura.
+ *
+ * @param capture_us Disparo da conversão, em µs desde o boot
+ */
+void sensor_txn_set_capture(sensor_txn_t *txn, sensor_field_t field, uint64_t capture_us);
+
+/**
+ * @brief Prepara as métricas de conforto da amostra de temperatura/umidade
+ *
+ * Chamar depois de sensor_txn_set_temp_humidity(), que as zera.
+ */
+void sensor_txn_set_comfort(sensor_txn_t *txn, const comfort_metrics_t *comfort);
+
+/**
+ * @brief Registra as marcas do detector de anomalias para uma grandeza
+ *
+ * Chamar depois do setter do valor correspondente, que zera as marcas.
+ * Uma amostra com ANOMALY_FLAG_REJECTED mantém o valor anterior e fica
+ * fora da série temporal e das estatísticas.
+ */
+void sensor_txn_set_anomaly(sensor_txn_t *txn, ts_metric_t metric, uint8_t flags);
+
+/**
+ * @brief Extrai as amostras novas e aceitas dos grupos em fields
+ *
+ * @param values Saída indexada por ts_metric_t (centésimos)
+ * @return Máscara (1 << ts_metric_t) das grandezas preenchidas
+ */
+uint8_t sensor_data_metric_values(const sensor_data_t *data, uint32_t fields, int32_t values[TS_METRIC_COUNT]);
+
+/**
+ * @brief Publica de uma vez todos os campos preparados na transação
+ *
+ * Os campos não tocados preservam o valor publicado. Uma transação
+ * vazia não gera nova versão.
+ *
+ * @return Versão publicada (ou a atual, se nada mudou)
+ */
+uint32_t sensor_data_commit(sensor_txn_t *txn);
+
+/**
+ * @brief Obtém as estatísticas deslizantes do último commit
+ *
+ * Não bloqueia; seguro para chamar a partir do contexto do lwIP.
+ */
+void sensor_data_get_stats(sensor_stats_t *out);
+
+/**
+ * @brief Versão do snapshot publicado (leitura barata, sem lock)
+ */
+uint32_t sensor_data_version(void);
+
+/**
+ * @brief Verifica se houve commit após a versão informada
+ */
+bool sensor_data_changed_since(uint32_t version);
+
+/**
+ * @brief Idade em ms de um grupo de campos no snapshot
+ * @return Idade em ms ou UINT32_MAX se o grupo nunca foi atualizado
  */
-void sensor_data_update(const sensor_data_t *data);
+uint32_t sensor_data_field_age_ms(const sensor_data_t *data, sensor_field_t field, uint32_t now_ms);
 
 /**
  * @brief Obtém uma cópia dos dados atuais dos sensores
+ *
+ * Não bloqueia: lê a última publicação validando seu número de sequência,
+ * podendo ser chamada do contexto do lwIP ou de interrupções.
+ *
  * @return Cópia da estrutura de dados
  */
 sensor_data_t sensor_data_get(void);
 
 /**
- * @brief Atualiza apenas os dados de luminosidade
- * @param lux Valor da luminosidade em lux
- * @param valid Se a leitura é válida
+ * @brief Número de sequência da amostra mais recente (0 se nenhuma)
+ *
+ * Leitura sem lock, segura em qualquer contexto.
  */
-void sensor_data_set_luminosity(float lux, bool valid);
+uint32_t sensor_data_history_head(void);
 
 /**
- * @brief Atualiza apenas os dados de temperatura e umidade
- * @param temp Temperatura em graus Celsius
- * @param humidity Umidade em porcentagem
- * @param valid Se a leitura é válida
+ * @brief Lê as amostras publicadas após o cursor, sem tomar o mutex
+ *
+ * Lê no máximo max amostras a partir de (*cursor + 1) e avança o cursor.
+ * Amostras já sobrescritas pelo produtor são puladas e contadas em lost.
+ *
+ * @param cursor Último número de sequência consumido (0 = desde o início)
+ * @param out Vetor de saída
+ * @param max Capacidade de out
+ * @param lost Opcional: recebe o número de amostras perdidas
+ * @return Quantidade de amostras copiadas
  */
-void sensor_data_set_temp_humidity(float temp, float humidity, bool valid);
+size_t sensor_data_history_read(uint32_t *cursor, sensor_sample_t *out, size_t max, uint32_t *lost);
 
 /**
- * @brief Atualiza o estado da matriz de LEDs
- * @param enabled Se a matriz está habilitada
- * @param intensity Nível de intensidade atual
+ * @brief Copia as últimas amostras em ordem cronológica, sem tomar o mutex
+ * @return Quantidade de amostras copiadas
  */
-void sensor_data_set_led_state(bool enabled, led_intensity_t intensity);
+size_t sensor_data_history_latest(sensor_sample_t *out, size_t max);
+
+/**
+ * @brief Número máximo de tasks inscritas para notificação de mudanças
+ */
+#define SENSOR_MAX_SUBSCRIBERS 4
+
+/**
+ * @brief Variação mínima para que uma mudança seja notificada
+ *
+ * Mudanças de validade e do estado dos LEDs são sempre notificadas.
+ * Mesma escala dos dados (centésimos).
+ */
+typedef struct {
+    int32_t luminosity_centi;
+    int32_t temperature_centi;
+    int32_t humidity_centi;
+} sensor_deadband_t;
+
+/**
+ * @brief Contadores por inscrito
+ */
+typedef struct {
+    uint32_t commits;      // Commits avaliados para o inscrito
+    uint32_t wakeups;      // Notificações enviadas
+    uint32_t suppressed;   // Commits sem mudança relevante (wakeups economizados)
+} sensor_subscriber_stats_t;
+
+/**
+ * @brief Obtém os contadores de um inscrito
+ * @return false se o id for inválido
+ */
+bool sensor_data_get_subscriber_stats(int id, sensor_subscriber_stats_t *out, const char **name);
 
 #ifdef USE_FREERTOS
 /**
@@ -78,6 +301,21 @@ void sensor_data_set_led_state(bool enabled, led_intensity_t intensity);
  * @param mutex Handle do mutex
  */
 void sensor_data_set_mutex(SemaphoreHandle_t mutex);
+
+/**
+ * @brief Inscreve uma task para ser acordada quando campos mudarem
+ *
+ * A cada commit, os campos de field_mask que variaram além da banda
+ * morta (em relação ao último valor notificado a esta task) são
+ * enviados como bits (sensor_field_t) via xTaskNotify(eSetBits).
+ *
+ * @param task Task a notificar
+ * @param name Nome para diagnóstico
+ * @param field_mask Campos de interesse (SENSOR_FIELD_*)
+ * @param deadband Banda morta (NULL = qualquer variação)
+ * @return Id do inscrito ou -1 se não houver espaço
+ */
+int sensor_data_subscribe(TaskHandle_t task, const char *name, uint32_t field_mask, const sensor_deadband_t *deadband);
 #endif
 
 #endif // SENSOR_DATA_H
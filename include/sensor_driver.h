@@ -0,0 +1,56 @@
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sensor_scheduler.h"
+
+/**
+ * @brief Número máximo de grandezas entregues por um sensor
+ */
+#define SENSOR_DRIVER_MAX_METRICS 4
+
+/**
+ * @brief Sem série temporal associada (sensor_metric_desc_t::ts_metric)
+ */
+#define SENSOR_METRIC_NO_SERIES (-1)
+
+/**
+ * @brief Descrição de uma grandeza exportada por um driver
+ *
+ * Valores sempre em centésimos (SENSOR_SCALE). Web, UART e display usam
+ * só esta descrição, sem conhecer o driver.
+ */
+typedef struct {
+    const char *key;        // Nome na exportação (JSON/UART), único no registro
+    const char *label;      // Rótulo curto para o display (até 6 caracteres)
+    const char *unit;       // Unidade exibida
+    uint8_t decimals;       // Casas decimais na apresentação
+    int8_t ts_metric;       // ts_metric_t com série/estatística/detector, ou SENSOR_METRIC_NO_SERIES
+} sensor_metric_desc_t;
+
+/**
+ * @brief Interface (vtable) de um driver de sensor
+ *
+ * Cada instância é um par (driver, dev): a mesma tabela serve a vários
+ * sensores do mesmo tipo, com dev apontando para o estado de cada um.
+ */
+typedef struct {
+    const char *name;
+    uint32_t period_ms;                  // Período nominal (taxa máxima)
+    uint32_t conversion_ms;              // Disparo até a coleta (0 = leitura imediata)
+    uint8_t metric_count;
+    const sensor_metric_desc_t *metrics;
+
+    // Detecta e configura o dispositivo (NULL = nada a fazer); false = ausente
+    bool (*init)(void *dev);
+
+    // Dispara uma conversão; false em erro de barramento
+    bool (*start)(void *dev);
+
+    // Coleta a conversão em values[metric_count]; SENSOR_SCHED_RETRY se ainda ocupado
+    sensor_sched_result_t (*collect)(void *dev, bool last_attempt, int32_t *values);
+} sensor_driver_t;
+
+#endif // SENSOR_DRIVER_H
@@ -0,0 +1,77 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Falhas seguidas (NACK, timeout, conversão que não termina) que tiram o sensor do ar
+ */
+#define SENSOR_HEALTH_FAIL_THRESHOLD 3
+
+/**
+ * @brief Espera antes da primeira sondagem de um sensor fora do ar
+ */
+#define SENSOR_HEALTH_BACKOFF_MIN_MS 1000
+
+/**
+ * @brief Teto da espera entre sondagens (dobra a cada sondagem sem resposta)
+ */
+#define SENSOR_HEALTH_BACKOFF_MAX_MS 60000
+
+/**
+ * @brief Estado de um sensor
+ */
+typedef enum {
+    SENSOR_HEALTH_OK,         // Última leitura com sucesso
+    SENSOR_HEALTH_DEGRADED,   // Falhas seguidas abaixo do limite, ainda lido no período normal
+    SENSOR_HEALTH_OFFLINE     // Sem leituras: só sondagens espaçadas, refazendo o init
+} sensor_health_state_t;
+
+/**
+ * @brief Saúde e contadores de um sensor
+ */
+typedef struct {
+    sensor_health_state_t state;
+    uint8_t consecutive_failures;
+    uint32_t backoff_ms;        // Espera entre sondagens; após voltar, cai pela metade a cada leitura boa
+    uint64_t next_probe_us;     // Próxima sondagem (µs desde o boot), se offline
+    uint32_t failures;          // Acessos com falha
+    uint32_t probes;            // Sondagens (reinicializações tentadas)
+    uint32_t recoveries;        // Sondagens que trouxeram o sensor de volta
+    uint32_t outages;           // Vezes em que o sensor saiu do ar
+} sensor_health_t;
+
+/**
+ * @brief Inicializa no estado OK, sem contadores
+ */
+void sensor_health_init(sensor_health_t *h);
+
+/**
+ * @brief Registra o resultado de um acesso normal (disparo ou coleta)
+ *
+ * @return true se esta falha tirou o sensor do ar (agendar a sondagem)
+ */
+bool sensor_health_report(sensor_health_t *h, bool ok, uint64_t now_us);
+
+/**
+ * @brief Tira o sensor do ar de imediato (ex.: init falhou no boot)
+ */
+void sensor_health_set_offline(sensor_health_t *h, uint64_t now_us);
+
+/**
+ * @brief Registra o resultado de uma sondagem de sensor fora do ar
+ *
+ * Sucesso devolve o sensor ao estado OK; falha dobra a espera (até
+ * SENSOR_HEALTH_BACKOFF_MAX_MS) e agenda a próxima sondagem. A espera não
+ * zera na volta: um sensor intermitente, que cai logo após cada
+ * recuperação, é sondado cada vez mais espaçado.
+ */
+void sensor_health_probe(sensor_health_t *h, bool ok, uint64_t now_us);
+
+/**
+ * @brief Nome do estado para exportação ("ok", "degraded", "offline")
+ */
+const char *sensor_health_state_name(sensor_health_state_t state);
+
+#endif // SENSOR_HEALTH_H
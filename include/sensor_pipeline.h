@@ -0,0 +1,76 @@
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "adaptive_rate.h"
+#include "anomaly_detector.h"
+#include "app_context.h"
+#include "sensor_scheduler.h"
+
+/**
+ * @brief Períodos máximos no modo adaptativo, com sinal estável (ajustáveis na compilação)
+ *
+ * A luz controla os LEDs, então seu teto é o atraso máximo aceito para
+ * reagir a um interruptor.
+ */
+#ifndef SENSOR_PIPELINE_LIGHT_MAX_PERIOD_MS
+#define SENSOR_PIPELINE_LIGHT_MAX_PERIOD_MS  1000
+#endif
+#ifndef SENSOR_PIPELINE_TEMP_MAX_PERIOD_MS
+#define SENSOR_PIPELINE_TEMP_MAX_PERIOD_MS   16000
+#endif
+
+/**
+ * @brief Inscreve os sensores do registro no escalonador e zera o detector de anomalias
+ *
+ * Os sensores são registrados antes (sensor_registry_add); o período
+ * mínimo de cada um é o nominal do driver.
+ *
+ * Não depende do FreeRTOS: a mesma sequência de aquisição roda na
+ * task_sensors e no replay de traces no host (tools/replay).
+ */
+void sensor_pipeline_init(const app_context_t *ctx, anomaly_detector_t *detector);
+
+/**
+ * @brief Executa uma passada: coletas vencidas, série temporal e um commit
+ *
+ * @return Próximo prazo do escalonador, em µs desde o boot (time_us_64)
+ */
+uint64_t sensor_pipeline_step(void);
+
+/**
+ * @brief Liga/desliga a amostragem adaptativa (ligada por padrão)
+ *
+ * Pode ser chamada de outra task: a mudança é aplicada na próxima passada.
+ */
+void sensor_pipeline_set_adaptive(bool enabled);
+
+/**
+ * @brief Indica se a amostragem adaptativa está ligada
+ */
+bool sensor_pipeline_adaptive_enabled(void);
+
+/**
+ * @brief Fixa o período de amostragem de todos os sensores (0 = volta ao normal)
+ *
+ * Enquanto fixo, a adaptação não muda os períodos; nenhum sensor é lido
+ * mais rápido que o período nominal do seu driver. Pode ser chamada de
+ * outra task: a mudança é aplicada na próxima passada.
+ */
+void sensor_pipeline_set_fixed_period(uint32_t period_ms);
+
+/**
+ * @brief Período fixo pedido em ms (0 = nominal/adaptativo)
+ */
+uint32_t sensor_pipeline_fixed_period(void);
+
+/**
+ * @brief Contadores da adaptação do sensor no índice do escalonador
+ * @return false se o índice for inválido ou o sensor tiver taxa fixa
+ */
+bool sensor_pipeline_get_adaptive_stats(size_t index, adaptive_stats_t *out);
+
+#endif // SENSOR_PIPELINE_H
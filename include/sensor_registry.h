@@ -0,0 +1,135 @@
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor_driver.h"
+#include "sensor_health.h"
+#include "sensor_scheduler.h"
+
+/**
+ * @brief Sensores registráveis (um por entrada do escalonador)
+ */
+#define SENSOR_REGISTRY_MAX_SENSORS SENSOR_SCHED_MAX_ENTRIES
+
+/**
+ * @brief Tamanho da tabela de grandezas (soma das grandezas de todos os sensores)
+ */
+#ifndef SENSOR_REGISTRY_MAX_METRICS
+#define SENSOR_REGISTRY_MAX_METRICS 32
+#endif
+
+/**
+ * @brief Último valor publicado de uma grandeza
+ */
+typedef struct {
+    const sensor_metric_desc_t *desc;
+    const char *sensor_name;
+    int sensor;                 // Índice do sensor (igual ao do escalonador)
+    int32_t value;              // Centésimos
+    bool valid;
+    uint8_t flags;              // ANOMALY_FLAG_* da última amostra
+    uint64_t capture_us;        // Disparo da conversão da última amostra
+    uint32_t samples;           // Amostras válidas publicadas
+} sensor_metric_value_t;
+
+/**
+ * @brief Nome e saúde de um sensor registrado
+ */
+typedef struct {
+    const char *name;
+    sensor_health_t health;
+} sensor_status_t;
+
+/**
+ * @brief Chamado a cada amostra, antes da publicação na tabela
+ *
+ * Pode filtrar values e preencher flags (uma posição por grandeza do
+ * driver). Com ok = false, values não tem conteúdo válido.
+ */
+typedef void (*sensor_registry_sample_fn)(int sensor, const sensor_driver_t *driver, bool ok,
+                                          uint64_t capture_us, int32_t *values, uint8_t *flags);
+
+/**
+ * @brief Esvazia o registro
+ */
+void sensor_registry_init(void);
+
+/**
+ * @brief Registra um sensor e chama o init do driver
+ *
+ * Um sensor cujo init falhou fica registrado fora do ar e é sondado com
+ * espera exponencial (ver sensor_health.h); as grandezas aparecem como
+ * inválidas até a primeira leitura depois que ele responder.
+ *
+ * @return Índice do sensor ou -1 sem espaço (sensores ou grandezas)
+ */
+int sensor_registry_add(const sensor_driver_t *driver, void *dev);
+
+/**
+ * @brief Número de sensores registrados
+ */
+size_t sensor_registry_count(void);
+
+/**
+ * @brief Driver do sensor no índice dado (NULL se inválido)
+ */
+const sensor_driver_t *sensor_registry_driver(int sensor);
+
+/**
+ * @brief Indica se o sensor está no ar (não está em SENSOR_HEALTH_OFFLINE)
+ */
+bool sensor_registry_ready(int sensor);
+
+/**
+ * @brief Copia o nome e a saúde de um sensor; seguro no contexto do lwIP
+ * @return false se o índice for inválido
+ */
+bool sensor_registry_get_status(int sensor, sensor_status_t *out);
+
+/**
+ * @brief Define a rota do sensor no escalonador (ver sensor_scheduler_set_route)
+ *
+ * Usada por sensores atrás de um multiplexador; aplicada em sensor_registry_start.
+ *
+ * @return false se o índice for inválido
+ */
+bool sensor_registry_set_route(int sensor, const uint8_t *current, uint8_t value);
+
+/**
+ * @brief Escalonador que atende os sensores registrados
+ */
+sensor_scheduler_t *sensor_registry_scheduler(void);
+
+/**
+ * @brief Inscreve todos os sensores no escalonador, com primeiro disparo imediato
+ *
+ * Chamada uma vez pela task de aquisição, depois dos registros, para que
+ * o atraso da inicialização não conte como jitter.
+ *
+ * @return false se algum sensor não couber no escalonador
+ */
+bool sensor_registry_start(sensor_sched_clock_fn clock, sensor_registry_sample_fn on_sample);
+
+/**
+ * @brief Número de grandezas na tabela
+ */
+size_t sensor_registry_metric_count(void);
+
+/**
+ * @brief Copia o último valor de uma grandeza
+ *
+ * Não bloqueia por mais que a cópia; seguro no contexto do lwIP.
+ *
+ * @return false se o índice for inválido
+ */
+bool sensor_registry_get_metric(size_t index, sensor_metric_value_t *out);
+
+/**
+ * @brief Índice da grandeza com a chave dada, ou -1
+ */
+int sensor_registry_find_metric(const char *key);
+
+#endif // SENSOR_REGISTRY_H
@@ -0,0 +1,209 @@
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "jitter_stats.h"
+
+/**
+ * @brief Número máximo de sensores registrados no escalonador
+ *
+ * Comporta os sensores diretos e os de até 12 canais de multiplexador.
+ */
+#ifndef SENSOR_SCHED_MAX_ENTRIES
+#define SENSOR_SCHED_MAX_ENTRIES 16
+#endif
+
+/**
+ * @brief Intervalo entre novas tentativas de coleta quando o sensor ainda está ocupado
+ */
+#define SENSOR_SCHED_RETRY_MS 10
+
+/**
+ * @brief Número máximo de tentativas de coleta antes de considerar falha
+ */
+#define SENSOR_SCHED_MAX_RETRIES 5
+
+/**
+ * @brief Prazo devolvido quando não há sensores registrados
+ */
+#define SENSOR_SCHED_NO_DEADLINE UINT64_MAX
+
+/**
+ * @brief Resultado de uma tentativa de coleta
+ */
+typedef enum {
+    SENSOR_SCHED_OK,      // Amostra coletada
+    SENSOR_SCHED_RETRY,   // Conversão ainda em andamento, tentar de novo
+    SENSOR_SCHED_FAIL     // Erro de leitura
+} sensor_sched_result_t;
+
+/**
+ * @brief Relógio monotônico em µs (time_us_64 no firmware, relógio falso no host)
+ */
+typedef uint64_t (*sensor_sched_clock_fn)(void);
+
+/**
+ * @brief Dispara a conversão do sensor (retorna false em erro)
+ */
+typedef bool (*sensor_sched_start_fn)(void *ctx);
+
+/**
+ * @brief Coleta o resultado da conversão disparada
+ *
+ * @param last_attempt true na última tentativa antes de desistir; um
+ *        SENSOR_SCHED_RETRY nessa chamada é contabilizado como falha
+ * @param capture_us Instante em que a conversão foi disparada (µs desde o boot),
+ *        o timestamp da amostra
+ */
+typedef sensor_sched_result_t (*sensor_sched_collect_fn)(void *ctx, bool last_attempt, uint64_t capture_us);
+
+/**
+ * @brief Estatísticas de execução por sensor
+ */
+typedef struct {
+    uint32_t starts;           // Disparos realizados
+    uint32_t samples;          // Amostras coletadas com sucesso
+    uint32_t failures;         // Disparos ou coletas com erro
+    uint32_t probes;           // Sondagens de sensor fora do ar (fora das demais contagens)
+    uint32_t intervals;        // Intervalos medidos entre disparos
+    uint64_t interval_sum_us;  // Soma dos intervalos (para período médio)
+    jitter_stats_t jitter;     // Atraso do disparo em relação ao agendado
+} sensor_sched_stats_t;
+
+/**
+ * @brief Entrada do escalonador (um sensor)
+ */
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t base_period_ms;   // Período registrado (taxa máxima), referência do duty cycle
+    uint32_t conversion_ms;
+    sensor_sched_start_fn start;
+    sensor_sched_collect_fn collect;
+    void *ctx;
+
+    // Rota até o sensor (ex.: canal de um multiplexador I2C): a entrada
+    // está "na rota" quando *route_current == route_value. NULL = sem rota
+    const uint8_t *route_current;
+    uint8_t route_value;
+
+    // Estado interno (instantes em µs desde o boot: 64 bits não dão a volta)
+    bool converting;
+    bool probing;              // Próximos disparos são sondagens (marcado pelo dono)
+    uint8_t retries;
+    uint64_t next_start_us;
+    uint64_t collect_due_us;
+    uint64_t capture_us;
+    bool has_capture;
+    sensor_sched_stats_t stats;
+} sensor_sched_entry_t;
+
+/**
+ * @brief Escalonador por prazos para sensores com taxas distintas
+ *
+ * Não depende do FreeRTOS nem do relógio do Pico: o tempo vem do relógio
+ * fornecido na inicialização, o que permite rodar a mesma lógica com um
+ * relógio simulado.
+ */
+typedef struct {
+    sensor_sched_entry_t entries[SENSOR_SCHED_MAX_ENTRIES];
+    size_t count;
+    sensor_sched_clock_fn clock;
+} sensor_scheduler_t;
+
+/**
+ * @brief Inicializa o escalonador sem sensores
+ * @param clock Relógio em µs, lido a cada disparo para o timestamp da amostra
+ */
+void sensor_scheduler_init(sensor_scheduler_t *sched, sensor_sched_clock_fn clock);
+
+/**
+ * @brief Registra um sensor
+ *
+ * @param period_ms Período desejado entre disparos
+ * @param conversion_ms Tempo de conversão entre disparo e coleta (0 = coleta imediata)
+ * @return Índice do sensor ou -1 se não houver espaço; o primeiro disparo ocorre imediatamente
+ */
+int sensor_scheduler_add(sensor_scheduler_t *sched, const char *name,
+                         uint32_t period_ms, uint32_t conversion_ms,
+                         sensor_sched_start_fn start, sensor_sched_collect_fn collect,
+                         void *ctx);
+
+/**
+ * @brief Altera o período de um sensor
+ *
+ * O próximo disparo é reancorado no último disparo agendado, então uma
+ * redução vale já para a próxima amostra em vez de esperar o período antigo.
+ *
+ * @return false se o índice ou o período forem inválidos
+ */
+bool sensor_scheduler_set_period(sensor_scheduler_t *sched, size_t index, uint32_t period_ms);
+
+/**
+ * @brief Adia o próximo disparo de um sensor até o instante dado
+ *
+ * Pode ser chamada de dentro do start/collect do próprio sensor (ex.:
+ * sensor fora do ar aguardando a próxima sondagem). Os disparos seguintes
+ * voltam a ser ancorados no período a partir desse instante.
+ *
+ * @return false se o índice for inválido
+ */
+bool sensor_scheduler_defer(sensor_scheduler_t *sched, size_t index, uint64_t until_us);
+
+/**
+ * @brief Marca os próximos disparos de um sensor como sondagens
+ *
+ * Usada junto de sensor_scheduler_defer() enquanto o sensor está fora do
+ * ar: as sondagens seguem a espera do dono, não o período, e não entram
+ * no jitter, nos intervalos nem nas falhas (são contadas em "probes").
+ *
+ * @return false se o índice for inválido
+ */
+bool sensor_scheduler_set_probing(sensor_scheduler_t *sched, size_t index, bool probing);
+
+/**
+ * @brief Associa uma rota a um sensor
+ *
+ * Entre os sensores vencidos numa passada, os que já estão na rota
+ * selecionada são atendidos primeiro, o que agrupa os acessos a um mesmo
+ * canal de multiplexador e reduz as trocas de canal.
+ *
+ * @param current Estado atual da rota, mantido pelo dono (ex.: cache do mux)
+ * @param value Valor de *current com que o sensor é acessível
+ * @return false se o índice for inválido
+ */
+bool sensor_scheduler_set_route(sensor_scheduler_t *sched, size_t index,
+                                const uint8_t *current, uint8_t value);
+
+/**
+ * @brief Executa disparos e coletas vencidos
+ *
+ * Os prazos são ancorados no agendado, nunca no instante em que a passada
+ * rodou: atrasos aparecem no jitter mas não se acumulam no período. Sem
+ * rotas, os sensores vencidos são atendidos na ordem de registro.
+ *
+ * @return Próximo prazo em µs desde o boot (para armar o alarme da task)
+ */
+uint64_t sensor_scheduler_run(sensor_scheduler_t *sched);
+
+/**
+ * @brief Obtém uma cópia das estatísticas de um sensor
+ * @return false se o índice for inválido
+ */
+bool sensor_scheduler_get_stats(const sensor_scheduler_t *sched, size_t index, sensor_sched_stats_t *out);
+
+/**
+ * @brief Período médio alcançado em ms (0 se ainda não houver medição)
+ */
+uint32_t sensor_scheduler_avg_period_ms(const sensor_sched_stats_t *stats);
+
+/**
+ * @brief Duty cycle efetivo em milésimos: amostras feitas em relação ao
+ *        período registrado (1000 = sempre na taxa máxima)
+ */
+uint32_t sensor_scheduler_duty_permille(const sensor_sched_stats_t *stats, uint32_t base_period_ms);
+
+#endif // SENSOR_SCHEDULER_H
@@ -0,0 +1,36 @@
+#ifndef SENSOR_UNITS_H
+#define SENSOR_UNITS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Escala de ponto fixo de todas as grandezas (centésimos)
+ *
+ * Temperatura em centésimos de °C, umidade em centésimos de % e
+ * luminosidade em centésimos de lux: 23.45 °C -> 2345. O RP2040 não
+ * tem FPU, então o caminho das amostras usa apenas inteiros.
+ */
+#define SENSOR_SCALE 100
+
+/**
+ * @brief Tamanho suficiente para qualquer int32_t formatado (com sinal e ponto)
+ */
+#define SENSOR_UNITS_STR_MAX 16
+
+/**
+ * @brief Formata um valor em centésimos com 0, 1 ou 2 casas decimais
+ *
+ * Arredonda a meio caminho para longe do zero (como lroundf), sem
+ * usar ponto flutuante.
+ *
+ * @return Número de caracteres escritos (sem o terminador), como snprintf
+ */
+int sensor_units_format(char *buffer, size_t size, int32_t centi, unsigned decimals);
+
+/**
+ * @brief Raiz quadrada inteira (piso), ex.: desvio padrão a partir da variância
+ */
+uint32_t sensor_units_isqrt(uint64_t value);
+
+#endif // SENSOR_UNITS_H
@@ -0,0 +1,82 @@
+#ifndef SERIES_CODEC_H
+#define SERIES_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "timeseries.h"
+
+/**
+ * @brief Amostra codificada (valores inteiros escalados, como na série temporal)
+ */
+typedef struct {
+    uint32_t t_ms;
+    uint8_t valid_mask;                 // Bit (1 << ts_metric_t) por grandeza presente
+    int32_t value[TS_METRIC_COUNT];
+} series_sample_t;
+
+/**
+ * @brief Codificador de um bloco (estilo Gorilla)
+ *
+ * Instantes são gravados como delta-do-delta e valores como delta em
+ * relação ao último valor válido da mesma grandeza, ambos em faixas de
+ * tamanho variável. Séries regulares e lentas custam poucos bits por
+ * amostra. Opera sobre um buffer fornecido pelo chamador, sem heap.
+ */
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;                    // Bytes disponíveis
+    size_t bit_pos;                     // Bits já escritos
+    uint16_t count;                     // Amostras no bloco
+
+    // Estado do preditor
+    uint32_t prev_t;
+    uint32_t prev_delta;
+    uint8_t prev_mask;
+    int32_t prev_value[TS_METRIC_COUNT];
+} series_encoder_t;
+
+/**
+ * @brief Decodificador de um bloco produzido por series_encoder_t
+ */
+typedef struct {
+    const uint8_t *buffer;
+    size_t len_bits;
+    size_t bit_pos;
+    uint16_t remaining;                 // Amostras ainda não lidas
+
+    uint32_t prev_t;
+    uint32_t prev_delta;
+    uint8_t prev_mask;
+    int32_t prev_value[TS_METRIC_COUNT];
+} series_decoder_t;
+
+/**
+ * @brief Inicia um bloco vazio em buffer (o conteúdo é sobrescrito)
+ */
+void series_encoder_init(series_encoder_t *enc, uint8_t *buffer, size_t capacity);
+
+/**
+ * @brief Acrescenta uma amostra ao bloco
+ * @return false (sem alterar o bloco) se a amostra não couber
+ */
+bool series_encoder_add(series_encoder_t *enc, const series_sample_t *sample);
+
+/**
+ * @brief Bytes ocupados pelo bloco até agora
+ */
+size_t series_encoder_bytes(const series_encoder_t *enc);
+
+/**
+ * @brief Prepara a leitura de um bloco com count amostras
+ */
+void series_decoder_init(series_decoder_t *dec, const uint8_t *buffer, size_t len, uint16_t count);
+
+/**
+ * @brief Lê a próxima amostra
+ * @return false ao fim do bloco ou se os dados estiverem truncados
+ */
+bool series_decoder_next(series_decoder_t *dec, series_sample_t *sample);
+
+#endif // SERIES_CODEC_H
@@ -0,0 +1,136 @@
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor_units.h"
+
+/**
+ * @brief Escala dos valores armazenados (a mesma das amostras)
+ */
+#define TIMESERIES_SCALE SENSOR_SCALE
+
+/**
+ * @brief Capacidade de cada camada (pontos), ajustável na compilação
+ *
+ * Com os valores padrão: ~100 s de amostras brutas a 5 Hz, 2 min em
+ * 1 s, 2 h em 1 min e 2 dias em 1 h.
+ */
+#ifndef TIMESERIES_RAW_LEN
+#define TIMESERIES_RAW_LEN 512
+#endif
+
+#ifndef TIMESERIES_1S_LEN
+#define TIMESERIES_1S_LEN 120
+#endif
+
+#ifndef TIMESERIES_1MIN_LEN
+#define TIMESERIES_1MIN_LEN 120
+#endif
+
+#ifndef TIMESERIES_1H_LEN
+#define TIMESERIES_1H_LEN 48
+#endif
+
+/**
+ * @brief Limite de RAM do armazenamento (verificado em tempo de compilação)
+ */
+#ifndef TIMESERIES_RAM_BUDGET
+#define TIMESERIES_RAM_BUDGET (28 * 1024)
+#endif
+
+/**
+ * @brief Grandezas armazenadas
+ */
+typedef enum {
+    TS_METRIC_TEMPERATURE,   // centésimos de °C
+    TS_METRIC_HUMIDITY,      // centésimos de %
+    TS_METRIC_LUX,           // centésimos de lux
+    TS_METRIC_COUNT
+} ts_metric_t;
+
+/**
+ * @brief Resoluções consultáveis
+ */
+typedef enum {
+    TS_RES_RAW,
+    TS_RES_1S,
+    TS_RES_1MIN,
+    TS_RES_1H,
+    TS_RES_COUNT
+} ts_resolution_t;
+
+/**
+ * @brief Ponto retornado pelas consultas
+ *
+ * Na camada bruta min = max = mean. Só as grandezas com o bit
+ * correspondente em valid_mask têm valores significativos.
+ */
+typedef struct {
+    uint64_t t_ms;                        // Início do intervalo (ou instante da amostra)
+    uint16_t samples[TS_METRIC_COUNT];    // Amostras agregadas por grandeza
+    uint8_t valid_mask;                   // Bit (1 << ts_metric_t) por grandeza presente
+    int32_t min[TS_METRIC_COUNT];
+    int32_t max[TS_METRIC_COUNT];
+    int32_t mean[TS_METRIC_COUNT];
+} ts_point_t;
+
+/**
+ * @brief Inicializa o armazenamento vazio
+ */
+void timeseries_init(void);
+
+/**
+ * @brief Insere uma amostra e atualiza as camadas agregadas
+ *
+ * Custo constante: cada camada só é fechada quando o tempo cruza o
+ * limite do seu intervalo. Os instantes devem ser não decrescentes.
+ *
+ * @param t_ms Instante da amostra (ms desde o boot, 64 bits: não dá a
+ *             volta em 2^32 ms, ~49,7 dias)
+ * @param values Valores escalados por TIMESERIES_SCALE, indexados por ts_metric_t
+ * @param valid_mask Grandezas presentes nesta amostra
+ */
+void timeseries_insert(uint64_t t_ms, const int32_t values[TS_METRIC_COUNT], uint8_t valid_mask);
+
+/**
+ * @brief Consulta pontos com início em [from_ms, to_ms], do mais antigo ao mais novo
+ *
+ * Localiza o início por busca binária e copia apenas os pontos
+ * retornados. Seguro para chamar a partir do contexto do lwIP.
+ *
+ * @return Número de pontos escritos em out
+ */
+size_t timeseries_query(ts_resolution_t res, uint64_t from_ms, uint64_t to_ms,
+                        ts_point_t *out, size_t max_points);
+
+/**
+ * @brief Copia os últimos max_points pontos de uma resolução
+ * @return Número de pontos escritos em out
+ */
+size_t timeseries_latest(ts_resolution_t res, ts_point_t *out, size_t max_points);
+
+/**
+ * @brief Pontos atualmente armazenados em uma resolução
+ */
+size_t timeseries_count(ts_resolution_t res);
+
+/**
+ * @brief Memória estática ocupada pelo armazenamento, em bytes
+ */
+size_t timeseries_memory_bytes(void);
+
+/**
+ * @brief Nome curto da resolução ("raw", "1s", "1min", "1h")
+ */
+const char *timeseries_resolution_name(ts_resolution_t res);
+
+/**
+ * @brief Converte um nome de resolução
+ * @return false se o nome não for reconhecido
+ */
+bool timeseries_parse_resolution(const char *name, ts_resolution_t *out);
+
+#endif // TIMESERIES_H
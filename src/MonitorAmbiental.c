@@ -5,8 +5,12 @@
 #include "ssd1306.h"
 #include "bh1750.h"
 #include "aht10.h"
+#include "tca9548a.h"
 #include "led_matrix.h"
+#include "i2c_async.h"
 #include "sensor_data.h"
+#include "sensor_registry.h"
+#include "timeseries.h"
 #include "wifi_manager.h"
 #include "wifi_config.h"
 #include "web_server.h"
@@ -30,6 +34,15 @@
 #define BTN_A 5
 #define BTN_B 6
 
+// Sensores atrás de multiplexadores TCA9548A (um por barramento, opcional)
+#define MUX_MAX_SENSORS 12
+
+static tca9548a_t muxes[2];
+static tca9548a_sensor_t mux_sensors[MUX_MAX_SENSORS];
+static aht10_t mux_aht10[MUX_MAX_SENSORS];
+static bh1750_t mux_bh1750[MUX_MAX_SENSORS];
+static size_t mux_sensor_count = 0;
+
 // Variável global para controlar estado da matriz de LEDs
 volatile bool led_matrix_enabled = true;
 
@@ -60,6 +73,39 @@ void i2c_scan(i2c_inst_t *i2c, const char *bus_name) {
     fflush(stdout);
 }
 
+// Procura AHT10 e BH1750 em cada canal do mux e registra os encontrados.
+// O primeiro sensor de cada grandeza alimenta séries, detector e LEDs.
+static void register_mux_sensors(tca9548a_t *mux, const char *bus_name,
+                                 bool *temp_series, bool *light_series) {
+    for (uint8_t ch = 0; ch < TCA9548A_CHANNELS; ch++) {
+        if (mux_sensor_count < MUX_MAX_SENSORS && tca9548a_probe(mux, ch, AHT10_I2C_ADDR)) {
+            size_t i = mux_sensor_count++;
+            mux_aht10[i] = (aht10_t){ .i2c_port = mux->i2c_port, .address = AHT10_I2C_ADDR };
+            int index = tca9548a_sensor_register(&mux_sensors[i], mux, ch, &aht10_driver, &mux_aht10[i], !*temp_series);
+            if (index >= 0) {
+                printf("[OK] AHT10 no %s canal %u (%s)\n", bus_name, ch, mux_sensors[i].name);
+                *temp_series = true;
+            } else {
+                printf("[ERRO] Registro cheio: AHT10 no %s canal %u ignorado\n", bus_name, ch);
+            }
+        }
+
+        if (mux_sensor_count < MUX_MAX_SENSORS && tca9548a_probe(mux, ch, BH1750_ADDR_LOW)) {
+            size_t i = mux_sensor_count++;
+            mux_bh1750[i] = (bh1750_t){ .i2c_port = mux->i2c_port, .address = BH1750_ADDR_LOW };
+            int index = tca9548a_sensor_register(&mux_sensors[i], mux, ch, &bh1750_driver, &mux_bh1750[i], !*light_series);
+            if (index >= 0) {
+                printf("[OK] BH1750 no %s canal %u (%s)\n", bus_name, ch, mux_sensors[i].name);
+                *light_series = true;
+            } else {
+                printf("[ERRO] Registro cheio: BH1750 no %s canal %u ignorado\n", bus_name, ch);
+            }
+        }
+    }
+    tca9548a_disable(mux);
+    fflush(stdout);
+}
+
 int main()
 {
     stdio_init_all();
@@ -93,6 +139,11 @@ int main()
     ssd1306_draw_string(&display, 0, 32, "WiFi: Aguarde");
     ssd1306_show(&display);
 
+    // Fila de transações via DMA: usada quando o scheduler estiver rodando
+    if (!i2c_async_init(I2C1_PORT)) {
+        printf("[ERRO] I2C1 sem DMA, usando acesso bloqueante\n");
+    }
+
     printf("[OK] Display inicializado\n");
     fflush(stdout);
 
@@ -139,6 +190,9 @@ int main()
     gpio_set_function(I2C0_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C0_SDA);
     gpio_pull_up(I2C0_SCL);
+    if (!i2c_async_init(I2C0_PORT)) {
+        printf("[ERRO] I2C0 sem DMA, usando acesso bloqueante\n");
+    }
     printf("[OK] I2C0 inicializado em 100 kHz\n");
     fflush(stdout);
 
@@ -155,36 +209,50 @@ int main()
     printf("[OK] Display OLED ja inicializado\n");
     fflush(stdout);
 
-    printf("\n[INFO] Inicializando sensor BH1750 no endereco 0x23...\n");
-    // Inicialização do sensor BH1750 no I2C0
-    bh1750_t light_sensor;
-    bool bh1750_ok = bh1750_init(&light_sensor, I2C0_PORT, BH1750_ADDR_LOW);
+    // Sensores entram no registro: a aquisição, a web, a UART e o display
+    // os enxergam pela tabela de grandezas, sem conhecer cada driver
+    sensor_registry_init();
+
+    // Com um TCA9548A no I2C0, os sensores desse barramento ficam atrás
+    // dele (vários AHT10 no mesmo endereço 0x38, um por canal)
+    bool temp_series = false;
+    bool light_series = false;
+    if (tca9548a_init(&muxes[0], I2C0_PORT, TCA9548A_ADDR_BASE)) {
+        printf("\n[INFO] TCA9548A encontrado no I2C0, procurando sensores nos canais...\n");
+        register_mux_sensors(&muxes[0], "I2C0", &temp_series, &light_series);
+    } else {
+        printf("\n[INFO] Inicializando sensor BH1750 no endereco 0x23...\n");
+        fflush(stdout);
+        // Sensor BH1750 no I2C0 (o init tenta também o endereço 0x5C)
+        static bh1750_t light_sensor = { .i2c_port = I2C0_PORT, .address = BH1750_ADDR_LOW };
+        int light_index = sensor_registry_add(&bh1750_driver, &light_sensor);
+        if (sensor_registry_ready(light_index)) {
+            printf("[OK] BH1750 inicializado no endereco 0x%02X\n", light_sensor.address);
+        } else {
+            printf("[ERRO] BH1750 nao encontrado em nenhum endereco! (nova tentativa em segundo plano)\n");
+        }
+        fflush(stdout);
 
-    if (!bh1750_ok) {
-        printf("[ERRO] Falha ao inicializar BH1750 no endereco 0x23!\n");
-        printf("[INFO] Tentando endereco alternativo 0x5C...\n");
+        printf("\n[INFO] Inicializando sensor AHT10 no endereco 0x38...\n");
         fflush(stdout);
-        bh1750_ok = bh1750_init(&light_sensor, I2C0_PORT, BH1750_ADDR_HIGH);
-        if (bh1750_ok) {
-            printf("[OK] BH1750 inicializado no endereco 0x5C\n");
+        // Sensor AHT10 no I2C0
+        static aht10_t temp_sensor = { .i2c_port = I2C0_PORT, .address = AHT10_I2C_ADDR };
+        int temp_index = sensor_registry_add(&aht10_driver, &temp_sensor);
+        if (sensor_registry_ready(temp_index)) {
+            printf("[OK] AHT10 inicializado no endereco 0x38\n");
         } else {
-            printf("[ERRO] BH1750 nao encontrado em nenhum endereco!\n");
+            printf("[ERRO] AHT10 nao respondeu! (nova tentativa em segundo plano)\n");
         }
-    } else {
-        printf("[OK] BH1750 inicializado no endereco 0x23\n");
+        fflush(stdout);
+        temp_series = true;
+        light_series = true;
     }
-    fflush(stdout);
 
-    printf("\n[INFO] Inicializando sensor AHT10 no endereco 0x38...\n");
-    fflush(stdout);
-    // Inicialização do sensor AHT10 no I2C0
-    aht10_t temp_sensor;
-    aht10_init(&temp_sensor, I2C0_PORT, AHT10_I2C_ADDR);
-    printf("[OK] AHT10 inicializado no endereco 0x38\n");
-    fflush(stdout);
-
-    // Marca AHT10 como OK (sempre, pois init não retorna bool)
-    bool aht10_ok = true;
+    // No I2C1 (display) sensores só atrás de um mux
+    if (tca9548a_init(&muxes[1], I2C1_PORT, TCA9548A_ADDR_BASE)) {
+        printf("\n[INFO] TCA9548A encontrado no I2C1, procurando sensores nos canais...\n");
+        register_mux_sensors(&muxes[1], "I2C1", &temp_series, &light_series);
+    }
 
     printf("\n[INFO] Inicializando matriz de LEDs...\n");
     // Inicialização da matriz de LEDs no GPIO 7
@@ -194,6 +262,7 @@ int main()
     // Inicializa estrutura de dados compartilhada
     printf("\n[INFO] Inicializando estrutura de dados...\n");
     sensor_data_init();
+    timeseries_init();
     printf("[OK] Estrutura de dados inicializada\n");
     fflush(stdout);
 
@@ -267,12 +336,8 @@ int main()
 
     app_context_t app_ctx = {
         .display = &display,
-        .light_sensor = &light_sensor,
-        .temp_sensor = &temp_sensor,
         .led_matrix = &led_matrix,
         .led_matrix_enabled = &led_matrix_enabled,
-        .bh1750_ok = &bh1750_ok,
-        .aht10_ok = &aht10_ok
     };
 
     rtos_start(&app_ctx);
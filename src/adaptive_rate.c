@@ -0,0 +1,108 @@
+#include "adaptive_rate.h"
+
+#include <string.h>
+
+// Peso da média de |diferença| = 1 / 2^NOISE_SHIFT
+#define NOISE_SHIFT 2
+
+static inline int32_t abs32(int32_t v) {
+    return v < 0 ? -v : v;
+}
+
+void adaptive_rate_init(adaptive_rate_t *a, const adaptive_config_t *cfg) {
+    memset(a, 0, sizeof(*a));
+    a->cfg = *cfg;
+    if (a->cfg.channels > ADAPTIVE_MAX_CHANNELS) {
+        a->cfg.channels = ADAPTIVE_MAX_CHANNELS;
+    }
+    if (a->cfg.max_period_ms < a->cfg.min_period_ms) {
+        a->cfg.max_period_ms = a->cfg.min_period_ms;
+    }
+    a->enabled = true;
+    a->period_ms = a->cfg.min_period_ms;
+}
+
+void adaptive_rate_set_enabled(adaptive_rate_t *a, bool enabled) {
+    a->enabled = enabled;
+    a->primed = false;
+    a->calm = 0;
+    a->period_ms = a->cfg.min_period_ms;
+}
+
+// Verifica os limites de um canal e atualiza seu ruído
+static bool channel_active(adaptive_rate_t *a, uint8_t ch, uint32_t dt_ms, int32_t value) {
+    const adaptive_channel_config_t *c = &a->cfg.channel[ch];
+    int32_t diff = abs32(value - a->last[ch]);
+    bool active = false;
+
+    int32_t delta = c->delta;
+    if (c->delta_shift > 0) {
+        delta += abs32(a->anchor[ch]) >> c->delta_shift;
+    }
+    if (abs32(value - a->anchor[ch]) > delta) {
+        active = true;
+    }
+
+    if (c->max_rate_per_s > 0 && (int64_t)diff * 1000 > (int64_t)c->max_rate_per_s * dt_ms) {
+        active = true;
+    }
+
+    a->noise_q4[ch] += ((diff << 4) - a->noise_q4[ch]) >> NOISE_SHIFT;
+    if (c->max_noise > 0 && a->noise_q4[ch] > (c->max_noise << 4)) {
+        active = true;
+    }
+
+    a->last[ch] = value;
+    return active;
+}
+
+uint32_t adaptive_rate_update(adaptive_rate_t *a, uint32_t t_ms, const int32_t *values, bool active) {
+    a->stats.samples++;
+
+    if (!a->primed) {
+        for (uint8_t ch = 0; ch < a->cfg.channels; ch++) {
+            a->anchor[ch] = values[ch];
+            a->last[ch] = values[ch];
+            a->noise_q4[ch] = 0;
+        }
+        a->last_t_ms = t_ms;
+        a->primed = true;
+        return a->period_ms;
+    }
+
+    uint32_t dt_ms = t_ms - a->last_t_ms;
+    a->last_t_ms = t_ms;
+
+    // Todos os canais são avaliados para manter o ruído de cada um em dia
+    for (uint8_t ch = 0; ch < a->cfg.channels; ch++) {
+        if (channel_active(a, ch, dt_ms, values[ch])) {
+            active = true;
+        }
+    }
+
+    if (!a->enabled) {
+        return a->period_ms;
+    }
+
+    if (active) {
+        if (a->period_ms != a->cfg.min_period_ms) {
+            a->stats.triggers++;
+        }
+        for (uint8_t ch = 0; ch < a->cfg.channels; ch++) {
+            a->anchor[ch] = values[ch];
+        }
+        a->calm = 0;
+        a->period_ms = a->cfg.min_period_ms;
+        return a->period_ms;
+    }
+
+    if (a->period_ms < a->cfg.max_period_ms && ++a->calm >= a->cfg.calm_samples) {
+        a->calm = 0;
+        a->period_ms *= 2;
+        if (a->period_ms > a->cfg.max_period_ms) {
+            a->period_ms = a->cfg.max_period_ms;
+        }
+        a->stats.slowdowns++;
+    }
+    return a->period_ms;
+}
@@ -0,0 +1,124 @@
+#include "anomaly_detector.h"
+
+#include <string.h>
+
+// Parâmetros padrão por grandeza (centésimos). Temperatura e umidade
+// são amostradas a cada 2 s e variam devagar: um quadro corrompido do
+// AHT10 cai no limite de taxa. A luz muda de patamar de verdade (lâmpada
+// acesa), então não tem limite de taxa: um pico de lanterna é rejeitado
+// pelo z-score e uma mudança que persiste vira o novo patamar.
+static const anomaly_config_t DEFAULT_CONFIG[TS_METRIC_COUNT] = {
+    [TS_METRIC_TEMPERATURE] = {
+        .alpha_shift = 4, .z_limit = 6, .min_stddev = 30,
+        .max_rate_per_s = 200, .warmup = 8, .max_rejects = 5, .reject = true,
+    },
+    [TS_METRIC_HUMIDITY] = {
+        .alpha_shift = 4, .z_limit = 6, .min_stddev = 150,
+        .max_rate_per_s = 1000, .warmup = 8, .max_rejects = 5, .reject = true,
+    },
+    [TS_METRIC_LUX] = {
+        .alpha_shift = 3, .z_limit = 6, .min_stddev = 2000,
+        .max_rate_per_s = 0, .warmup = 8, .max_rejects = 10, .reject = true,
+    },
+};
+
+static inline int64_t abs64(int64_t v) {
+    return (v < 0) ? -v : v;
+}
+
+// Recomeça a estatística a partir de um valor aceito
+static void rebaseline(anomaly_metric_t *m, uint32_t t_ms, int32_t value) {
+    m->mean_q8 = (int64_t)value * 256;
+    m->var_q8 = 0;
+    m->count = 1;
+    m->last_value = value;
+    m->last_t_ms = t_ms;
+    m->consecutive_rejects = 0;
+}
+
+// EWMA de média e variância (forma incremental de West), em Q8
+static void update_ewma(anomaly_metric_t *m, int32_t value) {
+    int64_t diff_q8 = (int64_t)value * 256 - m->mean_q8;
+    int64_t incr_q8 = diff_q8 / (1 << m->cfg.alpha_shift);
+    m->mean_q8 += incr_q8;
+    m->var_q8 += (diff_q8 * incr_q8) / 256;
+    m->var_q8 -= m->var_q8 / (1 << m->cfg.alpha_shift);
+}
+
+// ============= API =============
+
+void anomaly_metric_init(anomaly_metric_t *m, const anomaly_config_t *cfg) {
+    memset(m, 0, sizeof(*m));
+    m->cfg = *cfg;
+}
+
+void anomaly_detector_init(anomaly_detector_t *det) {
+    for (int i = 0; i < TS_METRIC_COUNT; i++) {
+        anomaly_metric_init(&det->metric[i], &DEFAULT_CONFIG[i]);
+    }
+}
+
+uint8_t anomaly_metric_check(anomaly_metric_t *m, uint32_t t_ms, int32_t value, int32_t *out_value) {
+    m->stats.samples++;
+    *out_value = value;
+
+    if (m->count == 0) {
+        rebaseline(m, t_ms, value);
+        return 0;
+    }
+
+    uint8_t flags = 0;
+
+    // Taxa de variação em relação ao último valor aceito
+    if (m->cfg.max_rate_per_s > 0) {
+        uint32_t dt_ms = t_ms - m->last_t_ms;
+        if (dt_ms == 0) dt_ms = 1;
+        int64_t step = abs64((int64_t)value - m->last_value);
+        if (step * 1000 > (int64_t)m->cfg.max_rate_per_s * dt_ms) {
+            flags |= ANOMALY_FLAG_RATE;
+            m->stats.flagged_rate++;
+        }
+    }
+
+    // z-score sem raiz: diff² > z² * max(var, piso²)
+    if (m->count >= m->cfg.warmup) {
+        int64_t diff = ((int64_t)value * 256 - m->mean_q8) / 256;
+        int64_t var = m->var_q8 / 256;
+        int64_t floor_var = (int64_t)m->cfg.min_stddev * m->cfg.min_stddev;
+        if (var < floor_var) var = floor_var;
+        if (diff * diff > (int64_t)m->cfg.z_limit * m->cfg.z_limit * var) {
+            flags |= ANOMALY_FLAG_ZSCORE;
+            m->stats.flagged_zscore++;
+        }
+    }
+
+    if (flags && m->cfg.reject) {
+        if (++m->consecutive_rejects <= m->cfg.max_rejects) {
+            m->stats.rejected++;
+            *out_value = m->last_value;
+            return flags | ANOMALY_FLAG_REJECTED;
+        }
+        // Desvio persistente: é um novo patamar, não um pico
+        m->stats.rebaselines++;
+        rebaseline(m, t_ms, value);
+        return flags;
+    }
+
+    m->consecutive_rejects = 0;
+    update_ewma(m, value);
+    m->count++;
+    m->last_value = value;
+    m->last_t_ms = t_ms;
+    return flags;
+}
+
+uint8_t anomaly_detector_check(anomaly_detector_t *det, ts_metric_t metric,
+                               uint32_t t_ms, int32_t value, int32_t *out_value) {
+    return anomaly_metric_check(&det->metric[metric], t_ms, value, out_value);
+}
+
+bool anomaly_detector_get_stats(const anomaly_detector_t *det, ts_metric_t metric, anomaly_stats_t *out) {
+    if (!det || !out || (int)metric < 0 || metric >= TS_METRIC_COUNT) return false;
+    *out = det->metric[metric].stats;
+    return true;
+}
@@ -0,0 +1,80 @@
+#include "app_control.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+
+#include "sensor_data.h"
+#include "sensor_pipeline.h"
+
+// Compara sem diferenciar maiúsculas; devolve o resto do texto após o prefixo ou NULL
+static const char *skip_prefix(const char *text, const char *prefix) {
+    while (*prefix) {
+        if (tolower((unsigned char)*text) != tolower((unsigned char)*prefix)) {
+            return NULL;
+        }
+        text++;
+        prefix++;
+    }
+    return text;
+}
+
+// Texto igual a "word", ignorando maiúsculas e espaços ao redor
+static bool word_is(const char *text, const char *word) {
+    while (*text == ' ' || *text == '\t') text++;
+    text = skip_prefix(text, word);
+    if (!text) return false;
+    while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') text++;
+    return *text == '\0';
+}
+
+void app_control_set_led(const app_context_t *ctx, bool on) {
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    *ctx->led_matrix_enabled = on;
+    if (!on) {
+        led_matrix_clear(ctx->led_matrix);
+    }
+    sensor_txn_set_led_state(&txn, on, on ? LED_INTENSITY_LOW : LED_INTENSITY_OFF);
+    sensor_data_commit(&txn);
+}
+
+bool app_control_parse_rate(const char *arg, uint32_t *period_ms) {
+    while (*arg == ' ' || *arg == '\t') arg++;
+    if (word_is(arg, "AUTO")) {
+        *period_ms = 0;
+        return true;
+    }
+    if (!isdigit((unsigned char)*arg)) return false;
+
+    char *end;
+    unsigned long value = strtoul(arg, &end, 10);
+    if (!word_is(end, "") || value == 0 || value > APP_CONTROL_RATE_MAX_MS) return false;
+    *period_ms = (uint32_t)value;
+    return true;
+}
+
+bool app_control_execute(const app_context_t *ctx, const char *command) {
+    while (*command == ' ' || *command == '\t') command++;
+
+    const char *arg = skip_prefix(command, "LED ");
+    if (arg) {
+        if (word_is(arg, "ON")) {
+            app_control_set_led(ctx, true);
+            return true;
+        }
+        if (word_is(arg, "OFF")) {
+            app_control_set_led(ctx, false);
+            return true;
+        }
+        return false;
+    }
+
+    arg = skip_prefix(command, "RATE ");
+    if (arg) {
+        uint32_t period_ms;
+        if (!app_control_parse_rate(arg, &period_ms)) return false;
+        sensor_pipeline_set_fixed_period(period_ms);
+        return true;
+    }
+    return false;
+}
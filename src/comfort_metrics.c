@@ -0,0 +1,133 @@
+#include "comfort_metrics.h"
+
+#include "sensor_units.h"
+
+// Pressão de saturação (centésimos de Pa) de COMFORT_TABLE_MIN_C a
+// COMFORT_TABLE_MAX_C, passo de 1 °C: 611.2 * exp(17.62 T / (243.12 + T)) * 100
+#define SVP_TABLE_LEN (COMFORT_TABLE_MAX_C - COMFORT_TABLE_MIN_C + 1)
+
+static const uint32_t SVP_TABLE[SVP_TABLE_LEN] = {
+    1902, 2109, 2336, 2586, 2858, 3157, 3484, 3840,
+    4230, 4654, 5117, 5620, 6168, 6764, 7410, 8112,
+    8872, 9696, 10588, 11553, 12597, 13723, 14939, 16251,
+    17665, 19187, 20826, 22589, 24483, 26518, 28703, 31047,
+    33559, 36251, 39134, 42218, 45517, 49043, 52809, 56830,
+    61120, 65695, 70570, 75763, 81292, 87174, 93430, 100079,
+    107143, 114643, 122603, 131046, 139998, 149483, 159531, 170167,
+    181423, 193327, 205913, 219212, 233260, 248090, 263742, 280251,
+    297659, 316006, 335334, 355689, 377115, 399660, 423372, 448303,
+    474505, 502031, 530939, 561284, 593128, 626531, 661558, 698274,
+    736746, 777044, 819241, 863409, 909627, 957971, 1008523, 1061367,
+    1116588, 1174274, 1234516, 1297407, 1363042, 1431521, 1502945, 1577416,
+    1655043, 1735933, 1820201, 1907960, 1999329, 2094429, 2193384, 2296322,
+    2403374, 2514671, 2630353, 2750558, 2875431, 3005117, 3139768, 3279536,
+    3424580, 3575059, 3731139, 3892987, 4060774, 4234677, 4414874, 4601548,
+    4794885,
+};
+
+#define TABLE_MIN_CENTI (COMFORT_TABLE_MIN_C * 100)
+#define TABLE_MAX_CENTI (COMFORT_TABLE_MAX_C * 100)
+
+static int32_t clamp_i32(int32_t v, int32_t lo, int32_t hi) {
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+// Divisão com arredondamento para o inteiro mais próximo (d > 0)
+static int64_t div_round(int64_t n, int64_t d) {
+    return (n >= 0) ? (n + d / 2) / d : -((-n + d / 2) / d);
+}
+
+uint32_t comfort_saturation_pressure(int32_t temp_centi) {
+    int32_t offset = clamp_i32(temp_centi, TABLE_MIN_CENTI, TABLE_MAX_CENTI) - TABLE_MIN_CENTI;
+    int32_t idx = offset / 100;
+    int32_t frac = offset % 100;
+    if (idx == SVP_TABLE_LEN - 1) {
+        return SVP_TABLE[idx];
+    }
+
+    uint32_t lo = SVP_TABLE[idx];
+    uint32_t hi = SVP_TABLE[idx + 1];
+    return lo + (uint32_t)(((uint64_t)(hi - lo) * (uint32_t)frac + 50u) / 100u);
+}
+
+// Inverso da tabela: temperatura (centésimos) em que a saturação vale pressure
+static int32_t dew_point_from_pressure(uint32_t pressure) {
+    if (pressure <= SVP_TABLE[0]) return TABLE_MIN_CENTI;
+    if (pressure >= SVP_TABLE[SVP_TABLE_LEN - 1]) return TABLE_MAX_CENTI;
+
+    // Busca binária do intervalo [lo, lo + 1] que contém a pressão
+    int lo = 0;
+    int hi = SVP_TABLE_LEN - 1;
+    while (hi - lo > 1) {
+        int mid = (lo + hi) / 2;
+        if (SVP_TABLE[mid] <= pressure) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    uint32_t span = SVP_TABLE[hi] - SVP_TABLE[lo];
+    int32_t frac = (int32_t)(((uint64_t)(pressure - SVP_TABLE[lo]) * 100u + span / 2) / span);
+    return TABLE_MIN_CENTI + lo * 100 + frac;
+}
+
+// Índice de calor da NOAA (Rothfusz/Steadman), em centésimos de °F
+static int32_t heat_index_f(int32_t tf, int32_t rh) {
+    // Fórmula simples de Steadman: vale enquanto a média com T fica abaixo de 80 °F
+    int32_t simple = (tf + 6100 + (tf - 6800) * 12 / 10 + rh * 94 / 1000) / 2;
+    if ((simple + tf) / 2 < 8000) {
+        return simple;
+    }
+
+    // Regressão de Rothfusz com coeficientes escalados por 1e8
+    int64_t t = tf;
+    int64_t r = rh;
+    int64_t t2 = t * t / 100;       // centésimos de °F²
+    int64_t r2 = r * r / 100;
+    int64_t hi = -4237900000LL * 100
+               + 204901523LL * t
+               + 1014333127LL * r
+               - 22475541LL * (t * r / 100)
+               - 683783LL * t2
+               - 5481717LL * r2
+               + 122874LL * (t2 * r / 100)
+               + 85282LL * (t * r2 / 100)
+               - 199LL * (t2 * r2 / 100);
+    int32_t result = (int32_t)div_round(hi, 100000000LL);
+
+    // Ajustes para ar muito seco ou muito úmido
+    if (rh < 1300 && tf >= 8000 && tf <= 11200) {
+        int32_t dist = tf - 9500;
+        if (dist < 0) dist = -dist;
+        // sqrt((17 - |T - 95|) / 17) em décimos de milésimo
+        uint32_t root = sensor_units_isqrt((uint64_t)(1700 - dist) * 100000000u / 1700u);
+        result -= (int32_t)((int64_t)(1300 - rh) * root / 4 / 10000);
+    } else if (rh > 8500 && tf >= 8000 && tf <= 8700) {
+        result += (int32_t)((int64_t)(rh - 8500) * (8700 - tf) / 10 / 5 / 100);
+    }
+    return result;
+}
+
+void comfort_metrics_compute(int32_t temp_centi, int32_t humidity_centi, comfort_metrics_t *out) {
+    int32_t rh = clamp_i32(humidity_centi, 0, 10000);
+
+    // Pressão parcial de vapor (centésimos de Pa)
+    uint32_t es = comfort_saturation_pressure(temp_centi);
+    uint32_t e = (uint32_t)(((uint64_t)es * (uint32_t)rh + 5000u) / 10000u);
+
+    out->dew_point_centi = dew_point_from_pressure(e);
+
+    // AH [g/m³] = 2.16679 * e[Pa] / T[K]; com e em centésimos de Pa e T em
+    // centésimos de K, AH em centésimos = 216679 * e / (T * 1000)
+    int64_t t_kelvin_centi = (int64_t)temp_centi + 27315;
+    if (t_kelvin_centi < 1) t_kelvin_centi = 1;
+    out->abs_humidity_centi = (int32_t)div_round((int64_t)e * 216679, t_kelvin_centi * 1000);
+
+    // Índice de calor em °F e de volta para °C
+    int32_t tf = (int32_t)div_round((int64_t)temp_centi * 9, 5) + 3200;
+    int32_t hi_f = heat_index_f(tf, rh);
+    out->heat_index_centi = (int32_t)div_round((int64_t)(hi_f - 3200) * 5, 9);
+}
@@ -0,0 +1,69 @@
+#include "jitter_stats.h"
+
+#include <string.h>
+
+#define LINEAR_BINS 8
+#define SUB_BINS    4     // Compartimentos por potência de dois (2 bits)
+
+// Posição do bit mais significativo (v > 0)
+static unsigned msb_index(uint32_t v) {
+    unsigned e = 0;
+    while (v >>= 1) {
+        e++;
+    }
+    return e;
+}
+
+static unsigned bin_of(uint32_t us) {
+    if (us < LINEAR_BINS) return us;
+
+    unsigned e = msb_index(us);   // >= 3
+    unsigned bin = LINEAR_BINS + (e - 3) * SUB_BINS + ((us >> (e - 2)) & (SUB_BINS - 1));
+    return bin < JITTER_STATS_BINS ? bin : JITTER_STATS_BINS - 1;
+}
+
+// Maior valor que cai no compartimento
+static uint32_t bin_upper_us(unsigned bin) {
+    if (bin < LINEAR_BINS) return bin;
+
+    unsigned e = 3 + (bin - LINEAR_BINS) / SUB_BINS;
+    unsigned sub = (bin - LINEAR_BINS) % SUB_BINS;
+    return ((uint32_t)(SUB_BINS + sub + 1) << (e - 2)) - 1;
+}
+
+void jitter_stats_reset(jitter_stats_t *js) {
+    memset(js, 0, sizeof(*js));
+}
+
+void jitter_stats_add(jitter_stats_t *js, uint32_t delay_us) {
+    if (js->count == 0 || delay_us < js->min_us) js->min_us = delay_us;
+    if (delay_us > js->max_us) js->max_us = delay_us;
+    js->count++;
+    js->sum_us += delay_us;
+    js->bins[bin_of(delay_us)]++;
+}
+
+uint32_t jitter_stats_mean_us(const jitter_stats_t *js) {
+    if (js->count == 0) return 0;
+    return (uint32_t)(js->sum_us / js->count);
+}
+
+uint32_t jitter_stats_percentile_us(const jitter_stats_t *js, uint32_t permille) {
+    if (js->count == 0) return 0;
+
+    // Posição da amostra do percentil, arredondada para cima
+    uint64_t rank = ((uint64_t)js->count * permille + 999) / 1000;
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned bin = 0; bin < JITTER_STATS_BINS; bin++) {
+        seen += js->bins[bin];
+        if (seen >= rank) {
+            uint32_t upper = bin_upper_us(bin);
+            if (upper > js->max_us || bin == JITTER_STATS_BINS - 1) upper = js->max_us;
+            if (upper < js->min_us) upper = js->min_us;
+            return upper;
+        }
+    }
+    return js->max_us;
+}
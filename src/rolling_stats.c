@@ -0,0 +1,164 @@
+#include "rolling_stats.h"
+
+#include <string.h>
+
+#define N ROLLING_STATS_BUCKETS
+
+// ============= FILA MONOTÔNICA =============
+
+static uint32_t dq_front(const rolling_deque_t *q) {
+    return q->items[q->head];
+}
+
+static uint32_t dq_back(const rolling_deque_t *q) {
+    return q->items[(q->head + q->size - 1) % N];
+}
+
+static void dq_pop_front(rolling_deque_t *q) {
+    q->head = (uint8_t)((q->head + 1) % N);
+    q->size--;
+}
+
+static void dq_pop_back(rolling_deque_t *q) {
+    q->size--;
+}
+
+static void dq_push_back(rolling_deque_t *q, uint32_t index) {
+    q->items[(q->head + q->size) % N] = index;
+    q->size++;
+}
+
+// ============= SUB-INTERVALOS =============
+
+static const rolling_bucket_t *closed_bucket(const rolling_window_t *w, uint32_t index) {
+    return &w->closed[index % N];
+}
+
+static void bucket_reset(rolling_bucket_t *b, uint32_t index) {
+    memset(b, 0, sizeof(*b));
+    b->index = index;
+}
+
+// Move o sub-intervalo atual para a janela fechada
+static void close_current(rolling_window_t *w) {
+    rolling_bucket_t *cur = &w->current;
+    if (cur->count == 0) return;
+
+    w->closed[cur->index % N] = *cur;
+    w->total_count += cur->count;
+    w->total_sum += cur->sum;
+    w->total_sum_sq += cur->sum_sq;
+
+    // Mantém as filas monotônicas: crescente para min, decrescente para max
+    while (w->min_q.size > 0 && closed_bucket(w, dq_back(&w->min_q))->min >= cur->min) {
+        dq_pop_back(&w->min_q);
+    }
+    dq_push_back(&w->min_q, cur->index);
+
+    while (w->max_q.size > 0 && closed_bucket(w, dq_back(&w->max_q))->max <= cur->max) {
+        dq_pop_back(&w->max_q);
+    }
+    dq_push_back(&w->max_q, cur->index);
+}
+
+// Remove os fechados com índice <= last_expired
+static void expire(rolling_window_t *w, uint32_t first, uint32_t last_expired) {
+    // Lacuna maior que a janela: nada fechado sobrevive
+    if ((int32_t)(last_expired - first) >= N) {
+        first = last_expired - (N - 1);
+    }
+
+    for (uint32_t idx = first; (int32_t)(last_expired - idx) >= 0; idx++) {
+        rolling_bucket_t *b = &w->closed[idx % N];
+        if (b->index != idx || b->count == 0) continue;
+        w->total_count -= b->count;
+        w->total_sum -= b->sum;
+        w->total_sum_sq -= b->sum_sq;
+        b->count = 0;
+    }
+
+    while (w->min_q.size > 0 && (int32_t)(last_expired - dq_front(&w->min_q)) >= 0) {
+        dq_pop_front(&w->min_q);
+    }
+    while (w->max_q.size > 0 && (int32_t)(last_expired - dq_front(&w->max_q)) >= 0) {
+        dq_pop_front(&w->max_q);
+    }
+}
+
+// ============= API =============
+
+void rolling_window_init(rolling_window_t *w, uint32_t window_ms) {
+    memset(w, 0, sizeof(*w));
+    w->bucket_ms = window_ms / N;
+    if (w->bucket_ms == 0) {
+        w->bucket_ms = 1;
+    }
+}
+
+void rolling_window_advance(rolling_window_t *w, uint32_t now_ms) {
+    if (!w->started) {
+        w->started = true;
+        bucket_reset(&w->current, now_ms / w->bucket_ms);
+        w->current_start_ms = w->current.index * w->bucket_ms;
+        return;
+    }
+
+    // Conta sub-intervalos pelo tempo decorrido, não por now_ms / bucket_ms,
+    // para os índices seguirem contínuos quando o contador de ms dá a volta
+    uint32_t elapsed = now_ms - w->current_start_ms;
+    if ((int32_t)elapsed < 0 || elapsed < w->bucket_ms) return;
+    uint32_t steps = elapsed / w->bucket_ms;
+    uint32_t index = w->current.index + steps;
+
+    // A janela cobre o sub-intervalo atual e os N-1 anteriores
+    uint32_t old_index = w->current.index;
+    close_current(w);
+    expire(w, old_index - (N - 1), index - N);
+    bucket_reset(&w->current, index);
+    w->current_start_ms += steps * w->bucket_ms;
+}
+
+void rolling_window_add(rolling_window_t *w, uint32_t t_ms, int32_t value) {
+    rolling_window_advance(w, t_ms);
+
+    rolling_bucket_t *cur = &w->current;
+    if (cur->count == 0 || value < cur->min) cur->min = value;
+    if (cur->count == 0 || value > cur->max) cur->max = value;
+    cur->count++;
+    cur->sum += value;
+    cur->sum_sq += (int64_t)value * value;
+}
+
+void rolling_window_result(const rolling_window_t *w, rolling_result_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    const rolling_bucket_t *cur = &w->current;
+    uint32_t count = w->total_count + cur->count;
+    if (count == 0) return;
+
+    int64_t sum = w->total_sum + cur->sum;
+    int64_t sum_sq = w->total_sum_sq + cur->sum_sq;
+
+    int64_t n = (int64_t)count;
+    int64_t mean = sum / n;
+    int64_t rem = sum - mean * n;
+
+    out->count = count;
+    out->mean = (int32_t)mean;
+    // n·var = sum_sq - sum²/n com sum = mean·n + rem, sem formar sum² (que
+    // estoura 64 bits com lux em janelas longas) e sem o erro de até
+    // 2|média| de usar a média truncada em E[x²] - média²
+    out->variance = (sum_sq - mean * mean * n - 2 * mean * rem - rem * rem / n) / n;
+    if (out->variance < 0) out->variance = 0;
+
+    bool has = false;
+    if (w->min_q.size > 0) {
+        out->min = closed_bucket(w, dq_front(&w->min_q))->min;
+        out->max = closed_bucket(w, dq_front(&w->max_q))->max;
+        has = true;
+    }
+    if (cur->count > 0) {
+        if (!has || cur->min < out->min) out->min = cur->min;
+        if (!has || cur->max > out->max) out->max = cur->max;
+    }
+}
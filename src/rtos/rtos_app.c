@@ -1,6 +1,7 @@
 #include "rtos_app.h"
 #include "rtos_tasks.h"
 #include "sensor_data.h"
+#include "sensor_registry.h"
 
 #include <stdio.h>
 
@@ -9,6 +10,7 @@
 #include "semphr.h"
 
 static rtos_task_params_t g_task_params;
+static anomaly_detector_t g_anomaly_detector;
 
 void rtos_start(const app_context_t *ctx) {
     if (!ctx) {
@@ -17,6 +19,8 @@ void rtos_start(const app_context_t *ctx) {
     }
 
     g_task_params.ctx = ctx;
+    g_task_params.scheduler = sensor_registry_scheduler();
+    g_task_params.detector = &g_anomaly_detector;
     g_task_params.sensor_mutex = xSemaphoreCreateMutex();
 
     if (g_task_params.sensor_mutex) {
@@ -30,6 +34,9 @@ void rtos_start(const app_context_t *ctx) {
     xTaskCreate(task_uart, "uart", 1024, &g_task_params, 1, NULL);
     xTaskCreate(task_web, "web", 1024, &g_task_params, 1, NULL);
 
+    // Menor prioridade: gravações na flash nunca atrasam sensores nem web
+    xTaskCreate(task_storage, "storage", 1024, &g_task_params, tskIDLE_PRIORITY, NULL);
+
     vTaskStartScheduler();
 
     // Se chegar aqui, houve erro ao iniciar o scheduler
@@ -3,6 +3,7 @@
 #include <stdio.h>
 
 #include "sensor_data.h"
+#include "sensor_registry.h"
 #include "ssd1306.h"
 
 #include "FreeRTOS.h"
@@ -11,9 +12,58 @@
 typedef enum {
     SCREEN_LUMINOSITY,
     SCREEN_TEMPERATURE,
+    SCREEN_METRICS,
     SCREEN_COUNT
 } display_screen_t;
 
+// Grandezas por página da tela genérica (linhas 16, 32 e 48)
+#define DISPLAY_METRICS_PER_PAGE 3
+
+// Grandezas do registro sem tela própria (sem série temporal)
+static size_t display_extra_metrics(size_t *indices, size_t max) {
+    size_t count = 0;
+    for (size_t i = 0; i < sensor_registry_metric_count() && count < max; i++) {
+        sensor_metric_value_t mv;
+        if (sensor_registry_get_metric(i, &mv) && mv.desc->ts_metric == SENSOR_METRIC_NO_SERIES) {
+            indices[count++] = i;
+        }
+    }
+    return count;
+}
+
+// Desenha uma página da tela genérica; a cada visita avança de página
+static void display_draw_metrics(ssd1306_t *display, const size_t *indices, size_t count, size_t *page) {
+    size_t pages = (count + DISPLAY_METRICS_PER_PAGE - 1) / DISPLAY_METRICS_PER_PAGE;
+    if (*page >= pages) {
+        *page = 0;
+    }
+
+    ssd1306_clear(display);
+    ssd1306_draw_string(display, 0, 0, "===Sensores===");
+
+    for (size_t line = 0; line < DISPLAY_METRICS_PER_PAGE; line++) {
+        size_t n = *page * DISPLAY_METRICS_PER_PAGE + line;
+        if (n >= count) break;
+
+        sensor_metric_value_t mv;
+        if (!sensor_registry_get_metric(indices[n], &mv)) continue;
+
+        char value_str[16];
+        char line_str[32];
+        if (mv.valid) {
+            sensor_units_format(value_str, sizeof(value_str), mv.value, mv.desc->decimals);
+        } else {
+            snprintf(value_str, sizeof(value_str), "--");
+        }
+        snprintf(line_str, sizeof(line_str), "%s%s", value_str, mv.desc->unit);
+        ssd1306_draw_string(display, 0, (int16_t)(16 + 16 * line), mv.desc->label);
+        ssd1306_draw_string(display, 50, (int16_t)(16 + 16 * line), line_str);
+    }
+
+    ssd1306_show(display);
+    (*page)++;
+}
+
 void task_display(void *param) {
     const rtos_task_params_t *params = (const rtos_task_params_t *)param;
     const app_context_t *ctx = params ? params->ctx : NULL;
@@ -23,21 +73,37 @@ void task_display(void *param) {
     }
 
     display_screen_t current_screen = SCREEN_LUMINOSITY;
-    uint32_t screen_timer = 0;
     const uint32_t SCREEN_DURATION_MS = 3000;
 
+    // Acordada apenas por mudanças visíveis (resolução de 0,1 exibida na tela)
+    // ou pela troca de tela, em vez de consultar os dados a cada 200 ms
+    static const sensor_deadband_t DISPLAY_DEADBAND = {
+        .luminosity_centi = 10,
+        .temperature_centi = 10,
+        .humidity_centi = 10,
+    };
+    sensor_data_subscribe(xTaskGetCurrentTaskHandle(), "display", SENSOR_FIELD_ALL, &DISPLAY_DEADBAND);
+
+    TickType_t screen_start = xTaskGetTickCount();
+    bool redraw = true;
+    size_t metrics_page = 0;
+
     while (true) {
         sensor_data_t data = sensor_data_get();
 
-        if (current_screen == SCREEN_LUMINOSITY) {
+        if (!redraw) {
+            // Mudança apenas em campos da outra tela
+        } else if (current_screen == SCREEN_LUMINOSITY) {
             char lux_str[32];
+            char value_str[16];
             char intensity_str[32];
             char status_str[32];
 
             if (data.luminosity_valid) {
-                snprintf(lux_str, sizeof(lux_str), "%.1f lux", data.luminosity_lux);
+                sensor_units_format(value_str, sizeof(value_str), data.luminosity_centi, 1);
+                snprintf(lux_str, sizeof(lux_str), "%s lux", value_str);
 
-                led_intensity_t intensity = led_matrix_get_intensity_from_lux(data.luminosity_lux);
+                led_intensity_t intensity = led_matrix_get_intensity_from_lux(data.luminosity_centi);
                 switch (intensity) {
                     case LED_INTENSITY_OFF:
                         snprintf(intensity_str, sizeof(intensity_str), "Desligado");
@@ -72,13 +138,20 @@ void task_display(void *param) {
         } else if (current_screen == SCREEN_TEMPERATURE) {
             char temp_str[32];
             char humid_str[32];
+            char dew_str[32];
+            char value_str[16];
 
             if (data.temp_humidity_valid) {
-                snprintf(temp_str, sizeof(temp_str), "%.1f*C", data.temperature_c);
-                snprintf(humid_str, sizeof(humid_str), "%.1f%%", data.humidity_percent);
+                sensor_units_format(value_str, sizeof(value_str), data.temperature_centi, 1);
+                snprintf(temp_str, sizeof(temp_str), "%s*C", value_str);
+                sensor_units_format(value_str, sizeof(value_str), data.humidity_centi, 1);
+                snprintf(humid_str, sizeof(humid_str), "%s%%", value_str);
+                sensor_units_format(value_str, sizeof(value_str), data.comfort.dew_point_centi, 1);
+                snprintf(dew_str, sizeof(dew_str), "%s*C", value_str);
             } else {
                 snprintf(temp_str, sizeof(temp_str), "Erro");
                 snprintf(humid_str, sizeof(humid_str), "Erro");
+                snprintf(dew_str, sizeof(dew_str), "--");
             }
 
             ssd1306_clear(ctx->display);
@@ -87,15 +160,38 @@ void task_display(void *param) {
             ssd1306_draw_string(ctx->display, 50, 14, temp_str);
             ssd1306_draw_string(ctx->display, 0, 32, "Umid:");
             ssd1306_draw_string(ctx->display, 50, 32, humid_str);
+            ssd1306_draw_string(ctx->display, 0, 48, "Orv:");
+            ssd1306_draw_string(ctx->display, 50, 48, dew_str);
             ssd1306_show(ctx->display);
+        } else if (current_screen == SCREEN_METRICS) {
+            size_t indices[SENSOR_REGISTRY_MAX_METRICS];
+            size_t count = display_extra_metrics(indices, SENSOR_REGISTRY_MAX_METRICS);
+            if (count > 0) {
+                display_draw_metrics(ctx->display, indices, count, &metrics_page);
+            } else {
+                // Sem grandezas extras: pula direto para a próxima tela
+                current_screen = (current_screen + 1) % SCREEN_COUNT;
+                screen_start = xTaskGetTickCount();
+                continue;
+            }
         }
 
-        screen_timer += 200;
-        if (screen_timer >= SCREEN_DURATION_MS) {
-            screen_timer = 0;
+        // Espera mudança nos campos exibidos ou o fim do tempo da tela
+        TickType_t elapsed = xTaskGetTickCount() - screen_start;
+        TickType_t duration = pdMS_TO_TICKS(SCREEN_DURATION_MS);
+        uint32_t changed = 0;
+
+        if (elapsed >= duration ||
+            xTaskNotifyWait(0, UINT32_MAX, &changed, duration - elapsed) == pdFALSE) {
+            screen_start = xTaskGetTickCount();
             current_screen = (current_screen + 1) % SCREEN_COUNT;
+            redraw = true;
+        } else {
+            // A tela genérica não tem campo no snapshot: fica até o fim do tempo
+            uint32_t shown = (current_screen == SCREEN_LUMINOSITY)
+                ? (SENSOR_FIELD_LUMINOSITY | SENSOR_FIELD_LED)
+                : (current_screen == SCREEN_TEMPERATURE) ? SENSOR_FIELD_TEMP_HUMIDITY : 0;
+            redraw = (changed & shown) != 0;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(200));
     }
 }
@@ -6,6 +6,7 @@
 #include "hardware/gpio.h"
 #include "sensor_data.h"
 #include "led_matrix.h"
+#include "sensor_pipeline.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
@@ -17,8 +18,51 @@
 #define BTN_EVENT_A (1u << 0)
 #define BTN_EVENT_B (1u << 1)
 
+#define SENSORS_MAX_SLEEP_MS  1000
+
 static volatile uint32_t s_button_events = 0;
-static TaskHandle_t s_button_task = NULL;
+static TaskHandle_t s_sensors_task = NULL;
+
+// Alarme de hardware do próximo prazo: acorda a task no microssegundo
+// agendado, sem a granularidade do tick nem o atraso do loop
+static int64_t sensors_alarm_callback(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+
+    if (s_sensors_task) {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(s_sensors_task, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+    return 0;   // Disparo único
+}
+
+// Dorme até deadline_us (ou até um botão); false se o prazo já passou
+static bool sensors_sleep_until(uint64_t deadline_us) {
+    uint64_t now_us = time_us_64();
+    uint64_t max_us = now_us + (uint64_t)SENSORS_MAX_SLEEP_MS * 1000u;
+    if (deadline_us > max_us) {
+        deadline_us = max_us;
+    }
+    if (deadline_us <= now_us) {
+        return false;
+    }
+
+    // fire_if_past = false: com o prazo vencido durante a chamada o
+    // retorno é 0 e a passada roda de novo, sem callback no contexto da task
+    alarm_id_t alarm = add_alarm_at(from_us_since_boot(deadline_us), sensors_alarm_callback, NULL, false);
+    if (alarm == 0) {
+        return false;
+    }
+
+    // Sem alarme livre (< 0), o timeout do tick serve de reserva
+    uint32_t timeout_ms = (uint32_t)((deadline_us - now_us + 999u) / 1000u);
+    bool woke = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) > 0;
+    if (alarm > 0) {
+        cancel_alarm(alarm);
+    }
+    return woke;
+}
 
 static void buttons_irq_handler(uint gpio, uint32_t events) {
     if ((events & GPIO_IRQ_EDGE_FALL) == 0) {
@@ -33,22 +77,61 @@ static void buttons_irq_handler(uint gpio, uint32_t events) {
         return;
     }
 
-    if (s_button_task) {
+    if (s_sensors_task) {
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        vTaskNotifyGiveFromISR(s_button_task, &xHigherPriorityTaskWoken);
+        vTaskNotifyGiveFromISR(s_sensors_task, &xHigherPriorityTaskWoken);
         portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
 }
 
+static void handle_button_events(const app_context_t *ctx, uint32_t *last_btn_a_ms, uint32_t *last_btn_b_ms) {
+    uint32_t events;
+    taskENTER_CRITICAL();
+    events = s_button_events;
+    s_button_events = 0;
+    taskEXIT_CRITICAL();
+
+    if (events == 0) {
+        return;
+    }
+
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    uint32_t now_ms = txn.now_ms;
+
+    if ((events & BTN_EVENT_A) != 0) {
+        if ((now_ms - *last_btn_a_ms) > 200) {
+            *last_btn_a_ms = now_ms;
+            if (*ctx->led_matrix_enabled) {
+                *ctx->led_matrix_enabled = false;
+                led_matrix_clear(ctx->led_matrix);
+                sensor_txn_set_led_state(&txn, false, LED_INTENSITY_OFF);
+            }
+        }
+    }
+
+    if ((events & BTN_EVENT_B) != 0) {
+        if ((now_ms - *last_btn_b_ms) > 200) {
+            *last_btn_b_ms = now_ms;
+            if (!*ctx->led_matrix_enabled) {
+                *ctx->led_matrix_enabled = true;
+                sensor_txn_set_led_state(&txn, true, LED_INTENSITY_LOW);
+            }
+        }
+    }
+
+    sensor_data_commit(&txn);
+}
+
 void task_sensors(void *param) {
     const rtos_task_params_t *params = (const rtos_task_params_t *)param;
     const app_context_t *ctx = params ? params->ctx : NULL;
 
-    if (!ctx || !ctx->light_sensor || !ctx->temp_sensor || !ctx->led_matrix || !ctx->led_matrix_enabled) {
+    if (!ctx || !ctx->led_matrix || !ctx->led_matrix_enabled || !params->detector) {
         vTaskDelete(NULL);
     }
 
-    s_button_task = xTaskGetCurrentTaskHandle();
+    s_sensors_task = xTaskGetCurrentTaskHandle();
 
     gpio_set_irq_enabled_with_callback(BTN_A, GPIO_IRQ_EDGE_FALL, true, &buttons_irq_handler);
     gpio_set_irq_enabled(BTN_B, GPIO_IRQ_EDGE_FALL, true);
@@ -56,65 +139,14 @@ void task_sensors(void *param) {
     uint32_t last_btn_a_ms = 0;
     uint32_t last_btn_b_ms = 0;
 
-    while (true) {
-        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(200));
-
-        uint32_t events;
-        taskENTER_CRITICAL();
-        events = s_button_events;
-        s_button_events = 0;
-        taskEXIT_CRITICAL();
-
-        if (events != 0) {
-            uint32_t now_ms = to_ms_since_boot(get_absolute_time());
-
-            if ((events & BTN_EVENT_A) != 0) {
-                if ((now_ms - last_btn_a_ms) > 200) {
-                    last_btn_a_ms = now_ms;
-                    if (*ctx->led_matrix_enabled) {
-                        *ctx->led_matrix_enabled = false;
-                        led_matrix_clear(ctx->led_matrix);
-                        sensor_data_set_led_state(false, LED_INTENSITY_OFF);
-                    }
-                }
-            }
-
-            if ((events & BTN_EVENT_B) != 0) {
-                if ((now_ms - last_btn_b_ms) > 200) {
-                    last_btn_b_ms = now_ms;
-                    if (!*ctx->led_matrix_enabled) {
-                        *ctx->led_matrix_enabled = true;
-                        sensor_data_set_led_state(true, LED_INTENSITY_LOW);
-                    }
-                }
-            }
-        }
-
-        float lux = 0.0f;
-        float temperature = 0.0f;
-        float humidity = 0.0f;
-
-        if (ctx->bh1750_ok && *ctx->bh1750_ok && bh1750_read_light(ctx->light_sensor, &lux)) {
-            sensor_data_set_luminosity(lux, true);
+    sensor_pipeline_init(ctx, params->detector);
 
-            led_intensity_t intensity = led_matrix_get_intensity_from_lux(lux);
-            if (*ctx->led_matrix_enabled) {
-                led_matrix_set_intensity(ctx->led_matrix, intensity);
-                sensor_data_set_led_state(true, intensity);
-            } else {
-                led_matrix_clear(ctx->led_matrix);
-                sensor_data_set_led_state(false, LED_INTENSITY_OFF);
-            }
-        } else {
-            sensor_data_set_luminosity(0.0f, false);
-        }
+    while (true) {
+        uint64_t deadline_us = sensor_pipeline_step();
 
-        if (ctx->aht10_ok && *ctx->aht10_ok && aht10_read_temperature_humidity(ctx->temp_sensor, &temperature, &humidity)) {
-            sensor_data_set_temp_humidity(temperature, humidity, true);
-        } else {
-            sensor_data_set_temp_humidity(0.0f, 0.0f, false);
+        // Dorme até o próximo prazo; botões acordam a task antes
+        if (sensors_sleep_until(deadline_us)) {
+            handle_button_events(ctx, &last_btn_a_ms, &last_btn_b_ms);
         }
-
-        vTaskDelay(pdMS_TO_TICKS(200));
     }
 }
@@ -0,0 +1,123 @@
+#include "rtos_tasks.h"
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "flash_store.h"
+#include "sample_log.h"
+#include "sensor_data.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+// Intervalo entre amostras persistidas (~55 h de histórico em 256 KB)
+#define STORAGE_SAMPLE_INTERVAL_MS 10000
+
+static bool storage_read(void *ctx, uint32_t offset, void *dst, size_t len) {
+    (void)ctx;
+    return flash_store_read(offset, dst, len);
+}
+
+static bool storage_program(void *ctx, uint32_t offset, const void *src, size_t len) {
+    (void)ctx;
+    return flash_store_program(offset, src, len);
+}
+
+static bool storage_erase(void *ctx, uint32_t offset, size_t len) {
+    (void)ctx;
+    return flash_store_erase(offset, len);
+}
+
+static const sample_log_flash_t s_flash = {
+    .read = storage_read,
+    .program = storage_program,
+    .erase = storage_erase,
+    .ctx = NULL,
+    .size = FLASH_STORE_SIZE,
+};
+
+static sample_log_t s_log;
+static SemaphoreHandle_t s_log_mutex = NULL;
+static bool s_log_ready = false;
+
+// Captura mais recente do snapshot: o registro leva o instante da medição,
+// não o de quando a task acordou (ela pode esperar o mutex ou a flash)
+static uint32_t snapshot_capture_ms(const sensor_data_t *data) {
+    uint64_t capture_us = data->temp_humidity_capture_us > data->luminosity_capture_us
+                              ? data->temp_humidity_capture_us
+                              : data->luminosity_capture_us;
+    return (uint32_t)(capture_us / 1000u);
+}
+
+static void entry_from_snapshot(const sensor_data_t *data, sample_log_entry_t *entry) {
+    entry->boot_id = 0;
+    entry->t_ms = snapshot_capture_ms(data);
+    entry->temp_humidity_valid = data->temp_humidity_valid;
+    entry->temperature_centi = (int16_t)data->temperature_centi;
+    entry->humidity_centi = (uint16_t)data->humidity_centi;
+    entry->luminosity_valid = data->luminosity_valid;
+    entry->luminosity_centi = (uint32_t)data->luminosity_centi;
+}
+
+size_t task_storage_latest(sample_log_entry_t *out, size_t max_entries) {
+    if (!s_log_ready) return 0;
+
+    xSemaphoreTake(s_log_mutex, portMAX_DELAY);
+    size_t n = sample_log_latest(&s_log, out, max_entries);
+    xSemaphoreGive(s_log_mutex);
+    return n;
+}
+
+bool task_storage_get_stats(sample_log_stats_t *out, uint16_t *boot_id) {
+    if (!s_log_ready || !out) return false;
+
+    xSemaphoreTake(s_log_mutex, portMAX_DELAY);
+    *out = s_log.stats;
+    if (boot_id) *boot_id = s_log.boot_id;
+    xSemaphoreGive(s_log_mutex);
+    return true;
+}
+
+void task_storage(void *param) {
+    (void)param;
+
+    s_log_mutex = xSemaphoreCreateMutex();
+    if (!s_log_mutex || !flash_store_init() || !sample_log_init(&s_log, &s_flash)) {
+        printf("[STORAGE] Log em flash indisponivel\n");
+        vTaskDelete(NULL);
+    }
+    s_log_ready = true;
+
+    printf("[STORAGE] Log recuperado: boot=%u paginas lidas=%lu corrompidas=%lu\n",
+           s_log.boot_id,
+           (unsigned long)s_log.stats.recovery_pages_read,
+           (unsigned long)s_log.stats.pages_corrupt);
+
+    // Acorda logo após um commit de temperatura/umidade: o apagamento e a
+    // gravação (que param a XIP) ocorrem com folga até o próximo prazo
+    sensor_data_subscribe(xTaskGetCurrentTaskHandle(), "storage", SENSOR_FIELD_TEMP_HUMIDITY, NULL);
+
+    uint32_t last_sample_ms = 0;
+    bool has_sample = false;
+
+    while (true) {
+        uint32_t changed = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &changed, portMAX_DELAY);
+
+        sensor_data_t data = sensor_data_get();
+        uint32_t t_ms = snapshot_capture_ms(&data);
+        if (has_sample && (t_ms - last_sample_ms) < STORAGE_SAMPLE_INTERVAL_MS) {
+            continue;
+        }
+        last_sample_ms = t_ms;
+        has_sample = true;
+
+        sample_log_entry_t entry;
+        entry_from_snapshot(&data, &entry);
+
+        xSemaphoreTake(s_log_mutex, portMAX_DELAY);
+        sample_log_append(&s_log, &entry);
+        xSemaphoreGive(s_log_mutex);
+    }
+}
@@ -5,10 +5,16 @@
 #include <ctype.h>
 
 #include "pico/stdlib.h"
+#include "app_control.h"
 #include "sensor_data.h"
+#include "timeseries.h"
 #include "wifi_manager.h"
 #include "auth.h"
-#include "led_matrix.h"
+#include "i2c_async.h"
+#include "sensor_pipeline.h"
+#include "sensor_registry.h"
+#include "sensor_trace.h"
+#include "web_server.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
@@ -17,11 +23,38 @@
 
 static char uart_cmd_buffer[UART_CMD_MAX];
 static size_t uart_cmd_len = 0;
+static const sensor_scheduler_t *uart_scheduler = NULL;
+static const anomaly_detector_t *uart_detector = NULL;
+static uint32_t uart_history_cursor = 0;
+
+// Amostras impressas por chamada de HIST
+#define UART_HISTORY_BATCH 16
+
+// Máximo de pontos impressos por TS
+#define UART_TS_MAX_POINTS 16
+
+// Máximo de amostras impressas por LOG
+#define UART_LOG_MAX_ENTRIES 16
+
+// Quadros de trace impressos por passada do loop (a cada 20 ms)
+#define UART_TRACE_BATCH 8
 
 static void uart_print_help(void) {
     printf("\nComandos UART:\n");
     printf("  HELP                - Lista comandos\n");
-    printf("  STATUS              - Mostra sensores\n");
+    printf("  STATUS              - Mostra sensores e medias/min/max por janela\n");
+    printf("  METRICS             - Todas as grandezas dos sensores registrados\n");
+    printf("  HIST                - Amostras novas desde o ultimo HIST\n");
+    printf("  SCHED               - Taxa, duty cycle e jitter (min/med/p99/max) por sensor\n");
+    printf("  HEALTH              - Estado, falhas e sondagens de cada sensor\n");
+    printf("  ADAPT [ON|OFF]      - Amostragem adaptativa (sem argumento: estado)\n");
+    printf("  RATE <ms>|AUTO      - Periodo fixo de amostragem ou volta ao normal\n");
+    printf("  I2C                 - Estatisticas das filas I2C\n");
+    printf("  LOG [n]             - Ultimas n amostras gravadas na flash\n");
+    printf("  TS <res> [n]        - Ultimos n pontos (raw|1s|1min|1h)\n");
+    printf("  EVENTS              - Notificacoes de mudanca e wakeups evitados\n");
+    printf("  ANOMALY             - Amostras marcadas/rejeitadas por grandeza\n");
+    printf("  TRACE ON|OFF        - Grava os quadros I2C brutos (replay no host)\n");
     printf("  WIFI?               - Mostra estado WiFi/IP\n");
     printf("  LED ON|OFF           - Liga/Desliga matriz\n");
     printf("  LOGIN RESET         - Reseta usuario/senha\n");
@@ -52,9 +85,324 @@ static int str_starts_with_ignore_case(const char *text, const char *prefix) {
     return 1;
 }
 
-static void uart_handle_command(const char *cmd_line,
-                                led_matrix_t *led_matrix,
-                                volatile bool *led_enabled) {
+static void uart_print_schedule(void) {
+    if (!uart_scheduler) {
+        printf("SCHED indisponivel\n");
+        return;
+    }
+
+    for (size_t i = 0; i < uart_scheduler->count; i++) {
+        sensor_sched_stats_t stats;
+        taskENTER_CRITICAL();
+        bool ok = sensor_scheduler_get_stats(uart_scheduler, i, &stats);
+        taskEXIT_CRITICAL();
+        if (!ok) continue;
+
+        const sensor_sched_entry_t *e = &uart_scheduler->entries[i];
+        uint32_t avg_period = sensor_scheduler_avg_period_ms(&stats);
+        uint32_t rate_centi_hz = avg_period ? (100000u / avg_period) : 0;
+        uint32_t duty = sensor_scheduler_duty_permille(&stats, e->base_period_ms);
+
+        const jitter_stats_t *j = &stats.jitter;
+        printf("SCHED %s periodo=%lums medio=%lums taxa=%lu.%02luHz duty=%lu.%lu%% jitter_us min=%lu med=%lu p99=%lu max=%lu ok=%lu falhas=%lu sondagens=%lu\n",
+               e->name ? e->name : "?",
+               (unsigned long)e->period_ms,
+               (unsigned long)avg_period,
+               (unsigned long)(rate_centi_hz / 100),
+               (unsigned long)(rate_centi_hz % 100),
+               (unsigned long)(duty / 10),
+               (unsigned long)(duty % 10),
+               (unsigned long)j->min_us,
+               (unsigned long)jitter_stats_mean_us(j),
+               (unsigned long)jitter_stats_percentile_us(j, 990),
+               (unsigned long)j->max_us,
+               (unsigned long)stats.samples,
+               (unsigned long)stats.failures,
+               (unsigned long)stats.probes);
+    }
+}
+
+static void uart_print_metrics(void) {
+    uint64_t now_us = time_us_64();
+
+    for (size_t i = 0; i < sensor_registry_metric_count(); i++) {
+        sensor_metric_value_t mv;
+        if (!sensor_registry_get_metric(i, &mv)) continue;
+
+        char value[SENSOR_UNITS_STR_MAX];
+        if (mv.valid) {
+            sensor_units_format(value, sizeof(value), mv.value, mv.desc->decimals);
+        } else {
+            snprintf(value, sizeof(value), "--");
+        }
+        printf("METRIC %s/%s=%s%s idade=%lums amostras=%lu marcas=0x%02x\n",
+               mv.sensor_name, mv.desc->key, value, mv.desc->unit,
+               (unsigned long)(mv.capture_us ? (now_us - mv.capture_us) / 1000u : 0),
+               (unsigned long)mv.samples,
+               mv.flags);
+    }
+}
+
+static void uart_print_health(void) {
+    uint64_t now_us = time_us_64();
+
+    for (size_t i = 0; i < sensor_registry_count(); i++) {
+        sensor_status_t st;
+        if (!sensor_registry_get_status((int)i, &st)) continue;
+
+        const sensor_health_t *h = &st.health;
+        uint32_t next_ms = 0;
+        if (h->state == SENSOR_HEALTH_OFFLINE && h->next_probe_us > now_us) {
+            next_ms = (uint32_t)((h->next_probe_us - now_us) / 1000u);
+        }
+        printf("HEALTH %s estado=%s falhas=%lu seguidas=%u quedas=%lu sondagens=%lu recuperacoes=%lu espera=%lums proxima=%lums\n",
+               st.name,
+               sensor_health_state_name(h->state),
+               (unsigned long)h->failures,
+               h->consecutive_failures,
+               (unsigned long)h->outages,
+               (unsigned long)h->probes,
+               (unsigned long)h->recoveries,
+               (unsigned long)h->backoff_ms,
+               (unsigned long)next_ms);
+    }
+}
+
+static void uart_print_adaptive(void) {
+    printf("ADAPT=%s\n", sensor_pipeline_adaptive_enabled() ? "ON" : "OFF");
+    if (sensor_pipeline_fixed_period()) {
+        printf("RATE=%lums (periodo fixo, adaptacao suspensa)\n", (unsigned long)sensor_pipeline_fixed_period());
+    }
+    if (!uart_scheduler) return;
+
+    for (size_t i = 0; i < uart_scheduler->count; i++) {
+        adaptive_stats_t stats;
+        taskENTER_CRITICAL();
+        bool ok = sensor_pipeline_get_adaptive_stats(i, &stats);
+        uint32_t period_ms = uart_scheduler->entries[i].period_ms;
+        taskEXIT_CRITICAL();
+        if (!ok) continue;
+
+        printf("ADAPT %s periodo=%lums amostras=%lu subidas=%lu reducoes=%lu\n",
+               uart_scheduler->entries[i].name ? uart_scheduler->entries[i].name : "?",
+               (unsigned long)period_ms,
+               (unsigned long)stats.samples,
+               (unsigned long)stats.triggers,
+               (unsigned long)stats.slowdowns);
+    }
+}
+
+// Formata centésimos em buf e devolve buf, para uso direto no printf
+static const char *uart_centi(char buf[SENSOR_UNITS_STR_MAX], int32_t centi, unsigned decimals) {
+    sensor_units_format(buf, SENSOR_UNITS_STR_MAX, centi, decimals);
+    return buf;
+}
+
+static void uart_print_stats(void) {
+    static const char *const labels[TS_METRIC_COUNT] = { "TEMP", "HUM", "LUX" };
+    sensor_stats_t stats;
+    sensor_data_get_stats(&stats);
+
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        for (int w = 0; w < SENSOR_STATS_WINDOW_COUNT; w++) {
+            const rolling_result_t *r = &stats.metric[m][w];
+            if (r->count == 0) continue;
+            char mean[SENSOR_UNITS_STR_MAX], min[SENSOR_UNITS_STR_MAX];
+            char max[SENSOR_UNITS_STR_MAX], dev[SENSOR_UNITS_STR_MAX];
+            int32_t stddev = (int32_t)sensor_units_isqrt((uint64_t)r->variance);
+            printf("  %-4s %4lus: media=%s min=%s max=%s desvio=%s n=%lu\n",
+                   labels[m],
+                   (unsigned long)stats.window_s[w],
+                   uart_centi(mean, r->mean, 2),
+                   uart_centi(min, r->min, 2),
+                   uart_centi(max, r->max, 2),
+                   uart_centi(dev, stddev, 2),
+                   (unsigned long)r->count);
+        }
+    }
+}
+
+static void uart_print_history(void) {
+    // Estático: 16 amostras não cabem junto dos printf na pilha da task
+    static sensor_sample_t samples[UART_HISTORY_BATCH];
+    uint32_t lost = 0;
+    size_t count = sensor_data_history_read(&uart_history_cursor, samples, UART_HISTORY_BATCH, &lost);
+
+    for (size_t i = 0; i < count; i++) {
+        char temp[SENSOR_UNITS_STR_MAX], hum[SENSOR_UNITS_STR_MAX], lux[SENSOR_UNITS_STR_MAX];
+        printf("#%lu t=%lums TEMP=%sC HUM=%s%% LUX=%s LED=%s\n",
+               (unsigned long)samples[i].seq,
+               (unsigned long)samples[i].timestamp_ms,
+               uart_centi(temp, samples[i].data.temperature_centi, 1),
+               uart_centi(hum, samples[i].data.humidity_centi, 1),
+               uart_centi(lux, samples[i].data.luminosity_centi, 1),
+               samples[i].data.led_matrix_enabled ? "ON" : "OFF");
+    }
+
+    uint32_t pending = sensor_data_history_head() - uart_history_cursor;
+    printf("HIST lidas=%lu perdidas=%lu pendentes=%lu\n",
+           (unsigned long)count, (unsigned long)lost, (unsigned long)pending);
+}
+
+static void uart_print_timeseries(const char *args) {
+    char res_name[8];
+    unsigned int n = 8;
+    ts_resolution_t res;
+
+    if (sscanf(args, "%7s %u", res_name, &n) < 1 || !timeseries_parse_resolution(res_name, &res)) {
+        printf("Uso: TS raw|1s|1min|1h [n]\n");
+        return;
+    }
+    if (n == 0 || n > UART_TS_MAX_POINTS) n = UART_TS_MAX_POINTS;
+
+    static ts_point_t points[UART_TS_MAX_POINTS];    // ~900 bytes: fora da pilha, idem
+    size_t count = timeseries_latest(res, points, n);
+    for (size_t i = 0; i < count; i++) {
+        const ts_point_t *pt = &points[i];
+        printf("t=%llums", (unsigned long long)pt->t_ms);
+        static const char *const labels[TS_METRIC_COUNT] = { "TEMP", "HUM", "LUX" };
+        for (int m = 0; m < TS_METRIC_COUNT; m++) {
+            if (!(pt->valid_mask & (1u << m))) continue;
+            char min[SENSOR_UNITS_STR_MAX], mean[SENSOR_UNITS_STR_MAX], max[SENSOR_UNITS_STR_MAX];
+            printf(" %s=%s/%s/%s", labels[m],
+                   uart_centi(min, pt->min[m], 2),
+                   uart_centi(mean, pt->mean[m], 2),
+                   uart_centi(max, pt->max[m], 2));
+        }
+        printf("\n");
+    }
+    printf("TS %s pontos=%lu/%lu (min/media/max) ram=%lu bytes\n",
+           timeseries_resolution_name(res),
+           (unsigned long)count,
+           (unsigned long)timeseries_count(res),
+           (unsigned long)timeseries_memory_bytes());
+}
+
+static void uart_print_log(const char *args) {
+    unsigned int n = 8;
+    sscanf(args, "%u", &n);
+    if (n == 0 || n > UART_LOG_MAX_ENTRIES) n = UART_LOG_MAX_ENTRIES;
+
+    sample_log_stats_t stats;
+    uint16_t boot_id = 0;
+    if (!task_storage_get_stats(&stats, &boot_id)) {
+        printf("LOG indisponivel\n");
+        return;
+    }
+
+    static sample_log_entry_t entries[UART_LOG_MAX_ENTRIES];
+    size_t count = task_storage_latest(entries, n);
+    for (size_t i = 0; i < count; i++) {
+        const sample_log_entry_t *e = &entries[i];
+        printf("boot=%u t=%lus", e->boot_id, (unsigned long)(e->t_ms / 1000));
+        char a[SENSOR_UNITS_STR_MAX], b[SENSOR_UNITS_STR_MAX];
+        if (e->temp_humidity_valid) {
+            printf(" TEMP=%sC HUM=%s%%",
+                   uart_centi(a, e->temperature_centi, 2),
+                   uart_centi(b, e->humidity_centi, 2));
+        }
+        if (e->luminosity_valid) {
+            printf(" LUX=%s", uart_centi(a, (int32_t)e->luminosity_centi, 2));
+        }
+        printf("\n");
+    }
+    printf("LOG boot=%u amostras=%lu paginas=%lu setores_apagados=%lu corrompidas=%lu erros=%lu\n",
+           boot_id,
+           (unsigned long)stats.entries_appended,
+           (unsigned long)stats.pages_written,
+           (unsigned long)stats.sectors_erased,
+           (unsigned long)stats.pages_corrupt,
+           (unsigned long)stats.write_errors);
+}
+
+static void uart_print_events(void) {
+    for (int i = 0; i < SENSOR_MAX_SUBSCRIBERS; i++) {
+        sensor_subscriber_stats_t stats;
+        const char *name;
+        if (!sensor_data_get_subscriber_stats(i, &stats, &name)) continue;
+        printf("%-8s commits=%lu wakeups=%lu suprimidos=%lu\n",
+               name,
+               (unsigned long)stats.commits,
+               (unsigned long)stats.wakeups,
+               (unsigned long)stats.suppressed);
+    }
+    printf("web      req=%lu conexoes=%lu abertas=%lu /data_304=%lu\n",
+           (unsigned long)web_server_get_request_count(),
+           (unsigned long)web_server_get_connection_count(),
+           (unsigned long)web_server_get_active_connections(),
+           (unsigned long)web_server_get_not_modified_count());
+    printf("pool     pico=%lu/%d recusadas=%lu respostas=%lu/%d esperas=%lu\n",
+           (unsigned long)web_server_get_peak_connections(), WEB_SERVER_MAX_CONNECTIONS,
+           (unsigned long)web_server_get_refused_count(),
+           (unsigned long)web_server_get_pending_responses(), WEB_SERVER_RESPONSE_BUFFERS,
+           (unsigned long)web_server_get_deferred_count());
+    printf("sse      inscritos=%lu eventos=%lu descartados=%lu\n",
+           (unsigned long)web_server_get_sse_clients(),
+           (unsigned long)web_server_get_sse_event_count(),
+           (unsigned long)web_server_get_sse_dropped_count());
+    printf("ws       clientes=%lu comandos=%lu descartados=%lu\n",
+           (unsigned long)web_server_get_ws_clients(),
+           (unsigned long)web_server_get_ws_command_count(),
+           (unsigned long)web_server_get_ws_dropped_count());
+}
+
+static void uart_print_anomalies(void) {
+    static const char *const labels[TS_METRIC_COUNT] = { "TEMP", "HUM", "LUX" };
+    if (!uart_detector) {
+        printf("ANOMALY indisponivel\n");
+        return;
+    }
+
+    sensor_data_t data = sensor_data_get();
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        anomaly_stats_t stats;
+        if (!anomaly_detector_get_stats(uart_detector, (ts_metric_t)m, &stats)) continue;
+        printf("ANOMALY %-4s amostras=%lu zscore=%lu taxa=%lu rejeitadas=%lu patamares=%lu ultima=0x%02x\n",
+               labels[m],
+               (unsigned long)stats.samples,
+               (unsigned long)stats.flagged_zscore,
+               (unsigned long)stats.flagged_rate,
+               (unsigned long)stats.rejected,
+               (unsigned long)stats.rebaselines,
+               data.anomaly_flags[m]);
+    }
+}
+
+// Esvazia a fila de quadros gravados (linhas "TRC ...")
+static void uart_flush_trace(void) {
+    sensor_trace_frame_t frames[UART_TRACE_BATCH];
+    size_t count = sensor_trace_drain(frames, UART_TRACE_BATCH);
+    for (size_t i = 0; i < count; i++) {
+        char line[SENSOR_TRACE_LINE_MAX];
+        sensor_trace_format(&frames[i], line, sizeof(line));
+        printf("%s\n", line);
+    }
+    if (count > 0) {
+        fflush(stdout);
+    }
+}
+
+static void uart_print_i2c_stats(void) {
+    i2c_inst_t *buses[2] = { i2c0, i2c1 };
+    for (int i = 0; i < 2; i++) {
+        i2c_async_stats_t stats;
+        if (!i2c_async_get_stats(buses[i], &stats)) {
+            printf("I2C%d DMA=OFF\n", i);
+            continue;
+        }
+        printf("I2C%d DMA=ON tx=%lu ok=%lu erros=%lu timeouts=%lu fila_cheia=%lu fila_max=%lu bloqueantes=%lu\n",
+               i,
+               (unsigned long)stats.submitted,
+               (unsigned long)stats.completed,
+               (unsigned long)stats.errors,
+               (unsigned long)stats.timeouts,
+               (unsigned long)stats.queue_full,
+               (unsigned long)stats.max_depth,
+               (unsigned long)stats.fallback_blocking);
+    }
+}
+
+static void uart_handle_command(const char *cmd_line, const app_context_t *ctx) {
     if (!cmd_line || cmd_line[0] == '\0') return;
 
     char cmd[UART_CMD_MAX];
@@ -72,11 +420,112 @@ static void uart_handle_command(const char *cmd_line,
 
     if (str_equals_ignore_case(p, "STATUS")) {
         sensor_data_t data = sensor_data_get();
-        printf("TEMP=%.1fC HUM=%.1f%% LUX=%.1f LED=%s\n",
-               data.temperature_c,
-               data.humidity_percent,
-               data.luminosity_lux,
+        char temp[SENSOR_UNITS_STR_MAX], hum[SENSOR_UNITS_STR_MAX], lux[SENSOR_UNITS_STR_MAX];
+        printf("TEMP=%sC HUM=%s%% LUX=%s LED=%s\n",
+               uart_centi(temp, data.temperature_centi, 1),
+               uart_centi(hum, data.humidity_centi, 1),
+               uart_centi(lux, data.luminosity_centi, 1),
                data.led_matrix_enabled ? "ON" : "OFF");
+        if (data.temp_humidity_valid) {
+            char dew[SENSOR_UNITS_STR_MAX], abs_hum[SENSOR_UNITS_STR_MAX], heat[SENSOR_UNITS_STR_MAX];
+            printf("ORVALHO=%sC UMID_ABS=%sg/m3 IND_CALOR=%sC\n",
+                   uart_centi(dew, data.comfort.dew_point_centi, 1),
+                   uart_centi(abs_hum, data.comfort.abs_humidity_centi, 1),
+                   uart_centi(heat, data.comfort.heat_index_centi, 1));
+        }
+        uart_print_stats();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "SCHED")) {
+        uart_print_schedule();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "HEALTH")) {
+        uart_print_health();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "METRICS")) {
+        uart_print_metrics();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "ADAPT")) {
+        uart_print_adaptive();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_starts_with_ignore_case(p, "ADAPT ")) {
+        const char *arg = p + 6;
+        while (*arg == ' ' || *arg == '\t') arg++;
+        if (str_equals_ignore_case(arg, "ON")) {
+            sensor_pipeline_set_adaptive(true);
+            printf("ADAPT=ON\n");
+        } else if (str_equals_ignore_case(arg, "OFF")) {
+            sensor_pipeline_set_adaptive(false);
+            printf("ADAPT=OFF\n");
+        } else {
+            printf("Uso: ADAPT [ON|OFF]\n");
+        }
+        fflush(stdout);
+        return;
+    }
+
+    if (str_starts_with_ignore_case(p, "RATE ")) {
+        uint32_t period_ms;
+        if (app_control_parse_rate(p + 5, &period_ms)) {
+            sensor_pipeline_set_fixed_period(period_ms);
+            if (period_ms) {
+                printf("RATE=%lums\n", (unsigned long)period_ms);
+            } else {
+                printf("RATE=AUTO\n");
+            }
+        } else {
+            printf("Uso: RATE <1-%d ms>|AUTO\n", APP_CONTROL_RATE_MAX_MS);
+        }
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "HIST")) {
+        uart_print_history();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "I2C")) {
+        uart_print_i2c_stats();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "LOG") || str_starts_with_ignore_case(p, "LOG ")) {
+        uart_print_log(p + 3);
+        fflush(stdout);
+        return;
+    }
+
+    if (str_starts_with_ignore_case(p, "TS ")) {
+        uart_print_timeseries(p + 3);
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "EVENTS")) {
+        uart_print_events();
+        fflush(stdout);
+        return;
+    }
+
+    if (str_equals_ignore_case(p, "ANOMALY")) {
+        uart_print_anomalies();
         fflush(stdout);
         return;
     }
@@ -93,13 +542,10 @@ static void uart_handle_command(const char *cmd_line,
         const char *arg = p + 4;
         while (*arg == ' ' || *arg == '\t') arg++;
         if (str_equals_ignore_case(arg, "ON")) {
-            *led_enabled = true;
-            sensor_data_set_led_state(true, LED_INTENSITY_LOW);
+            app_control_set_led(ctx, true);
             printf("LED=ON\n");
         } else if (str_equals_ignore_case(arg, "OFF")) {
-            *led_enabled = false;
-            led_matrix_clear(led_matrix);
-            sensor_data_set_led_state(false, LED_INTENSITY_OFF);
+            app_control_set_led(ctx, false);
             printf("LED=OFF\n");
         } else {
             printf("Uso: LED ON|OFF\n");
@@ -108,6 +554,23 @@ static void uart_handle_command(const char *cmd_line,
         return;
     }
 
+    if (str_starts_with_ignore_case(p, "TRACE ")) {
+        const char *arg = p + 6;
+        while (*arg == ' ' || *arg == '\t') arg++;
+        if (str_equals_ignore_case(arg, "ON")) {
+            sensor_trace_set_enabled(true);
+            printf("TRACE=ON\n");
+        } else if (str_equals_ignore_case(arg, "OFF")) {
+            uint32_t dropped = sensor_trace_dropped();
+            sensor_trace_set_enabled(false);
+            printf("TRACE=OFF descartados=%lu\n", (unsigned long)dropped);
+        } else {
+            printf("Uso: TRACE ON|OFF\n");
+        }
+        fflush(stdout);
+        return;
+    }
+
     if (str_equals_ignore_case(p, "LOGIN RESET")) {
         auth_reset_credentials();
         printf("LOGIN=RESET\n");
@@ -138,13 +601,13 @@ static void uart_handle_command(const char *cmd_line,
     fflush(stdout);
 }
 
-static void uart_poll(led_matrix_t *led_matrix, volatile bool *led_enabled) {
+static void uart_poll(const app_context_t *ctx) {
     int ch = getchar_timeout_us(0);
     while (ch != PICO_ERROR_TIMEOUT) {
         if (ch == '\r' || ch == '\n') {
             if (uart_cmd_len > 0) {
                 uart_cmd_buffer[uart_cmd_len] = '\0';
-                uart_handle_command(uart_cmd_buffer, led_matrix, led_enabled);
+                uart_handle_command(uart_cmd_buffer, ctx);
                 uart_cmd_len = 0;
             }
         } else if (ch == 8 || ch == 127) {
@@ -167,10 +630,13 @@ void task_uart(void *param) {
         vTaskDelete(NULL);
     }
 
+    uart_scheduler = params->scheduler;
+    uart_detector = params->detector;
     uart_print_help();
 
     while (true) {
-        uart_poll(ctx->led_matrix, ctx->led_matrix_enabled);
+        uart_poll(ctx);
+        uart_flush_trace();
         vTaskDelay(pdMS_TO_TICKS(20));
     }
 }
@@ -1,13 +1,23 @@
 #include "rtos_tasks.h"
 
+#include "app_control.h"
 #include "wifi_manager.h"
 #include "web_server.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
 
+static const app_context_t *web_ctx = NULL;
+
+// Comandos de /ws: rodam aqui, em web_server_poll()
+static bool web_control(const char *command) {
+    return web_ctx && app_control_execute(web_ctx, command);
+}
+
 void task_web(void *param) {
-    (void)param;
+    const rtos_task_params_t *params = (const rtos_task_params_t *)param;
+    web_ctx = params ? params->ctx : NULL;
+    web_server_set_control_handler(web_control);
 
     while (true) {
         wifi_manager_poll();
@@ -0,0 +1,296 @@
+#include "sample_log.h"
+
+#include <string.h>
+
+// Cabeçalho da página (little-endian):
+//   0 magic u16 | 2 formato u8 | 3 amostras u8 | 4 sequência u32
+//   8 boot u16  | 10 bytes de payload u16 | 12 CRC-32 (bytes 0..11 + payload)
+#define PAGE_MAGIC        0x4C53u   // "SL"
+#define PAGE_FORMAT_CODEC 2u        // Bloco series_codec (único formato aceito)
+
+// ============= CODIFICAÇÃO =============
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static void entry_to_sample(const sample_log_entry_t *e, series_sample_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->t_ms = e->t_ms;
+    if (e->temp_humidity_valid) {
+        s->valid_mask |= (1u << TS_METRIC_TEMPERATURE) | (1u << TS_METRIC_HUMIDITY);
+        s->value[TS_METRIC_TEMPERATURE] = e->temperature_centi;
+        s->value[TS_METRIC_HUMIDITY] = e->humidity_centi;
+    }
+    if (e->luminosity_valid) {
+        s->valid_mask |= (1u << TS_METRIC_LUX);
+        s->value[TS_METRIC_LUX] = (int32_t)e->luminosity_centi;
+    }
+}
+
+static void sample_to_entry(const series_sample_t *s, uint16_t boot_id, sample_log_entry_t *e) {
+    e->boot_id = boot_id;
+    e->t_ms = s->t_ms;
+    e->temp_humidity_valid = (s->valid_mask & (1u << TS_METRIC_TEMPERATURE)) != 0;
+    e->temperature_centi = (int16_t)s->value[TS_METRIC_TEMPERATURE];
+    e->humidity_centi = (uint16_t)s->value[TS_METRIC_HUMIDITY];
+    e->luminosity_valid = (s->valid_mask & (1u << TS_METRIC_LUX)) != 0;
+    e->luminosity_centi = (uint32_t)s->value[TS_METRIC_LUX];
+}
+
+// ============= PÁGINAS =============
+
+typedef struct {
+    uint8_t count;
+    uint32_t seq;
+    uint16_t boot_id;
+    uint16_t payload_len;
+} page_info_t;
+
+static bool all_erased(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (data[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+// Valida uma página completa já lida
+static bool page_parse(const uint8_t *page, page_info_t *info) {
+    uint16_t payload_len = get_u16(page + 10);
+    if (get_u16(page) != PAGE_MAGIC || page[2] != PAGE_FORMAT_CODEC || payload_len > SAMPLE_LOG_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    uint32_t crc = crc32_update(0, page, 12);
+    crc = crc32_update(crc, page + SAMPLE_LOG_HEADER_SIZE, payload_len);
+    if (crc != get_u32(page + 12)) return false;
+
+    info->count = page[3];
+    info->seq = get_u32(page + 4);
+    info->boot_id = get_u16(page + 8);
+    info->payload_len = payload_len;
+    return true;
+}
+
+// Copia as `need` amostras mais novas da página para out, da mais nova
+// para a mais antiga (o bloco comprimido só é lido do início ao fim)
+static size_t page_latest(const uint8_t *payload, const page_info_t *info,
+                          sample_log_entry_t *out, size_t need) {
+    size_t take = info->count < need ? info->count : need;
+    size_t skip = info->count - take;
+
+    series_decoder_t dec;
+    series_sample_t sample;
+    series_decoder_init(&dec, payload, info->payload_len, info->count);
+    for (size_t i = 0; i < info->count; i++) {
+        if (!series_decoder_next(&dec, &sample)) return 0;
+        if (i >= skip) {
+            sample_to_entry(&sample, info->boot_id, &out[info->count - 1 - i]);
+        }
+    }
+    return take;
+}
+
+static bool read_page(sample_log_t *log, uint32_t offset, uint8_t *page) {
+    log->stats.recovery_pages_read++;
+    return log->flash->read(log->flash->ctx, offset, page, SAMPLE_LOG_PAGE_SIZE);
+}
+
+static bool write_page(sample_log_t *log) {
+    const sample_log_flash_t *flash = log->flash;
+
+    // Setor novo: apaga antes de gravar a primeira página (descarta o mais antigo)
+    if (log->head % SAMPLE_LOG_SECTOR_SIZE == 0) {
+        if (!flash->erase(flash->ctx, log->head, SAMPLE_LOG_SECTOR_SIZE)) {
+            // Descarta o lote; o próximo tenta apagar o mesmo setor de novo
+            series_encoder_init(&log->enc, log->page + SAMPLE_LOG_HEADER_SIZE, SAMPLE_LOG_PAYLOAD_SIZE);
+            log->stats.write_errors++;
+            return false;
+        }
+        log->stats.sectors_erased++;
+    }
+
+    uint16_t payload_len = (uint16_t)series_encoder_bytes(&log->enc);
+    uint8_t *page = log->page;
+    put_u16(page, PAGE_MAGIC);
+    page[2] = PAGE_FORMAT_CODEC;
+    page[3] = (uint8_t)log->enc.count;
+    put_u32(page + 4, log->next_seq);
+    put_u16(page + 8, log->boot_id);
+    put_u16(page + 10, payload_len);
+    uint32_t crc = crc32_update(0, page, 12);
+    crc = crc32_update(crc, page + SAMPLE_LOG_HEADER_SIZE, payload_len);
+    put_u32(page + 12, crc);
+    memset(page + SAMPLE_LOG_HEADER_SIZE + payload_len, 0xFF,
+           SAMPLE_LOG_PAGE_SIZE - SAMPLE_LOG_HEADER_SIZE - payload_len);
+
+    bool ok = flash->program(flash->ctx, log->head, page, SAMPLE_LOG_PAGE_SIZE);
+
+    // Mesmo com erro a página fica consumida: NOR não regrava sem apagar
+    log->head = (log->head + SAMPLE_LOG_PAGE_SIZE) % flash->size;
+    log->next_seq++;
+    series_encoder_init(&log->enc, log->page + SAMPLE_LOG_HEADER_SIZE, SAMPLE_LOG_PAYLOAD_SIZE);
+
+    if (!ok) {
+        log->stats.write_errors++;
+        return false;
+    }
+    log->stats.pages_written++;
+    return true;
+}
+
+// ============= API =============
+
+bool sample_log_init(sample_log_t *log, const sample_log_flash_t *flash) {
+    if (!log || !flash || !flash->read || !flash->program || !flash->erase) return false;
+    if (flash->size < 2 * SAMPLE_LOG_SECTOR_SIZE || flash->size % SAMPLE_LOG_SECTOR_SIZE != 0) return false;
+
+    memset(log, 0, sizeof(*log));
+    log->flash = flash;
+    series_encoder_init(&log->enc, log->page + SAMPLE_LOG_HEADER_SIZE, SAMPLE_LOG_PAYLOAD_SIZE);
+
+    uint32_t sectors = flash->size / SAMPLE_LOG_SECTOR_SIZE;
+    uint8_t page[SAMPLE_LOG_PAGE_SIZE];
+    page_info_t info;
+
+    // 1) Setor mais novo: maior sequência na primeira página
+    bool found = false;
+    uint32_t newest_sector = 0;
+    page_info_t newest = { 0 };
+    for (uint32_t s = 0; s < sectors; s++) {
+        if (!read_page(log, s * SAMPLE_LOG_SECTOR_SIZE, page)) continue;
+        if (!page_parse(page, &info)) continue;
+        if (!found || info.seq > newest.seq) {
+            found = true;
+            newest_sector = s;
+            newest = info;
+        }
+    }
+
+    if (!found) {
+        // Log vazio (ou ilegível): começa do início
+        log->head = 0;
+        log->next_seq = 1;
+        log->boot_id = 1;
+        return true;
+    }
+
+    // 2) Dentro do setor: primeira página apagada é o ponto de escrita
+    uint32_t base = newest_sector * SAMPLE_LOG_SECTOR_SIZE;
+    uint32_t last_seq = newest.seq;
+    uint16_t last_boot = newest.boot_id;
+    uint32_t head_page = SAMPLE_LOG_PAGES_PER_SECTOR;
+
+    for (uint32_t p = 1; p < SAMPLE_LOG_PAGES_PER_SECTOR; p++) {
+        if (!read_page(log, base + p * SAMPLE_LOG_PAGE_SIZE, page)) break;
+        if (all_erased(page, SAMPLE_LOG_PAGE_SIZE)) {
+            head_page = p;
+            break;
+        }
+        if (page_parse(page, &info)) {
+            if (info.seq > last_seq) {
+                last_seq = info.seq;
+                last_boot = info.boot_id;
+            }
+        } else {
+            log->stats.pages_corrupt++;
+        }
+    }
+
+    // O resto do setor precisa estar apagado; senão (apagamento
+    // interrompido) continua no próximo setor, que será apagado antes
+    for (uint32_t p = head_page + 1; p < SAMPLE_LOG_PAGES_PER_SECTOR; p++) {
+        if (!read_page(log, base + p * SAMPLE_LOG_PAGE_SIZE, page) || !all_erased(page, SAMPLE_LOG_PAGE_SIZE)) {
+            head_page = SAMPLE_LOG_PAGES_PER_SECTOR;
+            break;
+        }
+    }
+
+    log->head = (base + head_page * SAMPLE_LOG_PAGE_SIZE) % flash->size;
+    log->next_seq = last_seq + 1;
+    log->boot_id = (uint16_t)(last_boot + 1);
+    return true;
+}
+
+bool sample_log_append(sample_log_t *log, const sample_log_entry_t *entry) {
+    if (!log || !log->flash || !entry) return false;
+
+    series_sample_t sample;
+    entry_to_sample(entry, &sample);
+    log->stats.entries_appended++;
+
+    if (log->enc.count < SAMPLE_LOG_PAGE_MAX_ENTRIES && series_encoder_add(&log->enc, &sample)) {
+        return true;
+    }
+
+    // Página cheia: grava e começa outra com esta amostra
+    bool ok = write_page(log);
+    series_encoder_add(&log->enc, &sample);
+    return ok;
+}
+
+size_t sample_log_latest(sample_log_t *log, sample_log_entry_t *out, size_t max_entries) {
+    if (!log || !log->flash || !out || max_entries == 0) return 0;
+
+    // Amostras ainda em RAM (mais novas primeiro)
+    page_info_t info = {
+        .count = (uint8_t)log->enc.count,
+        .boot_id = log->boot_id,
+        .payload_len = (uint16_t)series_encoder_bytes(&log->enc),
+    };
+    size_t n = page_latest(log->page + SAMPLE_LOG_HEADER_SIZE, &info, out, max_entries);
+
+    // Páginas gravadas, voltando a partir do ponto de escrita
+    uint8_t page[SAMPLE_LOG_PAGE_SIZE];
+    uint32_t offset = log->head;
+    uint32_t newer_seq = log->next_seq;
+    uint32_t pages = log->flash->size / SAMPLE_LOG_PAGE_SIZE;
+
+    for (uint32_t k = 0; k < pages && n < max_entries; k++) {
+        offset = (offset + log->flash->size - SAMPLE_LOG_PAGE_SIZE) % log->flash->size;
+
+        if (!log->flash->read(log->flash->ctx, offset, page, SAMPLE_LOG_PAGE_SIZE)) break;
+        if (all_erased(page, SAMPLE_LOG_PAGE_SIZE)) break;
+
+        if (!page_parse(page, &info)) {
+            continue;   // Página perdida em um corte de energia
+        }
+        if (info.seq >= newer_seq) break;      // Sequência deve decrescer até o mais antigo
+        newer_seq = info.seq;
+
+        n += page_latest(page + SAMPLE_LOG_HEADER_SIZE, &info, out + n, max_entries - n);
+    }
+
+    // Devolve em ordem cronológica
+    for (size_t i = 0; i < n / 2; i++) {
+        sample_log_entry_t tmp = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = tmp;
+    }
+    return n;
+}
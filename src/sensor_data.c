@@ -1,14 +1,55 @@
 #include "sensor_data.h"
 #include "pico/stdlib.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/critical_section.h"
+
 #ifdef USE_FREERTOS
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 #endif
 
 // Dados globais dos sensores (acesso interno)
 static sensor_data_t g_sensor_data;
 
+// Histórico circular: um produtor por vez (serializado pelo mutex dos
+// escritores) e vários leitores sem lock. O slot mais recente também é o
+// snapshot lido por sensor_data_get(). Cada slot guarda a sequência da
+// amostra que contém; o valor 0 marca um slot em reescrita.
+typedef struct {
+    volatile uint32_t seq;
+    sensor_sample_t sample;
+} history_slot_t;
+
+static history_slot_t g_history[SENSOR_HISTORY_LEN];
+static volatile uint32_t g_history_head = 0;
+
+// Inscritos para notificação de mudanças
+typedef struct {
+    bool active;
+    const char *name;
+#ifdef USE_FREERTOS
+    TaskHandle_t task;
+#endif
+    uint32_t field_mask;
+    sensor_deadband_t deadband;
+    sensor_data_t last_notified;   // Valores na última notificação enviada
+    bool has_last;
+    sensor_subscriber_stats_t stats;
+} subscriber_t;
+
+static subscriber_t g_subscribers[SENSOR_MAX_SUBSCRIBERS];
+
+// Estatísticas deslizantes: janelas atualizadas pelo commit (com o
+// mutex) e resultado publicado sob critical section para leitores
+static const uint32_t g_stats_windows_s[SENSOR_STATS_WINDOW_COUNT] = SENSOR_STATS_WINDOWS_S;
+static rolling_window_t g_stats_windows[TS_METRIC_COUNT][SENSOR_STATS_WINDOW_COUNT];
+static sensor_stats_t g_stats;
+static critical_section_t g_stats_lock;
+
 #ifdef USE_FREERTOS
 static SemaphoreHandle_t g_sensor_mutex = NULL;
 
@@ -27,71 +68,405 @@ static void sensor_unlock(void) {
 void sensor_data_set_mutex(SemaphoreHandle_t mutex) {
     g_sensor_mutex = mutex;
 }
+
+int sensor_data_subscribe(TaskHandle_t task, const char *name, uint32_t field_mask, const sensor_deadband_t *deadband) {
+    if (!task || field_mask == 0) return -1;
+
+    int id = -1;
+    sensor_lock();
+    for (int i = 0; i < SENSOR_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &g_subscribers[i];
+        if (sub->active) continue;
+
+        memset(sub, 0, sizeof(*sub));
+        sub->task = task;
+        sub->name = name;
+        sub->field_mask = field_mask;
+        if (deadband) {
+            sub->deadband = *deadband;
+        }
+        sub->active = true;
+        id = i;
+        break;
+    }
+    sensor_unlock();
+    return id;
+}
 #else
 static void sensor_lock(void) { }
 static void sensor_unlock(void) { }
 #endif
 
+// Publica a cópia atual no histórico (chamado com o mutex tomado)
+static void history_push(void) {
+    uint32_t seq = g_history_head + 1;
+    if (seq == 0) seq = 1;  // 0 é reservado para "slot vazio"
+    history_slot_t *slot = &g_history[seq % SENSOR_HISTORY_LEN];
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    // A versão do snapshot é a própria sequência da publicação
+    g_sensor_data.version = seq;
+    slot->sample.seq = seq;
+    slot->sample.timestamp_ms = g_sensor_data.last_update_ms;
+    slot->sample.data = g_sensor_data;
+
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_history_head, seq, __ATOMIC_RELEASE);
+}
+
+// Copia uma amostra; falha se o slot foi (ou está sendo) sobrescrito
+static bool history_copy(uint32_t seq, sensor_sample_t *out) {
+    const history_slot_t *slot = &g_history[seq % SENSOR_HISTORY_LEN];
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+        return false;
+    }
+    *out = slot->sample;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq;
+}
+
 void sensor_data_init(void) {
     sensor_lock();
-    g_sensor_data.luminosity_lux = 0.0f;
+    g_sensor_data.luminosity_centi = 0;
     g_sensor_data.luminosity_valid = false;
     
-    g_sensor_data.temperature_c = 0.0f;
-    g_sensor_data.humidity_percent = 0.0f;
+    g_sensor_data.temperature_centi = 0;
+    g_sensor_data.humidity_centi = 0;
     g_sensor_data.temp_humidity_valid = false;
+    memset(&g_sensor_data.comfort, 0, sizeof(g_sensor_data.comfort));
+    memset(g_sensor_data.anomaly_flags, 0, sizeof(g_sensor_data.anomaly_flags));
     
     g_sensor_data.led_matrix_enabled = true;
     g_sensor_data.led_intensity = LED_INTENSITY_OFF;
     
     g_sensor_data.last_update_ms = 0;
-    sensor_unlock();
-}
+    g_sensor_data.luminosity_update_ms = 0;
+    g_sensor_data.temp_humidity_update_ms = 0;
+    g_sensor_data.led_update_ms = 0;
+    g_sensor_data.luminosity_capture_us = 0;
+    g_sensor_data.temp_humidity_capture_us = 0;
+    g_sensor_data.changed_fields = 0;
 
-void sensor_data_update(const sensor_data_t *data) {
-    if (data == NULL) return;
-    
-    sensor_lock();
-    g_sensor_data.luminosity_lux = data->luminosity_lux;
-    g_sensor_data.luminosity_valid = data->luminosity_valid;
-    g_sensor_data.temperature_c = data->temperature_c;
-    g_sensor_data.humidity_percent = data->humidity_percent;
-    g_sensor_data.temp_humidity_valid = data->temp_humidity_valid;
-    g_sensor_data.led_matrix_enabled = data->led_matrix_enabled;
-    g_sensor_data.led_intensity = data->led_intensity;
-    g_sensor_data.last_update_ms = to_ms_since_boot(get_absolute_time());
+    for (size_t i = 0; i < SENSOR_HISTORY_LEN; i++) {
+        g_history[i].seq = 0;
+    }
+    g_history_head = 0;
+    history_push();
+
+    if (!critical_section_is_initialized(&g_stats_lock)) {
+        critical_section_init(&g_stats_lock);
+    }
+    memset(&g_stats, 0, sizeof(g_stats));
+    for (int w = 0; w < SENSOR_STATS_WINDOW_COUNT; w++) {
+        g_stats.window_s[w] = g_stats_windows_s[w];
+        for (int m = 0; m < TS_METRIC_COUNT; m++) {
+            rolling_window_init(&g_stats_windows[m][w], g_stats_windows_s[w] * 1000u);
+        }
+    }
     sensor_unlock();
 }
 
 sensor_data_t sensor_data_get(void) {
-    sensor_data_t copy;
-    sensor_lock();
-    copy = g_sensor_data;
-    sensor_unlock();
-    return copy;
+    // A amostra mais recente do histórico é o snapshot publicado: o
+    // escritor sempre prepara o próximo slot, nunca o que está sendo lido.
+    // Só há nova tentativa se o slot for reciclado durante a cópia.
+    sensor_sample_t sample;
+    for (;;) {
+        uint32_t head = sensor_data_history_head();
+        if (head == 0) {
+            sensor_data_t empty = {0};
+            return empty;
+        }
+        if (history_copy(head, &sample)) {
+            return sample.data;
+        }
+    }
 }
 
-void sensor_data_set_luminosity(float lux, bool valid) {
-    sensor_lock();
-    g_sensor_data.luminosity_lux = lux;
-    g_sensor_data.luminosity_valid = valid;
-    g_sensor_data.last_update_ms = to_ms_since_boot(get_absolute_time());
-    sensor_unlock();
+void sensor_data_begin(sensor_txn_t *txn) {
+    if (!txn) return;
+    txn->dirty = 0;
+    txn->now_ms = to_ms_since_boot(get_absolute_time());
 }
 
-void sensor_data_set_temp_humidity(float temp, float humidity, bool valid) {
-    sensor_lock();
-    g_sensor_data.temperature_c = temp;
-    g_sensor_data.humidity_percent = humidity;
-    g_sensor_data.temp_humidity_valid = valid;
-    g_sensor_data.last_update_ms = to_ms_since_boot(get_absolute_time());
-    sensor_unlock();
+void sensor_txn_set_luminosity(sensor_txn_t *txn, int32_t lux_centi, bool valid) {
+    txn->staged.luminosity_centi = lux_centi;
+    txn->staged.luminosity_valid = valid;
+    txn->staged.luminosity_capture_us = (uint64_t)txn->now_ms * 1000u;
+    txn->staged.anomaly_flags[TS_METRIC_LUX] = 0;
+    txn->dirty |= SENSOR_FIELD_LUMINOSITY;
+}
+
+void sensor_txn_set_temp_humidity(sensor_txn_t *txn, int32_t temp_centi, int32_t humidity_centi, bool valid) {
+    txn->staged.temperature_centi = temp_centi;
+    txn->staged.humidity_centi = humidity_centi;
+    txn->staged.temp_humidity_valid = valid;
+    memset(&txn->staged.comfort, 0, sizeof(txn->staged.comfort));
+    txn->staged.temp_humidity_capture_us = (uint64_t)txn->now_ms * 1000u;
+    txn->staged.anomaly_flags[TS_METRIC_TEMPERATURE] = 0;
+    txn->staged.anomaly_flags[TS_METRIC_HUMIDITY] = 0;
+    txn->dirty |= SENSOR_FIELD_TEMP_HUMIDITY;
+}
+
+void sensor_txn_set_led_state(sensor_txn_t *txn, bool enabled, led_intensity_t intensity) {
+    txn->staged.led_matrix_enabled = enabled;
+    txn->staged.led_intensity = intensity;
+    txn->dirty |= SENSOR_FIELD_LED;
+}
+
+void sensor_txn_set_capture(sensor_txn_t *txn, sensor_field_t field, uint64_t capture_us) {
+    if (field == SENSOR_FIELD_LUMINOSITY) {
+        txn->staged.luminosity_capture_us = capture_us;
+    } else if (field == SENSOR_FIELD_TEMP_HUMIDITY) {
+        txn->staged.temp_humidity_capture_us = capture_us;
+    }
+}
+
+void sensor_txn_set_comfort(sensor_txn_t *txn, const comfort_metrics_t *comfort) {
+    txn->staged.comfort = *comfort;
+}
+
+void sensor_txn_set_anomaly(sensor_txn_t *txn, ts_metric_t metric, uint8_t flags) {
+    txn->staged.anomaly_flags[metric] = flags;
 }
 
-void sensor_data_set_led_state(bool enabled, led_intensity_t intensity) {
+uint8_t sensor_data_metric_values(const sensor_data_t *data, uint32_t fields, int32_t values[TS_METRIC_COUNT]) {
+    uint8_t mask = 0;
+
+    if ((fields & SENSOR_FIELD_TEMP_HUMIDITY) && data->temp_humidity_valid) {
+        values[TS_METRIC_TEMPERATURE] = data->temperature_centi;
+        values[TS_METRIC_HUMIDITY] = data->humidity_centi;
+        mask |= (1u << TS_METRIC_TEMPERATURE) | (1u << TS_METRIC_HUMIDITY);
+    }
+    if ((fields & SENSOR_FIELD_LUMINOSITY) && data->luminosity_valid) {
+        values[TS_METRIC_LUX] = data->luminosity_centi;
+        mask |= (1u << TS_METRIC_LUX);
+    }
+
+    // Amostras rejeitadas repetem o valor anterior: não são dados novos
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (data->anomaly_flags[m] & ANOMALY_FLAG_REJECTED) {
+            mask &= (uint8_t)~(1u << m);
+        }
+    }
+    return mask;
+}
+
+// Campos que mudaram além da banda morta desde a última notificação
+static uint32_t subscriber_relevant_changes(const subscriber_t *sub, uint32_t dirty) {
+    uint32_t fields = dirty & sub->field_mask;
+    if (!sub->has_last) {
+        return fields;
+    }
+
+    const sensor_data_t *last = &sub->last_notified;
+    const sensor_data_t *now = &g_sensor_data;
+    uint32_t changed = 0;
+
+    if (fields & SENSOR_FIELD_LUMINOSITY) {
+        if (now->luminosity_valid != last->luminosity_valid ||
+            labs((long)(now->luminosity_centi - last->luminosity_centi)) > sub->deadband.luminosity_centi) {
+            changed |= SENSOR_FIELD_LUMINOSITY;
+        }
+    }
+    if (fields & SENSOR_FIELD_TEMP_HUMIDITY) {
+        if (now->temp_humidity_valid != last->temp_humidity_valid ||
+            labs((long)(now->temperature_centi - last->temperature_centi)) > sub->deadband.temperature_centi ||
+            labs((long)(now->humidity_centi - last->humidity_centi)) > sub->deadband.humidity_centi) {
+            changed |= SENSOR_FIELD_TEMP_HUMIDITY;
+        }
+    }
+    if (fields & SENSOR_FIELD_LED) {
+        if (now->led_matrix_enabled != last->led_matrix_enabled ||
+            now->led_intensity != last->led_intensity) {
+            changed |= SENSOR_FIELD_LED;
+        }
+    }
+    return changed;
+}
+
+// Avalia e acorda os inscritos (chamado com o mutex tomado, após o merge)
+static void notify_subscribers(uint32_t dirty) {
+    for (int i = 0; i < SENSOR_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &g_subscribers[i];
+        if (!sub->active || (dirty & sub->field_mask) == 0) {
+            continue;
+        }
+
+        sub->stats.commits++;
+        uint32_t changed = subscriber_relevant_changes(sub, dirty);
+        if (changed == 0) {
+            sub->stats.suppressed++;
+            continue;
+        }
+
+        sub->last_notified = g_sensor_data;
+        sub->has_last = true;
+        sub->stats.wakeups++;
+#ifdef USE_FREERTOS
+        xTaskNotify(sub->task, changed, eSetBits);
+#endif
+    }
+}
+
+// Alimenta as janelas com os valores válidos do commit e publica o resultado
+static void stats_update(uint32_t dirty, uint32_t now_ms) {
+    int32_t values[TS_METRIC_COUNT];
+    uint8_t mask = sensor_data_metric_values(&g_sensor_data, dirty, values);
+
+    rolling_result_t results[TS_METRIC_COUNT][SENSOR_STATS_WINDOW_COUNT];
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        for (int w = 0; w < SENSOR_STATS_WINDOW_COUNT; w++) {
+            rolling_window_t *win = &g_stats_windows[m][w];
+            if (mask & (1u << m)) {
+                rolling_window_add(win, now_ms, values[m]);
+            } else {
+                rolling_window_advance(win, now_ms);
+            }
+            rolling_window_result(win, &results[m][w]);
+        }
+    }
+
+    critical_section_enter_blocking(&g_stats_lock);
+    memcpy(g_stats.metric, results, sizeof(g_stats.metric));
+    g_stats.updated_ms = now_ms;
+    critical_section_exit(&g_stats_lock);
+}
+
+uint32_t sensor_data_commit(sensor_txn_t *txn) {
+    if (!txn || txn->dirty == 0) {
+        return sensor_data_version();
+    }
+
+    // Único ponto em que o mutex é tomado: uma aquisição por ciclo
     sensor_lock();
-    g_sensor_data.led_matrix_enabled = enabled;
-    g_sensor_data.led_intensity = intensity;
-    g_sensor_data.last_update_ms = to_ms_since_boot(get_absolute_time());
+    if (txn->dirty & SENSOR_FIELD_LUMINOSITY) {
+        g_sensor_data.luminosity_centi = txn->staged.luminosity_centi;
+        g_sensor_data.luminosity_valid = txn->staged.luminosity_valid;
+        g_sensor_data.luminosity_update_ms = txn->now_ms;
+        g_sensor_data.luminosity_capture_us = txn->staged.luminosity_capture_us;
+        g_sensor_data.anomaly_flags[TS_METRIC_LUX] = txn->staged.anomaly_flags[TS_METRIC_LUX];
+    }
+    if (txn->dirty & SENSOR_FIELD_TEMP_HUMIDITY) {
+        g_sensor_data.temperature_centi = txn->staged.temperature_centi;
+        g_sensor_data.humidity_centi = txn->staged.humidity_centi;
+        g_sensor_data.temp_humidity_valid = txn->staged.temp_humidity_valid;
+        g_sensor_data.comfort = txn->staged.comfort;
+        g_sensor_data.temp_humidity_update_ms = txn->now_ms;
+        g_sensor_data.temp_humidity_capture_us = txn->staged.temp_humidity_capture_us;
+        g_sensor_data.anomaly_flags[TS_METRIC_TEMPERATURE] = txn->staged.anomaly_flags[TS_METRIC_TEMPERATURE];
+        g_sensor_data.anomaly_flags[TS_METRIC_HUMIDITY] = txn->staged.anomaly_flags[TS_METRIC_HUMIDITY];
+    }
+    if (txn->dirty & SENSOR_FIELD_LED) {
+        g_sensor_data.led_matrix_enabled = txn->staged.led_matrix_enabled;
+        g_sensor_data.led_intensity = txn->staged.led_intensity;
+        g_sensor_data.led_update_ms = txn->now_ms;
+    }
+    g_sensor_data.changed_fields = txn->dirty;
+    g_sensor_data.last_update_ms = txn->now_ms;
+    history_push();
+    uint32_t version = g_sensor_data.version;
+    stats_update(txn->dirty, txn->now_ms);
+    notify_subscribers(txn->dirty);
     sensor_unlock();
+
+    txn->dirty = 0;
+    return version;
+}
+
+uint32_t sensor_data_version(void) {
+    return sensor_data_history_head();
+}
+
+bool sensor_data_changed_since(uint32_t version) {
+    return sensor_data_version() != version;
+}
+
+uint32_t sensor_data_field_age_ms(const sensor_data_t *data, sensor_field_t field, uint32_t now_ms) {
+    uint32_t updated_ms;
+    switch (field) {
+        case SENSOR_FIELD_LUMINOSITY:
+            updated_ms = data->luminosity_update_ms;
+            break;
+        case SENSOR_FIELD_TEMP_HUMIDITY:
+            updated_ms = data->temp_humidity_update_ms;
+            break;
+        case SENSOR_FIELD_LED:
+            updated_ms = data->led_update_ms;
+            break;
+        default:
+            return UINT32_MAX;
+    }
+    if (updated_ms == 0) {
+        return UINT32_MAX;
+    }
+    return now_ms - updated_ms;
+}
+
+uint32_t sensor_data_history_head(void) {
+    return __atomic_load_n(&g_history_head, __ATOMIC_ACQUIRE);
+}
+
+size_t sensor_data_history_read(uint32_t *cursor, sensor_sample_t *out, size_t max, uint32_t *lost) {
+    uint32_t dropped = 0;
+    size_t count = 0;
+
+    if (!cursor || !out || max == 0) {
+        if (lost) *lost = 0;
+        return 0;
+    }
+
+    uint32_t head = sensor_data_history_head();
+    uint32_t next = *cursor + 1;
+
+    // Amostras mais antigas que o tamanho do histórico já foram sobrescritas
+    if (head - *cursor > SENSOR_HISTORY_LEN) {
+        uint32_t oldest = head - SENSOR_HISTORY_LEN + 1;
+        dropped += oldest - next;
+        next = oldest;
+    }
+
+    while (count < max && (int32_t)(head - next) >= 0) {
+        if (history_copy(next, &out[count])) {
+            count++;
+        } else {
+            dropped++;
+        }
+        *cursor = next;
+        next++;
+    }
+
+    if (lost) *lost = dropped;
+    return count;
+}
+
+size_t sensor_data_history_latest(sensor_sample_t *out, size_t max) {
+    if (!out || max == 0) return 0;
+
+    uint32_t head = sensor_data_history_head();
+    uint32_t n = (max < SENSOR_HISTORY_LEN) ? (uint32_t)max : SENSOR_HISTORY_LEN;
+    if (n > head) n = head;
+
+    uint32_t cursor = head - n;
+    return sensor_data_history_read(&cursor, out, max, NULL);
+}
+
+bool sensor_data_get_subscriber_stats(int id, sensor_subscriber_stats_t *out, const char **name) {
+    if (id < 0 || id >= SENSOR_MAX_SUBSCRIBERS || !out) return false;
+    const subscriber_t *sub = &g_subscribers[id];
+    if (!sub->active) return false;
+
+    *out = sub->stats;
+    if (name) *name = sub->name ? sub->name : "?";
+    return true;
+}
+
+void sensor_data_get_stats(sensor_stats_t *out) {
+    if (!out) return;
+    critical_section_enter_blocking(&g_stats_lock);
+    *out = g_stats;
+    critical_section_exit(&g_stats_lock);
 }
@@ -0,0 +1,79 @@
+#include "sensor_health.h"
+
+#include <string.h>
+
+#define US_PER_MS 1000u
+
+void sensor_health_init(sensor_health_t *h) {
+    memset(h, 0, sizeof(*h));
+    h->state = SENSOR_HEALTH_OK;
+}
+
+// Dobra a espera, entre o mínimo e o teto
+static void grow_backoff(sensor_health_t *h) {
+    h->backoff_ms *= 2;
+    if (h->backoff_ms < SENSOR_HEALTH_BACKOFF_MIN_MS) {
+        h->backoff_ms = SENSOR_HEALTH_BACKOFF_MIN_MS;
+    }
+    if (h->backoff_ms > SENSOR_HEALTH_BACKOFF_MAX_MS) {
+        h->backoff_ms = SENSOR_HEALTH_BACKOFF_MAX_MS;
+    }
+}
+
+void sensor_health_set_offline(sensor_health_t *h, uint64_t now_us) {
+    h->state = SENSOR_HEALTH_OFFLINE;
+    h->outages++;
+    // Um sensor que cai logo depois de voltar continua da espera anterior
+    grow_backoff(h);
+    h->next_probe_us = now_us + (uint64_t)h->backoff_ms * US_PER_MS;
+}
+
+bool sensor_health_report(sensor_health_t *h, bool ok, uint64_t now_us) {
+    if (ok) {
+        h->state = SENSOR_HEALTH_OK;
+        h->consecutive_failures = 0;
+        // Cada leitura boa reduz a espera herdada da última queda
+        h->backoff_ms /= 2;
+        return false;
+    }
+
+    h->failures++;
+    if (h->consecutive_failures < UINT8_MAX) {
+        h->consecutive_failures++;
+    }
+    if (h->state == SENSOR_HEALTH_OFFLINE) {
+        return false;
+    }
+
+    if (h->consecutive_failures >= SENSOR_HEALTH_FAIL_THRESHOLD) {
+        sensor_health_set_offline(h, now_us);
+        return true;
+    }
+    h->state = SENSOR_HEALTH_DEGRADED;
+    return false;
+}
+
+void sensor_health_probe(sensor_health_t *h, bool ok, uint64_t now_us) {
+    h->probes++;
+
+    if (ok) {
+        h->state = SENSOR_HEALTH_OK;
+        h->consecutive_failures = 0;
+        h->recoveries++;
+        return;
+    }
+
+    // Cada sondagem sem resposta dobra a espera: um sensor ausente custa
+    // poucos acessos por minuto ao barramento
+    grow_backoff(h);
+    h->next_probe_us = now_us + (uint64_t)h->backoff_ms * US_PER_MS;
+}
+
+const char *sensor_health_state_name(sensor_health_state_t state) {
+    switch (state) {
+        case SENSOR_HEALTH_OK:       return "ok";
+        case SENSOR_HEALTH_DEGRADED: return "degraded";
+        case SENSOR_HEALTH_OFFLINE:  return "offline";
+    }
+    return "?";
+}
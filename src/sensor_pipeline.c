@@ -0,0 +1,278 @@
+#include "sensor_pipeline.h"
+
+#include "pico/stdlib.h"
+#include "sensor_data.h"
+#include "sensor_registry.h"
+#include "led_matrix.h"
+#include "timeseries.h"
+
+static sensor_scheduler_t *s_sched;
+
+// ============= AMOSTRAGEM ADAPTATIVA =============
+
+// Limites de atividade (centésimos): acima do ruído do sensor, abaixo do
+// que alguém perceberia como mudança. A luz usa desvio relativo (1/8 da
+// âncora) porque sua faixa cobre várias ordens de grandeza. O período
+// mínimo é o nominal de cada driver.
+static const adaptive_config_t LIGHT_ADAPTIVE = {
+    .max_period_ms = SENSOR_PIPELINE_LIGHT_MAX_PERIOD_MS,
+    .calm_samples = 10,
+    .channels = 1,
+    .channel = {
+        { .delta = 500, .delta_shift = 3, .max_rate_per_s = 0, .max_noise = 1000 },
+    },
+};
+
+static const adaptive_config_t TEMP_ADAPTIVE = {
+    .max_period_ms = SENSOR_PIPELINE_TEMP_MAX_PERIOD_MS,
+    .calm_samples = 5,
+    .channels = 2,
+    .channel = {
+        { .delta = 20, .delta_shift = 0, .max_rate_per_s = 5, .max_noise = 10 },     // Temperatura
+        { .delta = 100, .delta_shift = 0, .max_rate_per_s = 25, .max_noise = 50 },   // Umidade
+    },
+};
+
+// Por sensor do registro; sensores sem configuração ficam em taxa fixa
+static adaptive_rate_t s_rate[SENSOR_REGISTRY_MAX_SENSORS];
+static bool s_rate_used[SENSOR_REGISTRY_MAX_SENSORS];
+
+// Pedidos de outra task (UART, web), aplicados pela task dos sensores em step()
+static volatile bool s_adaptive_requested = true;
+static bool s_adaptive = true;
+static volatile uint32_t s_fixed_period_requested_ms = 0;
+static uint32_t s_fixed_period_ms = 0;
+
+// Aplica o período decidido para a amostra do sensor no índice dado
+static void adapt_period(int index, uint32_t t_ms, const int32_t *values, bool active) {
+    if (index < 0 || !s_rate_used[index] || s_fixed_period_ms) return;
+    uint32_t period_ms = adaptive_rate_update(&s_rate[index], t_ms, values, active);
+    sensor_scheduler_set_period(s_sched, (size_t)index, period_ms);
+}
+
+static void apply_adaptive_request(void) {
+    bool enabled = s_adaptive_requested;
+    if (enabled == s_adaptive) return;
+
+    s_adaptive = enabled;
+    for (size_t i = 0; i < s_sched->count; i++) {
+        if (!s_rate_used[i]) continue;
+        adaptive_rate_set_enabled(&s_rate[i], enabled);
+        if (!s_fixed_period_ms) {
+            sensor_scheduler_set_period(s_sched, i, s_rate[i].period_ms);
+        }
+    }
+}
+
+// Período fixo sobrepõe o adaptativo; nunca abaixo do período nominal do driver
+static void apply_fixed_period_request(void) {
+    uint32_t period_ms = s_fixed_period_requested_ms;
+    if (period_ms == s_fixed_period_ms) return;
+
+    s_fixed_period_ms = period_ms;
+    for (size_t i = 0; i < s_sched->count; i++) {
+        uint32_t base_ms = s_sched->entries[i].base_period_ms;
+        uint32_t target_ms = period_ms > base_ms ? period_ms : base_ms;
+        if (!period_ms) {
+            target_ms = s_rate_used[i] ? s_rate[i].period_ms : base_ms;
+        }
+        sensor_scheduler_set_period(s_sched, i, target_ms);
+    }
+}
+
+// ============= AMOSTRAS DOS SENSORES REGISTRADOS =============
+
+// Transação do ciclo: as amostras preparam os campos e o pipeline faz
+// um único commit ao fim de cada passada do escalonador
+static sensor_txn_t s_cycle;
+
+// Filtro de picos e quadros corrompidos antes da publicação
+static anomaly_detector_t *s_detector;
+
+static const app_context_t *s_ctx;
+
+// Instante da captura em ms, a base de tempo do detector e da adaptação
+static inline uint32_t capture_ms(uint64_t capture_us) {
+    return (uint32_t)(capture_us / 1000u);
+}
+
+// Posição da grandeza com a série dada entre as do driver, ou -1
+static int metric_slot(const sensor_driver_t *driver, ts_metric_t metric) {
+    for (uint8_t m = 0; m < driver->metric_count; m++) {
+        if (driver->metrics[m].ts_metric == (int8_t)metric) {
+            return m;
+        }
+    }
+    return -1;
+}
+
+// Configuração adaptativa pelo formato das grandezas (canais na ordem do driver)
+static const adaptive_config_t *adaptive_config_for(const sensor_driver_t *driver) {
+    if (driver->metric_count == 1 && metric_slot(driver, TS_METRIC_LUX) == 0) {
+        return &LIGHT_ADAPTIVE;
+    }
+    if (driver->metric_count == 2 && metric_slot(driver, TS_METRIC_TEMPERATURE) == 0 &&
+        metric_slot(driver, TS_METRIC_HUMIDITY) == 1) {
+        return &TEMP_ADAPTIVE;
+    }
+    return NULL;
+}
+
+static void update_leds(int32_t lux_centi) {
+    led_intensity_t intensity = led_matrix_get_intensity_from_lux(lux_centi);
+    if (*s_ctx->led_matrix_enabled) {
+        led_matrix_set_intensity(s_ctx->led_matrix, intensity);
+        sensor_txn_set_led_state(&s_cycle, true, intensity);
+    } else {
+        led_matrix_clear(s_ctx->led_matrix);
+        sensor_txn_set_led_state(&s_cycle, false, LED_INTENSITY_OFF);
+    }
+}
+
+// Grandezas com campo próprio no snapshot (série temporal, estatísticas,
+// flash e LEDs); as demais ficam só na tabela do registro
+static void stage_snapshot(const sensor_driver_t *driver, bool ok, uint64_t capture_us,
+                           const int32_t *values, const uint8_t *flags) {
+    int lux = metric_slot(driver, TS_METRIC_LUX);
+    if (lux >= 0) {
+        sensor_txn_set_luminosity(&s_cycle, ok ? values[lux] : 0, ok);
+        if (ok) {
+            sensor_txn_set_capture(&s_cycle, SENSOR_FIELD_LUMINOSITY, capture_us);
+            sensor_txn_set_anomaly(&s_cycle, TS_METRIC_LUX, flags[lux]);
+
+            // Um pico rejeitado (lanterna) não chega à decisão de intensidade
+            update_leds(values[lux]);
+        }
+    }
+
+    int temp = metric_slot(driver, TS_METRIC_TEMPERATURE);
+    int hum = metric_slot(driver, TS_METRIC_HUMIDITY);
+    if (temp >= 0 && hum >= 0) {
+        sensor_txn_set_temp_humidity(&s_cycle, ok ? values[temp] : 0, ok ? values[hum] : 0, ok);
+        if (ok) {
+            sensor_txn_set_capture(&s_cycle, SENSOR_FIELD_TEMP_HUMIDITY, capture_us);
+            sensor_txn_set_anomaly(&s_cycle, TS_METRIC_TEMPERATURE, flags[temp]);
+            sensor_txn_set_anomaly(&s_cycle, TS_METRIC_HUMIDITY, flags[hum]);
+
+            // Derivadas calculadas aqui, uma vez por amostra: leitores só copiam
+            comfort_metrics_t comfort;
+            comfort_metrics_compute(values[temp], values[hum], &comfort);
+            sensor_txn_set_comfort(&s_cycle, &comfort);
+        }
+    }
+}
+
+// Chamada pelo registro a cada amostra, antes da publicação na tabela
+static void on_sample(int sensor, const sensor_driver_t *driver, bool ok,
+                      uint64_t capture_us, int32_t *values, uint8_t *flags) {
+    uint32_t t_ms = capture_ms(capture_us);
+    bool active = false;
+
+    if (ok) {
+        for (uint8_t m = 0; m < driver->metric_count; m++) {
+            int8_t metric = driver->metrics[m].ts_metric;
+            if (metric < 0 || metric >= TS_METRIC_COUNT) continue;
+
+            flags[m] = anomaly_detector_check(s_detector, (ts_metric_t)metric, t_ms, values[m], &values[m]);
+            if (flags[m] != 0) {
+                active = true;
+            }
+        }
+    }
+
+    stage_snapshot(driver, ok, capture_us, values, flags);
+
+    // Amostra marcada pelo detector também conta como atividade: um degrau
+    // real precisa de amostras rápidas para sair da rejeição logo
+    if (ok) {
+        adapt_period(sensor, t_ms, values, active);
+    }
+}
+
+// Insere na série os valores de um campo no instante da sua captura
+static void record_field(const sensor_txn_t *txn, sensor_field_t field, uint64_t capture_us) {
+    if (!(txn->dirty & field)) return;
+
+    int32_t values[TS_METRIC_COUNT] = { 0 };
+    uint8_t mask = sensor_data_metric_values(&txn->staged, field, values);
+    timeseries_insert(capture_us / 1000u, values, mask);
+}
+
+// Registra na série temporal as leituras válidas do ciclo, cada campo com
+// o instante da amostragem; a série é ordenada, então a captura mais
+// antiga entra primeiro
+static void record_timeseries(const sensor_txn_t *txn) {
+    uint64_t lux_us = txn->staged.luminosity_capture_us;
+    uint64_t th_us = txn->staged.temp_humidity_capture_us;
+
+    if (lux_us <= th_us) {
+        record_field(txn, SENSOR_FIELD_LUMINOSITY, lux_us);
+        record_field(txn, SENSOR_FIELD_TEMP_HUMIDITY, th_us);
+    } else {
+        record_field(txn, SENSOR_FIELD_TEMP_HUMIDITY, th_us);
+        record_field(txn, SENSOR_FIELD_LUMINOSITY, lux_us);
+    }
+}
+
+// ============= API =============
+
+void sensor_pipeline_init(const app_context_t *ctx, anomaly_detector_t *detector) {
+    s_ctx = ctx;
+    s_detector = detector;
+    anomaly_detector_init(s_detector);
+
+    sensor_registry_start(time_us_64, on_sample);
+    s_sched = sensor_registry_scheduler();
+
+    for (size_t i = 0; i < sensor_registry_count() && i < SENSOR_REGISTRY_MAX_SENSORS; i++) {
+        const sensor_driver_t *driver = sensor_registry_driver((int)i);
+        const adaptive_config_t *base = adaptive_config_for(driver);
+
+        s_rate_used[i] = base != NULL;
+        if (base) {
+            adaptive_config_t cfg = *base;
+            cfg.min_period_ms = driver->period_ms;
+            adaptive_rate_init(&s_rate[i], &cfg);
+        }
+    }
+
+    s_adaptive = true;
+    s_fixed_period_ms = 0;
+    apply_adaptive_request();
+    apply_fixed_period_request();
+}
+
+uint64_t sensor_pipeline_step(void) {
+    sensor_data_begin(&s_cycle);
+    apply_adaptive_request();
+    apply_fixed_period_request();
+
+    uint64_t deadline_us = sensor_scheduler_run(s_sched);
+
+    // Um único commit por passada: leitores nunca veem meio ciclo
+    record_timeseries(&s_cycle);
+    sensor_data_commit(&s_cycle);
+    return deadline_us;
+}
+
+void sensor_pipeline_set_adaptive(bool enabled) {
+    s_adaptive_requested = enabled;
+}
+
+bool sensor_pipeline_adaptive_enabled(void) {
+    return s_adaptive_requested;
+}
+
+void sensor_pipeline_set_fixed_period(uint32_t period_ms) {
+    s_fixed_period_requested_ms = period_ms;
+}
+
+uint32_t sensor_pipeline_fixed_period(void) {
+    return s_fixed_period_requested_ms;
+}
+
+bool sensor_pipeline_get_adaptive_stats(size_t index, adaptive_stats_t *out) {
+    if (!s_sched || !out || index >= s_sched->count || !s_rate_used[index]) return false;
+    *out = s_rate[index].stats;
+    return true;
+}
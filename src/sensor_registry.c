@@ -0,0 +1,264 @@
+#include "sensor_registry.h"
+
+#include <string.h>
+
+#include "pico/critical_section.h"
+
+typedef struct {
+    const sensor_driver_t *driver;
+    void *dev;
+    sensor_health_t health;     // Protegida por s_lock (lida pela web/UART)
+    uint8_t first_metric;       // Posição da primeira grandeza na tabela
+    const uint8_t *route_current;
+    uint8_t route_value;
+} registry_slot_t;
+
+static registry_slot_t s_slots[SENSOR_REGISTRY_MAX_SENSORS];
+static size_t s_count;
+
+// Tabela de grandezas, lida por web/UART/display em qualquer contexto
+static sensor_metric_value_t s_metrics[SENSOR_REGISTRY_MAX_METRICS];
+static size_t s_metric_count;
+static critical_section_t s_lock;
+
+static sensor_scheduler_t s_sched;
+static sensor_registry_sample_fn s_on_sample;
+
+static inline int slot_index(const registry_slot_t *slot) {
+    return (int)(slot - s_slots);
+}
+
+// Repassa a amostra ao pipeline e publica o resultado na tabela
+static void publish(registry_slot_t *slot, bool ok, uint64_t capture_us,
+                    int32_t *values, uint8_t *flags) {
+    const sensor_driver_t *driver = slot->driver;
+    int sensor = slot_index(slot);
+
+    if (s_on_sample) {
+        s_on_sample(sensor, driver, ok, capture_us, values, flags);
+    }
+
+    critical_section_enter_blocking(&s_lock);
+    for (uint8_t m = 0; m < driver->metric_count; m++) {
+        sensor_metric_value_t *mv = &s_metrics[slot->first_metric + m];
+        mv->valid = ok;
+        mv->flags = ok ? flags[m] : 0;
+        mv->capture_us = capture_us;
+        if (ok) {
+            mv->value = values[m];
+            mv->samples++;
+        }
+    }
+    critical_section_exit(&s_lock);
+}
+
+// Atualiza a saúde após um acesso normal; se o sensor saiu do ar, os
+// disparos ficam suspensos até a primeira sondagem
+static void report_health(registry_slot_t *slot, bool ok) {
+    uint64_t now_us = s_sched.clock();
+
+    critical_section_enter_blocking(&s_lock);
+    bool went_offline = sensor_health_report(&slot->health, ok, now_us);
+    uint64_t probe_us = slot->health.next_probe_us;
+    critical_section_exit(&s_lock);
+
+    if (went_offline) {
+        sensor_scheduler_defer(&s_sched, (size_t)slot_index(slot), probe_us);
+        sensor_scheduler_set_probing(&s_sched, (size_t)slot_index(slot), true);
+    }
+}
+
+// Sondagem de um sensor fora do ar: refaz a sequência de init do driver
+// (o dispositivo pode ter sido religado e perdido a configuração)
+static bool probe(registry_slot_t *slot) {
+    uint64_t now_us = s_sched.clock();
+    if (now_us < slot->health.next_probe_us) {
+        // Disparo antecipado (ex.: mudança de período): mantém a espera
+        sensor_scheduler_defer(&s_sched, (size_t)slot_index(slot), slot->health.next_probe_us);
+        return false;
+    }
+
+    bool ok = slot->driver->init ? slot->driver->init(slot->dev) : true;
+
+    critical_section_enter_blocking(&s_lock);
+    sensor_health_probe(&slot->health, ok, s_sched.clock());
+    uint64_t probe_us = slot->health.next_probe_us;
+    critical_section_exit(&s_lock);
+
+    if (ok) {
+        sensor_scheduler_set_probing(&s_sched, (size_t)slot_index(slot), false);
+    } else {
+        sensor_scheduler_defer(&s_sched, (size_t)slot_index(slot), probe_us);
+    }
+    return ok;
+}
+
+// ============= ADAPTADORES PARA O ESCALONADOR =============
+
+static bool slot_start(void *arg) {
+    registry_slot_t *slot = (registry_slot_t *)arg;
+    bool ok;
+
+    if (slot->health.state == SENSOR_HEALTH_OFFLINE) {
+        ok = probe(slot) && slot->driver->start(slot->dev);
+        if (!ok && slot->health.state == SENSOR_HEALTH_OFFLINE) {
+            // Continua fora do ar: as grandezas já estão inválidas
+            return false;
+        }
+    } else {
+        ok = slot->driver->start(slot->dev);
+    }
+
+    if (ok) {
+        return true;
+    }
+
+    report_health(slot, false);
+
+    int32_t values[SENSOR_DRIVER_MAX_METRICS] = { 0 };
+    uint8_t flags[SENSOR_DRIVER_MAX_METRICS] = { 0 };
+    publish(slot, false, s_sched.entries[slot_index(slot)].capture_us, values, flags);
+    return false;
+}
+
+static sensor_sched_result_t slot_collect(void *arg, bool last_attempt, uint64_t capture_us) {
+    registry_slot_t *slot = (registry_slot_t *)arg;
+    int32_t values[SENSOR_DRIVER_MAX_METRICS] = { 0 };
+    uint8_t flags[SENSOR_DRIVER_MAX_METRICS] = { 0 };
+
+    sensor_sched_result_t result = slot->driver->collect(slot->dev, last_attempt, values);
+    if (result == SENSOR_SCHED_RETRY && !last_attempt) {
+        return SENSOR_SCHED_RETRY;
+    }
+
+    bool ok = result == SENSOR_SCHED_OK;
+    report_health(slot, ok);
+    publish(slot, ok, capture_us, values, flags);
+    return ok ? SENSOR_SCHED_OK : SENSOR_SCHED_FAIL;
+}
+
+// ============= API =============
+
+void sensor_registry_init(void) {
+    if (!critical_section_is_initialized(&s_lock)) {
+        critical_section_init(&s_lock);
+    }
+    memset(s_slots, 0, sizeof(s_slots));
+    memset(s_metrics, 0, sizeof(s_metrics));
+    s_count = 0;
+    s_metric_count = 0;
+    s_on_sample = NULL;
+}
+
+int sensor_registry_add(const sensor_driver_t *driver, void *dev) {
+    if (!driver || !driver->start || !driver->collect) return -1;
+    if (driver->metric_count > SENSOR_DRIVER_MAX_METRICS) return -1;
+    if (s_count >= SENSOR_REGISTRY_MAX_SENSORS) return -1;
+    if (s_metric_count + driver->metric_count > SENSOR_REGISTRY_MAX_METRICS) return -1;
+
+    registry_slot_t *slot = &s_slots[s_count];
+    slot->driver = driver;
+    slot->dev = dev;
+    slot->first_metric = (uint8_t)s_metric_count;
+    sensor_health_init(&slot->health);
+    if (driver->init && !driver->init(dev)) {
+        // Ausente no boot: entra fora do ar e é sondado após o início
+        sensor_health_set_offline(&slot->health, 0);
+    }
+
+    for (uint8_t m = 0; m < driver->metric_count; m++) {
+        sensor_metric_value_t *mv = &s_metrics[s_metric_count++];
+        memset(mv, 0, sizeof(*mv));
+        mv->desc = &driver->metrics[m];
+        mv->sensor_name = driver->name;
+        mv->sensor = (int)s_count;
+    }
+
+    return (int)s_count++;
+}
+
+size_t sensor_registry_count(void) {
+    return s_count;
+}
+
+const sensor_driver_t *sensor_registry_driver(int sensor) {
+    if (sensor < 0 || (size_t)sensor >= s_count) return NULL;
+    return s_slots[sensor].driver;
+}
+
+bool sensor_registry_ready(int sensor) {
+    if (sensor < 0 || (size_t)sensor >= s_count) return false;
+    return s_slots[sensor].health.state != SENSOR_HEALTH_OFFLINE;
+}
+
+bool sensor_registry_get_status(int sensor, sensor_status_t *out) {
+    if (!out || sensor < 0 || (size_t)sensor >= s_count) return false;
+
+    critical_section_enter_blocking(&s_lock);
+    out->name = s_slots[sensor].driver->name;
+    out->health = s_slots[sensor].health;
+    critical_section_exit(&s_lock);
+    return true;
+}
+
+bool sensor_registry_set_route(int sensor, const uint8_t *current, uint8_t value) {
+    if (sensor < 0 || (size_t)sensor >= s_count) return false;
+    s_slots[sensor].route_current = current;
+    s_slots[sensor].route_value = value;
+    return true;
+}
+
+sensor_scheduler_t *sensor_registry_scheduler(void) {
+    return &s_sched;
+}
+
+bool sensor_registry_start(sensor_sched_clock_fn clock, sensor_registry_sample_fn on_sample) {
+    s_on_sample = on_sample;
+    sensor_scheduler_init(&s_sched, clock);
+
+    for (size_t i = 0; i < s_count; i++) {
+        const sensor_driver_t *driver = s_slots[i].driver;
+        int index = sensor_scheduler_add(&s_sched, driver->name, driver->period_ms, driver->conversion_ms,
+                                         slot_start, slot_collect, &s_slots[i]);
+        if (index != (int)i) {
+            return false;
+        }
+        if (s_slots[i].route_current) {
+            sensor_scheduler_set_route(&s_sched, i, s_slots[i].route_current, s_slots[i].route_value);
+        }
+
+        // Sensores ausentes no boot: primeira sondagem após a espera mínima
+        sensor_health_t *h = &s_slots[i].health;
+        if (h->state == SENSOR_HEALTH_OFFLINE) {
+            critical_section_enter_blocking(&s_lock);
+            h->next_probe_us = clock() + (uint64_t)h->backoff_ms * 1000u;
+            critical_section_exit(&s_lock);
+            sensor_scheduler_defer(&s_sched, i, h->next_probe_us);
+            sensor_scheduler_set_probing(&s_sched, i, true);
+        }
+    }
+    return true;
+}
+
+size_t sensor_registry_metric_count(void) {
+    return s_metric_count;
+}
+
+bool sensor_registry_get_metric(size_t index, sensor_metric_value_t *out) {
+    if (!out || index >= s_metric_count) return false;
+
+    critical_section_enter_blocking(&s_lock);
+    *out = s_metrics[index];
+    critical_section_exit(&s_lock);
+    return true;
+}
+
+int sensor_registry_find_metric(const char *key) {
+    if (!key) return -1;
+    for (size_t i = 0; i < s_metric_count; i++) {
+        if (strcmp(s_metrics[i].desc->key, key) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
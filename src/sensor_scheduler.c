@@ -0,0 +1,217 @@
+#include "sensor_scheduler.h"
+
+#include <string.h>
+
+#define US_PER_MS 1000u
+
+void sensor_scheduler_init(sensor_scheduler_t *sched, sensor_sched_clock_fn clock) {
+    memset(sched, 0, sizeof(*sched));
+    sched->clock = clock;
+}
+
+int sensor_scheduler_add(sensor_scheduler_t *sched, const char *name,
+                         uint32_t period_ms, uint32_t conversion_ms,
+                         sensor_sched_start_fn start, sensor_sched_collect_fn collect,
+                         void *ctx) {
+    if (!sched || !sched->clock || !start || !collect || period_ms == 0) return -1;
+    if (sched->count >= SENSOR_SCHED_MAX_ENTRIES) return -1;
+
+    sensor_sched_entry_t *e = &sched->entries[sched->count];
+    memset(e, 0, sizeof(*e));
+    e->name = name;
+    e->period_ms = period_ms;
+    e->base_period_ms = period_ms;
+    e->conversion_ms = conversion_ms;
+    e->start = start;
+    e->collect = collect;
+    e->ctx = ctx;
+    e->next_start_us = sched->clock();
+    jitter_stats_reset(&e->stats.jitter);
+
+    return (int)sched->count++;
+}
+
+bool sensor_scheduler_set_period(sensor_scheduler_t *sched, size_t index, uint32_t period_ms) {
+    if (!sched || index >= sched->count || period_ms == 0) return false;
+
+    sensor_sched_entry_t *e = &sched->entries[index];
+    if (period_ms == e->period_ms) return true;
+
+    // next_start_us - período é o instante agendado do último disparo;
+    // em sondagem o prazo é a espera do dono e fica como está
+    if (e->has_capture && !e->probing) {
+        uint64_t now_us = sched->clock();
+        e->next_start_us = e->next_start_us - (uint64_t)e->period_ms * US_PER_MS
+                         + (uint64_t)period_ms * US_PER_MS;
+        if (e->next_start_us < now_us) {
+            e->next_start_us = now_us;
+        }
+    }
+    e->period_ms = period_ms;
+    return true;
+}
+
+bool sensor_scheduler_defer(sensor_scheduler_t *sched, size_t index, uint64_t until_us) {
+    if (!sched || index >= sched->count) return false;
+
+    sensor_sched_entry_t *e = &sched->entries[index];
+    if (until_us > e->next_start_us) {
+        e->next_start_us = until_us;
+    }
+    return true;
+}
+
+bool sensor_scheduler_set_probing(sensor_scheduler_t *sched, size_t index, bool probing) {
+    if (!sched || index >= sched->count) return false;
+
+    sched->entries[index].probing = probing;
+    return true;
+}
+
+bool sensor_scheduler_set_route(sensor_scheduler_t *sched, size_t index,
+                                const uint8_t *current, uint8_t value) {
+    if (!sched || index >= sched->count) return false;
+
+    sched->entries[index].route_current = current;
+    sched->entries[index].route_value = value;
+    return true;
+}
+
+static void finish_collect(sensor_sched_entry_t *e, sensor_sched_result_t result, uint64_t now_us) {
+    if (result == SENSOR_SCHED_RETRY && e->retries < SENSOR_SCHED_MAX_RETRIES) {
+        e->retries++;
+        e->collect_due_us = now_us + SENSOR_SCHED_RETRY_MS * US_PER_MS;
+        return;
+    }
+
+    e->converting = false;
+    if (result == SENSOR_SCHED_OK) {
+        e->stats.samples++;
+    } else {
+        e->stats.failures++;
+    }
+}
+
+static void start_entry(sensor_scheduler_t *sched, sensor_sched_entry_t *e) {
+    uint64_t scheduled_us = e->next_start_us;
+    // O dono pode desmarcar a sondagem dentro do start (sensor de volta)
+    bool probing = e->probing;
+
+    // Timestamp lido imediatamente antes do disparo da conversão
+    uint64_t capture_us = sched->clock();
+    uint64_t lateness_us = capture_us - scheduled_us;
+
+    if (probing) {
+        // A espera entre sondagens não é período nem atraso; o primeiro
+        // intervalo depois da volta começa no próximo disparo normal
+        e->stats.probes++;
+        e->has_capture = false;
+    } else {
+        e->stats.starts++;
+        jitter_stats_add(&e->stats.jitter, lateness_us > UINT32_MAX ? UINT32_MAX : (uint32_t)lateness_us);
+
+        if (e->has_capture) {
+            e->stats.intervals++;
+            e->stats.interval_sum_us += capture_us - e->capture_us;
+        }
+        e->has_capture = true;
+    }
+    e->capture_us = capture_us;
+
+    // Próximo prazo ancorado no agendado (sem deriva); se atrasou mais
+    // de um período inteiro, ressincroniza em vez de disparar em rajada
+    uint64_t period_us = (uint64_t)e->period_ms * US_PER_MS;
+    e->next_start_us = scheduled_us + period_us;
+    if (e->next_start_us <= capture_us) {
+        e->next_start_us = capture_us + period_us;
+    }
+
+    if (!e->start(e->ctx)) {
+        if (!probing) {
+            e->stats.failures++;
+        }
+        return;
+    }
+
+    e->converting = true;
+    e->retries = 0;
+    e->collect_due_us = capture_us + (uint64_t)e->conversion_ms * US_PER_MS;
+}
+
+static bool entry_due(const sensor_sched_entry_t *e, uint64_t now_us) {
+    return now_us >= (e->converting ? e->collect_due_us : e->next_start_us);
+}
+
+static bool entry_on_route(const sensor_sched_entry_t *e) {
+    return e->route_current == NULL || *e->route_current == e->route_value;
+}
+
+// Dispara (se livre) e coleta (se a conversão já venceu) uma entrada
+static void service_entry(sensor_scheduler_t *sched, sensor_sched_entry_t *e) {
+    if (!e->converting) {
+        start_entry(sched, e);
+    }
+
+    if (e->converting) {
+        uint64_t now_us = sched->clock();
+        if (now_us >= e->collect_due_us) {
+            bool last_attempt = e->retries >= SENSOR_SCHED_MAX_RETRIES;
+            finish_collect(e, e->collect(e->ctx, last_attempt, e->capture_us), now_us);
+        }
+    }
+}
+
+uint64_t sensor_scheduler_run(sensor_scheduler_t *sched) {
+    // Cada entrada é atendida no máximo duas vezes por passada (disparo e
+    // coleta), o que limita a passada mesmo com períodos muito curtos
+    for (size_t round = 0; round < 2 * sched->count; round++) {
+        uint64_t now_us = sched->clock();
+        sensor_sched_entry_t *pick = NULL;
+
+        // Primeiro vencido já na rota; senão, o primeiro vencido (que
+        // troca a rota e torna seus vizinhos de canal os próximos)
+        for (size_t i = 0; i < sched->count; i++) {
+            sensor_sched_entry_t *e = &sched->entries[i];
+            if (!entry_due(e, now_us)) continue;
+            if (entry_on_route(e)) {
+                pick = e;
+                break;
+            }
+            if (!pick) {
+                pick = e;
+            }
+        }
+        if (!pick) break;
+
+        service_entry(sched, pick);
+    }
+
+    uint64_t next_us = SENSOR_SCHED_NO_DEADLINE;
+    for (size_t i = 0; i < sched->count; i++) {
+        const sensor_sched_entry_t *e = &sched->entries[i];
+        uint64_t deadline_us = e->converting ? e->collect_due_us : e->next_start_us;
+        if (deadline_us < next_us) {
+            next_us = deadline_us;
+        }
+    }
+
+    return next_us;
+}
+
+bool sensor_scheduler_get_stats(const sensor_scheduler_t *sched, size_t index, sensor_sched_stats_t *out) {
+    if (!sched || !out || index >= sched->count) return false;
+    *out = sched->entries[index].stats;
+    return true;
+}
+
+uint32_t sensor_scheduler_avg_period_ms(const sensor_sched_stats_t *stats) {
+    if (stats->intervals == 0) return 0;
+    return (uint32_t)(stats->interval_sum_us / stats->intervals / US_PER_MS);
+}
+
+uint32_t sensor_scheduler_duty_permille(const sensor_sched_stats_t *stats, uint32_t base_period_ms) {
+    if (stats->intervals == 0) return 1000;
+    uint64_t avg_period_us = stats->interval_sum_us / stats->intervals;
+    if (avg_period_us == 0) return 1000;
+    return (uint32_t)(((uint64_t)base_period_ms * US_PER_MS * 1000u + avg_period_us / 2) / avg_period_us);
+}
@@ -0,0 +1,43 @@
+#include "sensor_units.h"
+
+#include <stdio.h>
+
+int sensor_units_format(char *buffer, size_t size, int32_t centi, unsigned decimals) {
+    // Trabalha com o módulo para arredondar simetricamente
+    uint32_t mag = (centi < 0) ? (uint32_t)(-(int64_t)centi) : (uint32_t)centi;
+    const char *sign = (centi < 0) ? "-" : "";
+
+    switch (decimals) {
+        case 0: {
+            uint32_t units = (mag + 50u) / 100u;
+            return snprintf(buffer, size, "%s%lu", units ? sign : "", (unsigned long)units);
+        }
+        case 1: {
+            uint32_t tenths = (mag + 5u) / 10u;
+            return snprintf(buffer, size, "%s%lu.%lu", tenths ? sign : "",
+                            (unsigned long)(tenths / 10u), (unsigned long)(tenths % 10u));
+        }
+        default:
+            return snprintf(buffer, size, "%s%lu.%02lu", sign,
+                            (unsigned long)(mag / 100u), (unsigned long)(mag % 100u));
+    }
+}
+
+uint32_t sensor_units_isqrt(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
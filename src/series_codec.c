@@ -0,0 +1,186 @@
+#include "series_codec.h"
+
+#include <string.h>
+
+// Faixas de tamanho variável (prefixo unário + payload):
+//   0 -> valor zero | 10 | 110 | 1110 -> payload curto | 1111 -> 32 bits
+// Larguras escolhidas para as séries do monitor: o jitter do instante
+// cabe em 7-12 bits e as variações lentas em 4-8 bits.
+static const uint8_t TIME_BITS[3]  = { 7, 9, 12 };
+static const uint8_t VALUE_BITS[3] = { 4, 8, 16 };
+
+// Cada amostra: máscara ('0' = repetida, '1' + 3 bits), delta-do-delta
+// do instante e um delta por grandeza presente
+#define MASK_BITS 3
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u);
+}
+
+// Bits necessários para codificar zz nas faixas dadas
+static size_t bucket_bits(uint32_t zz, const uint8_t widths[3]) {
+    if (zz == 0) return 1;
+    for (int i = 0; i < 3; i++) {
+        if (zz < (1u << widths[i])) return (size_t)(i + 2) + widths[i];
+    }
+    return 4 + 32;
+}
+
+// ============= ESCRITA DE BITS =============
+
+static void write_bits(series_encoder_t *enc, uint32_t value, uint8_t nbits) {
+    for (int i = nbits - 1; i >= 0; i--) {
+        size_t byte = enc->bit_pos >> 3;
+        uint8_t mask = (uint8_t)(0x80u >> (enc->bit_pos & 7u));
+        if ((value >> i) & 1u) {
+            enc->buffer[byte] |= mask;
+        } else {
+            enc->buffer[byte] &= (uint8_t)~mask;
+        }
+        enc->bit_pos++;
+    }
+}
+
+static void write_bucket(series_encoder_t *enc, uint32_t zz, const uint8_t widths[3]) {
+    if (zz == 0) {
+        write_bits(enc, 0, 1);
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (zz < (1u << widths[i])) {
+            // i+1 uns seguidos de um zero
+            write_bits(enc, ((1u << (i + 1)) - 1u) << 1, (uint8_t)(i + 2));
+            write_bits(enc, zz, widths[i]);
+            return;
+        }
+    }
+    write_bits(enc, 0xFu, 4);
+    write_bits(enc, zz, 32);
+}
+
+// ============= LEITURA DE BITS =============
+
+static bool read_bits(series_decoder_t *dec, uint8_t nbits, uint32_t *out) {
+    if (dec->bit_pos + nbits > dec->len_bits) return false;
+
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < nbits; i++) {
+        size_t byte = dec->bit_pos >> 3;
+        uint8_t bit = (uint8_t)((dec->buffer[byte] >> (7u - (dec->bit_pos & 7u))) & 1u);
+        value = (value << 1) | bit;
+        dec->bit_pos++;
+    }
+    *out = value;
+    return true;
+}
+
+static bool read_bucket(series_decoder_t *dec, const uint8_t widths[3], uint32_t *zz) {
+    uint32_t bit;
+    int ones = 0;
+    while (ones < 4) {
+        if (!read_bits(dec, 1, &bit)) return false;
+        if (!bit) break;
+        ones++;
+    }
+
+    if (ones == 0) {
+        *zz = 0;
+        return true;
+    }
+    return read_bits(dec, (ones < 4) ? widths[ones - 1] : 32, zz);
+}
+
+// ============= CODIFICADOR =============
+
+void series_encoder_init(series_encoder_t *enc, uint8_t *buffer, size_t capacity) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buffer = buffer;
+    enc->capacity = capacity;
+}
+
+bool series_encoder_add(series_encoder_t *enc, const series_sample_t *sample) {
+    if (!enc || !sample || enc->count == UINT16_MAX) return false;
+
+    uint8_t mask = sample->valid_mask & (uint8_t)((1u << TS_METRIC_COUNT) - 1u);
+    uint32_t delta = sample->t_ms - enc->prev_t;
+    uint32_t dod = zigzag((int32_t)(delta - enc->prev_delta));
+    uint32_t zz[TS_METRIC_COUNT];
+
+    // Calcula o tamanho antes de escrever: se não couber, o bloco fica intacto
+    size_t bits = (mask == enc->prev_mask) ? 1 : 1 + MASK_BITS;
+    bits += bucket_bits(dod, TIME_BITS);
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (!(mask & (1u << m))) continue;
+        zz[m] = zigzag((int32_t)((uint32_t)sample->value[m] - (uint32_t)enc->prev_value[m]));
+        bits += bucket_bits(zz[m], VALUE_BITS);
+    }
+    if (enc->bit_pos + bits > enc->capacity * 8u) return false;
+
+    if (mask == enc->prev_mask) {
+        write_bits(enc, 0, 1);
+    } else {
+        write_bits(enc, 1, 1);
+        write_bits(enc, mask, MASK_BITS);
+    }
+    write_bucket(enc, dod, TIME_BITS);
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (!(mask & (1u << m))) continue;
+        write_bucket(enc, zz[m], VALUE_BITS);
+        enc->prev_value[m] = sample->value[m];
+    }
+
+    enc->prev_mask = mask;
+    enc->prev_delta = delta;
+    enc->prev_t = sample->t_ms;
+    enc->count++;
+    return true;
+}
+
+size_t series_encoder_bytes(const series_encoder_t *enc) {
+    return (enc->bit_pos + 7u) / 8u;
+}
+
+// ============= DECODIFICADOR =============
+
+void series_decoder_init(series_decoder_t *dec, const uint8_t *buffer, size_t len, uint16_t count) {
+    memset(dec, 0, sizeof(*dec));
+    dec->buffer = buffer;
+    dec->len_bits = len * 8u;
+    dec->remaining = count;
+}
+
+bool series_decoder_next(series_decoder_t *dec, series_sample_t *sample) {
+    if (!dec || !sample || dec->remaining == 0) return false;
+
+    uint32_t bit;
+    uint32_t mask = dec->prev_mask;
+    if (!read_bits(dec, 1, &bit)) return false;
+    if (bit && !read_bits(dec, MASK_BITS, &mask)) return false;
+
+    uint32_t dod;
+    if (!read_bucket(dec, TIME_BITS, &dod)) return false;
+    uint32_t delta = dec->prev_delta + (uint32_t)unzigzag(dod);
+
+    sample->t_ms = dec->prev_t + delta;
+    sample->valid_mask = (uint8_t)mask;
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (!(mask & (1u << m))) {
+            sample->value[m] = 0;
+            continue;
+        }
+        uint32_t zz;
+        if (!read_bucket(dec, VALUE_BITS, &zz)) return false;
+        dec->prev_value[m] = (int32_t)((uint32_t)dec->prev_value[m] + (uint32_t)unzigzag(zz));
+        sample->value[m] = dec->prev_value[m];
+    }
+
+    dec->prev_mask = (uint8_t)mask;
+    dec->prev_delta = delta;
+    dec->prev_t = sample->t_ms;
+    dec->remaining--;
+    return true;
+}
@@ -0,0 +1,300 @@
+#include "timeseries.h"
+
+#include <string.h>
+#include <strings.h>
+
+#include "pico/critical_section.h"
+
+// Amostra bruta (compacta: sem min/max). Guarda só os 32 bits baixos do
+// instante: a camada bruta cobre bem menos que 2^32 ms, então o instante
+// completo sai da distância até a inserção mais nova (g_raw_last_ms)
+typedef struct {
+    uint32_t t_ms;
+    uint8_t valid_mask;
+    int32_t value[TS_METRIC_COUNT];
+} raw_point_t;
+
+// Ponto agregado armazenado; a média é fechada ao final do intervalo
+typedef struct {
+    uint32_t bucket;                    // Início em t_ms / width_ms (2^32 s = 136 anos)
+    uint16_t n[TS_METRIC_COUNT];        // Amostras por grandeza (0 = ausente)
+    int32_t min[TS_METRIC_COUNT];
+    int32_t max[TS_METRIC_COUNT];
+    int32_t mean[TS_METRIC_COUNT];
+} rollup_point_t;
+
+// Intervalo em aberto de uma camada agregada
+typedef struct {
+    bool open;
+    uint32_t bucket;                    // t_ms / width_ms
+    uint16_t n[TS_METRIC_COUNT];        // Amostras válidas por grandeza
+    int32_t min[TS_METRIC_COUNT];
+    int32_t max[TS_METRIC_COUNT];
+    int64_t sum[TS_METRIC_COUNT];
+} rollup_acc_t;
+
+// Anel de pontos agregados
+typedef struct {
+    rollup_point_t *points;
+    size_t capacity;
+    size_t head;        // Próxima posição de escrita
+    size_t count;
+    uint32_t width_ms;
+    rollup_acc_t acc;
+} rollup_tier_t;
+
+static raw_point_t g_raw[TIMESERIES_RAW_LEN];
+static size_t g_raw_head;
+static size_t g_raw_count;
+static uint64_t g_raw_last_ms;
+
+static rollup_point_t g_points_1s[TIMESERIES_1S_LEN];
+static rollup_point_t g_points_1min[TIMESERIES_1MIN_LEN];
+static rollup_point_t g_points_1h[TIMESERIES_1H_LEN];
+
+// Camadas agregadas em ordem: cada uma alimenta a seguinte ao fechar um ponto
+static rollup_tier_t g_tiers[TS_RES_COUNT - 1] = {
+    { g_points_1s,   TIMESERIES_1S_LEN,   0, 0, 1000u,    { 0 } },
+    { g_points_1min, TIMESERIES_1MIN_LEN, 0, 0, 60000u,   { 0 } },
+    { g_points_1h,   TIMESERIES_1H_LEN,   0, 0, 3600000u, { 0 } },
+};
+
+// Escrita pela task dos sensores, leitura pela UART e pelo lwIP (IRQ)
+static critical_section_t g_ts_lock;
+
+#define TS_STORAGE_BYTES (sizeof(g_raw) + sizeof(g_points_1s) + sizeof(g_points_1min) + \
+                          sizeof(g_points_1h) + sizeof(g_tiers))
+
+_Static_assert(sizeof(raw_point_t) * TIMESERIES_RAW_LEN +
+               sizeof(rollup_point_t) * (TIMESERIES_1S_LEN + TIMESERIES_1MIN_LEN + TIMESERIES_1H_LEN) +
+               sizeof(rollup_tier_t) * (TS_RES_COUNT - 1) <= TIMESERIES_RAM_BUDGET,
+               "timeseries excede TIMESERIES_RAM_BUDGET");
+
+static const char *const RES_NAMES[TS_RES_COUNT] = { "raw", "1s", "1min", "1h" };
+
+// ============= CAMADAS AGREGADAS =============
+
+static void acc_reset(rollup_acc_t *acc, uint32_t bucket) {
+    memset(acc, 0, sizeof(*acc));
+    acc->open = true;
+    acc->bucket = bucket;
+}
+
+static void acc_add_sample(rollup_acc_t *acc, const int32_t values[TS_METRIC_COUNT], uint8_t valid_mask) {
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (!(valid_mask & (1u << m))) continue;
+        int32_t v = values[m];
+        if (acc->n[m] == 0 || v < acc->min[m]) acc->min[m] = v;
+        if (acc->n[m] == 0 || v > acc->max[m]) acc->max[m] = v;
+        acc->sum[m] += v;
+        acc->n[m]++;
+    }
+}
+
+// Agrega um ponto já fechado da camada anterior (média ponderada pelas amostras)
+static void acc_add_point(rollup_acc_t *acc, const rollup_point_t *p) {
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (p->n[m] == 0) continue;
+        if (acc->n[m] == 0 || p->min[m] < acc->min[m]) acc->min[m] = p->min[m];
+        if (acc->n[m] == 0 || p->max[m] > acc->max[m]) acc->max[m] = p->max[m];
+        acc->sum[m] += (int64_t)p->mean[m] * p->n[m];
+        acc->n[m] += p->n[m];
+    }
+}
+
+static bool acc_empty(const rollup_acc_t *acc) {
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (acc->n[m] > 0) return false;
+    }
+    return true;
+}
+
+static void acc_close(const rollup_acc_t *acc, rollup_point_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->bucket = acc->bucket;
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        out->n[m] = acc->n[m];
+        if (acc->n[m] == 0) continue;
+        out->min[m] = acc->min[m];
+        out->max[m] = acc->max[m];
+        out->mean[m] = (int32_t)(acc->sum[m] / acc->n[m]);
+    }
+}
+
+static void tier_feed_point(size_t tier, const rollup_point_t *p);
+
+// Fecha o intervalo aberto da camada se t_ms já pertence a outro
+static void tier_roll(size_t tier, uint64_t t_ms) {
+    rollup_tier_t *t = &g_tiers[tier];
+    uint32_t bucket = (uint32_t)(t_ms / t->width_ms);
+    if (t->acc.open && t->acc.bucket == bucket) return;
+
+    if (t->acc.open && !acc_empty(&t->acc)) {
+        rollup_point_t *slot = &t->points[t->head];
+        acc_close(&t->acc, slot);
+        t->head = (t->head + 1) % t->capacity;
+        if (t->count < t->capacity) t->count++;
+
+        if (tier + 1 < TS_RES_COUNT - 1) {
+            tier_feed_point(tier + 1, slot);
+        }
+    }
+    acc_reset(&t->acc, bucket);
+}
+
+static void tier_feed_point(size_t tier, const rollup_point_t *p) {
+    tier_roll(tier, (uint64_t)p->bucket * g_tiers[tier - 1].width_ms);
+    acc_add_point(&g_tiers[tier].acc, p);
+}
+
+// ============= ACESSO POR ÍNDICE LÓGICO =============
+
+static uint64_t raw_time(const raw_point_t *r) {
+    return g_raw_last_ms - (uint32_t)((uint32_t)g_raw_last_ms - r->t_ms);
+}
+
+// Instante do i-ésimo ponto mais antigo de uma resolução
+static uint64_t point_time(ts_resolution_t res, size_t i) {
+    if (res == TS_RES_RAW) {
+        size_t idx = (g_raw_head + TIMESERIES_RAW_LEN - g_raw_count + i) % TIMESERIES_RAW_LEN;
+        return raw_time(&g_raw[idx]);
+    }
+    const rollup_tier_t *t = &g_tiers[res - 1];
+    return (uint64_t)t->points[(t->head + t->capacity - t->count + i) % t->capacity].bucket * t->width_ms;
+}
+
+static void point_copy(ts_resolution_t res, size_t i, ts_point_t *out) {
+    if (res == TS_RES_RAW) {
+        const raw_point_t *r = &g_raw[(g_raw_head + TIMESERIES_RAW_LEN - g_raw_count + i) % TIMESERIES_RAW_LEN];
+        out->t_ms = raw_time(r);
+        out->valid_mask = r->valid_mask;
+        for (int m = 0; m < TS_METRIC_COUNT; m++) {
+            out->samples[m] = (r->valid_mask & (1u << m)) ? 1 : 0;
+            out->min[m] = out->max[m] = out->mean[m] = r->value[m];
+        }
+        return;
+    }
+    const rollup_tier_t *t = &g_tiers[res - 1];
+    const rollup_point_t *p = &t->points[(t->head + t->capacity - t->count + i) % t->capacity];
+    out->t_ms = (uint64_t)p->bucket * t->width_ms;
+    out->valid_mask = 0;
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        out->samples[m] = p->n[m];
+        if (p->n[m] > 0) out->valid_mask |= (uint8_t)(1u << m);
+    }
+    memcpy(out->min, p->min, sizeof(out->min));
+    memcpy(out->max, p->max, sizeof(out->max));
+    memcpy(out->mean, p->mean, sizeof(out->mean));
+}
+
+static size_t count_locked(ts_resolution_t res) {
+    return (res == TS_RES_RAW) ? g_raw_count : g_tiers[res - 1].count;
+}
+
+// Primeiro índice com instante >= t_ms (pontos em ordem crescente)
+static size_t lower_bound(ts_resolution_t res, uint64_t t_ms) {
+    size_t lo = 0;
+    size_t hi = count_locked(res);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (point_time(res, mid) < t_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// ============= API =============
+
+void timeseries_init(void) {
+    if (!critical_section_is_initialized(&g_ts_lock)) {
+        critical_section_init(&g_ts_lock);
+    }
+
+    critical_section_enter_blocking(&g_ts_lock);
+    g_raw_head = 0;
+    g_raw_count = 0;
+    g_raw_last_ms = 0;
+    for (size_t i = 0; i < TS_RES_COUNT - 1; i++) {
+        g_tiers[i].head = 0;
+        g_tiers[i].count = 0;
+        memset(&g_tiers[i].acc, 0, sizeof(g_tiers[i].acc));
+    }
+    critical_section_exit(&g_ts_lock);
+}
+
+void timeseries_insert(uint64_t t_ms, const int32_t values[TS_METRIC_COUNT], uint8_t valid_mask) {
+    if (!values || valid_mask == 0) return;
+
+    critical_section_enter_blocking(&g_ts_lock);
+
+    raw_point_t *r = &g_raw[g_raw_head];
+    r->t_ms = (uint32_t)t_ms;
+    g_raw_last_ms = t_ms;
+    r->valid_mask = valid_mask;
+    memcpy(r->value, values, sizeof(r->value));
+    g_raw_head = (g_raw_head + 1) % TIMESERIES_RAW_LEN;
+    if (g_raw_count < TIMESERIES_RAW_LEN) g_raw_count++;
+
+    tier_roll(0, t_ms);
+    acc_add_sample(&g_tiers[0].acc, values, valid_mask);
+
+    critical_section_exit(&g_ts_lock);
+}
+
+size_t timeseries_query(ts_resolution_t res, uint64_t from_ms, uint64_t to_ms,
+                        ts_point_t *out, size_t max_points) {
+    if (res >= TS_RES_COUNT || !out || max_points == 0 || from_ms > to_ms) return 0;
+
+    critical_section_enter_blocking(&g_ts_lock);
+    size_t total = count_locked(res);
+    size_t n = 0;
+    for (size_t i = lower_bound(res, from_ms); i < total && n < max_points; i++) {
+        if (point_time(res, i) > to_ms) break;
+        point_copy(res, i, &out[n++]);
+    }
+    critical_section_exit(&g_ts_lock);
+    return n;
+}
+
+size_t timeseries_latest(ts_resolution_t res, ts_point_t *out, size_t max_points) {
+    if (res >= TS_RES_COUNT || !out || max_points == 0) return 0;
+
+    critical_section_enter_blocking(&g_ts_lock);
+    size_t total = count_locked(res);
+    size_t n = total < max_points ? total : max_points;
+    for (size_t i = 0; i < n; i++) {
+        point_copy(res, total - n + i, &out[i]);
+    }
+    critical_section_exit(&g_ts_lock);
+    return n;
+}
+
+size_t timeseries_count(ts_resolution_t res) {
+    if (res >= TS_RES_COUNT) return 0;
+    critical_section_enter_blocking(&g_ts_lock);
+    size_t n = count_locked(res);
+    critical_section_exit(&g_ts_lock);
+    return n;
+}
+
+size_t timeseries_memory_bytes(void) {
+    return TS_STORAGE_BYTES;
+}
+
+const char *timeseries_resolution_name(ts_resolution_t res) {
+    return (res < TS_RES_COUNT) ? RES_NAMES[res] : "?";
+}
+
+bool timeseries_parse_resolution(const char *name, ts_resolution_t *out) {
+    if (!name || !out) return false;
+    for (int i = 0; i < TS_RES_COUNT; i++) {
+        if (strcasecmp(name, RES_NAMES[i]) == 0) {
+            *out = (ts_resolution_t)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -2,6 +2,7 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "aht10.h"
+#include "sensor_units.h"
 
 #define I2C0_PORT i2c0
 #define I2C0_SDA 0
@@ -62,9 +63,45 @@ int main()
         fflush(stdout);
         
         for (int i = 0; i < 5; i++) {
-            float temp = 0, humid = 0;
+            int32_t temp = 0, humid = 0;
+            char t_str[SENSOR_UNITS_STR_MAX], h_str[SENSOR_UNITS_STR_MAX];
             if (aht10_read_temperature_humidity(&sensor, &temp, &humid)) {
-                printf("    Leitura %d: T=%.1f°C, H=%.1f%%\n", i+1, temp, humid);
+                sensor_units_format(t_str, sizeof(t_str), temp, 1);
+                sensor_units_format(h_str, sizeof(h_str), humid, 1);
+                printf("    Leitura %d: T=%s°C, H=%s%%\n", i+1, t_str, h_str);
+            } else {
+                printf("    Leitura %d: ERRO\n", i+1);
+            }
+            fflush(stdout);
+            sleep_ms(1000);
+        }
+
+        printf("\n[5] Leitura nao bloqueante (disparo/coleta)...\n");
+        fflush(stdout);
+
+        for (int i = 0; i < 5; i++) {
+            int32_t temp = 0, humid = 0;
+            char t_str[SENSOR_UNITS_STR_MAX], h_str[SENSOR_UNITS_STR_MAX];
+            uint32_t t_inicio = time_us_32();
+            bool disparou = aht10_start_measurement(&sensor);
+            uint32_t t_disparo = time_us_32() - t_inicio;
+
+            // Tempo livre para outras tarefas enquanto a conversao ocorre
+            uint32_t polls = 0;
+            while (disparou && !aht10_measurement_ready(&sensor)) {
+                polls++;
+                sleep_ms(5);
+            }
+
+            uint32_t t_coleta_ini = time_us_32();
+            bool ok = disparou && aht10_collect(&sensor, &temp, &humid);
+            uint32_t t_coleta = time_us_32() - t_coleta_ini;
+
+            if (ok) {
+                sensor_units_format(t_str, sizeof(t_str), temp, 1);
+                sensor_units_format(h_str, sizeof(h_str), humid, 1);
+                printf("    Leitura %d: T=%s°C, H=%s%% (disparo=%luus coleta=%luus polls=%lu)\n",
+                       i+1, t_str, h_str, (unsigned long)t_disparo, (unsigned long)t_coleta, (unsigned long)polls);
             } else {
                 printf("    Leitura %d: ERRO\n", i+1);
             }
@@ -76,7 +113,7 @@ int main()
         fflush(stdout);
     }
     
-    printf("\n[5] Teste finalizado\n");
+    printf("\n[6] Teste finalizado\n");
     fflush(stdout);
     
     while(1) {
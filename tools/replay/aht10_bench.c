@@ -0,0 +1,293 @@
+/*
+ * Ciclo do AHT10 bloqueante contra disparo/coleta, com um AHT10 simulado
+ *
+ * Simula um AHT10 e um BH1750 num barramento de 100 kHz, com o tempo de
+ * cada transferência e da conversão avançando um relógio virtual. Cada
+ * conversão devolve um quadro bruto pseudoaleatório (mesma semente nos
+ * dois modos), e o driver real (aht10.c, bh1750.c) lê os sensores de duas
+ * formas, como a tarefa de sensores fazia antes e faz agora:
+ *
+ *   bloqueante     aht10_read_temperature_humidity (sleep de 80 ms) e
+ *                  depois bh1750_read_light
+ *   disparo/coleta aht10_start_measurement, bh1750_read_light durante a
+ *                  conversão, espera aht10_ms_until_ready (a tarefa fica
+ *                  livre: seria um timer do FreeRTOS) e aht10_collect,
+ *                  repetindo a coleta enquanto o bit de busy estiver ativo
+ *
+ * Metade das conversões do simulador passa do tempo nominal (95 ms), para
+ * exercitar a nova tentativa pelo bit de busy nos dois modos.
+ *
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - leituras dos dois modos idênticas bit a bit, e iguais à conversão
+ *     de referência do datasheet em ponto flutuante (±1 centésimo)
+ *   - tempo ocupado por ciclo no disparo/coleta abaixo de 1/4 do bloqueante
+ *   - BH1750 lido antes do fim da conversão do AHT10
+ *   - coleta antecipada devolve false e mantém a conversão pendente
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Iinclude -Idrivers \
+ *       tools/replay/aht10_bench.c drivers/aht10.c drivers/bh1750.c -lm -o aht10_bench
+ *
+ * Uso:
+ *   ./aht10_bench [ciclos, padrão 500]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "aht10.h"
+#include "bh1750.h"
+
+#define SIM_BUS_HZ 100000u
+
+// Conversão real do AHT10: metade dentro do nominal, metade acima
+#define SIM_AHT10_FAST_US 75000u
+#define SIM_AHT10_SLOW_US 95000u
+
+// ============= BARRAMENTO SIMULADO =============
+
+struct replay_i2c_bus {
+    uint index;
+};
+
+static struct replay_i2c_bus g_bus = { .index = 0 };
+i2c_inst_t *const i2c0 = &g_bus;
+i2c_inst_t *const i2c1 = &g_bus;
+
+static uint64_t g_now_us;
+
+absolute_time_t get_absolute_time(void) { return g_now_us; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return g_now_us; }
+uint32_t time_us_32(void) { return (uint32_t)g_now_us; }
+void sleep_us(uint64_t us) { g_now_us += us; }
+void sleep_ms(uint32_t ms) { g_now_us += (uint64_t)ms * 1000u; }
+
+typedef struct {
+    uint32_t rng;
+    uint32_t conversions;
+    uint64_t busy_until_us;
+    uint8_t frame[6];
+    uint32_t raw_temp;
+    uint32_t raw_hum;
+} sim_aht10_t;
+
+static sim_aht10_t g_aht;
+
+static uint32_t sim_rand(void) {
+    g_aht.rng = g_aht.rng * 1103515245u + 12345u;
+    return g_aht.rng >> 8;
+}
+
+// Nova conversão: valores brutos de 20 bits na faixa útil do sensor
+static void sim_aht10_measure(void) {
+    g_aht.raw_hum = sim_rand() & 0xFFFFFu;
+    g_aht.raw_temp = 0x40000u + (sim_rand() % 0x80000u);   // 0 °C a 100 °C
+
+    g_aht.frame[0] = AHT10_STATUS_CALIBRATED;
+    g_aht.frame[1] = (uint8_t)(g_aht.raw_hum >> 12);
+    g_aht.frame[2] = (uint8_t)(g_aht.raw_hum >> 4);
+    g_aht.frame[3] = (uint8_t)(((g_aht.raw_hum & 0x0Fu) << 4) | (g_aht.raw_temp >> 16));
+    g_aht.frame[4] = (uint8_t)(g_aht.raw_temp >> 8);
+    g_aht.frame[5] = (uint8_t)g_aht.raw_temp;
+
+    uint32_t conversion_us = (g_aht.conversions++ & 1u) ? SIM_AHT10_SLOW_US : SIM_AHT10_FAST_US;
+    g_aht.busy_until_us = g_now_us + conversion_us;
+}
+
+// Endereço + dados, 9 bits por byte, mais START/STOP
+static void bus_transfer(size_t len) {
+    g_now_us += ((uint64_t)(len + 1) * 9u * 1000000u + SIM_BUS_HZ - 1) / SIM_BUS_HZ + 10u;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)nostop;
+    bus_transfer(len);
+
+    if (addr == AHT10_I2C_ADDR) {
+        if (len > 0 && src[0] == AHT10_CMD_MEASURE) sim_aht10_measure();
+        return (int)len;
+    }
+    if (addr == BH1750_ADDR_LOW) return (int)len;
+    return PICO_ERROR_GENERIC;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)i2c;
+    (void)nostop;
+    bus_transfer(len);
+
+    if (addr == AHT10_I2C_ADDR) {
+        for (size_t i = 0; i < len; i++) dst[i] = i < sizeof(g_aht.frame) ? g_aht.frame[i] : 0;
+        if (len > 0 && g_now_us < g_aht.busy_until_us) dst[0] |= AHT10_STATUS_BUSY;
+        return (int)len;
+    }
+    if (addr == BH1750_ADDR_LOW) {
+        for (size_t i = 0; i < len; i++) dst[i] = (uint8_t)(0x12 + i);
+        return (int)len;
+    }
+    return PICO_ERROR_GENERIC;
+}
+
+// ============= MODOS DE LEITURA =============
+
+typedef struct {
+    int32_t temp;
+    int32_t hum;
+    uint32_t raw_temp;
+    uint32_t raw_hum;
+} reading_t;
+
+typedef struct {
+    uint32_t ok;
+    uint32_t failures;
+    uint64_t busy_us;          // Tempo da tarefa presa nos drivers (transferências e sleeps)
+    uint64_t cycle_us;         // Do início do ciclo até as duas leituras
+    uint64_t bh_latency_us;    // Do início do ciclo até a leitura do BH1750
+    uint32_t collect_retries;
+} mode_result_t;
+
+static aht10_t s_aht;
+static bh1750_t s_bh;
+
+static void setup(uint32_t seed) {
+    g_now_us = 0;
+    memset(&g_aht, 0, sizeof(g_aht));
+    g_aht.rng = seed;
+    aht10_init(&s_aht, &g_bus, AHT10_I2C_ADDR);
+    bh1750_init(&s_bh, &g_bus, BH1750_ADDR_LOW);
+}
+
+static void run_blocking(uint32_t cycles, reading_t *out, mode_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    for (uint32_t c = 0; c < cycles; c++) {
+        uint64_t start = g_now_us;
+        int32_t lux;
+
+        bool ok = aht10_read_temperature_humidity(&s_aht, &out[c].temp, &out[c].hum);
+        out[c].raw_temp = g_aht.raw_temp;
+        out[c].raw_hum = g_aht.raw_hum;
+        bh1750_read_light(&s_bh, &lux);
+
+        r->bh_latency_us += g_now_us - start;
+        r->cycle_us += g_now_us - start;
+        r->busy_us += g_now_us - start;
+        if (ok) r->ok++;
+        else r->failures++;
+
+        g_now_us += 100000u;   // Resto do período da tarefa
+    }
+}
+
+static void run_split(uint32_t cycles, reading_t *out, mode_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    for (uint32_t c = 0; c < cycles; c++) {
+        uint64_t start = g_now_us;
+        uint64_t idle = 0;
+        int32_t lux;
+
+        bool ok = aht10_start_measurement(&s_aht);
+        bh1750_read_light(&s_bh, &lux);
+        r->bh_latency_us += g_now_us - start;
+
+        // A tarefa bloqueia num timer até o fim nominal: tempo livre
+        uint32_t wait_ms = aht10_ms_until_ready(&s_aht, to_ms_since_boot(get_absolute_time()));
+        g_now_us += (uint64_t)wait_ms * 1000u;
+        idle += (uint64_t)wait_ms * 1000u;
+
+        ok = ok && aht10_collect(&s_aht, &out[c].temp, &out[c].hum);
+        for (int tentativa = 0; !ok && s_aht.medicao_em_andamento && tentativa < 5; tentativa++) {
+            g_now_us += 10000u;
+            idle += 10000u;
+            r->collect_retries++;
+            ok = aht10_collect(&s_aht, &out[c].temp, &out[c].hum);
+        }
+        out[c].raw_temp = g_aht.raw_temp;
+        out[c].raw_hum = g_aht.raw_hum;
+
+        r->cycle_us += g_now_us - start;
+        r->busy_us += g_now_us - start - idle;
+        if (ok) r->ok++;
+        else r->failures++;
+
+        g_now_us += 100000u;
+    }
+}
+
+// ============= VERIFICAÇÕES =============
+
+// Conversão do datasheet: T = raw / 2^20 * 200 - 50, UR = raw / 2^20 * 100
+static bool matches_reference(const reading_t *r) {
+    double t = (double)r->raw_temp / 1048576.0 * 20000.0 - 5000.0;
+    double h = (double)r->raw_hum / 1048576.0 * 10000.0;
+    return fabs(r->temp - t) <= 1.0 && fabs(r->hum - h) <= 1.0;
+}
+
+// Coleta antes do fim da conversão: false, conversão ainda pendente
+static bool check_early_collect(void) {
+    int32_t t, h;
+    setup(7);
+    if (!aht10_start_measurement(&s_aht)) return false;
+    if (aht10_ms_until_ready(&s_aht, to_ms_since_boot(get_absolute_time())) == 0) return false;
+    if (aht10_measurement_ready(&s_aht)) return false;
+    if (aht10_collect(&s_aht, &t, &h)) return false;
+    if (!s_aht.medicao_em_andamento) return false;
+
+    g_now_us += SIM_AHT10_SLOW_US;
+    return aht10_measurement_ready(&s_aht) && aht10_collect(&s_aht, &t, &h) &&
+           !s_aht.medicao_em_andamento;
+}
+
+static void print_result(const char *name, const mode_result_t *r, uint32_t cycles) {
+    printf("%-14s ok=%u falhas=%u ocupado_medio=%.2fms ciclo_medio=%.2fms bh1750_latencia=%.2fms "
+           "novas_coletas=%u\n",
+           name, r->ok, r->failures, r->busy_us / 1000.0 / cycles, r->cycle_us / 1000.0 / cycles,
+           r->bh_latency_us / 1000.0 / cycles, r->collect_retries);
+}
+
+int main(int argc, char **argv) {
+    uint32_t cycles = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 500;
+    if (cycles == 0) cycles = 1;
+
+    reading_t *blocking = calloc(cycles, sizeof(reading_t));
+    reading_t *split = calloc(cycles, sizeof(reading_t));
+    if (!blocking || !split) return 1;
+
+    mode_result_t rb, rs;
+    setup(1234);
+    run_blocking(cycles, blocking, &rb);
+    setup(1234);
+    run_split(cycles, split, &rs);
+
+    print_result("bloqueante", &rb, cycles);
+    print_result("disparo/coleta", &rs, cycles);
+
+    uint32_t mismatches = 0;
+    uint32_t off_reference = 0;
+    for (uint32_t c = 0; c < cycles; c++) {
+        if (blocking[c].temp != split[c].temp || blocking[c].hum != split[c].hum) mismatches++;
+        if (!matches_reference(&split[c])) off_reference++;
+    }
+    bool early_ok = check_early_collect();
+
+    printf("leituras=%u divergentes=%u fora_da_referencia=%u coleta_antecipada=%s\n",
+           cycles, mismatches, off_reference, early_ok ? "ok" : "FALHOU");
+
+    bool pass = rb.failures == 0 && rs.failures == 0 && mismatches == 0 && off_reference == 0 &&
+                early_ok && rs.busy_us * 4 < rb.busy_us &&
+                rs.bh_latency_us < (uint64_t)cycles * AHT10_MEASUREMENT_TIME_MS * 1000u;
+
+    free(blocking);
+    free(split);
+    if (!pass) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
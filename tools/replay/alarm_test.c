@@ -0,0 +1,299 @@
+/*
+ * Disparo por alarme de hardware com relógio falso
+ *
+ * Roda o sensor_scheduler do firmware num laço que reproduz a task de
+ * sensores (sensors_sleep_until em src/rtos/task_sensors.c): arma um
+ * alarme no próximo prazo, limitado a SENSORS_MAX_SLEEP_MS, e dorme na
+ * notificação da task. O alarme acorda a task com a latência da
+ * interrupção e da troca de contexto; sem alarme livre vale o timeout do
+ * tick de 1 ms, e um prazo que vence antes de armar o alarme faz a
+ * passada rodar de novo. Todos os cenários começam perto de 2^32 ms
+ * (~49,7 dias), onde o contador de ms de to_ms_since_boot dá a volta, e
+ * atravessam várias voltas de 2^32 µs (~71,6 min). Cenários:
+ *
+ *   alarme       AHT10 (2000 ms, conversão 80 ms): 98% dos despertares
+ *                0-50 µs depois do prazo, 2% 0,2-3,2 ms; 1 em 500
+ *                passadas perde a CPU antes de armar o alarme e volta a
+ *                até 1 ms do prazo, antes ou depois dele
+ *   botoes       o mesmo, com botões acordando a task antes do prazo
+ *   sem_alarme   nenhum alarme livre: só o timeout do tick
+ *   longo        período de 5 s, maior que SENSORS_MAX_SLEEP_MS
+ *
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - nenhum disparo antes do agendado e nenhum disparo a mais ou a
+ *     menos (sem deriva: o agendado é o primeiro disparo + k períodos)
+ *   - o timestamp entregue à coleta é o instante do disparo, não o da
+ *     coleta, e os intervalos em ms truncados para 32 bits seguem certos
+ *     através da volta do contador
+ *   - mínimo e máximo do jitter iguais aos exatos; p99 do histograma
+ *     entre o exato e o exato + 25%
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Iinclude tools/replay/alarm_test.c \
+ *       src/sensor_scheduler.c src/jitter_stats.c -o alarm_test
+ *
+ * Uso:
+ *   ./alarm_test [amostras por cenário, padrão 50000]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sensor_scheduler.h"
+
+// Mesmos valores de src/rtos/task_sensors.c e do FreeRTOSConfig.h
+#define SENSORS_MAX_SLEEP_MS 1000u
+#define TICK_US              1000u
+
+// Início: 10 min antes da volta do contador de ms
+#define START_US ((((uint64_t)1 << 32) - 600000u) * 1000u)
+
+// Tempo de barramento por disparo e por coleta
+#define BUS_START_US   150u
+#define BUS_COLLECT_US 300u
+
+// ============= RELÓGIO FALSO =============
+
+static uint64_t g_now_us;
+static uint32_t g_rng = 7;
+
+static uint64_t fake_clock(void) {
+    return g_now_us;
+}
+
+static uint32_t sim_rand(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// Do alarme até a task rodar: em geral rápido, às vezes atrás de outra
+// interrupção ou de uma task de prioridade maior
+static uint32_t wake_latency_us(void) {
+    if (sim_rand() % 100u < 98u) return sim_rand() % 51u;
+    return 200u + sim_rand() % 3001u;
+}
+
+// ============= TASK SIMULADA =============
+
+typedef enum {
+    ALARMS_AVAILABLE,
+    ALARMS_EXHAUSTED,   // add_alarm_at devolve -1
+} alarm_pool_t;
+
+typedef struct {
+    alarm_pool_t pool;
+    uint32_t button_every;    // 1 em N sonos é interrompido por botão (0 = nunca)
+    uint32_t preempt_every;   // 1 em N passadas perde a CPU antes de armar (0 = nunca)
+
+    uint32_t sleeps;
+    uint32_t alarm_wakes;
+    uint32_t tick_wakes;
+    uint32_t button_wakes;
+    uint32_t past_deadlines;  // add_alarm_at devolveu 0
+} sim_task_t;
+
+// sensors_sleep_until com o alarme e a notificação simulados
+static void sim_sleep_until(sim_task_t *task, uint64_t deadline_us) {
+    uint64_t now_us = g_now_us;
+    uint64_t max_us = now_us + (uint64_t)SENSORS_MAX_SLEEP_MS * 1000u;
+    if (deadline_us > max_us) {
+        deadline_us = max_us;
+    }
+    if (deadline_us <= now_us) {
+        return;
+    }
+
+    // Preempção entre ler o relógio e armar o alarme, até perto do prazo
+    // (a 1 ms dele, antes ou depois)
+    if (task->preempt_every && sim_rand() % task->preempt_every == 0) {
+        uint64_t resume_us = deadline_us - 1000u + sim_rand() % 2001u;
+        if (resume_us > g_now_us) g_now_us = resume_us;
+    }
+
+    task->sleeps++;
+    uint64_t wake_us;
+    if (task->pool == ALARMS_EXHAUSTED) {
+        // ulTaskNotifyTake(timeout): acorda quando o tick chega a
+        // tick_atual + timeout, entre timeout - 1 e timeout ms depois
+        uint32_t timeout_ms = (uint32_t)((deadline_us - now_us + 999u) / 1000u);
+        wake_us = (g_now_us / TICK_US + timeout_ms) * TICK_US + wake_latency_us();
+        task->tick_wakes++;
+    } else if (deadline_us <= g_now_us) {
+        task->past_deadlines++;
+        return;
+    } else {
+        wake_us = deadline_us + wake_latency_us();
+        task->alarm_wakes++;
+    }
+
+    if (task->button_every && sim_rand() % task->button_every == 0 && wake_us > g_now_us + 1) {
+        wake_us = g_now_us + 1 + sim_rand() % (uint32_t)(wake_us - g_now_us - 1);
+        task->button_wakes++;
+    }
+    if (wake_us > g_now_us) g_now_us = wake_us;
+}
+
+// ============= SENSOR SIMULADO =============
+
+typedef struct {
+    uint32_t conversion_us;
+    size_t capacity;
+    size_t starts;
+    size_t collects;
+    uint64_t *start_us;        // Relógio no início de cada disparo
+    uint64_t *capture_us;      // Timestamp recebido na coleta
+    uint32_t wrong_capture;    // Coletas com timestamp diferente do disparo
+    uint32_t early_collects;
+} sim_sensor_t;
+
+static bool sim_start(void *ctx) {
+    sim_sensor_t *s = (sim_sensor_t *)ctx;
+    if (s->starts < s->capacity) s->start_us[s->starts] = g_now_us;
+    s->starts++;
+    g_now_us += BUS_START_US;
+    return true;
+}
+
+static sensor_sched_result_t sim_collect(void *ctx, bool last_attempt, uint64_t capture_us) {
+    sim_sensor_t *s = (sim_sensor_t *)ctx;
+    (void)last_attempt;
+
+    size_t i = s->starts - 1;
+    if (i < s->capacity) {
+        s->capture_us[i] = capture_us;
+        if (capture_us != s->start_us[i]) s->wrong_capture++;
+    }
+    if (g_now_us < capture_us + s->conversion_us) s->early_collects++;
+    s->collects++;
+    g_now_us += BUS_COLLECT_US;
+    return SENSOR_SCHED_OK;
+}
+
+// ============= CENÁRIOS =============
+
+static bool g_failed;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FALHOU: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_scenario(const char *name, sim_task_t *task, uint32_t period_ms, size_t n) {
+    sim_sensor_t s = { 0 };
+    s.conversion_us = 75000u;
+    s.capacity = n;
+    s.start_us = calloc(n, sizeof(*s.start_us));
+    s.capture_us = calloc(n, sizeof(*s.capture_us));
+    uint32_t *lateness = calloc(n, sizeof(*lateness));
+    if (!s.start_us || !s.capture_us || !lateness) {
+        fprintf(stderr, "alarm_test: sem memoria\n");
+        exit(1);
+    }
+
+    sensor_scheduler_t sched;
+    g_now_us = START_US;
+    sensor_scheduler_init(&sched, fake_clock);
+    sensor_scheduler_add(&sched, name, period_ms, 80, sim_start, sim_collect, &s);
+
+    // Laço da task: passada, dorme até o prazo, passada... até a coleta
+    // do último disparo
+    uint64_t deadline = sensor_scheduler_run(&sched);
+    while (s.collects < n) {
+        sim_sleep_until(task, deadline);
+        deadline = sensor_scheduler_run(&sched);
+    }
+
+    // Agendado: primeiro disparo + k períodos
+    uint64_t period_us = (uint64_t)period_ms * 1000u;
+    uint32_t early = 0, wrong_ms_interval = 0;
+    uint32_t wrap_crossings = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t scheduled = s.start_us[0] + i * period_us;
+        if (s.start_us[i] < scheduled) {
+            early++;
+            lateness[i] = 0;
+        } else {
+            lateness[i] = (uint32_t)(s.start_us[i] - scheduled);
+        }
+        if (i == 0) continue;
+
+        // Consumidores que guardam o instante em ms de 32 bits
+        uint32_t prev_ms = (uint32_t)(s.capture_us[i - 1] / 1000u);
+        uint32_t cur_ms = (uint32_t)(s.capture_us[i] / 1000u);
+        uint32_t exact_ms = (uint32_t)(s.capture_us[i] / 1000u - s.capture_us[i - 1] / 1000u);
+        if ((uint32_t)(cur_ms - prev_ms) != exact_ms) wrong_ms_interval++;
+        if (cur_ms < prev_ms) wrap_crossings++;
+    }
+
+    sensor_sched_stats_t st;
+    sensor_scheduler_get_stats(&sched, 0, &st);
+
+    qsort(lateness, n, sizeof(*lateness), cmp_u32);
+    size_t rank = (n * 990u + 999u) / 1000u;
+    uint32_t exact_p99 = lateness[rank - 1];
+    uint32_t hist_p99 = jitter_stats_percentile_us(&st.jitter, 990);
+    uint64_t last_scheduled = s.start_us[0] + (n - 1) * period_us;
+    uint64_t drift_us = s.start_us[n - 1] - last_scheduled;
+
+    printf("%s (periodo %ums, %zu amostras, inicio %.2f dias)\n", name, period_ms, n,
+           (double)START_US / 86400e6);
+    printf("  sonos=%u por_alarme=%u por_tick=%u por_botao=%u prazo_vencido=%u\n", task->sleeps,
+           task->alarm_wakes, task->tick_wakes, task->button_wakes, task->past_deadlines);
+    printf("  disparos=%u amostras=%u adiantados=%u timestamp_errado=%u coleta_cedo=%u "
+           "intervalo_ms_errado=%u voltas_ms=%u deriva_final=%lluus\n",
+           st.starts, st.samples, early, s.wrong_capture, s.early_collects, wrong_ms_interval,
+           wrap_crossings, (unsigned long long)drift_us);
+    printf("  jitter min=%u/%u max=%u/%u p99=%u/%u (histograma/exato) medio=%uus\n", st.jitter.min_us,
+           lateness[0], st.jitter.max_us, lateness[n - 1], hist_p99, exact_p99,
+           jitter_stats_mean_us(&st.jitter));
+
+    check(st.starts == n && st.samples == n && st.failures == 0, "disparos e amostras");
+    check(early == 0, "disparo antes do agendado");
+    check(s.wrong_capture == 0, "timestamp da amostra e o do disparo");
+    check(s.early_collects == 0, "coleta antes da conversao");
+    check(wrong_ms_interval == 0 && wrap_crossings >= 1, "intervalos em ms atraves da volta");
+    check(st.jitter.min_us == lateness[0] && st.jitter.max_us == lateness[n - 1], "minimo e maximo do jitter");
+    check(hist_p99 >= exact_p99 && hist_p99 <= exact_p99 + exact_p99 / 4u + 1u, "p99 do histograma");
+
+    free(s.start_us);
+    free(s.capture_us);
+    free(lateness);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 50000;
+    if (n < 1000) n = 1000;
+
+    sim_task_t alarm = { .pool = ALARMS_AVAILABLE, .preempt_every = 500 };
+    run_scenario("alarme", &alarm, 2000, n);
+    check(alarm.past_deadlines > 0, "prazo vencido ao armar o alarme exercitado");
+
+    sim_task_t buttons = { .pool = ALARMS_AVAILABLE, .button_every = 20, .preempt_every = 500 };
+    run_scenario("botoes", &buttons, 2000, n);
+    check(buttons.button_wakes > 0, "despertares por botao exercitados");
+
+    sim_task_t no_alarm = { .pool = ALARMS_EXHAUSTED };
+    run_scenario("sem_alarme", &no_alarm, 2000, n);
+
+    sim_task_t long_period = { .pool = ALARMS_AVAILABLE };
+    run_scenario("longo", &long_period, 5000, n / 5);
+    check(long_period.sleeps >= (n / 5) * 5u, "sono limitado a SENSORS_MAX_SLEEP_MS");
+
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
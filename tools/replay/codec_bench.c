@@ -0,0 +1,288 @@
+/*
+ * Codec das páginas do log (series_codec.c): ida e volta, compressão e custo
+ *
+ * Codifica séries em blocos do tamanho do payload de uma página do
+ * sample_log (SAMPLE_LOG_PAYLOAD_SIZE bytes, até 255 amostras, como o
+ * log faz), decodifica e compara bit a bit. Séries:
+ *
+ *   log        o que a task_storage grava: luz, temperatura e umidade a
+ *              cada 10 s num ciclo diário sintético com ruído, com o
+ *              atraso de acordar da task
+ *   luz        BH1750 a cada 200 ms com jitter de até 3 ms
+ *   falhas     como "log", mas com leituras inválidas alternando a máscara
+ *   extremos   instantes e valores aleatórios em toda a faixa de 32 bits,
+ *              inclusive a volta do relógio em t_ms (pior caso)
+ *
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - toda amostra volta idêntica (instante, máscara e valores presentes)
+ *   - o decodificador para ao fim do bloco
+ *   - uma amostra recusada por falta de espaço não altera o bloco
+ *   - na série "log", no máximo metade dos bytes do registro fixo do
+ *     formato antigo (12 bytes)
+ *
+ * Também mede bytes e bits por amostra, amostras por página e o custo de
+ * codificar e decodificar cada amostra.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Iinclude tools/replay/codec_bench.c src/series_codec.c \
+ *       -o codec_bench
+ *
+ * Uso:
+ *   ./codec_bench [amostras por série, padrão 20000]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sample_log.h"
+#include "series_codec.h"
+
+// Mesmo intervalo da task_storage
+#define STORAGE_SAMPLE_INTERVAL_MS 10000u
+#define LUX_PERIOD_MS 200u
+
+// Registro fixo que as páginas do log usavam antes da compressão
+#define RAW_RECORD_SIZE 12u
+
+#define ALL_METRICS ((1u << TS_METRIC_COUNT) - 1u)
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t g_rng = 2024;
+
+static uint32_t sim_rand(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// ============= SÉRIES =============
+
+typedef enum {
+    SERIES_LOG,
+    SERIES_LUX,
+    SERIES_FAULTS,
+    SERIES_EXTREME,
+    SERIES_COUNT,
+} series_kind_t;
+
+static const char *const SERIES_NAMES[SERIES_COUNT] = { "log", "luz", "falhas", "extremos" };
+
+static int32_t noise(int32_t amplitude) {
+    return (int32_t)(sim_rand() % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Ciclo diário em rampa (mínimo à meia-noite, máximo ao meio-dia) com o
+// ruído de leitura dos sensores, em centésimos
+static void read_sensors(series_sample_t *s, uint32_t t_ms, uint32_t mask) {
+    int32_t phase = (int32_t)((t_ms / 1000u) % 86400u);
+    int32_t ramp = phase < 43200 ? phase : 86400 - phase;   // 0..43200
+
+    s->valid_mask = 0;
+    memset(s->value, 0, sizeof(s->value));
+    if (mask & (1u << TS_METRIC_TEMPERATURE)) {
+        s->valid_mask |= (1u << TS_METRIC_TEMPERATURE) | (1u << TS_METRIC_HUMIDITY);
+        s->value[TS_METRIC_TEMPERATURE] = 1800 + ramp * 800 / 43200 + noise(3);
+        s->value[TS_METRIC_HUMIDITY] = 7000 - ramp * 2000 / 43200 + noise(15);
+    }
+    if (mask & (1u << TS_METRIC_LUX)) {
+        s->valid_mask |= 1u << TS_METRIC_LUX;
+        s->value[TS_METRIC_LUX] = (ramp > 10800 ? (ramp - 10800) * 6 : 0) + 50 + noise(20);
+    }
+}
+
+static void generate_series(series_kind_t kind, series_sample_t *out, size_t n) {
+    if (kind == SERIES_EXTREME) {
+        uint32_t t = UINT32_MAX - 5000u;   // Passa pela volta do relógio
+        for (size_t i = 0; i < n; i++) {
+            t += sim_rand() % 4u == 0 ? sim_rand() : sim_rand() % 100000u;
+            out[i].t_ms = t;
+            out[i].valid_mask = (uint8_t)(sim_rand() & ALL_METRICS);
+            for (int m = 0; m < TS_METRIC_COUNT; m++) {
+                out[i].value[m] = (out[i].valid_mask & (1u << m)) ? (int32_t)sim_rand() : 0;
+            }
+        }
+        return;
+    }
+
+    uint32_t period = kind == SERIES_LUX ? LUX_PERIOD_MS : STORAGE_SAMPLE_INTERVAL_MS;
+    uint32_t mask = kind == SERIES_LUX ? (1u << TS_METRIC_LUX) : ALL_METRICS;
+    for (size_t i = 0; i < n; i++) {
+        // Atraso de acordar: a task_storage até 30 ms, a de sensores até 3 ms
+        uint32_t late = sim_rand() % (kind == SERIES_LUX ? 4u : 31u);
+        uint32_t t_ms = (uint32_t)i * period + late;
+
+        read_sensors(&out[i], t_ms, mask);
+        out[i].t_ms = t_ms;
+
+        // Um sensor fora em trechos de 20 amostras a cada 50
+        if (kind == SERIES_FAULTS && (i / 20) % 5 == 2) {
+            int m = (i / 100) % 2 ? TS_METRIC_LUX : TS_METRIC_TEMPERATURE;
+            out[i].valid_mask &= (uint8_t)~(1u << m);
+            out[i].value[m] = 0;
+            if (m == TS_METRIC_TEMPERATURE) {
+                out[i].valid_mask &= (uint8_t)~(1u << TS_METRIC_HUMIDITY);
+                out[i].value[TS_METRIC_HUMIDITY] = 0;
+            }
+        }
+    }
+}
+
+// ============= IDA E VOLTA =============
+
+static bool g_failed;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FALHOU: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static bool same_sample(const series_sample_t *a, const series_sample_t *b) {
+    if (a->t_ms != b->t_ms || a->valid_mask != b->valid_mask) return false;
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if ((a->valid_mask & (1u << m)) && a->value[m] != b->value[m]) return false;
+    }
+    return true;
+}
+
+// Um bloco por página, como o sample_log
+typedef struct {
+    uint8_t payload[SAMPLE_LOG_PAYLOAD_SIZE];
+    size_t bytes;
+    uint16_t count;
+} block_t;
+
+typedef struct {
+    size_t blocks;
+    size_t bytes;
+    size_t mismatched;
+    size_t overrun;          // Decodificador não parou ao fim do bloco
+    size_t rejected_changed; // Recusa que alterou o bloco
+    double encode_ns;
+    double decode_ns;
+} series_result_t;
+
+static size_t encode_blocks(const series_sample_t *samples, size_t n, block_t *blocks, series_result_t *r) {
+    size_t nb = 0;
+    series_encoder_t enc;
+    series_encoder_init(&enc, blocks[0].payload, SAMPLE_LOG_PAYLOAD_SIZE);
+
+    for (size_t i = 0; i < n; i++) {
+        if (enc.count < SAMPLE_LOG_PAGE_MAX_ENTRIES && series_encoder_add(&enc, &samples[i])) continue;
+
+        // Recusa: nada do bloco pode mudar
+        if (enc.count < SAMPLE_LOG_PAGE_MAX_ENTRIES) {
+            uint8_t before[SAMPLE_LOG_PAYLOAD_SIZE];
+            memcpy(before, blocks[nb].payload, sizeof(before));
+            series_encoder_t enc_before = enc;
+            if (series_encoder_add(&enc, &samples[i]) || memcmp(&enc, &enc_before, sizeof(enc)) != 0 ||
+                memcmp(before, blocks[nb].payload, sizeof(before)) != 0) {
+                r->rejected_changed++;
+            }
+        }
+
+        blocks[nb].bytes = series_encoder_bytes(&enc);
+        blocks[nb].count = enc.count;
+        nb++;
+        series_encoder_init(&enc, blocks[nb].payload, SAMPLE_LOG_PAYLOAD_SIZE);
+        series_encoder_add(&enc, &samples[i]);
+    }
+    blocks[nb].bytes = series_encoder_bytes(&enc);
+    blocks[nb].count = enc.count;
+    return nb + 1;
+}
+
+static size_t decode_blocks(const block_t *blocks, size_t nb, series_sample_t *out, series_result_t *r) {
+    size_t n = 0;
+    for (size_t b = 0; b < nb; b++) {
+        series_decoder_t dec;
+        series_decoder_init(&dec, blocks[b].payload, blocks[b].bytes, blocks[b].count);
+        for (uint16_t i = 0; i < blocks[b].count; i++) {
+            if (!series_decoder_next(&dec, &out[n])) break;
+            n++;
+        }
+        series_sample_t extra;
+        if (series_decoder_next(&dec, &extra)) r->overrun++;
+    }
+    return n;
+}
+
+static series_result_t run_series(series_kind_t kind, size_t n) {
+    series_result_t r = { 0 };
+    series_sample_t *samples = calloc(n, sizeof(*samples));
+    series_sample_t *decoded = calloc(n, sizeof(*decoded));
+    block_t *blocks = calloc(n + 1, sizeof(*blocks));
+    if (!samples || !decoded || !blocks) {
+        fprintf(stderr, "codec_bench: sem memoria\n");
+        exit(1);
+    }
+    generate_series(kind, samples, n);
+
+    // Verificação numa passada; tempo como a melhor de algumas repetições
+    r.blocks = encode_blocks(samples, n, blocks, &r);
+    size_t got = decode_blocks(blocks, r.blocks, decoded, &r);
+    for (size_t i = 0; i < n; i++) {
+        if (i >= got || !same_sample(&samples[i], &decoded[i])) r.mismatched++;
+    }
+    for (size_t b = 0; b < r.blocks; b++) r.bytes += blocks[b].bytes;
+
+    r.encode_ns = r.decode_ns = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        series_result_t scratch = { 0 };
+        uint64_t t0 = mono_ns();
+        encode_blocks(samples, n, blocks, &scratch);
+        uint64_t t1 = mono_ns();
+        decode_blocks(blocks, r.blocks, decoded, &scratch);
+        uint64_t t2 = mono_ns();
+        if ((double)(t1 - t0) / n < r.encode_ns) r.encode_ns = (double)(t1 - t0) / n;
+        if ((double)(t2 - t1) / n < r.decode_ns) r.decode_ns = (double)(t2 - t1) / n;
+    }
+
+    free(samples);
+    free(decoded);
+    free(blocks);
+    return r;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 20000;
+    if (n < 1000) n = 1000;
+
+    printf("codec pagina=%u bytes de payload, max %u amostras, registro antigo=%u bytes\n",
+           SAMPLE_LOG_PAYLOAD_SIZE, SAMPLE_LOG_PAGE_MAX_ENTRIES, RAW_RECORD_SIZE);
+    for (int kind = 0; kind < SERIES_COUNT; kind++) {
+        series_result_t r = run_series((series_kind_t)kind, n);
+        double bytes_per_sample = (double)r.bytes / n;
+        printf("  %-8s amostras=%zu paginas=%zu bytes_por_amostra=%.2f bits_por_amostra=%.1f "
+               "amostras_por_pagina=%.1f razao=%.2fx codifica=%.1fns decodifica=%.1fns "
+               "diferentes=%zu passou_do_fim=%zu recusa_alterou=%zu\n",
+               SERIES_NAMES[kind], n, r.blocks, bytes_per_sample, bytes_per_sample * 8.0,
+               (double)n / r.blocks, RAW_RECORD_SIZE / bytes_per_sample, r.encode_ns, r.decode_ns,
+               r.mismatched, r.overrun, r.rejected_changed);
+
+        check(r.mismatched == 0, "amostras identicas depois da volta");
+        check(r.overrun == 0, "decodificador para ao fim do bloco");
+        check(r.rejected_changed == 0, "recusa sem alterar o bloco");
+        if (kind == SERIES_LOG) {
+            check(bytes_per_sample * 2.0 <= RAW_RECORD_SIZE, "serie log com metade dos bytes do registro antigo");
+        }
+    }
+
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * Métricas de conforto em ponto fixo (comfort_metrics.c): exatidão e custo
+ *
+ * Varre -40..80 °C e 0..100 %UR em passos de 0,1 e compara cada saída de
+ * comfort_metrics_compute() com as fórmulas de referência em double:
+ *
+ *   pressão    Magnus (WMO): 611,2 * exp(17,62 T / (243,12 + T)) Pa
+ *   orvalho    inverso da mesma fórmula, com a pressão parcial exata
+ *   absoluta   2,16679 * e / T[K] g/m³
+ *   calor      índice de calor da NOAA (Steadman abaixo de 80 °F, senão
+ *              Rothfusz com os dois ajustes), em °F e convertido para °C
+ *
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - pressão de saturação: erro relativo até 0,15 %
+ *   - ponto de orvalho: até 0,03 °C; abaixo de -40 °C (ar muito seco e
+ *     frio) o esperado é -40 °C, o extremo da tabela
+ *   - umidade absoluta: até 0,07 g/m³
+ *   - índice de calor: até 0,07 °C, exceto a 0,05 °F do limiar de 80 °F
+ *     da própria NOAA, onde o arredondamento pode escolher a outra
+ *     fórmula (o salto é da referência); esses pontos são contados à parte
+ *
+ * Também mede o custo por amostra do ponto fixo e do double com libm
+ * (o host tem FPU; no RP2040 exp() e log() são emulados).
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Iinclude \
+ *       tools/replay/comfort_bench.c src/comfort_metrics.c src/sensor_units.c -lm -o comfort_bench
+ *
+ * Uso:
+ *   ./comfort_bench
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comfort_metrics.h"
+
+#define SWEEP_STEP_CENTI 10
+
+#define MAX_SVP_REL_ERR 0.0015
+#define MAX_DEW_ERR_C 0.03
+#define MAX_AH_ERR 0.07
+#define MAX_HI_ERR_C 0.07
+#define HI_SWITCH_MARGIN_F 0.05
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ============= REFERÊNCIA =============
+
+static double ref_svp_pa(double t_c) {
+    return 611.2 * exp(17.62 * t_c / (243.12 + t_c));
+}
+
+static double ref_dew_point_c(double e_pa) {
+    double g = log(e_pa / 611.2);
+    return 243.12 * g / (17.62 - g);
+}
+
+static double ref_abs_humidity(double t_c, double e_pa) {
+    return 2.16679 * e_pa / (t_c + 273.15);
+}
+
+// Distância (°F) do critério de troca de fórmula da NOAA ao limiar
+static double ref_hi_switch_distance_f(double tf, double rh) {
+    double simple = 0.5 * (tf + 61.0 + (tf - 68.0) * 1.2 + rh * 0.094);
+    return (simple + tf) / 2.0 - 80.0;
+}
+
+static double ref_heat_index_f(double tf, double rh) {
+    double simple = 0.5 * (tf + 61.0 + (tf - 68.0) * 1.2 + rh * 0.094);
+    if ((simple + tf) / 2.0 < 80.0) return simple;
+
+    double hi = -42.379 + 2.04901523 * tf + 10.14333127 * rh - 0.22475541 * tf * rh -
+                0.00683783 * tf * tf - 0.05481717 * rh * rh + 0.00122874 * tf * tf * rh +
+                0.00085282 * tf * rh * rh - 0.00000199 * tf * tf * rh * rh;
+    if (rh < 13.0 && tf >= 80.0 && tf <= 112.0) {
+        hi -= ((13.0 - rh) / 4.0) * sqrt((17.0 - fabs(tf - 95.0)) / 17.0);
+    } else if (rh > 85.0 && tf >= 80.0 && tf <= 87.0) {
+        hi += ((rh - 85.0) / 10.0) * ((87.0 - tf) / 5.0);
+    }
+    return hi;
+}
+
+typedef struct {
+    double dew_c;
+    double ah;
+    double hi_c;
+} ref_metrics_t;
+
+static void ref_compute(double t_c, double rh, ref_metrics_t *out) {
+    double e = ref_svp_pa(t_c) * rh / 100.0;
+    out->dew_c = e > 0 ? ref_dew_point_c(e) : -INFINITY;
+    out->ah = ref_abs_humidity(t_c, e);
+    double tf = t_c * 9.0 / 5.0 + 32.0;
+    out->hi_c = (ref_heat_index_f(tf, rh) - 32.0) * 5.0 / 9.0;
+}
+
+// ============= VARREDURA =============
+
+typedef struct {
+    uint32_t points;
+    double svp_rel;
+    uint32_t svp_bad;
+    double dew;
+    uint32_t dew_bad;
+    uint32_t dew_clamped;       // Referência abaixo da tabela
+    double ah;
+    uint32_t ah_bad;
+    double hi;
+    uint32_t hi_bad;
+    uint32_t hi_switch;         // Pontos junto ao limiar da NOAA
+    double hi_switch_worst;
+} sweep_result_t;
+
+static void track(double err, double limit, double *worst, uint32_t *bad) {
+    err = fabs(err);
+    if (err > *worst) *worst = err;
+    if (err > limit) (*bad)++;
+}
+
+static void sweep(sweep_result_t *r) {
+    for (int32_t t = COMFORT_TABLE_MIN_C * 100; t <= COMFORT_TABLE_MAX_C * 100; t += SWEEP_STEP_CENTI) {
+        double t_c = t / 100.0;
+        double svp = comfort_saturation_pressure(t) / 100.0;
+        track((svp - ref_svp_pa(t_c)) / ref_svp_pa(t_c), MAX_SVP_REL_ERR, &r->svp_rel, &r->svp_bad);
+
+        for (int32_t h = 0; h <= 10000; h += SWEEP_STEP_CENTI) {
+            double rh = h / 100.0;
+            comfort_metrics_t got;
+            ref_metrics_t ref;
+            comfort_metrics_compute(t, h, &got);
+            ref_compute(t_c, rh, &ref);
+            r->points++;
+
+            // Abaixo da tabela o esperado é o extremo dela
+            double dew_want = ref.dew_c;
+            if (dew_want < COMFORT_TABLE_MIN_C) {
+                dew_want = COMFORT_TABLE_MIN_C;
+                r->dew_clamped++;
+            }
+            track(got.dew_point_centi / 100.0 - dew_want, MAX_DEW_ERR_C, &r->dew, &r->dew_bad);
+
+            track(got.abs_humidity_centi / 100.0 - ref.ah, MAX_AH_ERR, &r->ah, &r->ah_bad);
+
+            double hi_err = got.heat_index_centi / 100.0 - ref.hi_c;
+            double tf = t_c * 9.0 / 5.0 + 32.0;
+            if (fabs(ref_hi_switch_distance_f(tf, rh)) < HI_SWITCH_MARGIN_F) {
+                r->hi_switch++;
+                if (fabs(hi_err) > r->hi_switch_worst) r->hi_switch_worst = fabs(hi_err);
+            } else {
+                track(hi_err, MAX_HI_ERR_C, &r->hi, &r->hi_bad);
+            }
+        }
+    }
+}
+
+// ============= CUSTO =============
+
+static volatile int32_t g_sink;
+static volatile double g_sink_f;
+
+static void bench(double *fixed_ns, double *float_ns) {
+    enum { SAMPLES = 200000 };
+    static int32_t temps[SAMPLES], hums[SAMPLES];
+    uint32_t rng = 1;
+    for (int i = 0; i < SAMPLES; i++) {
+        rng = rng * 1103515245u + 12345u;
+        temps[i] = 1500 + (int32_t)((rng >> 8) % 2000u);     // 15..35 °C, faixa típica
+        hums[i] = 2000 + (int32_t)((rng >> 4) % 6000u);       // 20..80 %
+    }
+
+    *fixed_ns = *float_ns = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        uint64_t t0 = mono_ns();
+        int32_t acc = 0;
+        for (int i = 0; i < SAMPLES; i++) {
+            comfort_metrics_t m;
+            comfort_metrics_compute(temps[i], hums[i], &m);
+            acc += m.dew_point_centi + m.abs_humidity_centi + m.heat_index_centi;
+        }
+        uint64_t t1 = mono_ns();
+        double accf = 0;
+        for (int i = 0; i < SAMPLES; i++) {
+            ref_metrics_t m;
+            ref_compute(temps[i] / 100.0, hums[i] / 100.0, &m);
+            accf += m.dew_c + m.ah + m.hi_c;
+        }
+        uint64_t t2 = mono_ns();
+        g_sink = acc;
+        g_sink_f = accf;
+        if ((double)(t1 - t0) / SAMPLES < *fixed_ns) *fixed_ns = (double)(t1 - t0) / SAMPLES;
+        if ((double)(t2 - t1) / SAMPLES < *float_ns) *float_ns = (double)(t2 - t1) / SAMPLES;
+    }
+}
+
+int main(void) {
+    sweep_result_t r = { 0 };
+    sweep(&r);
+
+    printf("varredura %d..%d C x 0..100 %%UR, passo 0.1: pontos=%u\n", COMFORT_TABLE_MIN_C, COMFORT_TABLE_MAX_C,
+           r.points);
+    printf("  pressao   pior_erro_relativo=%.3f%% fora=%u\n", r.svp_rel * 100.0, r.svp_bad);
+    printf("  orvalho   pior_erro=%.3fC fora=%u abaixo_da_tabela=%u\n", r.dew, r.dew_bad, r.dew_clamped);
+    printf("  absoluta  pior_erro=%.3fg/m3 fora=%u\n", r.ah, r.ah_bad);
+    printf("  calor     pior_erro=%.3fC fora=%u junto_ao_limiar=%u pior_junto_ao_limiar=%.2fC\n", r.hi, r.hi_bad,
+           r.hi_switch, r.hi_switch_worst);
+
+    double fixed_ns, float_ns;
+    bench(&fixed_ns, &float_ns);
+    printf("custo por amostra (15..35 C, 20..80 %%): ponto_fixo=%.1fns double_libm=%.1fns\n", fixed_ns, float_ns);
+
+    bool ok = r.svp_bad == 0 && r.dew_bad == 0 && r.ah_bad == 0 && r.hi_bad == 0;
+    if (!ok) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
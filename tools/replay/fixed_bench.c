@@ -0,0 +1,377 @@
+/*
+ * Ponto fixo dos drivers ao texto: exatidão bit a bit e custo
+ *
+ * Roda as conversões reais dos drivers (aht10.c, bh1750.c) sobre todos
+ * os códigos brutos possíveis, com um barramento I2C simulado que
+ * devolve o quadro de cada código, e as rotinas de sensor_units.c:
+ *
+ *   aht10      os 2^20 códigos de temperatura e de umidade
+ *   bh1750     os 2^16 códigos de luminosidade
+ *   formato    sensor_units_format() com 0, 1 e 2 casas para todo valor
+ *              em ±2000,00 e os extremos de int32_t
+ *   isqrt      sensor_units_isqrt() nos 2^20 primeiros inteiros, em
+ *              quadrados perfeitos ±1 até 2^32 e em valores aleatórios
+ *
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - conversões iguais ao valor exato arredondado (meio para cima),
+ *     calculado em 64 bits com a fórmula do datasheet sem simplificar
+ *   - texto igual ao do printf com o valor deslocado para longe do zero
+ *     (mesmo arredondamento de lroundf) e sem "-0"
+ *   - isqrt igual ao piso da raiz
+ *
+ * Também conta em quantos códigos o caminho antigo em float (fórmulas de
+ * antes + lroundf) erra o centésimo, e mede o custo por conversão no
+ * host dos dois caminhos. No RP2040 (sem FPU, float emulado) a diferença
+ * é maior: a razão medida aqui é um piso.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Iinclude -Idrivers \
+ *       tools/replay/fixed_bench.c drivers/aht10.c drivers/bh1750.c src/sensor_units.c -lm -o fixed_bench
+ *
+ * Uso:
+ *   ./fixed_bench
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "aht10.h"
+#include "bh1750.h"
+#include "sensor_units.h"
+
+#define AHT10_CODES (1u << 20)
+#define BH1750_CODES (1u << 16)
+#define FORMAT_RANGE_CENTI 200000
+
+// ============= RELÓGIO =============
+
+static uint64_t g_now_us;
+
+absolute_time_t get_absolute_time(void) { return g_now_us; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return g_now_us; }
+uint32_t time_us_32(void) { return (uint32_t)g_now_us; }
+void sleep_us(uint64_t us) { g_now_us += us; }
+void sleep_ms(uint32_t ms) { g_now_us += (uint64_t)ms * 1000u; }
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// ============= BARRAMENTO SIMULADO =============
+
+// Quadros devolvidos pelos sensores: o harness escolhe o código bruto
+static uint8_t g_aht_frame[6];
+static uint8_t g_bh_frame[2];
+
+struct replay_i2c_bus {
+    uint index;
+};
+
+static struct replay_i2c_bus g_bus[2] = { { 0 }, { 1 } };
+i2c_inst_t *const i2c0 = &g_bus[0];
+i2c_inst_t *const i2c1 = &g_bus[1];
+
+uint i2c_get_index(i2c_inst_t *i2c) { return i2c->index; }
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)src;
+    (void)nostop;
+    return (addr == AHT10_I2C_ADDR || addr == BH1750_ADDR_LOW) ? (int)len : PICO_ERROR_GENERIC;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)i2c;
+    (void)nostop;
+    const uint8_t *frame;
+    size_t frame_len;
+    if (addr == AHT10_I2C_ADDR) {
+        frame = g_aht_frame;
+        frame_len = sizeof(g_aht_frame);
+    } else if (addr == BH1750_ADDR_LOW) {
+        frame = g_bh_frame;
+        frame_len = sizeof(g_bh_frame);
+    } else {
+        return PICO_ERROR_GENERIC;
+    }
+    for (size_t i = 0; i < len; i++) dst[i] = i < frame_len ? frame[i] : 0;
+    return (int)len;
+}
+
+// Mesmo código nas duas grandezas: um quadro cobre temperatura e umidade
+static void set_aht_code(uint32_t code) {
+    g_aht_frame[0] = AHT10_STATUS_CALIBRATED;
+    g_aht_frame[1] = (uint8_t)(code >> 12);
+    g_aht_frame[2] = (uint8_t)(code >> 4);
+    g_aht_frame[3] = (uint8_t)(((code & 0x0Fu) << 4) | (code >> 16));
+    g_aht_frame[4] = (uint8_t)(code >> 8);
+    g_aht_frame[5] = (uint8_t)code;
+}
+
+static void set_bh_code(uint32_t code) {
+    g_bh_frame[0] = (uint8_t)(code >> 8);
+    g_bh_frame[1] = (uint8_t)code;
+}
+
+// ============= REFERÊNCIAS =============
+
+static bool g_failed;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FALHOU: %s\n", what);
+        g_failed = true;
+    }
+}
+
+// Arredondamento para o mais próximo, meio para cima, de num / den (num >= 0)
+static int64_t round_div(int64_t num, int64_t den) {
+    return (2 * num + den) / (2 * den);
+}
+
+// Datasheet: T = raw / 2^20 * 200 - 50 °C, RH = raw / 2^20 * 100 %
+static int32_t ref_temperature_centi(uint32_t code) {
+    return (int32_t)(round_div((int64_t)code * 20000, 1ll << 20) - 5000);
+}
+
+static int32_t ref_humidity_centi(uint32_t code) {
+    return (int32_t)round_div((int64_t)code * 10000, 1ll << 20);
+}
+
+// Datasheet: lux = raw / 1,2 (modo de alta resolução)
+static int32_t ref_lux_centi(uint32_t code) {
+    return (int32_t)round_div((int64_t)code * 1000, 12);
+}
+
+// Caminho antigo: conversão em float nos drivers e lroundf() na saída.
+// volatile impede o compilador de dobrar as contas em tempo de compilação
+static volatile float g_float_scale = 100.0f;
+
+static int32_t old_temperature_centi(uint32_t code) {
+    float t = ((code * 200.0f) / (1 << 20)) - 50.0f;
+    return (int32_t)lroundf(t * g_float_scale);
+}
+
+static int32_t old_humidity_centi(uint32_t code) {
+    float h = (code * 100.0f) / (1 << 20);
+    return (int32_t)lroundf(h * g_float_scale);
+}
+
+static int32_t old_lux_centi(uint32_t code) {
+    float lux = code / 1.2f;
+    return (int32_t)lroundf(lux * g_float_scale);
+}
+
+// ============= CONVERSÕES =============
+
+static aht10_t s_aht;
+static bh1750_t s_bh;
+
+static bool read_aht(uint32_t code, int32_t *temp, int32_t *hum) {
+    set_aht_code(code);
+    return aht10_start_measurement(&s_aht) && aht10_collect(&s_aht, temp, hum);
+}
+
+static void run_aht10(void) {
+    uint32_t wrong_temp = 0, wrong_hum = 0, read_errors = 0, ties = 0;
+    uint32_t old_wrong_temp = 0, old_wrong_hum = 0;
+
+    for (uint32_t code = 0; code < AHT10_CODES; code++) {
+        int32_t temp, hum;
+        if (!read_aht(code, &temp, &hum)) {
+            read_errors++;
+            continue;
+        }
+        if (temp != ref_temperature_centi(code)) wrong_temp++;
+        if (hum != ref_humidity_centi(code)) wrong_hum++;
+        if (((int64_t)code * 20000) % (1ll << 20) == (1ll << 19)) ties++;
+        if (old_temperature_centi(code) != ref_temperature_centi(code)) old_wrong_temp++;
+        if (old_humidity_centi(code) != ref_humidity_centi(code)) old_wrong_hum++;
+    }
+
+    printf("aht10   codigos=%u temp_errada=%u umid_errada=%u erros_leitura=%u empates=%u "
+           "float_temp_errada=%u float_umid_errada=%u\n",
+           AHT10_CODES, wrong_temp, wrong_hum, read_errors, ties, old_wrong_temp, old_wrong_hum);
+    check(wrong_temp == 0 && wrong_hum == 0 && read_errors == 0, "aht10 igual ao valor exato arredondado");
+}
+
+static void run_bh1750(void) {
+    uint32_t wrong = 0, read_errors = 0, old_wrong = 0;
+
+    for (uint32_t code = 0; code < BH1750_CODES; code++) {
+        int32_t lux;
+        set_bh_code(code);
+        if (!bh1750_read_light(&s_bh, &lux)) {
+            read_errors++;
+            continue;
+        }
+        if (lux != ref_lux_centi(code)) wrong++;
+        if (old_lux_centi(code) != ref_lux_centi(code)) old_wrong++;
+    }
+
+    printf("bh1750  codigos=%u lux_errado=%u erros_leitura=%u float_lux_errado=%u\n", BH1750_CODES, wrong,
+           read_errors, old_wrong);
+    check(wrong == 0 && read_errors == 0, "bh1750 igual ao valor exato arredondado");
+}
+
+// ============= FORMATO =============
+
+// printf com o valor deslocado para longe do zero: empates como lroundf
+static void ref_format(char *buf, size_t size, int32_t centi, unsigned decimals) {
+    double v = centi / 100.0;
+    v += (centi < 0) ? -1e-7 : 1e-7;
+    snprintf(buf, size, "%.*f", (int)decimals, v);
+
+    // Sem "-0", "-0.0": zero sai sem sinal
+    bool zero = true;
+    for (const char *p = buf; *p; p++) {
+        if (*p >= '1' && *p <= '9') zero = false;
+    }
+    if (zero && buf[0] == '-') memmove(buf, buf + 1, strlen(buf));
+}
+
+static uint32_t check_format(int32_t centi, unsigned decimals) {
+    char got[SENSOR_UNITS_STR_MAX], want[32];
+    int n = sensor_units_format(got, sizeof(got), centi, decimals);
+    ref_format(want, sizeof(want), centi, decimals);
+    return (strcmp(got, want) != 0 || n != (int)strlen(got)) ? 1u : 0u;
+}
+
+static void run_format(void) {
+    uint32_t wrong[3] = { 0, 0, 0 };
+    uint32_t checked = 0;
+
+    for (unsigned d = 0; d <= 2; d++) {
+        for (int32_t centi = -FORMAT_RANGE_CENTI; centi <= FORMAT_RANGE_CENTI; centi++) {
+            wrong[d] += check_format(centi, d);
+            checked++;
+        }
+        const int32_t extremes[] = { INT32_MIN, INT32_MIN + 1, INT32_MAX, INT32_MAX - 49, -2147483599 };
+        for (size_t i = 0; i < sizeof(extremes) / sizeof(extremes[0]); i++) {
+            wrong[d] += check_format(extremes[i], d);
+            checked++;
+        }
+    }
+
+    printf("formato valores=%u errados_0casas=%u errados_1casa=%u errados_2casas=%u\n", checked, wrong[0],
+           wrong[1], wrong[2]);
+    check(wrong[0] == 0 && wrong[1] == 0 && wrong[2] == 0, "formato igual ao printf arredondado");
+}
+
+// ============= RAIZ INTEIRA =============
+
+static uint32_t g_rng = 4242;
+
+static uint32_t sim_rand(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static bool isqrt_ok(uint64_t v) {
+    uint64_t r = sensor_units_isqrt(v);
+    return r * r <= v && (r + 1) * (r + 1) > v;
+}
+
+static void run_isqrt(void) {
+    uint32_t wrong = 0, checked = 0;
+
+    for (uint64_t v = 0; v < (1u << 20); v++, checked++) {
+        if (!isqrt_ok(v)) wrong++;
+    }
+    for (uint64_t r = 1; r < (1ull << 32); r += 1 + (r >> 6), checked += 3) {
+        uint64_t sq = r * r;
+        if (!isqrt_ok(sq) || !isqrt_ok(sq - 1) || !isqrt_ok(sq + 1)) wrong++;
+    }
+    for (int i = 0; i < 1000000; i++, checked++) {
+        uint64_t v = ((uint64_t)sim_rand() << 32 | sim_rand()) >> (sim_rand() % 64u);
+        if (v >= 0xFFFFFFFE00000001ull) v >>= 1;   // r + 1 ao quadrado cabe em 64 bits
+        if (!isqrt_ok(v)) wrong++;
+    }
+
+    printf("isqrt   valores=%u errados=%u\n", checked, wrong);
+    check(wrong == 0, "isqrt igual ao piso da raiz");
+}
+
+// ============= CUSTO =============
+
+static volatile int32_t g_sink;
+
+// Só a conversão: o quadro já decodificado em código bruto
+static double bench(int32_t (*conv)(uint32_t), uint32_t codes) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        uint64_t t0 = mono_ns();
+        int32_t acc = 0;
+        for (uint32_t code = 0; code < codes; code++) acc += conv(code);
+        uint64_t dt = mono_ns() - t0;
+        g_sink = acc;
+        if ((double)dt / codes < best) best = (double)dt / codes;
+    }
+    return best;
+}
+
+// Mesmas contas dos drivers (aht10.c, bh1750.c), que são static lá
+static int32_t int_temperature_centi(uint32_t code) {
+    return (int32_t)((code * 625u + (1u << 14)) >> 15) - 5000;
+}
+
+static int32_t int_humidity_centi(uint32_t code) {
+    return (int32_t)((code * 625u + (1u << 15)) >> 16);
+}
+
+static int32_t int_lux_centi(uint32_t code) {
+    return (int32_t)((code * 250u + 1u) / 3u);
+}
+
+static void run_bench(void) {
+    // As cópias acima precisam bater com o driver, senão o custo não vale
+    uint32_t drift = 0;
+    for (uint32_t code = 0; code < AHT10_CODES; code += 7) {
+        int32_t temp, hum;
+        if (!read_aht(code, &temp, &hum) || temp != int_temperature_centi(code) ||
+            hum != int_humidity_centi(code)) {
+            drift++;
+        }
+    }
+    check(drift == 0, "copias das contas do driver iguais ao driver");
+
+    printf("custo (ns por conversao no host, melhor de 5)\n");
+    double it = bench(int_temperature_centi, AHT10_CODES), ft = bench(old_temperature_centi, AHT10_CODES);
+    double ih = bench(int_humidity_centi, AHT10_CODES), fh = bench(old_humidity_centi, AHT10_CODES);
+    double il = bench(int_lux_centi, BH1750_CODES), fl = bench(old_lux_centi, BH1750_CODES);
+    printf("  temperatura inteiro=%.2f float=%.2f razao=%.1fx\n", it, ft, ft / it);
+    printf("  umidade     inteiro=%.2f float=%.2f razao=%.1fx\n", ih, fh, fh / ih);
+    printf("  luz         inteiro=%.2f float=%.2f razao=%.1fx\n", il, fl, fl / il);
+}
+
+int main(void) {
+    s_aht.i2c_port = i2c0;
+    s_aht.address = AHT10_I2C_ADDR;
+    s_bh.i2c_port = i2c0;
+    s_bh.address = BH1750_ADDR_LOW;
+
+    run_aht10();
+    run_bh1750();
+    run_format();
+    run_isqrt();
+    run_bench();
+
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,294 @@
+/*
+ * Histórico de amostras do sensor_data com leitores concorrentes
+ *
+ * Compila o sensor_data.c do firmware no host e roda, com pthreads, um
+ * escritor publicando amostras sem pausa (cede a CPU a cada uma) e
+ * leitores que nunca tomam lock:
+ *
+ *   cursor      dois consumidores rápidos com sensor_data_history_read()
+ *   lento       um consumidor que dorme 1 ms entre leituras e perde
+ *               amostras sobrescritas
+ *   snapshot    um leitor de sensor_data_get()
+ *
+ * Cada publicação k grava um padrão derivado de k em todos os campos
+ * (inclusive os de 64 bits), então uma cópia rasgada ou fora de ordem aparece como inconsistência.
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - nenhuma amostra ou snapshot inconsistente
+ *   - sequências estritamente crescentes por consumidor, e cada salto
+ *     coberto pelas perdas informadas
+ *   - recebidas + perdidas = publicadas, para cada consumidor
+ *
+ * Depois, compara o custo por leitura de sensor_data_get() com a cópia
+ * sob mutex de antes (snapshot único com pthread_mutex), com e sem um
+ * escritor publicando a cada 200 µs.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -pthread -Itools/replay/host -Iinclude -Idrivers \
+ *       tools/replay/history_stress.c src/sensor_data.c src/rolling_stats.c -o history_stress
+ *
+ * Uso:
+ *   ./history_stress [publicações, padrão 200000]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "sensor_data.h"
+
+#define CURSOR_BATCH 16
+
+// ============= RELÓGIO =============
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+absolute_time_t get_absolute_time(void) { return mono_ns() / 1000u; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return mono_ns() / 1000u; }
+uint32_t time_us_32(void) { return (uint32_t)(mono_ns() / 1000u); }
+void sleep_us(uint64_t us) {
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+    nanosleep(&ts, NULL);
+}
+void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000u); }
+
+// ============= PADRÃO DAS PUBLICAÇÕES =============
+
+// A publicação k (1, 2, ...) vira a versão k + 1: a versão 1 é a do init
+static void publish(uint32_t k) {
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    sensor_txn_set_luminosity(&txn, (int32_t)k, true);
+    sensor_txn_set_capture(&txn, SENSOR_FIELD_LUMINOSITY, ((uint64_t)k << 32) | k);
+    sensor_txn_set_temp_humidity(&txn, (int32_t)(k * 3u + 1u), (int32_t)(k ^ 0x5555u), (k & 1u) != 0);
+    sensor_txn_set_capture(&txn, SENSOR_FIELD_TEMP_HUMIDITY, ~(((uint64_t)k << 32) | k));
+    sensor_txn_set_led_state(&txn, true, (led_intensity_t)(k % 4u));
+    sensor_data_commit(&txn);
+}
+
+static bool data_consistent(const sensor_data_t *d) {
+    if (d->version <= 1) return true;   // Snapshot do init
+    uint32_t k = d->version - 1;
+    return d->luminosity_centi == (int32_t)k &&
+           d->luminosity_capture_us == (((uint64_t)k << 32) | k) &&
+           d->temperature_centi == (int32_t)(k * 3u + 1u) &&
+           d->humidity_centi == (int32_t)(k ^ 0x5555u) &&
+           d->temp_humidity_valid == ((k & 1u) != 0) &&
+           d->temp_humidity_capture_us == ~(((uint64_t)k << 32) | k) &&
+           d->led_intensity == (led_intensity_t)(k % 4u);
+}
+
+// ============= STRESS =============
+
+typedef struct {
+    uint32_t reads;
+    uint32_t inconsistent;
+    uint32_t went_back;
+} snapshot_reader_t;
+
+typedef struct {
+    const char *name;
+    uint32_t pause_us;        // Pausa entre leituras (consumidor lento)
+    uint32_t received;
+    uint32_t lost;
+    uint32_t inconsistent;
+    uint32_t out_of_order;
+    uint32_t unexplained_gaps;
+} consumer_t;
+
+static volatile bool g_writer_done;
+static uint32_t g_publishes;
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    // Cede a CPU a cada publicação para os consumidores acompanharem; as
+    // cópias ainda são interrompidas pela preempção no meio do caminho
+    for (uint32_t k = 1; k <= g_publishes; k++) {
+        publish(k);
+        sched_yield();
+    }
+    __atomic_store_n(&g_writer_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void *consumer_main(void *arg) {
+    consumer_t *c = (consumer_t *)arg;
+    sensor_sample_t batch[CURSOR_BATCH];
+    uint32_t cursor = 1;   // Já viu a amostra do init
+    uint32_t last_seq = 1;
+
+    for (;;) {
+        bool done = __atomic_load_n(&g_writer_done, __ATOMIC_ACQUIRE);
+        uint32_t lost = 0;
+        size_t n = sensor_data_history_read(&cursor, batch, CURSOR_BATCH, &lost);
+        c->lost += lost;
+
+        uint32_t gap_budget = lost;
+        for (size_t i = 0; i < n; i++) {
+            const sensor_sample_t *s = &batch[i];
+            if (s->seq != s->data.version || !data_consistent(&s->data)) c->inconsistent++;
+            if (s->seq <= last_seq) {
+                c->out_of_order++;
+            } else {
+                uint32_t skipped = s->seq - last_seq - 1;
+                if (skipped > gap_budget) c->unexplained_gaps++;
+                else gap_budget -= skipped;
+            }
+            last_seq = s->seq;
+        }
+        c->received += (uint32_t)n;
+
+        if (n == 0 && lost == 0) {
+            if (done && cursor == sensor_data_history_head()) break;
+            sched_yield();
+        }
+        if (c->pause_us) sleep_us(c->pause_us);
+    }
+    return NULL;
+}
+
+static void *snapshot_main(void *arg) {
+    snapshot_reader_t *r = (snapshot_reader_t *)arg;
+    uint32_t last_version = 0;
+
+    while (!__atomic_load_n(&g_writer_done, __ATOMIC_ACQUIRE)) {
+        sensor_data_t d = sensor_data_get();
+        if (!data_consistent(&d)) r->inconsistent++;
+        if (d.version < last_version) r->went_back++;
+        last_version = d.version;
+        if ((++r->reads & 63u) == 0) sched_yield();
+    }
+    return NULL;
+}
+
+static bool run_stress(uint32_t publishes) {
+    consumer_t consumers[3] = {
+        { .name = "cursor1" },
+        { .name = "cursor2" },
+        { .name = "lento", .pause_us = 1000 },
+    };
+    snapshot_reader_t snap = { 0 };
+    pthread_t readers[4], writer;
+
+    sensor_data_init();
+    g_publishes = publishes;
+    g_writer_done = false;
+
+    for (int i = 0; i < 3; i++) pthread_create(&readers[i], NULL, consumer_main, &consumers[i]);
+    pthread_create(&readers[3], NULL, snapshot_main, &snap);
+    uint64_t start = mono_ns();
+    pthread_create(&writer, NULL, writer_main, NULL);
+
+    pthread_join(writer, NULL);
+    uint64_t elapsed = mono_ns() - start;
+    for (int i = 0; i < 4; i++) pthread_join(readers[i], NULL);
+
+    bool ok = true;
+    printf("stress publicacoes=%u tempo=%.0fms historico=%u slots\n", publishes, elapsed / 1e6,
+           SENSOR_HISTORY_LEN);
+    for (int i = 0; i < 3; i++) {
+        const consumer_t *c = &consumers[i];
+        bool c_ok = c->inconsistent == 0 && c->out_of_order == 0 && c->unexplained_gaps == 0 &&
+                    c->received + c->lost == publishes;
+        printf("  %-8s recebidas=%u perdidas=%u inconsistentes=%u fora_de_ordem=%u saltos_sem_perda=%u %s\n",
+               c->name, c->received, c->lost, c->inconsistent, c->out_of_order, c->unexplained_gaps,
+               c_ok ? "ok" : "FALHOU");
+        ok = ok && c_ok;
+    }
+    bool s_ok = snap.inconsistent == 0 && snap.went_back == 0;
+    printf("  snapshot leituras=%u inconsistentes=%u versao_voltou=%u %s\n", snap.reads, snap.inconsistent,
+           snap.went_back, s_ok ? "ok" : "FALHOU");
+    return ok && s_ok;
+}
+
+// ============= CUSTO POR LEITURA =============
+
+// Como era antes: um snapshot único copiado sob o mutex
+static sensor_data_t g_locked_snapshot;
+static pthread_mutex_t g_locked_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static sensor_data_t locked_get(void) {
+    pthread_mutex_lock(&g_locked_mutex);
+    sensor_data_t copy = g_locked_snapshot;
+    pthread_mutex_unlock(&g_locked_mutex);
+    return copy;
+}
+
+static volatile bool g_bench_stop;
+static bool g_bench_locked;
+
+static void *bench_writer_main(void *arg) {
+    (void)arg;
+    uint32_t k = 1;
+    while (!__atomic_load_n(&g_bench_stop, __ATOMIC_ACQUIRE)) {
+        if (g_bench_locked) {
+            pthread_mutex_lock(&g_locked_mutex);
+            g_locked_snapshot.version = k + 1;
+            g_locked_snapshot.luminosity_centi = (int32_t)k;
+            pthread_mutex_unlock(&g_locked_mutex);
+        } else {
+            publish(k);
+        }
+        k++;
+        sleep_us(200);
+    }
+    return NULL;
+}
+
+static double bench_reads(bool locked, bool with_writer) {
+    const uint64_t window_ns = 300000000u;
+    pthread_t writer;
+    volatile uint32_t sink = 0;
+
+    sensor_data_init();
+    g_bench_locked = locked;
+    g_bench_stop = false;
+    if (with_writer) pthread_create(&writer, NULL, bench_writer_main, NULL);
+
+    uint64_t reads = 0;
+    uint64_t start = mono_ns();
+    uint64_t now = start;
+    while (now - start < window_ns) {
+        for (int i = 0; i < 1000; i++) {
+            sensor_data_t d = locked ? locked_get() : sensor_data_get();
+            sink += d.led_intensity;
+        }
+        reads += 1000;
+        now = mono_ns();
+    }
+    (void)sink;
+
+    __atomic_store_n(&g_bench_stop, true, __ATOMIC_RELEASE);
+    if (with_writer) pthread_join(writer, NULL);
+    return (double)(now - start) / (double)reads;
+}
+
+int main(int argc, char **argv) {
+    uint32_t publishes = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 200000;
+    if (publishes == 0) publishes = 1;
+
+    bool ok = run_stress(publishes);
+
+    printf("leitura (sensor_data_t de %zu bytes)\n", sizeof(sensor_data_t));
+    printf("  mutex    sem_escritor=%.1fns com_escritor=%.1fns\n", bench_reads(true, false),
+           bench_reads(true, true));
+    printf("  seqlock  sem_escritor=%.1fns com_escritor=%.1fns\n", bench_reads(false, false),
+           bench_reads(false, true));
+
+    if (!ok) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef REPLAY_HOST_FREERTOS_H
+#define REPLAY_HOST_FREERTOS_H
+
+// Subconjunto do FreeRTOS.h usado pelos módulos compilados no host
+// (i2c_async_test.c): tick de 1 ms e sem preempção
+
+#include <stdint.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+#endif // REPLAY_HOST_FREERTOS_H
@@ -0,0 +1,6 @@
+#ifndef REPLAY_HOST_HARDWARE_CLOCKS_H
+#define REPLAY_HOST_HARDWARE_CLOCKS_H
+
+#include "pico/stdlib.h"
+
+#endif // REPLAY_HOST_HARDWARE_CLOCKS_H
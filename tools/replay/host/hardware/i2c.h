@@ -0,0 +1,17 @@
+#ifndef REPLAY_HOST_HARDWARE_I2C_H
+#define REPLAY_HOST_HARDWARE_I2C_H
+
+// Barramento I2C simulado por cada teste
+
+#include "pico/stdlib.h"
+
+typedef struct replay_i2c_bus i2c_inst_t;
+
+extern i2c_inst_t *const i2c0;
+extern i2c_inst_t *const i2c1;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+uint i2c_get_index(i2c_inst_t *i2c);
+
+#endif // REPLAY_HOST_HARDWARE_I2C_H
@@ -0,0 +1,16 @@
+#ifndef REPLAY_HOST_HARDWARE_PIO_H
+#define REPLAY_HOST_HARDWARE_PIO_H
+
+// PIO sem efeito: a matriz de LEDs só registra a intensidade escolhida
+
+#include "pico/stdlib.h"
+
+typedef struct replay_pio *PIO;
+
+#define pio0 ((PIO)0)
+
+static inline void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    (void)pio; (void)sm; (void)data;
+}
+
+#endif // REPLAY_HOST_HARDWARE_PIO_H
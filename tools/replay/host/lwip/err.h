@@ -0,0 +1,15 @@
+#ifndef REPLAY_HOST_LWIP_ERR_H
+#define REPLAY_HOST_LWIP_ERR_H
+
+// Subconjunto do lwip/err.h usado pelo servidor web no host (http_bench.c)
+
+typedef signed char err_t;
+
+#define ERR_OK    0
+#define ERR_MEM  -1
+#define ERR_VAL  -6
+#define ERR_ABRT -13
+#define ERR_RST  -14
+#define ERR_CLSD -15
+
+#endif // REPLAY_HOST_LWIP_ERR_H
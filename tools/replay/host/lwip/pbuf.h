@@ -0,0 +1,22 @@
+#ifndef REPLAY_HOST_LWIP_PBUF_H
+#define REPLAY_HOST_LWIP_PBUF_H
+
+// Subconjunto do lwip/pbuf.h: cadeias de pbufs montadas pela pilha simulada
+
+#include <stdint.h>
+
+typedef uint16_t u16_t;
+typedef uint8_t u8_t;
+
+struct pbuf {
+    struct pbuf *next;
+    void *payload;
+    u16_t tot_len;      // Bytes deste pbuf e dos seguintes na cadeia
+    u16_t len;          // Bytes deste pbuf
+};
+
+u8_t pbuf_free(struct pbuf *p);
+void pbuf_cat(struct pbuf *head, struct pbuf *tail);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+
+#endif // REPLAY_HOST_LWIP_PBUF_H
@@ -0,0 +1,17 @@
+#ifndef REPLAY_HOST_PICO_CRITICAL_SECTION_H
+#define REPLAY_HOST_PICO_CRITICAL_SECTION_H
+
+// Os testes que passam por aqui são single-thread: seções críticas não fazem nada
+
+#include <stdbool.h>
+
+typedef struct {
+    bool initialized;
+} critical_section_t;
+
+static inline void critical_section_init(critical_section_t *cs) { cs->initialized = true; }
+static inline bool critical_section_is_initialized(critical_section_t *cs) { return cs->initialized; }
+static inline void critical_section_enter_blocking(critical_section_t *cs) { (void)cs; }
+static inline void critical_section_exit(critical_section_t *cs) { (void)cs; }
+
+#endif // REPLAY_HOST_PICO_CRITICAL_SECTION_H
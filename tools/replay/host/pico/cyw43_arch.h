@@ -0,0 +1,9 @@
+#ifndef REPLAY_HOST_PICO_CYW43_ARCH_H
+#define REPLAY_HOST_PICO_CYW43_ARCH_H
+
+// Só a trava do lwIP: no host a pilha simulada roda na mesma thread
+
+static inline void cyw43_arch_lwip_begin(void) { }
+static inline void cyw43_arch_lwip_end(void) { }
+
+#endif // REPLAY_HOST_PICO_CYW43_ARCH_H
@@ -0,0 +1,23 @@
+#ifndef REPLAY_HOST_PICO_STDLIB_H
+#define REPLAY_HOST_PICO_STDLIB_H
+
+// Subconjunto do pico/stdlib.h usado pelos módulos compilados no host.
+// O tempo é o relógio virtual de cada teste.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+
+#define PICO_ERROR_GENERIC -1
+
+#endif // REPLAY_HOST_PICO_STDLIB_H
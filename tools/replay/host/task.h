@@ -0,0 +1,26 @@
+#ifndef REPLAY_HOST_TASK_H
+#define REPLAY_HOST_TASK_H
+
+// Subconjunto do task.h: o harness implementa as funções sobre o relógio
+// virtual, e um bloqueio em notificação avança o tempo até a conclusão
+
+#include "FreeRTOS.h"
+
+typedef struct replay_task *TaskHandle_t;
+
+#define taskSCHEDULER_SUSPENDED   0
+#define taskSCHEDULER_NOT_STARTED 1
+#define taskSCHEDULER_RUNNING     2
+
+// Single-thread: a "interrupção" do barramento simulado só roda dentro
+// de ulTaskNotifyTakeIndexed, nunca no meio de uma seção crítica
+#define taskENTER_CRITICAL() do { } while (0)
+#define taskEXIT_CRITICAL()  do { } while (0)
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskGetSchedulerState(void);
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t task, UBaseType_t index, BaseType_t *higher_priority_woken);
+
+#endif // REPLAY_HOST_TASK_H
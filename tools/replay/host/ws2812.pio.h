@@ -0,0 +1,24 @@
+#ifndef REPLAY_HOST_WS2812_PIO_H
+#define REPLAY_HOST_WS2812_PIO_H
+
+// Substitui o cabeçalho gerado pelo pioasm
+
+#include "hardware/pio.h"
+
+static const int ws2812_program = 0;
+
+static inline uint pio_add_program(PIO pio, const int *program) {
+    (void)pio; (void)program;
+    return 0;
+}
+
+static inline uint pio_claim_unused_sm(PIO pio, bool required) {
+    (void)pio; (void)required;
+    return 0;
+}
+
+static inline void ws2812_program_init(PIO pio, uint sm, uint offset, uint pin, float freq, bool rgbw) {
+    (void)pio; (void)sm; (void)offset; (void)pin; (void)freq; (void)rgbw;
+}
+
+#endif // REPLAY_HOST_WS2812_PIO_H
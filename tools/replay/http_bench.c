@@ -0,0 +1,1377 @@
+/*
+ * Carga HTTP no servidor web, com e sem keep-alive, sobre uma pilha TCP simulada
+ *
+ * web_server.c, web_pages.c e auth.c do firmware rodam sem alterações sobre
+ * o subconjunto do lwIP implementado abaixo (host/lwip/). Como no lwIP do
+ * Pico, os PCBs vêm de um pool de MEMP_NUM_TCP_PCB (5, padrão do lwIP) e
+ * quem fecha a conexão primeiro deixa o PCB em TIME_WAIT por 2*MSL (120 s);
+ * com o pool cheio, o lwIP recicla o TIME_WAIT mais antigo. O relógio é
+ * virtual: cada ida e volta na rede custa um RTT e o timer lento (500 ms)
+ * dispara os tcp_poll do servidor.
+ *
+ * Cenários, com o cliente pedindo "Connection: close" (o comportamento
+ * anterior do servidor) e com keep-alive:
+ *
+ *   rajada   login + 500 GET /data seguidos: requisições/s e PCBs usados
+ *   painel   GET /data?since=<versão> a cada 500 ms por 2 min, como o painel,
+ *            e o tempo até o servidor fechar a conexão ociosa
+ *   limite   WEB_SERVER_MAX_CONNECTIONS + 2 clientes simultâneos
+ *
+ * e, para 1 a 16 abas abertas no painel (pool de PCBs ampliado), consulta a
+ * /data?since= a cada 500 ms contra o fluxo /events (SSE), com amostras
+ * chegando como no firmware (luz a cada 700 ms, temperatura a cada 4 s) e
+ * web_server_poll() a cada 100 ms, como na task_web:
+ *
+ *   espectadores  bytes no ar (IP+TCP, com ACKs e handshakes) e CPU do
+ *                 servidor por aba, e atraso médio entre amostra e tela
+ *
+ * e, para 1 a 16 clientes em /ws, cada um mandando "LED ON"/"LED OFF" uma
+ * vez por segundo:
+ *
+ *   websocket     conformidade (handshake com a chave da RFC 6455, ping,
+ *                 comando em dois segmentos, close, recusas) e percentis do
+ *                 atraso amostra -> cliente e da ida e volta de um comando
+ *
+ * e, com o heap do lwIP limitado a MEM_SIZE (4000 bytes, lwipopts.h) e os
+ * ACKs saindo na velocidade do enlace de cada cliente:
+ *
+ *   carga paralela  4 navegadores com GET /data a cada 500 ms junto de 0 a
+ *                   16 clientes lentos (4 KB/s) baixando / sem parar:
+ *                   percentis da latência dos navegadores, respostas
+ *                   pendentes, esperas por buffer e conexões recusadas
+ *
+ * Compilação (na raiz do repositório; 16 slots para caber todas as abas):
+ *
+ *   gcc -O2 -std=c11 -DWEB_SERVER_MAX_CONNECTIONS=16 -Itools/replay/host -Iinclude -Idrivers -Iweb \
+ *       tools/replay/http_bench.c web/web_server.c web/web_pages.c web/auth.c web/websocket.c web/http_parser.c \
+ *       src/sensor_data.c src/sensor_registry.c src/sensor_health.c src/sensor_scheduler.c \
+ *       src/jitter_stats.c src/timeseries.c src/rolling_stats.c src/sensor_units.c \
+ *       -o http_bench
+ *
+ * Uso:
+ *   ./http_bench [RTT em ms, padrão 8]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "lwip/tcp.h"
+#include "jitter_stats.h"
+#include "sensor_data.h"
+#include "web_server.h"
+#include "websocket.h"
+
+// Padrões do lwIP (opt.h) que o lwipopts.h do projeto não altera
+#define SIM_MEMP_NUM_TCP_PCB  5
+#define SIM_POOL_MAX          40
+#define SIM_TIME_WAIT_MS      (2 * 60000)
+#define SIM_SLOW_TIMER_MS     500
+
+// Resposta recebida pelo cliente simulado
+#define SIM_RX_MAX 4096
+
+// Cabeçalhos IP+TCP por segmento (sem opções)
+#define SIM_TCP_MSS      1460
+#define SIM_TCPIP_HEADER 40
+
+// lwipopts.h: heap de onde o tcp_write (COPY) tira os segmentos, e fila de envio
+#define SIM_MEM_SIZE     4000
+#define SIM_TCP_SND_BUF  (8 * SIM_TCP_MSS)
+
+// ============= RELÓGIO VIRTUAL =============
+
+static uint64_t g_now_us;
+
+absolute_time_t get_absolute_time(void) { return g_now_us; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return g_now_us; }
+uint32_t time_us_32(void) { return (uint32_t)g_now_us; }
+
+static uint64_t now_ms(void) { return g_now_us / 1000u; }
+
+// ============= PILHA TCP SIMULADA =============
+
+typedef enum {
+    PCB_FREE,
+    PCB_LISTEN,
+    PCB_ESTABLISHED,
+    PCB_TIME_WAIT
+} pcb_state_t;
+
+struct tcp_pcb {
+    pcb_state_t state;
+    uint32_t id;                // Muda a cada alocação (o cliente detecta reuso)
+    void *arg;
+    tcp_accept_fn accept;
+    tcp_recv_fn recv;
+    tcp_sent_fn sent;
+    tcp_poll_fn poll;
+    tcp_err_fn errf;
+    u8_t poll_interval;
+    u8_t poll_ticks;
+    uint64_t time_wait_until_ms;
+    bool peer_closed;           // Cliente já mandou FIN: fechamento passivo
+
+    // Lado do cliente: bytes escritos pelo servidor
+    char rx[SIM_RX_MAX];
+    size_t rx_len;
+
+    // Com heap limitado: bytes na fila de envio à espera de ACK e a
+    // velocidade do enlace do cliente (bytes/ms)
+    size_t unacked;
+    uint32_t link_bytes_per_ms;
+    size_t link_credit;         // Bytes já no fio desde o último ACK
+};
+
+typedef struct {
+    uint32_t allocated;     // PCBs alocados (conexões que chegaram ao servidor)
+    uint32_t in_use;        // Ocupados agora (ativos + TIME_WAIT)
+    uint32_t peak_in_use;   // Pico de ocupação do pool
+    uint32_t time_wait;     // Fechamentos que deixaram o PCB em TIME_WAIT
+    uint32_t recycled;      // TIME_WAIT reciclados com o pool cheio
+    uint32_t no_pcb;        // SYNs descartados sem PCB livre
+    uint32_t aborted;       // Conexões derrubadas com RST
+    uint32_t pbufs_leaked;  // pbufs entregues ao servidor e não liberados
+} sim_stats_t;
+
+static struct tcp_pcb s_pool[SIM_POOL_MAX];
+static int s_pool_size = SIM_MEMP_NUM_TCP_PCB;
+static struct tcp_pcb s_listen;
+static sim_stats_t s_stats;
+static uint32_t s_next_id;
+static uint64_t s_next_slow_timer_ms;
+static uint64_t s_air_bytes;
+
+// Heap do lwIP: 0 = ilimitado (ACK imediato), como nos cenários sem carga paralela
+static size_t s_heap_limit;
+static size_t s_heap_used;
+static size_t s_heap_peak;
+static uint32_t s_heap_refused;     // tcp_write devolvidos com ERR_MEM
+
+// Segmentos de uma mensagem com seus cabeçalhos, mais o ACK de volta
+static void count_air(size_t len) {
+    s_air_bytes += len + SIM_TCPIP_HEADER * ((len + SIM_TCP_MSS - 1) / SIM_TCP_MSS) + SIM_TCPIP_HEADER;
+}
+
+static void pcb_free(struct tcp_pcb *pcb) {
+    // Segmentos ainda na fila voltam ao heap junto com o PCB
+    s_heap_used -= pcb->unacked;
+    pcb->unacked = 0;
+    pcb->state = PCB_FREE;
+    s_stats.in_use--;
+}
+
+static struct tcp_pcb *pcb_alloc(void) {
+    struct tcp_pcb *pcb = NULL;
+    for (int i = 0; i < s_pool_size && !pcb; i++) {
+        if (s_pool[i].state == PCB_FREE) pcb = &s_pool[i];
+    }
+
+    // Pool cheio: o lwIP recicla o TIME_WAIT mais antigo (tcp_kill_timewait)
+    if (!pcb) {
+        for (int i = 0; i < s_pool_size; i++) {
+            if (s_pool[i].state != PCB_TIME_WAIT) continue;
+            if (!pcb || s_pool[i].time_wait_until_ms < pcb->time_wait_until_ms) pcb = &s_pool[i];
+        }
+        if (!pcb) {
+            s_stats.no_pcb++;
+            return NULL;
+        }
+        s_stats.recycled++;
+        pcb_free(pcb);
+    }
+
+    uint32_t id = ++s_next_id;
+    memset(pcb, 0, sizeof(*pcb));
+    pcb->state = PCB_ESTABLISHED;
+    pcb->id = id;
+    s_stats.allocated++;
+    s_stats.in_use++;
+    if (s_stats.in_use > s_stats.peak_in_use) s_stats.peak_in_use = s_stats.in_use;
+    return pcb;
+}
+
+struct tcp_pcb *tcp_new(void) {
+    memset(&s_listen, 0, sizeof(s_listen));
+    return &s_listen;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, const void *ipaddr, u16_t port) {
+    (void)pcb; (void)ipaddr; (void)port;
+    return ERR_OK;
+}
+
+struct tcp_pcb *tcp_listen(struct tcp_pcb *pcb) {
+    pcb->state = PCB_LISTEN;
+    return pcb;
+}
+
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept) { pcb->accept = accept; }
+void tcp_arg(struct tcp_pcb *pcb, void *arg) { pcb->arg = arg; }
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv) { pcb->recv = recv; }
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent) { pcb->sent = sent; }
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn errf) { pcb->errf = errf; }
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval) {
+    pcb->poll = poll;
+    pcb->poll_interval = interval;
+    pcb->poll_ticks = 0;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len) { (void)pcb; (void)len; }
+err_t tcp_output(struct tcp_pcb *pcb) { (void)pcb; return ERR_OK; }
+
+u16_t tcp_sndbuf(struct tcp_pcb *pcb) {
+    size_t room = SIM_RX_MAX - pcb->rx_len;
+    if (s_heap_limit && SIM_TCP_SND_BUF - pcb->unacked < room) room = SIM_TCP_SND_BUF - pcb->unacked;
+    return (u16_t)room;
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags) {
+    (void)apiflags;
+    if (pcb->state != PCB_ESTABLISHED) return ERR_CLSD;
+    if (len > tcp_sndbuf(pcb)) return ERR_MEM;
+    if (s_heap_limit) {
+        // Cabe na janela mas não no heap: o lwIP também devolve ERR_MEM
+        if (s_heap_used + len > s_heap_limit) {
+            s_heap_refused++;
+            return ERR_MEM;
+        }
+        s_heap_used += len;
+        if (s_heap_used > s_heap_peak) s_heap_peak = s_heap_used;
+        pcb->unacked += len;
+    }
+    memcpy(pcb->rx + pcb->rx_len, dataptr, len);
+    pcb->rx_len += len;
+    count_air(len);
+    return ERR_OK;
+}
+
+// ACKs de "ms" milissegundos de enlace, um por segmento inteiro: devolvem
+// o heap e chamam o tcp_sent
+static void sim_ack(uint64_t ms) {
+    for (int i = 0; i < s_pool_size; i++) {
+        struct tcp_pcb *pcb = &s_pool[i];
+        if (pcb->unacked == 0) {
+            pcb->link_credit = 0;
+            continue;
+        }
+        size_t n = pcb->unacked;
+        if (pcb->link_bytes_per_ms) {
+            pcb->link_credit += pcb->link_bytes_per_ms * ms;
+            size_t segment = n < SIM_TCP_MSS ? n : SIM_TCP_MSS;
+            if (pcb->link_credit < segment) continue;
+            if (n > pcb->link_credit) n = pcb->link_credit / SIM_TCP_MSS * SIM_TCP_MSS;
+            pcb->link_credit -= n;
+        }
+        pcb->unacked -= n;
+        s_heap_used -= n;
+        // Depois do tcp_close o lwIP ainda entrega a fila, mas sem callbacks
+        if (pcb->state == PCB_ESTABLISHED && pcb->sent) pcb->sent(pcb->arg, pcb, (u16_t)n);
+    }
+}
+
+err_t tcp_close(struct tcp_pcb *pcb) {
+    if (pcb == &s_listen) {
+        s_listen.state = PCB_FREE;
+        return ERR_OK;
+    }
+    if (pcb->peer_closed) {
+        // Fechamento passivo: LAST_ACK dura um RTT, sem TIME_WAIT
+        s_air_bytes += 4 * SIM_TCPIP_HEADER;
+        pcb_free(pcb);
+        return ERR_OK;
+    }
+    // FIN e ACK nos dois sentidos
+    s_air_bytes += 4 * SIM_TCPIP_HEADER;
+    pcb->state = PCB_TIME_WAIT;
+    pcb->time_wait_until_ms = now_ms() + SIM_TIME_WAIT_MS;
+    s_stats.time_wait++;
+    return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb) {
+    tcp_err_fn errf = pcb->errf;
+    void *arg = pcb->arg;
+    s_stats.aborted++;
+    pcb_free(pcb);
+    if (errf) errf(arg, ERR_ABRT);
+}
+
+// Cada pbuf vem de client_deliver() num único malloc (estrutura + payload):
+// o servidor pode segurá-lo depois do recv enquanto a resposta anterior sai
+static struct pbuf *pbuf_new(const void *data, u16_t len) {
+    struct pbuf *p = malloc(sizeof(struct pbuf) + len);
+    *p = (struct pbuf){ NULL, (char *)(p + 1), len, len };
+    memcpy(p + 1, data, len);
+    s_stats.pbufs_leaked++;
+    return p;
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+    u8_t count = 0;
+    while (p) {
+        struct pbuf *next = p->next;
+        free(p);
+        p = next;
+        count++;
+    }
+    s_stats.pbufs_leaked -= count;
+    return count;
+}
+
+void pbuf_cat(struct pbuf *head, struct pbuf *tail) {
+    struct pbuf *p = head;
+    for (; p->next; p = p->next) {
+        p->tot_len = (u16_t)(p->tot_len + tail->tot_len);
+    }
+    p->tot_len = (u16_t)(p->tot_len + tail->tot_len);
+    p->next = tail;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset) {
+    u16_t copied = 0;
+    for (; p && copied < len; p = p->next) {
+        if (offset >= p->len) {
+            offset = (u16_t)(offset - p->len);
+            continue;
+        }
+        u16_t n = (u16_t)(p->len - offset);
+        if (n > len - copied) n = (u16_t)(len - copied);
+        memcpy((char *)dataptr + copied, (const char *)p->payload + offset, n);
+        copied = (u16_t)(copied + n);
+        offset = 0;
+    }
+    return copied;
+}
+
+// Timer lento do lwIP: tcp_poll dos PCBs ativos e fim dos TIME_WAIT
+static void slow_timer(void) {
+    for (int i = 0; i < s_pool_size; i++) {
+        struct tcp_pcb *pcb = &s_pool[i];
+        if (pcb->state == PCB_TIME_WAIT && now_ms() >= pcb->time_wait_until_ms) {
+            pcb_free(pcb);
+        } else if (pcb->state == PCB_ESTABLISHED && pcb->poll && ++pcb->poll_ticks >= pcb->poll_interval) {
+            pcb->poll_ticks = 0;
+            pcb->poll(pcb->arg, pcb);
+        }
+    }
+}
+
+static void sim_advance_ms(uint64_t ms) {
+    uint64_t target = now_ms() + ms;
+    while (s_next_slow_timer_ms <= target) {
+        g_now_us = s_next_slow_timer_ms * 1000u;
+        slow_timer();
+        s_next_slow_timer_ms += SIM_SLOW_TIMER_MS;
+    }
+    g_now_us = target * 1000u;
+}
+
+static void sim_reset(int pool_size) {
+    web_server_deinit();
+    for (int i = 0; i < SIM_POOL_MAX; i++) {
+        s_pool[i].state = PCB_FREE;
+    }
+    s_pool_size = pool_size;
+    s_heap_limit = 0;
+    s_heap_used = 0;
+    s_heap_peak = 0;
+    s_heap_refused = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_next_slow_timer_ms = now_ms() + SIM_SLOW_TIMER_MS;
+    web_server_init(WEB_SERVER_PORT);
+}
+
+// ============= CLIENTE HTTP =============
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    uint32_t id;
+    bool keep_alive;
+    char cookie[96];
+} sim_client_t;
+
+typedef struct {
+    int status;
+    bool server_closed;
+    uint32_t version;       // "version" do JSON de /data
+} sim_response_t;
+
+static uint32_t s_rtt_ms = 8;
+static uint64_t s_cpu_ns;           // Tempo de CPU do host dentro do servidor
+static uint32_t s_base_conns;       // Contadores do servidor no início da medição
+static uint32_t s_base_requests;
+static uint32_t s_bad_length;       // Content-Length diferente do corpo recebido
+static size_t s_rx_bytes;
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool client_alive(const sim_client_t *c) {
+    return c->pcb && c->pcb->id == c->id && c->pcb->state == PCB_ESTABLISHED;
+}
+
+// Aceite no servidor, sem avançar o relógio
+static bool client_open(sim_client_t *c) {
+    s_air_bytes += 3 * SIM_TCPIP_HEADER;
+    c->pcb = pcb_alloc();
+    if (!c->pcb) return false;
+    c->id = c->pcb->id;
+
+    if (s_listen.accept(s_listen.arg, c->pcb, ERR_OK) != ERR_OK) {
+        c->pcb = NULL;
+        return false;
+    }
+    return client_alive(c);
+}
+
+// SYN / SYN-ACK: um RTT antes do primeiro byte da requisição
+static bool client_connect(sim_client_t *c) {
+    sim_advance_ms(s_rtt_ms);
+    return client_open(c);
+}
+
+static void client_close(sim_client_t *c) {
+    if (!client_alive(c)) return;
+    c->pcb->peer_closed = true;
+    c->pcb->recv(c->pcb->arg, c->pcb, NULL, ERR_OK);
+    c->pcb = NULL;
+}
+
+static void parse_response(sim_client_t *c, sim_response_t *out) {
+    struct tcp_pcb *pcb = c->pcb;
+    pcb->rx[pcb->rx_len] = '\0';
+    s_rx_bytes += pcb->rx_len;
+
+    out->status = atoi(pcb->rx + 9);
+    const char *blank = strstr(pcb->rx, "\r\n\r\n");
+    const char *length = strstr(pcb->rx, "Content-Length: ");
+    if (blank && length && length < blank) {
+        size_t body_len = pcb->rx_len - (size_t)(blank + 4 - pcb->rx);
+        if ((size_t)atoi(length + 16) != body_len) s_bad_length++;
+    } else if (out->status != 304) {
+        s_bad_length++;
+    }
+
+    const char *cookie = strstr(pcb->rx, "Set-Cookie: session=");
+    if (cookie) {
+        sscanf(cookie + 12, "%95[^;\r]", c->cookie);
+    }
+    const char *version = strstr(pcb->rx, "\"version\":");
+    if (version) {
+        out->version = (uint32_t)strtoul(version + 10, NULL, 10);
+    }
+}
+
+// Entrega bytes do cliente ao servidor em dois pbufs encadeados, sem avançar o relógio
+static void client_deliver(struct tcp_pcb *pcb, const void *data, size_t len) {
+    u16_t half = (u16_t)(len / 2);
+    struct pbuf *chain = pbuf_new(data, half);
+    pbuf_cat(chain, pbuf_new((const char *)data + half, (u16_t)(len - half)));
+    count_air(len);
+
+    uint64_t t0 = host_ns();
+    pcb->recv(pcb->arg, pcb, chain, ERR_OK);
+    s_cpu_ns += host_ns() - t0;
+}
+
+// Entrega a requisição em dois pbufs encadeados, descartando a resposta anterior
+static void client_send(sim_client_t *c, const char *method, const char *path, const char *body) {
+    static char request[512];
+    int len = snprintf(request, sizeof(request),
+                       "%s %s HTTP/1.1\r\n"
+                       "Host: pico\r\n"
+                       "%s%s%s"
+                       "Content-Length: %u\r\n"
+                       "%s"
+                       "\r\n"
+                       "%s",
+                       method, path,
+                       c->cookie[0] ? "Cookie: " : "", c->cookie, c->cookie[0] ? "\r\n" : "",
+                       (unsigned)strlen(body),
+                       c->keep_alive ? "" : "Connection: close\r\n",
+                       body);
+
+    c->pcb->rx_len = 0;
+    client_deliver(c->pcb, request, (size_t)len);
+}
+
+// Envia a requisição e espera a resposta (um RTT)
+static bool client_request(sim_client_t *c, const char *method, const char *path, const char *body,
+                           sim_response_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (!client_alive(c) && !client_connect(c)) return false;
+
+    struct tcp_pcb *pcb = c->pcb;
+    sim_advance_ms(s_rtt_ms / 2);
+    client_send(c, method, path, body);
+    sim_advance_ms(s_rtt_ms - s_rtt_ms / 2);
+    if (pcb->id != c->id || pcb->rx_len == 0) return false;
+
+    parse_response(c, out);
+    out->server_closed = pcb->state != PCB_ESTABLISHED;
+    return true;
+}
+
+static bool client_login(sim_client_t *c) {
+    sim_response_t r;
+    c->cookie[0] = '\0';
+    return client_request(c, "POST", "/login", "username=root&password=root", &r) && r.status == 302 && c->cookie[0];
+}
+
+// ============= CENÁRIOS =============
+
+static void publish_sample(int32_t temp_centi) {
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    sensor_txn_set_temp_humidity(&txn, temp_centi, 5500, true);
+    sensor_txn_set_luminosity(&txn, 12000, true);
+    sensor_data_commit(&txn);
+}
+
+static void report(const char *mode, uint32_t requests, uint32_t ok, uint64_t elapsed_ms) {
+    uint32_t conns = web_server_get_connection_count() - s_base_conns;
+    uint32_t served = web_server_get_request_count() - s_base_requests;
+    printf("  %-10s req/s=%7.1f ok=%lu/%lu conexoes=%-4lu req/conexao=%6.1f pcbs_alocados=%-4lu pico_pool=%lu/%d "
+           "time_wait=%-4lu reciclados=%-4lu cpu_host=%.1fus/req\n",
+           mode,
+           elapsed_ms ? 1000.0 * requests / (double)elapsed_ms : 0.0,
+           (unsigned long)ok, (unsigned long)requests,
+           (unsigned long)conns,
+           conns ? (double)served / conns : 0.0,
+           (unsigned long)s_stats.allocated,
+           (unsigned long)s_stats.peak_in_use, s_pool_size,
+           (unsigned long)s_stats.time_wait,
+           (unsigned long)s_stats.recycled,
+           requests ? (double)s_cpu_ns / requests / 1000.0 : 0.0);
+}
+
+// Zera as medições (o login entra em conexões e req/conexão)
+static void reset_counters(void) {
+    s_cpu_ns = 0;
+    s_rx_bytes = 0;
+    s_base_conns = web_server_get_connection_count();
+    s_base_requests = web_server_get_request_count();
+    memset(&s_stats, 0, sizeof(s_stats));
+    for (int i = 0; i < s_pool_size; i++) {
+        if (s_pool[i].state != PCB_FREE) s_stats.in_use++;
+    }
+    s_stats.peak_in_use = s_stats.in_use;
+}
+
+static void run_burst(bool keep_alive, uint32_t count) {
+    sim_reset(SIM_MEMP_NUM_TCP_PCB);
+    reset_counters();
+    sim_client_t client = { .keep_alive = keep_alive };
+    if (!client_login(&client)) {
+        printf("  login falhou\n");
+        return;
+    }
+
+    uint64_t start = now_ms();
+    uint32_t ok = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sim_response_t r;
+        if (client_request(&client, "GET", "/data", "", &r) && r.status == 200) ok++;
+    }
+    report(keep_alive ? "keep-alive" : "close", count, ok, now_ms() - start);
+    client_close(&client);
+}
+
+static void run_dashboard(bool keep_alive, uint32_t duration_s) {
+    sim_reset(SIM_MEMP_NUM_TCP_PCB);
+    reset_counters();
+    sim_client_t client = { .keep_alive = keep_alive };
+    if (!client_login(&client)) {
+        printf("  login falhou\n");
+        return;
+    }
+
+    uint64_t start = now_ms();
+    uint32_t requests = 0, ok = 0, version = 0;
+    for (uint32_t tick = 0; tick < duration_s * 2; tick++) {
+        // Uma amostra nova por segundo: metade das consultas volta com 304
+        if (tick % 2 == 0) publish_sample(2150 + (int32_t)(tick % 20));
+
+        uint64_t t0 = now_ms();
+        char path[40];
+        snprintf(path, sizeof(path), "/data?since=%lu", (unsigned long)version);
+        sim_response_t r;
+        requests++;
+        if (client_request(&client, "GET", path, "", &r) && (r.status == 200 || r.status == 304)) {
+            ok++;
+            if (r.status == 200) version = r.version;
+        }
+
+        uint64_t spent = now_ms() - t0;
+        if (spent < 500) sim_advance_ms(500 - spent);
+    }
+    uint64_t elapsed = now_ms() - start;
+    report(keep_alive ? "keep-alive" : "close", requests, ok, elapsed);
+
+    // Painel fechado sem FIN: o servidor libera o slot pelo tcp_poll
+    uint64_t idle_start = now_ms();
+    while (client_alive(&client) && now_ms() - idle_start < 30000) {
+        sim_advance_ms(100);
+    }
+    printf("  %-10s time_wait_no_fim=%lu pbufs_vazados=%lu content_length_errado=%lu bytes/resp=%.0f",
+           "",
+           (unsigned long)(s_stats.in_use - web_server_get_active_connections()),
+           (unsigned long)s_stats.pbufs_leaked,
+           (unsigned long)s_bad_length,
+           requests ? (double)s_rx_bytes / requests : 0.0);
+    if (keep_alive) {
+        printf(" ociosa_fechada_apos=%.1fs abertas=%lu",
+               (double)(now_ms() - idle_start) / 1000.0,
+               (unsigned long)web_server_get_active_connections());
+    }
+    printf("\n");
+}
+
+static void run_limit(uint32_t clients) {
+    sim_reset(WEB_SERVER_MAX_CONNECTIONS + 3 < SIM_POOL_MAX ? WEB_SERVER_MAX_CONNECTIONS + 3 : SIM_POOL_MAX);
+    sim_client_t login = { .keep_alive = true };
+    if (!client_login(&login)) {
+        printf("  login falhou\n");
+        return;
+    }
+    client_close(&login);
+
+    static sim_client_t c[SIM_POOL_MAX];
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < clients && i < SIM_POOL_MAX; i++) {
+        c[i] = (sim_client_t){ .keep_alive = true };
+        strcpy(c[i].cookie, login.cookie);
+        sim_response_t r;
+        if (client_request(&c[i], "GET", "/data", "", &r) && r.status == 200) accepted++;
+    }
+    printf("  %lu clientes simultaneos, %d slots: atendidos=%lu recusados(RST)=%lu abertas=%lu\n",
+           (unsigned long)clients, WEB_SERVER_MAX_CONNECTIONS,
+           (unsigned long)accepted, (unsigned long)s_stats.aborted,
+           (unsigned long)web_server_get_active_connections());
+
+    // Depois de 2 s sem requisições, a nova conexão toma o slot mais ocioso
+    sim_advance_ms(2000);
+    sim_client_t late = { .keep_alive = true };
+    strcpy(late.cookie, login.cookie);
+    sim_response_t r;
+    bool served = client_request(&late, "GET", "/data", "", &r) && r.status == 200;
+    uint32_t still_open = 0;
+    for (uint32_t i = 0; i < clients && i < SIM_POOL_MAX; i++) {
+        if (client_alive(&c[i])) still_open++;
+    }
+    printf("  apos 2 s ociosos: nova conexao %s, antigas ainda abertas=%lu\n",
+           served ? "atendida" : "recusada", (unsigned long)still_open);
+}
+
+// ============= ESPECTADORES: CONSULTA x SSE =============
+
+#define VIEW_MAX          16
+#define VIEW_DURATION_S   60
+#define VIEW_TASK_MS      100     // Período da task_web (web_server_poll)
+#define VIEW_POLL_MS      500     // Período do fetch do painel antigo
+#define VIEW_LUX_MS       700     // Período médio do BH1750 no replay
+#define VIEW_TEMP_MS      4000    // Período médio do AHT10 no replay
+#define VIEW_PHASE_MS     37      // Amostras fora de fase com a task_web
+
+// Instante de commit de cada versão, para medir o atraso até a tela
+#define VIEW_VERSION_RING 1024
+static uint64_t s_commit_ms[VIEW_VERSION_RING];
+
+typedef struct {
+    uint32_t updates;       // Amostras novas que chegaram à aba
+    uint64_t delay_ms;      // Soma dos atrasos commit -> aba
+} view_stats_t;
+
+static void commit_lux(int32_t lux_centi) {
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    sensor_txn_set_luminosity(&txn, lux_centi, true);
+    uint32_t version = sensor_data_commit(&txn);
+    s_commit_ms[version % VIEW_VERSION_RING] = now_ms();
+}
+
+static void commit_temp(int32_t temp_centi) {
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    sensor_txn_set_temp_humidity(&txn, temp_centi, 5500, true);
+    uint32_t version = sensor_data_commit(&txn);
+    s_commit_ms[version % VIEW_VERSION_RING] = now_ms();
+}
+
+// extra_ms: trânsito ainda não contado no relógio (meio RTT de um push)
+static void view_receive(view_stats_t *v, uint32_t *seen, uint32_t version, uint32_t extra_ms) {
+    if (version <= *seen) return;
+    *seen = version;
+    v->updates++;
+    v->delay_ms += now_ms() + extra_ms - s_commit_ms[version % VIEW_VERSION_RING];
+}
+
+// Consome o fluxo SSE recebido pela aba (o que o navegador faria)
+static void view_read_stream(sim_client_t *c, view_stats_t *v, uint32_t *seen) {
+    if (!client_alive(c)) return;
+    struct tcp_pcb *pcb = c->pcb;
+    pcb->rx[pcb->rx_len] = '\0';
+    s_rx_bytes += pcb->rx_len;
+    for (const char *ev = strstr(pcb->rx, "\"version\":"); ev; ev = strstr(ev + 1, "\"version\":")) {
+        view_receive(v, seen, (uint32_t)strtoul(ev + 10, NULL, 10), s_rtt_ms / 2);
+    }
+    pcb->rx_len = 0;
+}
+
+static void run_viewers(bool sse, uint32_t viewers) {
+    sim_reset(SIM_POOL_MAX);
+    reset_counters();
+    s_air_bytes = 0;
+
+    sim_client_t login = { .keep_alive = true };
+    if (!client_login(&login)) {
+        printf("  login falhou\n");
+        return;
+    }
+    client_close(&login);
+
+    static sim_client_t tabs[VIEW_MAX];
+    static view_stats_t stats[VIEW_MAX];
+    static uint32_t seen[VIEW_MAX];
+    uint32_t first_version = sensor_data_version();
+    for (uint32_t i = 0; i < viewers; i++) {
+        tabs[i] = (sim_client_t){ .keep_alive = true };
+        strcpy(tabs[i].cookie, login.cookie);
+        stats[i] = (view_stats_t){ 0 };
+        seen[i] = first_version;
+        if (sse) {
+            sim_response_t r;
+            client_request(&tabs[i], "GET", "/events", "", &r);
+            tabs[i].pcb->rx_len = 0;
+        }
+    }
+
+    uint64_t air_start = s_air_bytes;
+    uint64_t cpu_start = s_cpu_ns;
+    uint64_t start = now_ms();
+    uint64_t next_lux = start + VIEW_LUX_MS - VIEW_PHASE_MS;
+    uint64_t next_temp = start + VIEW_TEMP_MS - VIEW_PHASE_MS;
+    uint32_t events_start = web_server_get_sse_event_count();
+    uint32_t drops_start = web_server_get_sse_dropped_count();
+    int32_t lux = 12000, temp = 2150;
+
+    for (uint64_t t = start + VIEW_TASK_MS; t <= start + VIEW_DURATION_S * 1000u; t += VIEW_TASK_MS) {
+        // Amostras que chegaram desde a última passada da task_web
+        while (next_lux <= t || next_temp <= t) {
+            bool lux_first = next_lux <= next_temp;
+            uint64_t at = lux_first ? next_lux : next_temp;
+            if (at > now_ms()) sim_advance_ms(at - now_ms());
+            if (lux_first) {
+                commit_lux(lux += 37);
+                next_lux += VIEW_LUX_MS;
+            } else {
+                commit_temp(temp += 3);
+                next_temp += VIEW_TEMP_MS;
+            }
+        }
+        if (t > now_ms()) sim_advance_ms(t - now_ms());
+
+        // task_web: um evento por amostra nova, para todas as abas
+        uint64_t t0 = host_ns();
+        web_server_poll();
+        s_cpu_ns += host_ns() - t0;
+
+        for (uint32_t i = 0; i < viewers; i++) {
+            if (sse) {
+                view_read_stream(&tabs[i], &stats[i], &seen[i]);
+                continue;
+            }
+            // Abas defasadas entre si, cada uma no seu ciclo de 500 ms
+            if ((t - start + i * VIEW_TASK_MS) % VIEW_POLL_MS != 0) continue;
+            char path[40];
+            snprintf(path, sizeof(path), "/data?since=%lu", (unsigned long)seen[i]);
+            sim_response_t r;
+            if (client_request(&tabs[i], "GET", path, "", &r) && r.status == 200) {
+                view_receive(&stats[i], &seen[i], r.version, 0);
+            }
+        }
+    }
+
+    uint64_t updates = 0, delay = 0;
+    for (uint32_t i = 0; i < viewers; i++) {
+        updates += stats[i].updates;
+        delay += stats[i].delay_ms;
+        client_close(&tabs[i]);
+    }
+    double per_view_s = (double)viewers * VIEW_DURATION_S;
+    printf("  %-8s abas=%-2lu bytes_no_ar/s/aba=%7.0f cpu_host/s/aba=%6.1fus amostras/aba=%5.1f atraso_medio=%4.0fms "
+           "req=%-5lu eventos=%-4lu descartados=%lu\n",
+           sse ? "sse" : "consulta",
+           (unsigned long)viewers,
+           (double)(s_air_bytes - air_start) / per_view_s,
+           (double)(s_cpu_ns - cpu_start) / per_view_s / 1000.0,
+           (double)updates / viewers,
+           updates ? (double)delay / (double)updates : 0.0,
+           (unsigned long)(web_server_get_request_count() - s_base_requests),
+           (unsigned long)(web_server_get_sse_event_count() - events_start),
+           (unsigned long)(web_server_get_sse_dropped_count() - drops_start));
+}
+
+// ============= WEBSOCKET: LATÊNCIA COM VÁRIOS CLIENTES =============
+
+#define WS_CMD_PERIOD_MS  1000      // Cada cliente manda um comando por segundo
+#define WS_CMD_PHASE_MS   61        // Clientes defasados entre si e com a task_web
+#define WS_CMD_LOST_MS    5000      // Sem resposta nesse tempo: comando perdido
+#define WS_DRIFT_MS       13        // Amostras e comandos escorregam em relação à task_web
+#define WS_KEY            "dGhlIHNhbXBsZSBub25jZQ=="
+#define WS_ACCEPT         "s3pPLMBiTxaQ9kYGzzhZRbK+xOo="     // RFC 6455, seção 1.3
+
+typedef struct {
+    uint8_t opcode;
+    const uint8_t *payload;
+    size_t len;
+} ws_in_frame_t;
+
+typedef struct {
+    sim_client_t http;
+    uint32_t seen;              // Última versão recebida
+    uint64_t cmd_sent_ms;       // 0 = nenhum comando em andamento
+    uint64_t cmd_arrive_ms;     // Chegada do quadro ao servidor (meio RTT depois)
+    uint64_t next_cmd_ms;
+    uint32_t cmd_sent;
+    uint8_t out[WEBSOCKET_MAX_CLIENT_FRAME];
+    size_t out_len;             // Quadro ainda em trânsito até o servidor
+} ws_client_t;
+
+static uint32_t s_ws_commands;
+
+// Handler de controle do bench: alterna a matriz como o app_control do firmware
+static bool bench_control(const char *command) {
+    s_ws_commands++;
+    bool on = strcmp(command, "LED ON") == 0;
+    if (!on && strcmp(command, "LED OFF") != 0) return false;
+
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    sensor_txn_set_led_state(&txn, on, on ? LED_INTENSITY_LOW : LED_INTENSITY_OFF);
+    // Não é amostra de sensor: fica fora do atraso amostra -> cliente
+    uint32_t version = sensor_data_commit(&txn);
+    s_commit_ms[version % VIEW_VERSION_RING] = 0;
+    return true;
+}
+
+// Quadro mascarado, como o navegador manda
+static size_t ws_client_frame(uint8_t *out, websocket_opcode_t opcode, const void *payload, size_t len) {
+    static uint32_t mask = 0x2545F491u;
+    mask = mask * 1103515245u + 12345u;
+    out[0] = (uint8_t)(0x80 | opcode);
+    out[1] = (uint8_t)(0x80 | len);
+    memcpy(out + 2, &mask, 4);
+    for (size_t i = 0; i < len; i++) {
+        out[6 + i] = ((const uint8_t *)payload)[i] ^ out[2 + (i & 3)];
+    }
+    return 6 + len;
+}
+
+// Próximo quadro do servidor em rx; false se não houver um completo
+static bool ws_client_next(const struct tcp_pcb *pcb, size_t *pos, ws_in_frame_t *f) {
+    const uint8_t *b = (const uint8_t *)pcb->rx + *pos;
+    size_t avail = pcb->rx_len - *pos;
+    if (avail < 2) return false;
+
+    size_t len = b[1] & 0x7F;
+    size_t head = 2;
+    if (len == 126) {
+        if (avail < 4) return false;
+        len = ((size_t)b[2] << 8) | b[3];
+        head = 4;
+    }
+    if (avail < head + len) return false;
+
+    f->opcode = b[0] & 0x0F;
+    f->payload = b + head;
+    f->len = len;
+    *pos += head + len;
+    return true;
+}
+
+static bool ws_payload_has(const ws_in_frame_t *f, const char *text) {
+    char buf[256];
+    size_t n = f->len < sizeof(buf) - 1 ? f->len : sizeof(buf) - 1;
+    memcpy(buf, f->payload, n);
+    buf[n] = '\0';
+    return strstr(buf, text) != NULL;
+}
+
+// Handshake de /ws; devolve o status HTTP e deixa em rx só os quadros que vieram junto
+static int ws_open(sim_client_t *c, const char *extra_headers, bool *accept_ok) {
+    if (!client_alive(c) && !client_connect(c)) return 0;
+
+    static char request[512];
+    int len = snprintf(request, sizeof(request),
+                       "GET /ws HTTP/1.1\r\n"
+                       "Host: pico\r\n"
+                       "Cookie: %s\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Version: 13\r\n"
+                       "%s"
+                       "\r\n",
+                       c->cookie, extra_headers);
+
+    struct tcp_pcb *pcb = c->pcb;
+    pcb->rx_len = 0;
+    sim_advance_ms(s_rtt_ms / 2);
+    client_deliver(pcb, request, (size_t)len);
+    sim_advance_ms(s_rtt_ms - s_rtt_ms / 2);
+    if (pcb->id != c->id || pcb->rx_len == 0) return 0;
+
+    pcb->rx[pcb->rx_len] = '\0';
+    int status = atoi(pcb->rx + 9);
+    if (accept_ok) {
+        *accept_ok = strstr(pcb->rx, "Sec-WebSocket-Accept: " WS_ACCEPT "\r\n") != NULL;
+    }
+    const char *blank = strstr(pcb->rx, "\r\n\r\n");
+    size_t head = blank ? (size_t)(blank + 4 - pcb->rx) : pcb->rx_len;
+    pcb->rx_len -= head;
+    memmove(pcb->rx, pcb->rx + head, pcb->rx_len);
+    return status;
+}
+
+// Quadro entregue na hora; devolve o primeiro quadro da resposta (após web_server_poll, se pedido)
+static bool ws_exchange(sim_client_t *c, websocket_opcode_t opcode, const void *payload, size_t len,
+                        size_t split, bool poll, ws_in_frame_t *reply) {
+    if (!client_alive(c)) return false;
+    uint8_t frame[WEBSOCKET_MAX_CLIENT_FRAME + 8];
+    size_t frame_len = len <= WEBSOCKET_MAX_CLIENT_PAYLOAD ? ws_client_frame(frame, opcode, payload, len) : 0;
+    if (!frame_len) {
+        // Payload de 16 bits (proibido pelo servidor): só o cabeçalho interessa
+        frame[0] = (uint8_t)(0x80 | opcode);
+        frame[1] = 0x80 | 126;
+        frame[2] = (uint8_t)(len >> 8);
+        frame[3] = (uint8_t)len;
+        memset(frame + 4, 0, 8);
+        frame_len = 12;
+    }
+
+    struct tcp_pcb *pcb = c->pcb;
+    pcb->rx_len = 0;
+    // Quadro partido em dois segmentos TCP
+    if (split && split < frame_len) {
+        client_deliver(pcb, frame, split);
+        client_deliver(pcb, frame + split, frame_len - split);
+    } else {
+        client_deliver(pcb, frame, frame_len);
+    }
+    if (poll) web_server_poll();
+
+    size_t pos = 0;
+    return ws_client_next(pcb, &pos, reply);
+}
+
+static const char *check(bool ok) {
+    return ok ? "ok" : "FALHOU";
+}
+
+// Conformidade: handshake, ping, comando em dois segmentos, close e recusas
+static void run_ws_checks(void) {
+    sim_reset(SIM_POOL_MAX);
+    web_server_set_control_handler(bench_control);
+    sim_client_t login = { .keep_alive = true };
+    if (!client_login(&login)) {
+        printf("  login falhou\n");
+        return;
+    }
+    client_close(&login);
+
+    sim_client_t c = { .keep_alive = true };
+    strcpy(c.cookie, login.cookie);
+    bool accept_ok = false;
+    int status = ws_open(&c, "Sec-WebSocket-Key: " WS_KEY "\r\n", &accept_ok);
+    size_t pos = 0;
+    ws_in_frame_t f;
+    bool first = status == 101 && ws_client_next(c.pcb, &pos, &f) &&
+                 f.opcode == WEBSOCKET_OP_TEXT && ws_payload_has(&f, "\"version\":");
+
+    bool pong = ws_exchange(&c, WEBSOCKET_OP_PING, "abc", 3, 0, false, &f) &&
+                f.opcode == WEBSOCKET_OP_PONG && f.len == 3 && memcmp(f.payload, "abc", 3) == 0;
+    bool command = ws_exchange(&c, WEBSOCKET_OP_TEXT, "LED ON", 6, 3, true, &f) &&
+                   f.opcode == WEBSOCKET_OP_TEXT && ws_payload_has(&f, "\"ok\":true");
+    bool unknown = ws_exchange(&c, WEBSOCKET_OP_TEXT, "XYZ", 3, 0, true, &f) &&
+                   ws_payload_has(&f, "\"ok\":false");
+    static const uint8_t normal[2] = { 0x03, 0xE8 };    // 1000
+    bool closed = ws_exchange(&c, WEBSOCKET_OP_CLOSE, normal, 2, 0, false, &f) &&
+                  f.opcode == WEBSOCKET_OP_CLOSE && f.len == 2 && memcmp(f.payload, normal, 2) == 0 &&
+                  !client_alive(&c);
+
+    sim_client_t other = { .keep_alive = true };
+    strcpy(other.cookie, login.cookie);
+    int other_origin = ws_open(&other, "Origin: http://outro.exemplo\r\nSec-WebSocket-Key: " WS_KEY "\r\n", NULL);
+    client_close(&other);
+
+    sim_client_t keyless = { .keep_alive = true };
+    strcpy(keyless.cookie, login.cookie);
+    int no_key = ws_open(&keyless, "", NULL);
+    client_close(&keyless);
+
+    sim_client_t big = { .keep_alive = true };
+    strcpy(big.cookie, login.cookie);
+    ws_open(&big, "Sec-WebSocket-Key: " WS_KEY "\r\n", NULL);
+    bool too_big = ws_exchange(&big, WEBSOCKET_OP_TEXT, NULL, 300, 0, false, &f) &&
+                   f.opcode == WEBSOCKET_OP_CLOSE && f.len == 2 && f.payload[0] == 0x03 && f.payload[1] == 0xEA &&
+                   !client_alive(&big);
+
+    printf("  handshake=%d accept=%s primeira_amostra=%s ping/pong=%s comando_em_2_segmentos=%s comando_invalido=%s "
+           "close=%s outra_origem=%d sem_chave=%d quadro_grande=%s pbufs_vazados=%lu\n",
+           status, check(accept_ok), check(first), check(pong), check(command), check(unknown),
+           check(closed), other_origin, no_key, check(too_big), (unsigned long)s_stats.pbufs_leaked);
+}
+
+// Lê os quadros que chegaram ao cliente (o servidor escreveu agora; chegam em meio RTT)
+static void ws_client_read(ws_client_t *w, jitter_stats_t *telemetry, jitter_stats_t *command, uint32_t *acks_ok) {
+    if (!client_alive(&w->http)) return;
+    struct tcp_pcb *pcb = w->http.pcb;
+    uint64_t arrive_ms = now_ms() + s_rtt_ms / 2;
+    size_t pos = 0;
+    ws_in_frame_t f;
+    while (ws_client_next(pcb, &pos, &f)) {
+        if (f.opcode != WEBSOCKET_OP_TEXT) continue;
+        if (ws_payload_has(&f, "\"ok\":")) {
+            if (w->cmd_sent_ms) {
+                jitter_stats_add(command, (uint32_t)(arrive_ms - w->cmd_sent_ms) * 1000u);
+                w->cmd_sent_ms = 0;
+            }
+            if (ws_payload_has(&f, "\"ok\":true")) (*acks_ok)++;
+            continue;
+        }
+
+        char buf[256];
+        size_t n = f.len < sizeof(buf) - 1 ? f.len : sizeof(buf) - 1;
+        memcpy(buf, f.payload, n);
+        buf[n] = '\0';
+        const char *version = strstr(buf, "\"version\":");
+        if (!version) continue;
+        uint32_t v = (uint32_t)strtoul(version + 10, NULL, 10);
+        // Um quadro entrega todas as versões publicadas desde o anterior
+        for (uint32_t pending = w->seen + 1; pending <= v; pending++) {
+            uint64_t commit_ms = s_commit_ms[pending % VIEW_VERSION_RING];
+            if (commit_ms) jitter_stats_add(telemetry, (uint32_t)(arrive_ms - commit_ms) * 1000u);
+        }
+        if (v > w->seen) w->seen = v;
+    }
+    s_rx_bytes += pcb->rx_len;
+    pcb->rx_len = 0;
+}
+
+static void print_percentiles(const char *label, const jitter_stats_t *js) {
+    printf(" %s p50/p90/p99=%.0f/%.0f/%.0fms max=%lums",
+           label,
+           jitter_stats_percentile_us(js, 500) / 1000.0,
+           jitter_stats_percentile_us(js, 900) / 1000.0,
+           jitter_stats_percentile_us(js, 990) / 1000.0,
+           (unsigned long)(js->max_us / 1000u));
+}
+
+static void run_websocket(uint32_t clients) {
+    sim_reset(SIM_POOL_MAX);
+    reset_counters();
+    s_air_bytes = 0;
+    web_server_set_control_handler(bench_control);
+
+    sim_client_t login = { .keep_alive = true };
+    if (!client_login(&login)) {
+        printf("  login falhou\n");
+        return;
+    }
+    client_close(&login);
+
+    static ws_client_t ws[VIEW_MAX];
+    uint32_t opened = 0;
+    for (uint32_t i = 0; i < clients; i++) {
+        ws[i] = (ws_client_t){ .http = { .keep_alive = true } };
+        strcpy(ws[i].http.cookie, login.cookie);
+        if (ws_open(&ws[i].http, "Sec-WebSocket-Key: " WS_KEY "\r\n", NULL) == 101) opened++;
+        // A amostra atual veio junto com o 101
+        ws[i].seen = sensor_data_version();
+        if (client_alive(&ws[i].http)) ws[i].http.pcb->rx_len = 0;
+    }
+
+    // Relógio já avançou com os handshakes
+    uint64_t start = now_ms();
+    for (uint32_t i = 0; i < clients; i++) {
+        ws[i].next_cmd_ms = start + 250 + i * WS_CMD_PHASE_MS;
+    }
+
+    jitter_stats_t telemetry, command;
+    jitter_stats_reset(&telemetry);
+    jitter_stats_reset(&command);
+    uint32_t acks_ok = 0, lost = 0, sent = 0;
+    uint32_t commands_start = web_server_get_ws_command_count();
+    uint32_t drops_start = web_server_get_ws_dropped_count();
+    uint64_t air_start = s_air_bytes;
+    uint64_t cpu_start = s_cpu_ns;
+    uint64_t next_lux = start + VIEW_LUX_MS - VIEW_PHASE_MS;
+    uint64_t next_temp = start + VIEW_TEMP_MS - VIEW_PHASE_MS;
+    int32_t lux = 12000, temp = 2150;
+
+    // Passo de 1 ms: amostras, comandos e passadas da task_web nos seus instantes exatos
+    for (uint64_t t = start + 1; t <= start + VIEW_DURATION_S * 1000u; t++) {
+        sim_advance_ms(1);
+
+        if (t >= next_lux) {
+            commit_lux(lux += 37);
+            next_lux += VIEW_LUX_MS + WS_DRIFT_MS;
+        }
+        if (t >= next_temp) {
+            commit_temp(temp += 3);
+            next_temp += VIEW_TEMP_MS + WS_DRIFT_MS;
+        }
+
+        for (uint32_t i = 0; i < clients; i++) {
+            ws_client_t *w = &ws[i];
+            if (!client_alive(&w->http)) continue;
+            if (w->cmd_sent_ms && t - w->cmd_sent_ms > WS_CMD_LOST_MS) {
+                lost++;
+                w->cmd_sent_ms = 0;
+            }
+            if (!w->cmd_sent_ms && t >= w->next_cmd_ms) {
+                const char *cmd = (w->cmd_sent++ & 1) ? "LED OFF" : "LED ON";
+                w->out_len = ws_client_frame(w->out, WEBSOCKET_OP_TEXT, cmd, strlen(cmd));
+                w->cmd_sent_ms = t;
+                w->cmd_arrive_ms = t + s_rtt_ms / 2;
+                w->next_cmd_ms += WS_CMD_PERIOD_MS + WS_DRIFT_MS;
+                sent++;
+            }
+            if (w->out_len && t >= w->cmd_arrive_ms) {
+                client_deliver(w->http.pcb, w->out, w->out_len);
+                w->out_len = 0;
+            }
+        }
+
+        // task_web: comandos pendentes e um quadro por amostra nova, para todos
+        if ((t - start) % VIEW_TASK_MS == 0) {
+            uint64_t t0 = host_ns();
+            web_server_poll();
+            s_cpu_ns += host_ns() - t0;
+        }
+
+        for (uint32_t i = 0; i < clients; i++) {
+            ws_client_read(&ws[i], &telemetry, &command, &acks_ok);
+        }
+    }
+
+    uint32_t still_open = 0;
+    for (uint32_t i = 0; i < clients; i++) {
+        if (client_alive(&ws[i].http)) still_open++;
+        client_close(&ws[i].http);
+    }
+    double per_client_s = (double)clients * VIEW_DURATION_S;
+    printf("  ws clientes=%-2lu abertos=%lu/%lu", (unsigned long)clients,
+           (unsigned long)still_open, (unsigned long)opened);
+    print_percentiles("amostra->cliente", &telemetry);
+    print_percentiles("comando->resposta", &command);
+    printf("\n  %-5s comandos=%lu/%lu ok=%lu perdidos=%lu descartados=%lu bytes_no_ar/s/cliente=%.0f cpu_host/s/cliente=%.1fus\n",
+           "",
+           (unsigned long)(web_server_get_ws_command_count() - commands_start), (unsigned long)sent,
+           (unsigned long)acks_ok, (unsigned long)lost,
+           (unsigned long)(web_server_get_ws_dropped_count() - drops_start),
+           (double)(s_air_bytes - air_start) / per_client_s,
+           (double)(s_cpu_ns - cpu_start) / per_client_s / 1000.0);
+}
+
+// ============= CARGA PARALELA: NAVEGADORES E CLIENTES LENTOS =============
+
+#define PAR_DURATION_S      30
+#define PAR_TICK_MS         2
+#define PAR_POLL_MS         500     // Navegador: GET /data a cada 500 ms
+#define PAR_GIVE_UP_MS      10000   // Sem resposta completa nesse tempo: desiste
+#define PAR_FAST_LINK       1000    // bytes/ms (~8 Mbit/s)
+#define PAR_SLOW_LINK       4       // bytes/ms (~4 KB/s): raspador num enlace ruim
+
+typedef struct {
+    sim_client_t c;
+    bool slow;              // Raspador: GET / em sequência, no enlace lento
+    bool waiting;
+    uint64_t sent_ms;
+    uint64_t next_ms;
+} par_client_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t ok;
+    uint32_t lost;          // Conexão caiu ou desistência antes da resposta
+    uint32_t no_conn;       // Conexão recusada (RST ou sem PCB)
+} par_stats_t;
+
+// Resposta inteira no cliente: cabeçalhos, corpo do Content-Length e nada na fila de envio
+static bool par_response_complete(struct tcp_pcb *pcb) {
+    if (pcb->rx_len == 0 || pcb->unacked) return false;
+    pcb->rx[pcb->rx_len] = '\0';
+    const char *blank = strstr(pcb->rx, "\r\n\r\n");
+    const char *length = strstr(pcb->rx, "Content-Length: ");
+    if (!blank) return false;
+    size_t head = (size_t)(blank + 4 - pcb->rx);
+    return !length || length > blank || pcb->rx_len >= head + (size_t)atoi(length + 16);
+}
+
+static void par_step(par_client_t *p, par_stats_t *st, jitter_stats_t *latency, uint32_t *pages) {
+    sim_client_t *c = &p->c;
+    uint64_t now = now_ms();
+
+    if (p->waiting) {
+        struct tcp_pcb *pcb = c->pcb;
+        bool same = pcb && pcb->id == c->id && pcb->state != PCB_FREE;
+        if (same && par_response_complete(pcb)) {
+            sim_response_t r = { 0 };
+            parse_response(c, &r);
+            if (r.status == 200) {
+                st->ok++;
+                if (p->slow) (*pages)++;
+                // Ida da requisição e volta do último ACK: um RTT fora do relógio do enlace
+                jitter_stats_add(latency, (uint32_t)((now - p->sent_ms + s_rtt_ms) * 1000u));
+            }
+            p->waiting = false;
+            p->next_ms = p->slow ? now : p->sent_ms + PAR_POLL_MS;
+        } else if (!same || pcb->state != PCB_ESTABLISHED || now - p->sent_ms >= PAR_GIVE_UP_MS) {
+            st->lost++;
+            client_close(c);
+            c->pcb = NULL;
+            p->waiting = false;
+            p->next_ms = now + PAR_POLL_MS;
+        }
+        return;
+    }
+
+    if (now < p->next_ms) return;
+    if (!client_alive(c)) {
+        if (!client_open(c)) {
+            st->no_conn++;
+            c->pcb = NULL;
+            p->next_ms = now + PAR_POLL_MS;
+            return;
+        }
+        c->pcb->link_bytes_per_ms = p->slow ? PAR_SLOW_LINK : PAR_FAST_LINK;
+    }
+    st->sent++;
+    p->waiting = true;
+    p->sent_ms = now;
+    client_send(c, "GET", p->slow ? "/" : "/data", "");
+}
+
+static void run_parallel(uint32_t browsers, uint32_t scrapers) {
+    sim_reset(SIM_POOL_MAX);
+    sim_client_t login = { .keep_alive = true };
+    if (!client_login(&login)) {
+        printf("  login falhou\n");
+        return;
+    }
+    client_close(&login);
+    reset_counters();
+    s_bad_length = 0;
+    s_heap_limit = SIM_MEM_SIZE;
+
+    static par_client_t clients[SIM_POOL_MAX];
+    uint32_t total = browsers + scrapers;
+    for (uint32_t i = 0; i < total; i++) {
+        clients[i] = (par_client_t){ .c = { .keep_alive = true }, .slow = i >= browsers };
+        strcpy(clients[i].c.cookie, login.cookie);
+        // Navegadores defasados entre si dentro do ciclo de 500 ms
+        clients[i].next_ms = now_ms() + (clients[i].slow ? 0 : i * PAR_POLL_MS / browsers);
+    }
+
+    static jitter_stats_t latency;
+    jitter_stats_reset(&latency);
+    par_stats_t fast = { 0 }, slow = { 0 };
+    uint32_t pages = 0, pending_peak = 0, active_peak = 0;
+    uint32_t refused_start = web_server_get_refused_count();
+    uint32_t deferred_start = web_server_get_deferred_count();
+    uint64_t end = now_ms() + PAR_DURATION_S * 1000u;
+
+    while (now_ms() < end) {
+        sim_advance_ms(PAR_TICK_MS);
+        sim_ack(PAR_TICK_MS);
+        for (uint32_t i = 0; i < total; i++) {
+            if (clients[i].slow) {
+                static jitter_stats_t ignored;
+                par_step(&clients[i], &slow, &ignored, &pages);
+            } else {
+                par_step(&clients[i], &fast, &latency, &pages);
+            }
+        }
+        uint32_t pending = web_server_get_pending_responses();
+        if (pending > pending_peak) pending_peak = pending;
+        uint32_t active = web_server_get_active_connections();
+        if (active > active_peak) active_peak = active;
+    }
+
+    for (uint32_t i = 0; i < total; i++) {
+        client_close(&clients[i].c);
+    }
+    sim_ack(PAR_GIVE_UP_MS);
+
+    printf("  navegadores=%-2lu lentos=%-2lu /data ok=%lu/%lu perdidas=%lu sem_conexao=%lu",
+           (unsigned long)browsers, (unsigned long)scrapers,
+           (unsigned long)fast.ok, (unsigned long)fast.sent,
+           (unsigned long)fast.lost, (unsigned long)fast.no_conn);
+    print_percentiles("latencia", &latency);
+    printf(" paginas_lentas=%lu/%lu\n", (unsigned long)pages, (unsigned long)slow.sent);
+    printf("      pico_conexoes=%lu/%d recusadas=%lu esperas=%lu respostas_pendentes_pico=%lu/%d heap_pico=%lu/%d "
+           "err_mem=%lu content_length_errado=%lu pbufs_vazados=%lu\n",
+           (unsigned long)active_peak, WEB_SERVER_MAX_CONNECTIONS,
+           (unsigned long)(web_server_get_refused_count() - refused_start),
+           (unsigned long)(web_server_get_deferred_count() - deferred_start),
+           (unsigned long)pending_peak, WEB_SERVER_RESPONSE_BUFFERS,
+           (unsigned long)s_heap_peak, SIM_MEM_SIZE,
+           (unsigned long)s_heap_refused, (unsigned long)s_bad_length,
+           (unsigned long)s_stats.pbufs_leaked);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) s_rtt_ms = (uint32_t)strtoul(argv[1], NULL, 10);
+    if (s_rtt_ms == 0) s_rtt_ms = 8;
+
+    sensor_data_init();
+    publish_sample(2150);
+
+    printf("RTT=%lums, pool de %d PCBs, TIME_WAIT=%ds, WEB_SERVER_MAX_CONNECTIONS=%d, timeout=%ds\n",
+           (unsigned long)s_rtt_ms, SIM_MEMP_NUM_TCP_PCB, SIM_TIME_WAIT_MS / 1000,
+           WEB_SERVER_MAX_CONNECTIONS, WEB_SERVER_TIMEOUT_S);
+
+    printf("rajada: 500 GET /data seguidos\n");
+    run_burst(false, 500);
+    run_burst(true, 500);
+
+    printf("painel: GET /data?since= a cada 500 ms por 120 s\n");
+    run_dashboard(false, 120);
+    run_dashboard(true, 120);
+
+    printf("limite de conexoes\n");
+    run_limit(WEB_SERVER_MAX_CONNECTIONS + 2);
+
+    printf("espectadores: %ds de painel aberto, pool de %d PCBs\n", VIEW_DURATION_S, SIM_POOL_MAX);
+    static const uint32_t tabs[] = { 1, 4, 16 };
+    for (size_t i = 0; i < sizeof(tabs) / sizeof(tabs[0]); i++) {
+        run_viewers(false, tabs[i]);
+        run_viewers(true, tabs[i]);
+    }
+
+    printf("websocket: conformidade\n");
+    run_ws_checks();
+    printf("websocket: %ds, amostras como acima e um comando LED por segundo por cliente\n", VIEW_DURATION_S);
+    for (size_t i = 0; i < sizeof(tabs) / sizeof(tabs[0]); i++) {
+        run_websocket(tabs[i]);
+    }
+
+    printf("carga paralela: %ds, navegadores com GET /data a cada 500 ms e clientes lentos (%d KB/s) com GET / "
+           "em sequencia, heap do lwIP de %d bytes\n", PAR_DURATION_S, PAR_SLOW_LINK, SIM_MEM_SIZE);
+    static const uint32_t mix[][2] = { { 4, 0 }, { 4, 1 }, { 4, 2 }, { 4, 4 }, { 4, 8 }, { 4, 16 } };
+    for (size_t i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+        run_parallel(mix[i][0], mix[i][1]);
+    }
+    return 0;
+}
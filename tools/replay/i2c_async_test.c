@@ -0,0 +1,440 @@
+/*
+ * Fila de transações I2C (i2c_async.c) contra um backend simulado
+ *
+ * Compila a fila do firmware com USE_FREERTOS e troca o backend de DMA
+ * (i2c_async_dma.c) por dois barramentos simulados, com o tempo de cada
+ * transferência avançando um relógio virtual. A "interrupção" de fim de
+ * transferência roda quando uma task bloqueia na notificação, como no
+ * firmware. Dispositivos simulados:
+ *
+ *   0x38, 0x3C  respondem (AHT10, SSD1306)
+ *   0x55        NACK: a transação termina com erro
+ *   0x66        trava o barramento: a transação nunca termina
+ *
+ * Casos (saída com código 1 se algum falhar):
+ *   antes       antes do scheduler iniciar, ou com o barramento sem
+ *               i2c_async_init, o acesso cai no bloqueante do SDK
+ *   fifo        transações de várias tasks saem na ordem de submissão em
+ *               cada barramento, com I2C0 e I2C1 em paralelo
+ *   cheia       a fila recusa além de I2C_ASYNC_QUEUE_LEN pendentes
+ *   cancela     transação na fila é removida sem tocar no barramento; a
+ *               em andamento é abortada e a seguinte começa em seguida
+ *   timeout     acesso a um dispositivo travado desiste em
+ *               I2C_ASYNC_TIMEOUT_MS e o barramento segue utilizável
+ *   nack        erro do dispositivo chega ao chamador e às estatísticas
+ *   notificacao notificação antiga (de um timeout anterior) não conclui
+ *               a transação seguinte antes da hora
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -DUSE_FREERTOS=1 -Itools/replay/host -Iinclude -Idrivers \
+ *       tools/replay/i2c_async_test.c drivers/i2c_async.c drivers/sensor_trace.c \
+ *       -o i2c_async_test
+ *
+ * Uso:
+ *   ./i2c_async_test
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "i2c_async.h"
+#include "i2c_async_backend.h"
+
+#define SIM_ADDR_NACK 0x55
+#define SIM_ADDR_HUNG 0x66
+
+#define SIM_MAX_LOG 64
+
+// ============= RELÓGIO E TASKS =============
+
+static uint64_t g_now_us;
+
+absolute_time_t get_absolute_time(void) { return g_now_us; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return g_now_us; }
+uint32_t time_us_32(void) { return (uint32_t)g_now_us; }
+void sleep_us(uint64_t us) { g_now_us += us; }
+void sleep_ms(uint32_t ms) { g_now_us += (uint64_t)ms * 1000u; }
+
+struct replay_task {
+    const char *name;
+    uint32_t notify;
+};
+
+static struct replay_task g_tasks[3] = { { "sensores", 0 }, { "display", 0 }, { "uart", 0 } };
+static TaskHandle_t g_current = &g_tasks[0];
+static BaseType_t g_scheduler_state = taskSCHEDULER_NOT_STARTED;
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return g_current; }
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(g_now_us / 1000u); }
+BaseType_t xTaskGetSchedulerState(void) { return g_scheduler_state; }
+
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t task, UBaseType_t index, BaseType_t *higher_priority_woken) {
+    (void)index;
+    task->notify++;
+    *higher_priority_woken = pdTRUE;
+}
+
+// ============= BARRAMENTO SIMULADO =============
+
+typedef struct {
+    const i2c_async_txn_t *txn;
+    uint8_t bus;
+} log_entry_t;
+
+struct replay_i2c_bus {
+    uint index;
+    uint32_t hz;
+    const i2c_async_txn_t *active;
+    uint64_t done_at_us;
+    bool ok;
+    uint32_t aborts;
+    uint32_t idles;
+};
+
+static struct replay_i2c_bus g_bus[2] = {
+    { .index = 0, .hz = 100000 },
+    { .index = 1, .hz = 400000 },
+};
+i2c_inst_t *const i2c0 = &g_bus[0];
+i2c_inst_t *const i2c1 = &g_bus[1];
+
+static log_entry_t g_started[SIM_MAX_LOG];
+static size_t g_started_count;
+static log_entry_t g_finished[SIM_MAX_LOG];
+static size_t g_finished_count;
+static uint32_t g_blocking_calls;
+
+uint i2c_get_index(i2c_inst_t *i2c) {
+    return i2c->index;
+}
+
+// Endereço + dados, 9 bits por byte, mais START/STOP
+static uint64_t transfer_us(const struct replay_i2c_bus *bus, size_t len) {
+    return ((uint64_t)(len + 1) * 9u * 1000000u + bus->hz - 1) / bus->hz + 10u;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)src;
+    (void)nostop;
+    g_blocking_calls++;
+    g_now_us += transfer_us(i2c, len);
+    return addr == SIM_ADDR_NACK || addr == SIM_ADDR_HUNG ? PICO_ERROR_GENERIC : (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)nostop;
+    g_blocking_calls++;
+    g_now_us += transfer_us(i2c, len);
+    memset(dst, 0xA5, len);
+    return addr == SIM_ADDR_NACK || addr == SIM_ADDR_HUNG ? PICO_ERROR_GENERIC : (int)len;
+}
+
+bool i2c_async_backend_init(i2c_inst_t *i2c) {
+    i2c->active = NULL;
+    return true;
+}
+
+void i2c_async_backend_start(i2c_inst_t *i2c, const i2c_async_txn_t *txn) {
+    if (i2c->active) {
+        printf("FALHOU: duas transacoes ao mesmo tempo no barramento %u\n", i2c->index);
+    }
+    i2c->active = txn;
+    i2c->ok = txn->address != SIM_ADDR_NACK;
+    i2c->done_at_us = txn->address == SIM_ADDR_HUNG ? UINT64_MAX
+                    : g_now_us + transfer_us(i2c, txn->tx_len + txn->rx_len);
+    if (g_started_count < SIM_MAX_LOG) {
+        g_started[g_started_count++] = (log_entry_t){ txn, (uint8_t)i2c->index };
+    }
+}
+
+void i2c_async_backend_abort(i2c_inst_t *i2c) {
+    i2c->active = NULL;
+    i2c->aborts++;
+}
+
+void i2c_async_backend_idle(i2c_inst_t *i2c) {
+    i2c->idles++;
+}
+
+// Avança o relógio até o instante dado, disparando as interrupções de fim
+// de transferência no caminho; para antes se a task tiver notificação
+static void advance(uint64_t until_us, TaskHandle_t wake) {
+    for (;;) {
+        if (wake && wake->notify > 0) return;
+
+        struct replay_i2c_bus *next = NULL;
+        for (int b = 0; b < 2; b++) {
+            struct replay_i2c_bus *bus = &g_bus[b];
+            if (bus->active && bus->done_at_us <= until_us &&
+                (!next || bus->done_at_us < next->done_at_us)) {
+                next = bus;
+            }
+        }
+        if (!next) break;
+
+        if (next->done_at_us > g_now_us) g_now_us = next->done_at_us;
+        const i2c_async_txn_t *txn = next->active;
+        next->active = NULL;
+        if (g_finished_count < SIM_MAX_LOG) {
+            g_finished[g_finished_count++] = (log_entry_t){ txn, (uint8_t)next->index };
+        }
+        i2c_async_backend_done(next, next->ok);
+    }
+    if (until_us != UINT64_MAX && until_us > g_now_us) g_now_us = until_us;
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t index, BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    (void)index;
+    TaskHandle_t task = g_current;
+    if (task->notify == 0 && ticks_to_wait > 0) {
+        advance(g_now_us + (uint64_t)ticks_to_wait * 1000u, task);
+    }
+
+    uint32_t value = task->notify;
+    if (value > 0) {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+static void reset(void) {
+    g_now_us = 0;
+    g_started_count = 0;
+    g_finished_count = 0;
+    g_blocking_calls = 0;
+    for (int t = 0; t < 3; t++) g_tasks[t].notify = 0;
+    g_current = &g_tasks[0];
+}
+
+// ============= CASOS =============
+
+static bool g_failed;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FALHOU: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static i2c_async_txn_t make_txn(uint8_t addr, const uint8_t *tx, size_t tx_len, TaskHandle_t owner) {
+    return (i2c_async_txn_t){ .address = addr, .tx = tx, .tx_len = tx_len, .owner = owner };
+}
+
+static void case_before_scheduler(void) {
+    static const uint8_t cmd[3] = { 0xAC, 0x33, 0x00 };
+    reset();
+
+    // I2C1 ainda sem init: bloqueante, sem estatísticas
+    int r1 = i2c_async_write(i2c1, 0x3C, cmd, sizeof(cmd));
+    i2c_async_stats_t st1;
+    bool has_stats = i2c_async_get_stats(i2c1, &st1);
+
+    i2c_async_init(i2c0);
+    i2c_async_init(i2c1);
+
+    // Inicializado, mas o scheduler ainda não rodou (init dos sensores)
+    g_scheduler_state = taskSCHEDULER_NOT_STARTED;
+    int r0 = i2c_async_write(i2c0, 0x38, cmd, sizeof(cmd));
+    i2c_async_stats_t st0;
+    i2c_async_get_stats(i2c0, &st0);
+
+    printf("antes      bloqueantes=%u pela_fila=%zu fallback_i2c0=%u\n", g_blocking_calls, g_started_count,
+           st0.fallback_blocking);
+    check(r1 == 3 && r0 == 3, "antes: resultado do acesso bloqueante");
+    check(!has_stats, "antes: barramento sem init nao tem estatisticas");
+    check(g_blocking_calls == 2 && g_started_count == 0, "antes: acessos bloqueantes, nenhum pela fila");
+    check(st0.fallback_blocking == 1 && st0.submitted == 0, "antes: fallback contado");
+
+    g_scheduler_state = taskSCHEDULER_RUNNING;
+}
+
+static void case_fifo(void) {
+    static const uint8_t data[16] = { 0 };
+    i2c_async_txn_t t0[6], t1[3];
+    reset();
+
+    // Sensores e UART no I2C0, display no I2C1
+    for (int i = 0; i < 6; i++) {
+        t0[i] = make_txn(0x38, data, 2 + (size_t)i, &g_tasks[i % 2 == 0 ? 0 : 2]);
+        check(i2c_async_submit(i2c0, &t0[i]), "fifo: submissao no i2c0");
+    }
+    for (int i = 0; i < 3; i++) {
+        t1[i] = make_txn(0x3C, data, 16, &g_tasks[1]);
+        check(i2c_async_submit(i2c1, &t1[i]), "fifo: submissao no i2c1");
+    }
+    uint64_t serial_us = 0;
+    for (int i = 0; i < 6; i++) serial_us += transfer_us(&g_bus[0], t0[i].tx_len);
+    for (int i = 0; i < 3; i++) serial_us += transfer_us(&g_bus[1], t1[i].tx_len);
+
+    advance(UINT64_MAX, NULL);
+
+    bool order_ok = g_finished_count == 9;
+    size_t n0 = 0, n1 = 0;
+    for (size_t i = 0; i < g_finished_count; i++) {
+        const log_entry_t *e = &g_finished[i];
+        if (e->bus == 0) order_ok = order_ok && n0 < 6 && e->txn == &t0[n0++];
+        else order_ok = order_ok && n1 < 3 && e->txn == &t1[n1++];
+    }
+    bool all_done = true;
+    for (int i = 0; i < 6; i++) all_done = all_done && t0[i].done && t0[i].result == (int)t0[i].tx_len;
+    for (int i = 0; i < 3; i++) all_done = all_done && t1[i].done && t1[i].result == 16;
+
+    i2c_async_stats_t st;
+    i2c_async_get_stats(i2c0, &st);
+    printf("fifo       concluidas=%zu ordem=%s tempo=%lluus serial=%lluus profundidade_max_i2c0=%u "
+           "notif_sensores=%u notif_display=%u notif_uart=%u\n",
+           g_finished_count, order_ok ? "ok" : "ERRADA", (unsigned long long)g_now_us,
+           (unsigned long long)serial_us, st.max_depth, g_tasks[0].notify, g_tasks[1].notify, g_tasks[2].notify);
+
+    check(order_ok, "fifo: ordem de submissao por barramento");
+    check(all_done, "fifo: todas concluidas com o tamanho transferido");
+    check(g_now_us < serial_us, "fifo: i2c0 e i2c1 em paralelo");
+    check(st.max_depth == 5, "fifo: profundidade maxima");
+    check(g_tasks[0].notify == 3 && g_tasks[1].notify == 3 && g_tasks[2].notify == 3,
+          "fifo: cada dona notificada pelas suas transacoes");
+}
+
+static void case_queue_full(void) {
+    static const uint8_t data[4] = { 0 };
+    i2c_async_txn_t txn[I2C_ASYNC_QUEUE_LEN + 2];
+    reset();
+
+    i2c_async_stats_t before, after;
+    i2c_async_get_stats(i2c0, &before);
+
+    int accepted = 0;
+    for (int i = 0; i < I2C_ASYNC_QUEUE_LEN + 2; i++) {
+        txn[i] = make_txn(0x38, data, sizeof(data), &g_tasks[0]);
+        if (i2c_async_submit(i2c0, &txn[i])) accepted++;
+    }
+    advance(UINT64_MAX, NULL);
+    i2c_async_get_stats(i2c0, &after);
+
+    printf("cheia      aceitas=%d recusadas=%u\n", accepted, after.queue_full - before.queue_full);
+    check(accepted == I2C_ASYNC_QUEUE_LEN + 1, "cheia: uma em andamento mais a fila");
+    check(after.queue_full - before.queue_full == 1, "cheia: recusa contada");
+    check(!txn[I2C_ASYNC_QUEUE_LEN + 1].done, "cheia: recusada nao conclui");
+}
+
+static void case_cancel(void) {
+    static const uint8_t data[4] = { 0 };
+    reset();
+
+    i2c_async_stats_t before, after;
+    i2c_async_get_stats(i2c0, &before);
+    uint32_t aborts = g_bus[0].aborts;
+
+    // Na fila: removida sem passar pelo barramento
+    i2c_async_txn_t a = make_txn(0x38, data, 4, &g_tasks[0]);
+    i2c_async_txn_t b = make_txn(0x38, data, 4, &g_tasks[1]);
+    i2c_async_txn_t c = make_txn(0x38, data, 4, &g_tasks[2]);
+    i2c_async_submit(i2c0, &a);
+    i2c_async_submit(i2c0, &b);
+    i2c_async_submit(i2c0, &c);
+    bool cancel_queued = i2c_async_cancel(i2c0, &b);
+    advance(UINT64_MAX, NULL);
+    bool order = g_finished_count == 2 && g_finished[0].txn == &a && g_finished[1].txn == &c;
+    bool cancel_done = i2c_async_cancel(i2c0, &a);
+
+    // Em andamento (dispositivo travado): abortada, a seguinte começa já
+    i2c_async_txn_t h = make_txn(SIM_ADDR_HUNG, data, 4, &g_tasks[0]);
+    i2c_async_txn_t d = make_txn(0x38, data, 4, &g_tasks[1]);
+    i2c_async_submit(i2c0, &h);
+    i2c_async_submit(i2c0, &d);
+    size_t started_before = g_started_count;
+    bool cancel_current = i2c_async_cancel(i2c0, &h);
+    bool next_started = g_started_count == started_before + 1 && g_started[started_before].txn == &d;
+    advance(UINT64_MAX, NULL);
+    i2c_async_get_stats(i2c0, &after);
+
+    printf("cancela    fila=%s concluida=%s andamento=%s seguinte=%s abortos=%u\n",
+           cancel_queued ? "removida" : "FALHOU", cancel_done ? "REMOVIDA" : "ignorada",
+           cancel_current ? "abortada" : "FALHOU", next_started ? "iniciada" : "PARADA",
+           g_bus[0].aborts - aborts);
+
+    check(cancel_queued && b.done && b.result == PICO_ERROR_GENERIC, "cancela: fila");
+    check(order, "cancela: restantes na ordem, removida nunca iniciada");
+    check(!cancel_done, "cancela: transacao ja concluida nao e removida");
+    check(cancel_current && h.done && h.result == PICO_ERROR_GENERIC, "cancela: em andamento");
+    check(g_bus[0].aborts - aborts == 1, "cancela: backend abortado uma vez");
+    check(next_started && d.done && d.result == 4, "cancela: seguinte iniciada e concluida");
+    check(after.timeouts - before.timeouts == 2, "cancela: cancelamentos contados");
+}
+
+static void case_timeout(void) {
+    static const uint8_t cmd[3] = { 0xAC, 0x33, 0x00 };
+    reset();
+
+    i2c_async_stats_t before, after;
+    i2c_async_get_stats(i2c0, &before);
+
+    uint64_t start = g_now_us;
+    int hung = i2c_async_write(i2c0, SIM_ADDR_HUNG, cmd, sizeof(cmd));
+    uint64_t waited_us = g_now_us - start;
+
+    // O barramento segue utilizável depois do cancelamento
+    uint8_t buf[6];
+    int ok = i2c_async_read(i2c0, 0x38, buf, sizeof(buf));
+    i2c_async_get_stats(i2c0, &after);
+
+    printf("timeout    resultado=%d espera=%llums depois=%d timeouts=%u\n", hung,
+           (unsigned long long)(waited_us / 1000u), ok, after.timeouts - before.timeouts);
+    check(hung == PICO_ERROR_GENERIC, "timeout: erro ao chamador");
+    check(waited_us == I2C_ASYNC_TIMEOUT_MS * 1000u, "timeout: espera de I2C_ASYNC_TIMEOUT_MS");
+    check(after.timeouts - before.timeouts == 1, "timeout: contado");
+    check(ok == 6 && g_bus[0].active == NULL, "timeout: barramento liberado");
+}
+
+static void case_nack(void) {
+    uint8_t buf[2];
+    reset();
+
+    i2c_async_stats_t before, after;
+    i2c_async_get_stats(i2c1, &before);
+    int r = i2c_async_read(i2c1, SIM_ADDR_NACK, buf, sizeof(buf));
+    i2c_async_get_stats(i2c1, &after);
+
+    printf("nack       resultado=%d erros=%u\n", r, after.errors - before.errors);
+    check(r == PICO_ERROR_GENERIC, "nack: erro ao chamador");
+    check(after.errors - before.errors == 1 && after.completed - before.completed == 1, "nack: contado");
+}
+
+static void case_stale_notification(void) {
+    static const uint8_t data[32] = { 0 };
+    reset();
+
+    // Conclusão que chegou depois de a task desistir de uma transação
+    g_tasks[0].notify = 1;
+    uint64_t start = g_now_us;
+    int r = i2c_async_write(i2c0, 0x3C, data, sizeof(data));
+    uint64_t took_us = g_now_us - start;
+
+    printf("notificacao resultado=%d duracao=%lluus transferencia=%lluus\n", r, (unsigned long long)took_us,
+           (unsigned long long)transfer_us(&g_bus[0], sizeof(data)));
+    check(r == (int)sizeof(data), "notificacao: resultado da transacao nova");
+    check(took_us >= transfer_us(&g_bus[0], sizeof(data)), "notificacao: nao conclui antes da hora");
+}
+
+int main(void) {
+    case_before_scheduler();
+    case_fifo();
+    case_queue_full();
+    case_cancel();
+    case_timeout();
+    case_nack();
+    case_stale_notification();
+
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * Vazão de sensores atrás de multiplexadores TCA9548A, num barramento simulado
+ *
+ * Simula I2C0 (100 kHz) e I2C1 (400 kHz), cada um com um TCA9548A em 0x70
+ * e AHT10/BH1750 nos canais, com o tempo de cada transferência e de cada
+ * conversão avançando um relógio virtual. Os drivers reais (tca9548a,
+ * aht10, bh1750) e o mesmo registro/escalonador do firmware leem os
+ * sensores de três formas, e o resultado é a vazão em leituras por segundo:
+ *
+ *   sequencial  seleciona o canal e lê cada sensor de forma bloqueante
+ *   escalonado  disparos sobrepostos pelo escalonador, sem rotas
+ *   rotas       idem, atendendo primeiro os sensores do canal já selecionado
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -DSENSOR_SCHED_MAX_ENTRIES=32 -DSENSOR_REGISTRY_MAX_METRICS=64 \
+ *       -Itools/replay/host -Iinclude -Idrivers \
+ *       tools/replay/mux_bench.c drivers/tca9548a.c drivers/aht10.c drivers/bh1750.c \
+ *       src/sensor_registry.c src/sensor_health.c src/sensor_scheduler.c src/jitter_stats.c \
+ *       -o mux_bench
+ *
+ * Uso:
+ *   ./mux_bench [segundos simulados por rodada, padrão 60]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "aht10.h"
+#include "bh1750.h"
+#include "sensor_registry.h"
+#include "tca9548a.h"
+
+#define SIM_BUSES 2
+#define SIM_MAX_SENSORS (SIM_BUSES * TCA9548A_CHANNELS * 2)
+
+// Conversão real do AHT10 (o driver espera AHT10_MEASUREMENT_TIME_MS)
+#define SIM_AHT10_CONVERSION_US 75000u
+
+// Modo contínuo do BH1750 em alta resolução
+#define SIM_BH1750_PERIOD_MS 120
+
+// ============= BARRAMENTO SIMULADO =============
+
+typedef struct {
+    bool aht10;
+    bool bh1750;
+    uint64_t aht10_busy_until_us;
+} sim_channel_t;
+
+struct replay_i2c_bus {
+    uint index;
+    uint32_t hz;
+    uint8_t mux_mask;
+    sim_channel_t channels[TCA9548A_CHANNELS];
+    uint64_t busy_us;         // Tempo total ocupado com transferências
+    uint32_t collisions;      // Dois dispositivos respondendo no mesmo endereço
+};
+
+static struct replay_i2c_bus g_bus[SIM_BUSES] = {
+    { .index = 0, .hz = 100000 },
+    { .index = 1, .hz = 400000 },
+};
+i2c_inst_t *const i2c0 = &g_bus[0];
+i2c_inst_t *const i2c1 = &g_bus[1];
+
+static uint64_t g_now_us;
+
+absolute_time_t get_absolute_time(void) { return g_now_us; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return g_now_us; }
+uint32_t time_us_32(void) { return (uint32_t)g_now_us; }
+void sleep_us(uint64_t us) { g_now_us += us; }
+void sleep_ms(uint32_t ms) { g_now_us += (uint64_t)ms * 1000u; }
+
+uint i2c_get_index(i2c_inst_t *i2c) {
+    return i2c->index;
+}
+
+// Endereço + dados, 9 bits por byte, mais START/STOP
+static void bus_transfer(i2c_inst_t *i2c, size_t len) {
+    uint64_t us = ((uint64_t)(len + 1) * 9u * 1000000u + i2c->hz - 1) / i2c->hz + 10u;
+    g_now_us += us;
+    i2c->busy_us += us;
+}
+
+// Canal habilitado com um dispositivo no endereço (-1 se nenhum ou colisão)
+static int find_device(i2c_inst_t *i2c, uint8_t addr) {
+    int found = -1;
+    for (int ch = 0; ch < TCA9548A_CHANNELS; ch++) {
+        if (!(i2c->mux_mask & (1u << ch))) continue;
+        const sim_channel_t *c = &i2c->channels[ch];
+        bool present = (addr == AHT10_I2C_ADDR && c->aht10) || (addr == BH1750_ADDR_LOW && c->bh1750);
+        if (!present) continue;
+        if (found >= 0) {
+            i2c->collisions++;
+            return -1;
+        }
+        found = ch;
+    }
+    return found;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)nostop;
+    bus_transfer(i2c, len);
+
+    if (addr == TCA9548A_ADDR_BASE) {
+        i2c->mux_mask = src[0];
+        return (int)len;
+    }
+
+    int ch = find_device(i2c, addr);
+    if (ch < 0) return PICO_ERROR_GENERIC;
+
+    if (addr == AHT10_I2C_ADDR && len > 0 && src[0] == AHT10_CMD_MEASURE) {
+        i2c->channels[ch].aht10_busy_until_us = g_now_us + SIM_AHT10_CONVERSION_US;
+    }
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)nostop;
+    bus_transfer(i2c, len);
+
+    if (addr == TCA9548A_ADDR_BASE) {
+        memset(dst, i2c->mux_mask, len);
+        return (int)len;
+    }
+
+    int ch = find_device(i2c, addr);
+    if (ch < 0) return PICO_ERROR_GENERIC;
+
+    if (addr == AHT10_I2C_ADDR) {
+        // ~50 %RH e ~25 °C, com o bit de busy enquanto converte
+        static const uint8_t frame[6] = { AHT10_STATUS_CALIBRATED, 0x80, 0x00, 0x06, 0x66, 0x66 };
+        for (size_t i = 0; i < len && i < sizeof(frame); i++) dst[i] = frame[i];
+        if (g_now_us < i2c->channels[ch].aht10_busy_until_us) dst[0] |= AHT10_STATUS_BUSY;
+    } else {
+        for (size_t i = 0; i < len; i++) dst[i] = (uint8_t)(0x10 + ch);
+    }
+    return (int)len;
+}
+
+// ============= SENSORES =============
+
+typedef struct {
+    uint bus;
+    uint8_t channel;
+    bool is_aht10;
+} sim_sensor_t;
+
+static sim_sensor_t s_sensors[SIM_MAX_SENSORS];
+static size_t s_sensor_count;
+
+static tca9548a_t s_muxes[SIM_BUSES];
+static tca9548a_sensor_t s_wrapped[SIM_MAX_SENSORS];
+static aht10_t s_aht10[SIM_MAX_SENSORS];
+static bh1750_t s_bh1750[SIM_MAX_SENSORS];
+
+// Monta os barramentos: AHT10 nos primeiros canais e BH1750 nos
+// primeiros bh_channels, em cada barramento usado. A lista fica na ordem
+// de um arquivo de configuração típico: todos os AHT10, depois os BH1750.
+static void setup(uint buses, uint8_t aht_channels, uint8_t bh_channels) {
+    g_now_us = 0;
+    s_sensor_count = 0;
+    for (uint b = 0; b < SIM_BUSES; b++) {
+        memset(g_bus[b].channels, 0, sizeof(g_bus[b].channels));
+        g_bus[b].mux_mask = 0;
+        g_bus[b].busy_us = 0;
+        g_bus[b].collisions = 0;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint b = 0; b < buses; b++) {
+            uint8_t count = pass == 0 ? aht_channels : bh_channels;
+            for (uint8_t ch = 0; ch < count; ch++) {
+                if (pass == 0) g_bus[b].channels[ch].aht10 = true;
+                else g_bus[b].channels[ch].bh1750 = true;
+                s_sensors[s_sensor_count++] = (sim_sensor_t){ b, ch, pass == 0 };
+            }
+        }
+    }
+
+    for (uint b = 0; b < SIM_BUSES; b++) {
+        tca9548a_init(&s_muxes[b], &g_bus[b], TCA9548A_ADDR_BASE);
+    }
+}
+
+static void init_devices(void) {
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        const sim_sensor_t *s = &s_sensors[i];
+        s_aht10[i] = (aht10_t){ .i2c_port = &g_bus[s->bus], .address = AHT10_I2C_ADDR };
+        s_bh1750[i] = (bh1750_t){ .i2c_port = &g_bus[s->bus], .address = BH1750_ADDR_LOW };
+    }
+}
+
+// ============= MODOS DE LEITURA =============
+
+typedef struct {
+    uint32_t reads;
+    uint32_t failures;
+} bench_result_t;
+
+static bench_result_t run_sequential(uint32_t duration_s) {
+    bench_result_t r = { 0 };
+    init_devices();
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        const sim_sensor_t *s = &s_sensors[i];
+        tca9548a_select(&s_muxes[s->bus], s->channel);
+        if (s->is_aht10) aht10_init(&s_aht10[i], s_aht10[i].i2c_port, AHT10_I2C_ADDR);
+        else bh1750_init(&s_bh1750[i], s_bh1750[i].i2c_port, BH1750_ADDR_LOW);
+    }
+
+    uint64_t end_us = g_now_us + (uint64_t)duration_s * 1000000u;
+    while (g_now_us < end_us) {
+        for (size_t i = 0; i < s_sensor_count && g_now_us < end_us; i++) {
+            const sim_sensor_t *s = &s_sensors[i];
+            int32_t a, b;
+            bool ok = tca9548a_select(&s_muxes[s->bus], s->channel)
+                   && (s->is_aht10 ? aht10_read_temperature_humidity(&s_aht10[i], &a, &b)
+                                   : bh1750_read_light(&s_bh1750[i], &a));
+            if (ok) r.reads++;
+            else r.failures++;
+        }
+    }
+    return r;
+}
+
+static bench_result_t run_scheduled(uint32_t duration_s, bool routes) {
+    bench_result_t r = { 0 };
+    init_devices();
+    sensor_registry_init();
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        const sim_sensor_t *s = &s_sensors[i];
+        int index = s->is_aht10
+            ? tca9548a_sensor_register(&s_wrapped[i], &s_muxes[s->bus], s->channel, &aht10_driver, &s_aht10[i], false)
+            : tca9548a_sensor_register(&s_wrapped[i], &s_muxes[s->bus], s->channel, &bh1750_driver, &s_bh1750[i], false);
+        if (index < 0) {
+            fprintf(stderr, "Registro cheio no sensor %zu\n", i);
+            exit(1);
+        }
+        // Taxa máxima de cada sensor: limitada só pela conversão
+        s_wrapped[i].driver.period_ms = s->is_aht10 ? AHT10_MEASUREMENT_TIME_MS : SIM_BH1750_PERIOD_MS;
+        if (!routes) sensor_registry_set_route(index, NULL, 0);
+    }
+
+    sensor_registry_start(time_us_64, NULL);
+    sensor_scheduler_t *sched = sensor_registry_scheduler();
+
+    uint64_t end_us = g_now_us + (uint64_t)duration_s * 1000000u;
+    while (g_now_us < end_us) {
+        uint64_t deadline_us = sensor_scheduler_run(sched);
+        if (deadline_us > g_now_us) g_now_us = deadline_us;
+    }
+
+    for (size_t i = 0; i < sched->count; i++) {
+        r.reads += sched->entries[i].stats.samples;
+        r.failures += sched->entries[i].stats.failures;
+    }
+    return r;
+}
+
+// ============= RELATÓRIO =============
+
+static void report(const char *mode, uint32_t duration_s, bench_result_t r, uint buses) {
+    uint32_t switches = 0, hits = 0, collisions = 0;
+    uint64_t busy_us = 0;
+    for (uint b = 0; b < buses; b++) {
+        switches += s_muxes[b].stats.switches;
+        hits += s_muxes[b].stats.cache_hits;
+        collisions += g_bus[b].collisions;
+        busy_us += g_bus[b].busy_us;
+    }
+
+    printf("  %-11s leituras/s=%7.1f falhas=%-5lu trocas/s=%7.1f cache=%-6lu colisoes=%lu ocupacao=%4.1f%%\n",
+           mode,
+           (double)r.reads / duration_s,
+           (unsigned long)r.failures,
+           (double)switches / duration_s,
+           (unsigned long)hits,
+           (unsigned long)collisions,
+           100.0 * (double)busy_us / ((double)duration_s * 1e6 * buses));
+}
+
+static void bench(const char *title, uint buses, uint8_t aht_channels, uint8_t bh_channels, uint32_t duration_s) {
+    printf("%s\n", title);
+
+    setup(buses, aht_channels, bh_channels);
+    report("sequencial", duration_s, run_sequential(duration_s), buses);
+
+    setup(buses, aht_channels, bh_channels);
+    report("escalonado", duration_s, run_scheduled(duration_s, false), buses);
+
+    setup(buses, aht_channels, bh_channels);
+    report("rotas", duration_s, run_scheduled(duration_s, true), buses);
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 60;
+    if (duration_s == 0) duration_s = 60;
+
+    bench("8 AHT10 no I2C0", 1, 8, 0, duration_s);
+    bench("8 AHT10 no I2C0 + 8 AHT10 no I2C1", 2, 8, 0, duration_s);
+    bench("8 AHT10 + 8 BH1750 em cada barramento", 2, 8, 8, duration_s);
+    return 0;
+}
@@ -0,0 +1,503 @@
+/*
+ * Parser HTTP incremental contra a cópia para request_buffer
+ *
+ * Compara, no host, o caminho antigo do tcp_recv_callback (copiar a cadeia
+ * de pbufs para um buffer de 1 KB com pbuf_copy_partial e procurar linha de
+ * requisição, corpo, Connection e cookie com strstr) com http_parser.c, que
+ * lê cada payload no lugar e só copia os campos usados. As funções antigas
+ * estão reproduzidas abaixo como estavam em web_server.c, e a busca do
+ * cookie como estava em auth_is_authenticated_request() no auth.c.
+ *
+ * Cargas, cada uma entregue como o lwIP entregaria (um ou mais recv, cada
+ * recv com uma cadeia de pbufs):
+ *
+ *   get        GET /data?since= com os cabeçalhos de um navegador, 1 pbuf
+ *   get_3pbuf  a mesma requisição partida em 3 pbufs (segmentos menores)
+ *   cookie_1k  cookies de terceiros antes de "session": cabeçalhos > 1 KB
+ *   login_2rx  POST /login com o corpo chegando no recv seguinte
+ *   pipeline   3 GET /data no mesmo recv
+ *
+ * Para cada uma: ns por requisição e quantas requisições saíram com
+ * método, caminho, query, sessão, keep-alive e corpo corretos.
+ *
+ * Antes, confere as recusas do parser (Content-Length repetido, com espaço
+ * entre dígitos ou vazio, Transfer-Encoding, corpo grande demais, espaço ou
+ * tab no nome de um cabeçalho, obs-fold), com a requisição inteira e byte a
+ * byte; qualquer divergência sai com código 1.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Iweb \
+ *       tools/replay/parser_bench.c web/http_parser.c web/auth.c -o parser_bench
+ *
+ * Uso:
+ *   ./parser_bench [repetições por carga, padrão 200000]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "lwip/pbuf.h"
+#include "auth.h"
+#include "http_parser.h"
+
+// Tamanho de request_buffer antes do parser (WEB_SERVER_REQUEST_SIZE)
+#define LEGACY_REQUEST_SIZE 1024
+
+#define BENCH_MAX_RECV 3
+#define BENCH_MAX_PBUFS 3
+#define BENCH_MAX_REQUESTS 3
+
+// ============= PILHA MÍNIMA =============
+
+absolute_time_t get_absolute_time(void) {
+    return 0;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+    (void)p;
+    return 0;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset) {
+    u16_t copied = 0;
+    for (; p && copied < len; p = p->next) {
+        if (offset >= p->len) {
+            offset = (u16_t)(offset - p->len);
+            continue;
+        }
+        u16_t n = (u16_t)(p->len - offset);
+        if (n > len - copied) n = (u16_t)(len - copied);
+        memcpy((char *)dataptr + copied, (const char *)p->payload + offset, n);
+        copied = (u16_t)(copied + n);
+        offset = 0;
+    }
+    return copied;
+}
+
+// ============= CAMINHO ANTIGO (web_server.c antes do parser) =============
+
+static char request_buffer[LEGACY_REQUEST_SIZE];
+
+static int parse_request_line(const char *request, char *method_out, size_t method_len, char *path_out, size_t path_len, const char **query_out) {
+    const char *space = strchr(request, ' ');
+    if (!space) return 0;
+
+    size_t mlen = (size_t)(space - request);
+    if (mlen + 1 > method_len) return 0;
+    memcpy(method_out, request, mlen);
+    method_out[mlen] = '\0';
+
+    const char *path_start = space + 1;
+    const char *path_end = strchr(path_start, ' ');
+    if (!path_end) return 0;
+
+    size_t plen = (size_t)(path_end - path_start);
+    if (plen + 1 > path_len) return 0;
+    memcpy(path_out, path_start, plen);
+    path_out[plen] = '\0';
+
+    *query_out = "";
+    char *query = strchr(path_out, '?');
+    if (query) {
+        *query = '\0';
+        *query_out = query + 1;
+    }
+
+    return 1;
+}
+
+static const char *find_body(const char *request) {
+    const char *body = strstr(request, "\r\n\r\n");
+    if (!body) return NULL;
+    return body + 4;
+}
+
+static bool header_value_is(const char *value, const char *expected) {
+    while (*value == ' ') value++;
+    size_t i = 0;
+    for (; expected[i]; i++) {
+        if (tolower((unsigned char)value[i]) != expected[i]) return false;
+    }
+    return value[i] == '\r' || value[i] == ' ' || value[i] == '\0';
+}
+
+static const char *find_header(const char *request, const char *name) {
+    const char *line = strstr(request, "\r\n");
+    while (line && line[2] != '\r' && line[2] != '\0') {
+        line += 2;
+        size_t i = 0;
+        while (name[i] && tolower((unsigned char)line[i]) == name[i]) i++;
+        if (!name[i]) {
+            const char *value = line + i;
+            while (*value == ' ') value++;
+            return value;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return NULL;
+}
+
+static bool request_keep_alive(const char *request) {
+    const char *line = strstr(request, "\r\n");
+    if (!line) return false;
+    bool http10 = (line - request) >= 8 && strncmp(line - 8, "HTTP/1.0", 8) == 0;
+
+    const char *connection = find_header(request, "connection:");
+    if (connection) {
+        if (header_value_is(connection, "close")) return false;
+        if (header_value_is(connection, "keep-alive")) return true;
+    }
+    return !http10;
+}
+
+// auth_is_authenticated_request() do auth.c: cookie "session" procurado com strstr
+static bool request_authenticated(const char *request) {
+    const char *cookie = strstr(request, "Cookie:");
+    if (!cookie) {
+        return false;
+    }
+
+    const char *line_end = strstr(cookie, "\r\n");
+    if (!line_end) {
+        return false;
+    }
+
+    const char *session = strstr(cookie, "session=");
+    if (!session || session > line_end) {
+        return false;
+    }
+
+    session += strlen("session=");
+    size_t token_len = 0;
+    while (session + token_len < line_end && session[token_len] != ';' && session[token_len] != '\r') {
+        token_len++;
+    }
+
+    return auth_is_authenticated_session(session, token_len);
+}
+
+// ============= CARGAS =============
+
+typedef struct {
+    char method[HTTP_PARSER_METHOD_MAX];
+    char path[HTTP_PARSER_PATH_MAX];
+    char query[HTTP_PARSER_QUERY_MAX];
+    bool authenticated;
+    bool keep_alive;
+    char body[HTTP_PARSER_BODY_MAX + 1];
+} request_view_t;
+
+typedef struct {
+    const char *name;
+    int recv_count;
+    struct pbuf *recv[BENCH_MAX_RECV];
+    int expected_count;
+    request_view_t expected[BENCH_MAX_REQUESTS];
+} workload_t;
+
+static char s_text[BENCH_MAX_RECV][4096];
+static struct pbuf s_pbufs[BENCH_MAX_RECV][BENCH_MAX_PBUFS];
+static char s_session[AUTH_TOKEN_MAX + 1];
+
+// Monta o recv "index" com "text" partido em "parts" pbufs de tamanhos próximos
+static struct pbuf *make_recv(int index, const char *text, int parts) {
+    size_t len = strlen(text);
+    memcpy(s_text[index], text, len + 1);
+
+    size_t start = 0;
+    for (int i = 0; i < parts; i++) {
+        size_t end = (i == parts - 1) ? len : len * (size_t)(i + 1) / (size_t)parts;
+        s_pbufs[index][i].payload = s_text[index] + start;
+        s_pbufs[index][i].len = (u16_t)(end - start);
+        s_pbufs[index][i].tot_len = (u16_t)(len - start);
+        s_pbufs[index][i].next = (i == parts - 1) ? NULL : &s_pbufs[index][i + 1];
+        start = end;
+    }
+    return &s_pbufs[index][0];
+}
+
+static request_view_t view(const char *method, const char *path, const char *query, bool authenticated,
+                           bool keep_alive, const char *body) {
+    request_view_t v;
+    memset(&v, 0, sizeof(v));
+    snprintf(v.method, sizeof(v.method), "%s", method);
+    snprintf(v.path, sizeof(v.path), "%s", path);
+    snprintf(v.query, sizeof(v.query), "%s", query);
+    v.authenticated = authenticated;
+    v.keep_alive = keep_alive;
+    snprintf(v.body, sizeof(v.body), "%s", body);
+    return v;
+}
+
+// Cabeçalhos de um navegador de mesa pedindo /data
+static int browser_get(char *out, size_t max, uint32_t since, const char *cookie) {
+    return snprintf(out, max,
+                    "GET /data?since=%lu HTTP/1.1\r\n"
+                    "Host: 192.168.4.1\r\n"
+                    "Connection: keep-alive\r\n"
+                    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+                    "Chrome/124.0.0.0 Safari/537.36\r\n"
+                    "Accept: */*\r\n"
+                    "Referer: http://192.168.4.1/\r\n"
+                    "Accept-Encoding: gzip, deflate\r\n"
+                    "Accept-Language: pt-BR,pt;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+                    "Cookie: %s\r\n"
+                    "\r\n",
+                    (unsigned long)since, cookie);
+}
+
+static void build_workload(workload_t *w, const char *name) {
+    static char text[4096];
+    static char cookie[2048];
+    memset(w, 0, sizeof(*w));
+    w->name = name;
+
+    snprintf(cookie, sizeof(cookie), "session=%s", s_session);
+
+    if (strcmp(name, "get") == 0 || strcmp(name, "get_3pbuf") == 0) {
+        browser_get(text, sizeof(text), 42, cookie);
+        w->recv_count = 1;
+        w->recv[0] = make_recv(0, text, name[3] == '_' ? 3 : 1);
+        w->expected_count = 1;
+        w->expected[0] = view("GET", "/data", "since=42", true, true, "");
+    } else if (strcmp(name, "cookie_1k") == 0) {
+        // Cookies de análise/rede local que o navegador manda junto para o IP
+        size_t n = 0;
+        for (int i = 0; i < 16; i++) {
+            n += (size_t)snprintf(cookie + n, sizeof(cookie) - n, "_ga_%02d=GA1.1.%010d.%010d.1.1.%010d; ", i,
+                                  123456789 + i, 987654321 - i, 555 * i);
+        }
+        snprintf(cookie + n, sizeof(cookie) - n, "session=%s", s_session);
+        browser_get(text, sizeof(text), 7, cookie);
+        w->recv_count = 1;
+        w->recv[0] = make_recv(0, text, 2);
+        w->expected_count = 1;
+        w->expected[0] = view("GET", "/data", "since=7", true, true, "");
+    } else if (strcmp(name, "login_2rx") == 0) {
+        static const char body[] = "username=root&password=root";
+        snprintf(text, sizeof(text),
+                 "POST /login HTTP/1.1\r\n"
+                 "Host: 192.168.4.1\r\n"
+                 "Connection: keep-alive\r\n"
+                 "Content-Type: application/x-www-form-urlencoded\r\n"
+                 "Origin: http://192.168.4.1\r\n"
+                 "Content-Length: %zu\r\n"
+                 "\r\n",
+                 sizeof(body) - 1);
+        w->recv_count = 2;
+        w->recv[0] = make_recv(0, text, 1);
+        w->recv[1] = make_recv(1, body, 1);
+        w->expected_count = 1;
+        w->expected[0] = view("POST", "/login", "", false, true, body);
+    } else if (strcmp(name, "pipeline") == 0) {
+        size_t n = 0;
+        for (int i = 0; i < 3; i++) {
+            n += (size_t)snprintf(text + n, sizeof(text) - n,
+                                  "GET /data?since=%d HTTP/1.1\r\nHost: 192.168.4.1\r\nCookie: session=%s\r\n\r\n",
+                                  10 + i, s_session);
+        }
+        w->recv_count = 1;
+        w->recv[0] = make_recv(0, text, 1);
+        w->expected_count = 3;
+        w->expected[0] = view("GET", "/data", "since=10", true, true, "");
+        w->expected[1] = view("GET", "/data", "since=11", true, true, "");
+        w->expected[2] = view("GET", "/data", "since=12", true, true, "");
+    }
+}
+
+static bool same_view(const request_view_t *a, const request_view_t *b) {
+    return strcmp(a->method, b->method) == 0 && strcmp(a->path, b->path) == 0 &&
+           strcmp(a->query, b->query) == 0 && a->authenticated == b->authenticated &&
+           a->keep_alive == b->keep_alive && strcmp(a->body, b->body) == 0;
+}
+
+// ============= OS DOIS CAMINHOS =============
+
+// Um recv = uma requisição: copia até 1 KB e procura tudo no buffer
+static int run_legacy(const workload_t *w, request_view_t *out) {
+    int count = 0;
+    for (int r = 0; r < w->recv_count && count < BENCH_MAX_REQUESTS; r++) {
+        const struct pbuf *p = w->recv[r];
+        size_t req_len = p->tot_len < (sizeof(request_buffer) - 1) ? p->tot_len : (sizeof(request_buffer) - 1);
+        pbuf_copy_partial(p, request_buffer, (uint16_t)req_len, 0);
+        request_buffer[req_len] = '\0';
+
+        request_view_t *v = &out[count];
+        const char *query = "";
+        if (parse_request_line(request_buffer, v->method, sizeof(v->method), v->path, sizeof(v->path), &query) == 0) {
+            continue;
+        }
+        snprintf(v->query, sizeof(v->query), "%s", query);
+        v->keep_alive = request_keep_alive(request_buffer);
+
+        const char *body = find_body(request_buffer);
+        size_t body_len = 0;
+        if (body && body >= request_buffer && body < request_buffer + req_len) {
+            body_len = (size_t)(request_buffer + req_len - body);
+        }
+        if (body_len > HTTP_PARSER_BODY_MAX) body_len = HTTP_PARSER_BODY_MAX;
+        if (body_len) memcpy(v->body, body, body_len);
+        v->body[body_len] = '\0';
+
+        v->authenticated = request_authenticated(request_buffer);
+        count++;
+    }
+    return count;
+}
+
+static http_parser_t s_parser;
+
+static int run_parser(const workload_t *w, request_view_t *out) {
+    int count = 0;
+    http_parser_reset(&s_parser);
+    for (int r = 0; r < w->recv_count; r++) {
+        const struct pbuf *p = w->recv[r];
+        uint16_t offset = 0;
+        while (offset < p->tot_len && count < BENCH_MAX_REQUESTS) {
+            uint16_t used = 0;
+            http_parse_result_t parsed = http_parser_feed_pbuf(&s_parser, p, offset, &used);
+            offset = (uint16_t)(offset + used);
+            if (parsed == HTTP_PARSE_INCOMPLETE) break;
+
+            if (parsed == HTTP_PARSE_DONE) {
+                request_view_t *v = &out[count++];
+                memcpy(v->method, s_parser.method, sizeof(v->method));
+                memcpy(v->path, s_parser.path, sizeof(v->path));
+                memcpy(v->query, s_parser.query, sizeof(v->query));
+                v->keep_alive = http_parser_keep_alive(&s_parser);
+                memcpy(v->body, s_parser.body, (size_t)s_parser.body_len + 1);
+                v->authenticated = auth_is_authenticated_session(s_parser.session, strlen(s_parser.session));
+            }
+            http_parser_reset(&s_parser);
+        }
+    }
+    return count;
+}
+
+// ============= RECUSAS =============
+
+typedef struct {
+    const char *name;
+    const char *text;
+    uint16_t status;        // 0 = requisição aceita
+    uint16_t body_len;      // Corpo esperado quando aceita
+} reject_case_t;
+
+static const reject_case_t REJECT_CASES[] = {
+    { "cl_valido", "POST /login HTTP/1.1\r\nContent-Length:  5 \r\n\r\nabcde", 0, 5 },
+    { "cl_repetido", "POST /login HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nabcdefghijkl", 400, 0 },
+    { "cl_repetido_igual", "POST /login HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 3\r\n\r\nabc", 400, 0 },
+    { "cl_espaco_entre", "POST /login HTTP/1.1\r\nContent-Length: 1 2\r\n\r\nabcdefghijkl", 400, 0 },
+    { "cl_vazio", "POST /login HTTP/1.1\r\nContent-Length: \r\n\r\n", 400, 0 },
+    { "cl_letra", "POST /login HTTP/1.1\r\nContent-Length: 1a\r\n\r\n", 400, 0 },
+    { "cl_grande", "POST /login HTTP/1.1\r\nContent-Length: 4096\r\n\r\n", 413, 0 },
+    { "chunked", "POST /login HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 411, 0 },
+    { "nome_espaco", "GET /data HTTP/1.1\r\nHost : pico\r\n\r\n", 400, 0 },
+    { "nome_tab", "POST /login HTTP/1.1\r\nContent-Length\t: 3\r\n\r\nabc", 400, 0 },
+    { "nome_espaco_meio", "GET /data HTTP/1.1\r\nX Forwarded: a\r\n\r\n", 400, 0 },
+    { "obs_fold", "GET /data HTTP/1.1\r\nUser-Agent: pico\r\n Cookie: session=x\r\n\r\n", 400, 0 },
+    { "obs_fold_tab", "GET /data HTTP/1.1\r\nX-Extra: a\r\n\tb: c\r\n\r\n", 400, 0 },
+};
+
+// Alimenta "text" em trechos de "step" bytes (0 = tudo de uma vez)
+static http_parse_result_t feed_steps(const char *text, size_t step) {
+    size_t len = strlen(text), pos = 0;
+    http_parse_result_t result = HTTP_PARSE_INCOMPLETE;
+    http_parser_reset(&s_parser);
+    while (pos < len && result == HTTP_PARSE_INCOMPLETE) {
+        size_t n = step && len - pos > step ? step : len - pos, used = 0;
+        result = http_parser_feed(&s_parser, text + pos, n, &used);
+        pos += used;
+    }
+    return result;
+}
+
+static bool check_rejects(void) {
+    bool all_ok = true;
+    printf("recusas:\n");
+    for (size_t i = 0; i < sizeof(REJECT_CASES) / sizeof(REJECT_CASES[0]); i++) {
+        const reject_case_t *c = &REJECT_CASES[i];
+        bool ok = true;
+        uint16_t got = 0;
+        for (size_t step = 0; step <= 1; step++) {
+            http_parse_result_t r = feed_steps(c->text, step);
+            got = r == HTTP_PARSE_ERROR ? s_parser.status : 0;
+            if (c->status) ok = ok && r == HTTP_PARSE_ERROR && s_parser.status == c->status;
+            else ok = ok && r == HTTP_PARSE_DONE && s_parser.body_len == c->body_len;
+        }
+        printf("  %-18s esperado=%-3u obtido=%-3u %s\n", c->name, c->status, got, ok ? "ok" : "FALHOU");
+        all_ok = all_ok && ok;
+    }
+    return all_ok;
+}
+
+// ============= MEDIÇÃO =============
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+typedef int (*path_fn_t)(const workload_t *w, request_view_t *out);
+
+static void measure(const char *label, path_fn_t fn, const workload_t *w, long reps) {
+    static request_view_t out[BENCH_MAX_REQUESTS];
+
+    memset(out, 0, sizeof(out));
+    int count = fn(w, out);
+    int ok = 0;
+    for (int i = 0; i < count && i < w->expected_count; i++) {
+        if (same_view(&out[i], &w->expected[i])) ok++;
+    }
+
+    volatile int sink = 0;
+    uint64_t t0 = host_ns();
+    for (long i = 0; i < reps; i++) {
+        sink += fn(w, out);
+    }
+    uint64_t elapsed = host_ns() - t0;
+    (void)sink;
+
+    printf("  %-10s %-7s ns/req=%7.1f corretas=%d/%d\n", w->name, label,
+           (double)elapsed / (double)reps / (double)w->expected_count, ok, w->expected_count);
+}
+
+int main(int argc, char **argv) {
+    long reps = argc > 1 ? atol(argv[1]) : 200000;
+    if (reps <= 0) reps = 1;
+
+    auth_init();
+    char set_cookie[128];
+    if (!auth_try_login("username=root&password=root", 27, set_cookie, sizeof(set_cookie))) {
+        fprintf(stderr, "login falhou\n");
+        return 1;
+    }
+    const char *token = strstr(set_cookie, "session=") + 8;
+    snprintf(s_session, sizeof(s_session), "%.*s", (int)strcspn(token, ";"), token);
+
+    bool rejects_ok = check_rejects();
+
+    printf("parser HTTP: %ld repetições por carga, request_buffer antigo de %d bytes, http_parser_t de %zu bytes\n",
+           reps, LEGACY_REQUEST_SIZE, sizeof(http_parser_t));
+
+    static const char *names[] = { "get", "get_3pbuf", "cookie_1k", "login_2rx", "pipeline" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        static workload_t w;
+        build_workload(&w, names[i]);
+        measure("antigo", run_legacy, &w, reps);
+        measure("parser", run_parser, &w, reps);
+    }
+    return rejects_ok ? 0 : 1;
+}
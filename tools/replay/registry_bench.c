@@ -0,0 +1,221 @@
+/*
+ * Registro de sensores com N sensores simulados no host
+ *
+ * Registra de 1 a 12 sensores de tipos variados (leitura imediata e com
+ * conversão, 1 a 3 grandezas cada) no mesmo registro/escalonador/pipeline
+ * do firmware, roda alguns minutos de relógio virtual e mede o custo de
+ * cada passada conforme o número de sensores cresce. No fim exporta a
+ * tabela de grandezas no mesmo JSON da rota /metrics. Compilação (na raiz
+ * do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Itools/replay -Iinclude -Idrivers -Iweb \
+ *       tools/replay/registry_bench.c tools/replay/replay_backend.c \
+ *       src/sensor_pipeline.c src/sensor_registry.c src/sensor_health.c src/sensor_data.c src/sensor_units.c \
+ *       src/sensor_scheduler.c src/jitter_stats.c src/anomaly_detector.c \
+ *       src/comfort_metrics.c src/adaptive_rate.c src/timeseries.c src/rolling_stats.c \
+ *       drivers/led_matrix.c drivers/sensor_trace.c web/web_pages.c \
+ *       -o registry_bench
+ *
+ * Uso:
+ *   ./registry_bench [segundos simulados por rodada, padrão 600]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "led_matrix.h"
+#include "replay_backend.h"
+#include "sensor_pipeline.h"
+#include "sensor_registry.h"
+#include "sensor_data.h"
+#include "timeseries.h"
+#include "web_pages.h"
+
+#define BENCH_MAX_SENSORS 12
+#define BENCH_MAX_SLEEP_MS 1000
+
+// ============= SENSORES SIMULADOS =============
+
+typedef struct {
+    const char *name;
+    uint32_t period_ms;
+    uint32_t conversion_ms;
+    uint8_t metric_count;
+    const char *keys[3];
+    const char *unit;
+} sim_kind_t;
+
+// Tipos revezados conforme N cresce
+static const sim_kind_t SIM_KINDS[] = {
+    { "CO2",   1000,  0, 1, { "co2" }, "ppm" },
+    { "PM",    2000, 80, 2, { "pm25", "pm10" }, "ug" },
+    { "VENTO",  500,  0, 3, { "vel", "dir", "raj" }, "" },
+    { "SOLO",  5000, 20, 1, { "solo" }, "%" },
+};
+#define SIM_KIND_COUNT (sizeof(SIM_KINDS) / sizeof(SIM_KINDS[0]))
+
+typedef struct {
+    uint32_t seed;
+    uint32_t busy;              // Coletas que ainda respondem "ocupado"
+    int32_t base;
+} sim_dev_t;
+
+static sim_dev_t s_devs[BENCH_MAX_SENSORS];
+static sensor_driver_t s_drivers[BENCH_MAX_SENSORS];
+static sensor_metric_desc_t s_descs[BENCH_MAX_SENSORS][3];
+static char s_keys[BENCH_MAX_SENSORS][3][12];
+static char s_names[BENCH_MAX_SENSORS][12];
+
+static uint32_t sim_rand(sim_dev_t *dev) {
+    dev->seed = dev->seed * 1664525u + 1013904223u;
+    return dev->seed >> 8;
+}
+
+static bool sim_start(void *arg) {
+    sim_dev_t *dev = (sim_dev_t *)arg;
+    // Um em cada oito disparos ainda está ocupado na primeira coleta
+    dev->busy = (sim_rand(dev) & 7u) == 0 ? 1u : 0u;
+    return true;
+}
+
+static sensor_sched_result_t sim_collect(void *arg, bool last_attempt, int32_t *values) {
+    (void)last_attempt;
+    sim_dev_t *dev = (sim_dev_t *)arg;
+    if (dev->busy > 0) {
+        dev->busy--;
+        return SENSOR_SCHED_RETRY;
+    }
+    for (int m = 0; m < 3; m++) {
+        values[m] = dev->base + (int32_t)(sim_rand(dev) % 200u) - 100;
+    }
+    return SENSOR_SCHED_OK;
+}
+
+static void sim_register(int index) {
+    const sim_kind_t *kind = &SIM_KINDS[index % SIM_KIND_COUNT];
+    sensor_driver_t *drv = &s_drivers[index];
+
+    snprintf(s_names[index], sizeof(s_names[index]), "%s%d", kind->name, index);
+    for (uint8_t m = 0; m < kind->metric_count; m++) {
+        snprintf(s_keys[index][m], sizeof(s_keys[index][m]), "%s%d", kind->keys[m], index);
+        s_descs[index][m] = (sensor_metric_desc_t){
+            .key = s_keys[index][m],
+            .label = s_keys[index][m],
+            .unit = kind->unit,
+            .decimals = 1,
+            .ts_metric = SENSOR_METRIC_NO_SERIES,
+        };
+    }
+    *drv = (sensor_driver_t){
+        .name = s_names[index],
+        .period_ms = kind->period_ms,
+        .conversion_ms = kind->conversion_ms,
+        .metric_count = kind->metric_count,
+        .metrics = s_descs[index],
+        .init = NULL,
+        .start = sim_start,
+        .collect = sim_collect,
+    };
+    s_devs[index] = (sim_dev_t){ .seed = 12345u + (uint32_t)index, .base = 1000 * (index + 1) };
+    sensor_registry_add(drv, &s_devs[index]);
+}
+
+// ============= MEDIÇÃO =============
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static led_matrix_t s_led_matrix;
+static volatile bool s_led_enabled = false;
+static anomaly_detector_t s_detector;
+
+static void run(int sensors, uint32_t duration_s) {
+
+    replay_rewind();
+    sensor_registry_init();
+    for (int i = 0; i < sensors; i++) {
+        sim_register(i);
+    }
+    sensor_data_init();
+    timeseries_init();
+
+    app_context_t ctx = {
+        .led_matrix = &s_led_matrix,
+        .led_matrix_enabled = &s_led_enabled,
+    };
+    sensor_pipeline_init(&ctx, &s_detector);
+    const sensor_scheduler_t *sched = sensor_registry_scheduler();
+
+    uint64_t end_us = time_us_64() + (uint64_t)duration_s * 1000000u;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint32_t steps = 0;
+
+    while (time_us_64() < end_us) {
+        uint64_t t0 = host_ns();
+        uint64_t deadline_us = sensor_pipeline_step();
+        uint64_t dt = host_ns() - t0;
+
+        total_ns += dt;
+        if (dt > max_ns) max_ns = dt;
+        steps++;
+
+        uint64_t now_us = time_us_64();
+        uint64_t wait_us = deadline_us > now_us ? deadline_us - now_us : 1;
+        if (wait_us > BENCH_MAX_SLEEP_MS * 1000u) wait_us = BENCH_MAX_SLEEP_MS * 1000u;
+        sleep_us(wait_us);
+    }
+
+    uint32_t samples = 0;
+    uint32_t worst_p99 = 0;
+    for (size_t i = 0; i < sched->count; i++) {
+        sensor_sched_stats_t stats;
+        sensor_scheduler_get_stats(sched, i, &stats);
+        samples += stats.samples;
+        uint32_t p99 = jitter_stats_percentile_us(&stats.jitter, 990);
+        if (p99 > worst_p99) worst_p99 = p99;
+    }
+
+    printf("N=%2d grandezas=%2lu passadas=%6lu amostras=%6lu ns/passada=%5lu ns/amostra=%5lu max=%6luns jitter_p99=%luus\n",
+           sensors,
+           (unsigned long)sensor_registry_metric_count(),
+           (unsigned long)steps,
+           (unsigned long)samples,
+           (unsigned long)(steps ? total_ns / steps : 0),
+           (unsigned long)(samples ? total_ns / samples : 0),
+           (unsigned long)max_ns,
+           (unsigned long)worst_p99);
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 600;
+    if (duration_s == 0) duration_s = 600;
+
+    replay_set_speed(0);
+    led_matrix_init(&s_led_matrix, 7);
+    for (int n = 1; n <= BENCH_MAX_SENSORS; n++) {
+        run(n, duration_s);
+    }
+
+    // Mesma exportação genérica da rota /metrics, com os 12 sensores
+    static sensor_metric_value_t metrics[SENSOR_REGISTRY_MAX_METRICS];
+    static char json[4096];
+    size_t count = sensor_registry_metric_count();
+    for (size_t i = 0; i < count; i++) {
+        sensor_registry_get_metric(i, &metrics[i]);
+    }
+    int len = web_pages_generate_metrics(json, sizeof(json), metrics, count, time_us_64());
+    if (len > 0) {
+        const char *body = strstr(json, "\r\n\r\n");
+        printf("\n%s\n", body ? body + 4 : json);
+    }
+    return 0;
+}
@@ -0,0 +1,349 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "replay_backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "aht10.h"
+#include "bh1750.h"
+
+#define REPLAY_MAX_KEYS 8
+#define REPLAY_MAX_FAULTS 8
+
+// Quadros do mesmo endereço e tamanho, em ordem de tempo
+typedef struct {
+    uint8_t addr;
+    uint8_t len;
+    size_t *index;
+    size_t count;
+    size_t cursor;
+} replay_key_t;
+
+// Janela em que um endereço não responde (sensor desconectado)
+typedef struct {
+    uint8_t addr;
+    uint32_t start_ms;
+    uint32_t end_ms;
+} replay_fault_t;
+
+struct replay_i2c_bus {
+    uint index;
+};
+
+static struct replay_i2c_bus g_bus[2] = { { 0 }, { 1 } };
+i2c_inst_t *const i2c0 = &g_bus[0];
+i2c_inst_t *const i2c1 = &g_bus[1];
+
+static sensor_trace_frame_t *g_frames;
+static size_t g_count;
+static size_t g_capacity;
+static replay_key_t g_keys[REPLAY_MAX_KEYS];
+static size_t g_key_count;
+static bool g_indexed;
+
+static uint64_t g_now_us;
+static double g_speed;
+static uint32_t g_reads;
+static uint32_t g_misses;
+
+static replay_fault_t g_faults[REPLAY_MAX_FAULTS];
+static size_t g_fault_count;
+static uint32_t g_fault_hits;
+
+// ============= RELÓGIO VIRTUAL =============
+
+absolute_time_t get_absolute_time(void) {
+    return g_now_us;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
+
+uint64_t time_us_64(void) {
+    return g_now_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)g_now_us;
+}
+
+void sleep_us(uint64_t us) {
+    g_now_us += us;
+    if (g_speed > 0) {
+        double real_ns = (double)us * 1000.0 / g_speed;
+        struct timespec ts = {
+            .tv_sec = (time_t)(real_ns / 1e9),
+            .tv_nsec = (long)((uint64_t)real_ns % 1000000000u),
+        };
+        nanosleep(&ts, NULL);
+    }
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+void replay_set_speed(double speed) {
+    g_speed = speed;
+}
+
+// ============= TRACE =============
+
+static void push_frame(const sensor_trace_frame_t *frame) {
+    if (g_count == g_capacity) {
+        g_capacity = g_capacity ? g_capacity * 2 : 1024;
+        g_frames = realloc(g_frames, g_capacity * sizeof(*g_frames));
+        if (!g_frames) {
+            fprintf(stderr, "replay: sem memoria\n");
+            exit(1);
+        }
+    }
+    g_frames[g_count++] = *frame;
+    g_indexed = false;
+}
+
+static int compare_frames(const void *a, const void *b) {
+    const sensor_trace_frame_t *fa = a;
+    const sensor_trace_frame_t *fb = b;
+    if (fa->t_ms != fb->t_ms) return (fa->t_ms < fb->t_ms) ? -1 : 1;
+    return 0;
+}
+
+static replay_key_t *find_key(uint8_t addr, uint8_t len) {
+    for (size_t i = 0; i < g_key_count; i++) {
+        if (g_keys[i].addr == addr && g_keys[i].len == len) return &g_keys[i];
+    }
+    return NULL;
+}
+
+// Ordena por tempo e separa os quadros por (endereço, tamanho)
+static void build_index(void) {
+    if (g_indexed) return;
+
+    qsort(g_frames, g_count, sizeof(*g_frames), compare_frames);
+    for (size_t i = 0; i < g_key_count; i++) {
+        free(g_keys[i].index);
+    }
+    memset(g_keys, 0, sizeof(g_keys));
+    g_key_count = 0;
+
+    for (size_t i = 0; i < g_count; i++) {
+        replay_key_t *key = find_key(g_frames[i].addr, g_frames[i].len);
+        if (!key) {
+            if (g_key_count == REPLAY_MAX_KEYS) continue;
+            key = &g_keys[g_key_count++];
+            key->addr = g_frames[i].addr;
+            key->len = g_frames[i].len;
+        }
+        key->index = realloc(key->index, (key->count + 1) * sizeof(size_t));
+        key->index[key->count++] = i;
+    }
+    g_indexed = true;
+}
+
+bool replay_load_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[256];
+    sensor_trace_frame_t frame;
+    while (fgets(line, sizeof(line), f)) {
+        if (sensor_trace_parse(line, &frame)) {
+            push_frame(&frame);
+        }
+    }
+    fclose(f);
+    build_index();
+    return g_count > 0;
+}
+
+bool replay_save_file(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+
+    build_index();
+    char line[SENSOR_TRACE_LINE_MAX];
+    for (size_t i = 0; i < g_count; i++) {
+        sensor_trace_format(&g_frames[i], line, sizeof(line));
+        fprintf(f, "%s\n", line);
+    }
+    fclose(f);
+    return true;
+}
+
+// Gerador determinístico (LCG) para o ruído
+static uint32_t g_seed;
+
+static int32_t noise(int32_t amplitude) {
+    g_seed = g_seed * 1103515245u + 12345u;
+    return (int32_t)((g_seed >> 16) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Onda triangular de período period_ms entre -amplitude e +amplitude
+static int32_t triangle(uint32_t t_ms, uint32_t period_ms, int32_t amplitude) {
+    uint32_t phase = t_ms % period_ms;
+    int64_t ramp = (int64_t)phase * 4 * amplitude / period_ms;
+    if (ramp > 2 * amplitude) ramp = 4 * (int64_t)amplitude - ramp;
+    return (int32_t)(ramp - amplitude);
+}
+
+// Pulso de abertura de janela: queda linear em 60 s e retorno em 300 s,
+// repetido a cada 1300 s a partir de 600 s; devolve 0..amplitude
+static int32_t window_event(uint32_t t_ms, int32_t amplitude) {
+    if (t_ms < 600000) return 0;
+    uint32_t phase = (t_ms - 600000) % 1300000;
+    if (phase < 60000) return (int32_t)((int64_t)amplitude * phase / 60000);
+    if (phase < 360000) return (int32_t)((int64_t)amplitude * (360000 - phase) / 300000);
+    return 0;
+}
+
+void replay_generate(uint32_t duration_s, uint32_t seed) {
+    g_seed = seed;
+    uint32_t end_ms = duration_s * 1000u;
+
+    for (uint32_t t = 0; t < end_ms; t += 200) {
+        // Luz (centésimos de lux): rampa lenta, ruído, luz apagada por
+        // 4 min a cada 13 min e um pico de lanterna de 3 amostras a cada 97 s
+        int32_t lux_centi = 30000 + triangle(t, 600000, 20000) + noise(200);
+        if (t % 780000 >= 390000 && t % 780000 < 630000) {
+            lux_centi = 4000 + noise(100);
+        }
+        if (t % 97000 < 600) {
+            lux_centi = 2000000;
+        }
+        uint32_t raw = (uint32_t)lux_centi * 12u / 1000u;   // lux * 1.2
+        if (raw > 0xFFFF) raw = 0xFFFF;
+
+        sensor_trace_frame_t frame = {
+            .t_ms = t, .bus = 0, .addr = BH1750_ADDR_LOW, .len = 2,
+            .data = { (uint8_t)(raw >> 8), (uint8_t)raw },
+        };
+        push_frame(&frame);
+
+        if (t % 2000 != 0) continue;
+
+        // AHT10: quadro de 6 bytes ao fim da conversão; um quadro
+        // corrompido (tudo 0xFF) a cada 301 s e uma janela aberta
+        // (-1,5 °C, +8 %) a cada 1300 s
+        int32_t temp_centi = 2500 + triangle(t, 1800000, 200) - window_event(t, 150) + noise(3);
+        int32_t hum_centi = 5500 + triangle(t, 2400000, 500) + window_event(t, 800) + noise(10);
+        uint32_t temp_raw = (uint32_t)(((int64_t)temp_centi + 5000) * (1 << 20) / 20000);
+        uint32_t hum_raw = (uint32_t)((int64_t)hum_centi * (1 << 20) / 10000);
+
+        sensor_trace_frame_t aht = {
+            .t_ms = t + AHT10_MEASUREMENT_TIME_MS, .bus = 0, .addr = AHT10_I2C_ADDR, .len = 6,
+            .data = {
+                AHT10_STATUS_CALIBRATED,
+                (uint8_t)(hum_raw >> 12),
+                (uint8_t)(hum_raw >> 4),
+                (uint8_t)(((hum_raw & 0x0F) << 4) | ((temp_raw >> 16) & 0x0F)),
+                (uint8_t)(temp_raw >> 8),
+                (uint8_t)temp_raw,
+            },
+        };
+        if (t % 301000 == 150000) {
+            memset(&aht.data[1], 0xFF, 5);
+        }
+        push_frame(&aht);
+    }
+    build_index();
+}
+
+void replay_rewind(void) {
+    build_index();
+    for (size_t i = 0; i < g_key_count; i++) {
+        g_keys[i].cursor = 0;
+    }
+    g_now_us = g_count ? (uint64_t)g_frames[0].t_ms * 1000u : 0;
+    g_reads = 0;
+    g_misses = 0;
+    g_fault_hits = 0;
+}
+
+size_t replay_frame_count(void) {
+    return g_count;
+}
+
+uint32_t replay_end_ms(void) {
+    build_index();
+    return g_count ? g_frames[g_count - 1].t_ms : 0;
+}
+
+uint32_t replay_reads(void) {
+    return g_reads;
+}
+
+uint32_t replay_misses(void) {
+    return g_misses;
+}
+
+// ============= FALHAS INJETADAS =============
+
+bool replay_add_fault(uint8_t addr, uint32_t start_ms, uint32_t end_ms) {
+    if (g_fault_count == REPLAY_MAX_FAULTS || end_ms <= start_ms) return false;
+    g_faults[g_fault_count++] = (replay_fault_t){ addr, start_ms, end_ms };
+    return true;
+}
+
+uint32_t replay_fault_hits(void) {
+    return g_fault_hits;
+}
+
+// Acesso a um endereço desconectado agora: conta e devolve NACK
+static bool fault_active(uint8_t addr) {
+    uint32_t now_ms = to_ms_since_boot(g_now_us);
+    for (size_t i = 0; i < g_fault_count; i++) {
+        if (g_faults[i].addr == addr && now_ms >= g_faults[i].start_ms && now_ms < g_faults[i].end_ms) {
+            g_fault_hits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============= BARRAMENTO I2C =============
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c; (void)src; (void)nostop;
+    if (fault_active(addr)) return PICO_ERROR_GENERIC;
+
+    // Só respondem os endereços presentes no trace (ex.: o init do BH1750
+    // não "encontra" o endereço alternativo 0x5C)
+    build_index();
+    for (size_t i = 0; i < g_key_count; i++) {
+        if (g_keys[i].addr == addr) return (int)len;
+    }
+    return PICO_ERROR_GENERIC;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)i2c; (void)nostop;
+    if (fault_active(addr)) return PICO_ERROR_GENERIC;
+
+    replay_key_t *key = find_key(addr, (uint8_t)len);
+    if (!key || key->count == 0) {
+        // Ex.: consulta do byte de status, nunca gravada
+        g_misses++;
+        return PICO_ERROR_GENERIC;
+    }
+
+    // Avança até o quadro mais recente que já "aconteceu"
+    uint32_t now_ms = to_ms_since_boot(g_now_us);
+    while (key->cursor + 1 < key->count && g_frames[key->index[key->cursor + 1]].t_ms <= now_ms) {
+        key->cursor++;
+    }
+
+    memcpy(dst, g_frames[key->index[key->cursor]].data, len);
+    g_reads++;
+    return (int)len;
+}
+
+uint i2c_get_index(i2c_inst_t *i2c) {
+    return i2c->index;
+}
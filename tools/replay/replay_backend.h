@@ -0,0 +1,45 @@
+#ifndef REPLAY_BACKEND_H
+#define REPLAY_BACKEND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor_trace.h"
+
+// Backend do host para os drivers reais: o relógio do Pico vira um
+// relógio virtual e as leituras I2C devolvem os quadros de um trace
+// (gravado com TRACE ON ou sintético). Uma leitura no instante t recebe
+// o quadro mais recente do mesmo endereço e tamanho com t_ms <= t.
+
+// Carrega as linhas "TRC ..." de um log serial (demais linhas ignoradas)
+bool replay_load_file(const char *path);
+
+// Gera um trace sintético: BH1750 a cada 200 ms e AHT10 a cada 2 s,
+// com ruído, picos de luz e quadros corrompidos em intervalos fixos
+void replay_generate(uint32_t duration_s, uint32_t seed);
+
+// Grava o trace carregado/gerado no mesmo formato da UART
+bool replay_save_file(const char *path);
+
+// Velocidade: 1 = tempo real, 10 = dez vezes mais rápido, 0 = sem espera
+void replay_set_speed(double speed);
+
+// Posiciona o relógio virtual no primeiro quadro do trace
+void replay_rewind(void);
+
+size_t replay_frame_count(void);
+uint32_t replay_end_ms(void);
+
+// Injeta uma falha: o endereço não responde (NACK em leituras e escritas)
+// de start_ms a end_ms, como um sensor desconectado e religado depois
+bool replay_add_fault(uint8_t addr, uint32_t start_ms, uint32_t end_ms);
+
+// Acessos ao barramento recusados pelas falhas injetadas
+uint32_t replay_fault_hits(void);
+
+// Leituras atendidas pelo trace e leituras sem quadro correspondente
+uint32_t replay_reads(void);
+uint32_t replay_misses(void);
+
+#endif // REPLAY_BACKEND_H
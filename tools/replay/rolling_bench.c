@@ -0,0 +1,286 @@
+/*
+ * Janelas deslizantes (rolling_stats.c): exatidão contra força bruta e custo
+ *
+ * Alimenta janelas de 10 s, 60 s, 300 s e 3600 s (as três últimas são
+ * as do sensor_data) com séries sintéticas e, a cada poucas amostras,
+ * recalcula o resultado por força bruta sobre as amostras guardadas nos
+ * mesmos sub-intervalos que a janela cobre (o atual e os
+ * ROLLING_STATS_BUCKETS - 1 anteriores). Séries:
+ *
+ *   temperatura  a cada 2 s, passeio aleatório em centésimos de °C
+ *   luz          a cada 200 ms, toda a faixa do BH1750 com picos
+ *   lacunas      como temperatura, com faltas de até 3x a janela em que
+ *                só rolling_window_advance() é chamado (sensor falhando)
+ *   volta        como luz, começando 2 janelas antes da volta do contador
+ *                de ms (to_ms_since_boot após ~49,7 dias)
+ *
+ * Verificações (saída com código 1 se alguma falhar):
+ *   - contagem, média truncada, mínimo e máximo exatos (a contagem
+ *     também cobre a volta do contador de ms)
+ *   - variância a menos de 2 (escala ao quadrado) da exata: só o erro
+ *     das divisões inteiras
+ *
+ * Também mede o custo por amostra inserida conforme a duração da janela.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Iinclude \
+ *       tools/replay/rolling_bench.c src/rolling_stats.c -lm -o rolling_bench
+ *
+ * Uso:
+ *   ./rolling_bench [amostras por série, padrão 40000]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rolling_stats.h"
+
+#define N ROLLING_STATS_BUCKETS
+
+// Intervalo entre verificações por força bruta (em amostras)
+#define CHECK_EVERY 37
+
+// Maior leitura do BH1750 em centésimos de lux (65535 / 1,2)
+#define LUX_MAX_CENTI 5461250
+
+static const uint32_t WINDOWS_S[] = { 10, 60, 300, 3600 };
+#define WINDOW_COUNT (sizeof(WINDOWS_S) / sizeof(WINDOWS_S[0]))
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t g_rng = 99;
+
+static uint32_t sim_rand(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// ============= SÉRIES =============
+
+typedef enum {
+    SERIES_TEMPERATURE,
+    SERIES_LUX,
+    SERIES_GAPS,
+    SERIES_WRAP,
+    SERIES_COUNT,
+} series_kind_t;
+
+static const char *const SERIES_NAMES[SERIES_COUNT] = { "temperatura", "luz", "lacunas", "volta" };
+
+// Um evento: amostra (has_value) ou só avanço do relógio
+typedef struct {
+    uint64_t t64;          // Tempo sem volta, para o modelo
+    uint32_t t_ms;         // O que o firmware passa (to_ms_since_boot)
+    bool has_value;
+    int32_t value;
+} event_t;
+
+static size_t generate_series(series_kind_t kind, uint32_t window_ms, event_t *out, size_t n) {
+    bool lux = kind == SERIES_LUX || kind == SERIES_WRAP;
+    uint32_t period = lux ? 200u : 2000u;
+    uint64_t t = kind == SERIES_WRAP ? (1ull << 32) - 2ull * window_ms : 1000u + sim_rand() % 5000u;
+    int32_t value = lux ? 30000 : 2300;
+
+    for (size_t i = 0; i < n; i++) {
+        t += period + sim_rand() % 4u;
+        if (lux) {
+            value += (int32_t)(sim_rand() % 2001u) - 1000;
+            if (sim_rand() % 500u == 0) value = (int32_t)(sim_rand() % (LUX_MAX_CENTI + 1u));  // Pico
+            if (value < 0) value = 0;
+            if (value > LUX_MAX_CENTI) value = LUX_MAX_CENTI;
+        } else {
+            value += (int32_t)(sim_rand() % 21u) - 10;
+        }
+
+        out[i].t64 = t;
+        out[i].t_ms = (uint32_t)t;
+        out[i].has_value = true;
+        out[i].value = value;
+
+        // Falta: só avanços do relógio, a cada período, por até 3 janelas
+        if (kind == SERIES_GAPS && sim_rand() % 400u == 0) {
+            uint64_t gap_end = t + sim_rand() % (3u * window_ms + 1u);
+            while (i + 1 < n && t + period < gap_end) {
+                t += period;
+                i++;
+                out[i].t64 = t;
+                out[i].t_ms = (uint32_t)t;
+                out[i].has_value = false;
+                out[i].value = 0;
+            }
+        }
+    }
+    return n;
+}
+
+// ============= MODELO =============
+
+typedef struct {
+    uint32_t count;
+    int32_t mean;
+    int32_t min;
+    int32_t max;
+    double exact_variance;
+} ref_result_t;
+
+// Força bruta sobre os eventos [0, now]: amostras nos sub-intervalos do
+// atual e dos N-1 anteriores, contados a partir do primeiro evento
+static void reference(const event_t *ev, size_t now, uint32_t bucket_ms, ref_result_t *r) {
+    uint64_t first_start = ev[0].t64 - (uint64_t)(ev[0].t_ms % bucket_ms);
+    uint64_t cur = (ev[now].t64 - first_start) / bucket_ms;
+    uint64_t oldest = cur >= (uint64_t)(N - 1) ? cur - (N - 1) : 0;
+
+    memset(r, 0, sizeof(*r));
+    int64_t sum = 0;
+    double exact_sum = 0;
+    for (size_t i = now + 1; i-- > 0;) {
+        uint64_t idx = (ev[i].t64 - first_start) / bucket_ms;
+        if (idx < oldest) break;
+        if (!ev[i].has_value) continue;
+        int32_t v = ev[i].value;
+        if (r->count == 0 || v < r->min) r->min = v;
+        if (r->count == 0 || v > r->max) r->max = v;
+        sum += v;
+        exact_sum += v;
+        r->count++;
+    }
+    if (r->count == 0) return;
+
+    r->mean = (int32_t)(sum / (int64_t)r->count);
+
+    double mu = exact_sum / r->count;
+    double acc = 0;
+    for (size_t i = now + 1; i-- > 0;) {
+        uint64_t idx = (ev[i].t64 - first_start) / bucket_ms;
+        if (idx < oldest) break;
+        if (ev[i].has_value) acc += (ev[i].value - mu) * (ev[i].value - mu);
+    }
+    r->exact_variance = acc / r->count;
+}
+
+// ============= VERIFICAÇÃO =============
+
+typedef struct {
+    uint32_t checks;
+    uint32_t wrong_count;
+    uint32_t wrong_mean;
+    uint32_t wrong_minmax;
+    uint32_t wrong_variance;
+    double worst_variance_err;
+    double worst_stddev_err;   // Maior |desvio padrão - exato| (escala dos valores)
+} verify_result_t;
+
+static void verify_series(series_kind_t kind, uint32_t window_s, size_t n, verify_result_t *v) {
+    uint32_t window_ms = window_s * 1000u;
+    event_t *ev = calloc(n, sizeof(*ev));
+    if (!ev) {
+        fprintf(stderr, "rolling_bench: sem memoria\n");
+        exit(1);
+    }
+    generate_series(kind, window_ms, ev, n);
+
+    rolling_window_t w;
+    rolling_window_init(&w, window_ms);
+    memset(v, 0, sizeof(*v));
+
+    for (size_t i = 0; i < n; i++) {
+        if (ev[i].has_value) {
+            rolling_window_add(&w, ev[i].t_ms, ev[i].value);
+        } else {
+            rolling_window_advance(&w, ev[i].t_ms);
+        }
+        if (i % CHECK_EVERY != 0 && i != n - 1) continue;
+
+        rolling_result_t got;
+        ref_result_t ref;
+        rolling_window_result(&w, &got);
+        reference(ev, i, w.bucket_ms, &ref);
+        v->checks++;
+
+        if (got.count != ref.count) {
+            v->wrong_count++;
+            continue;
+        }
+        if (ref.count == 0) continue;
+        if (got.mean != ref.mean) v->wrong_mean++;
+        if (got.min != ref.min || got.max != ref.max) v->wrong_minmax++;
+        double err = fabs((double)got.variance - ref.exact_variance);
+        if (err > 2.0) v->wrong_variance++;
+        if (err > v->worst_variance_err) v->worst_variance_err = err;
+        double sd_err = fabs(sqrt((double)got.variance) - sqrt(ref.exact_variance));
+        if (sd_err > v->worst_stddev_err) v->worst_stddev_err = sd_err;
+    }
+    free(ev);
+}
+
+// ============= CUSTO =============
+
+static double bench_insert(uint32_t window_s, size_t n) {
+    event_t *ev = calloc(n, sizeof(*ev));
+    if (!ev) {
+        fprintf(stderr, "rolling_bench: sem memoria\n");
+        exit(1);
+    }
+    generate_series(SERIES_LUX, window_s * 1000u, ev, n);
+
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        rolling_window_t w;
+        rolling_result_t r;
+        rolling_window_init(&w, window_s * 1000u);
+        uint64_t t0 = mono_ns();
+        for (size_t i = 0; i < n; i++) {
+            rolling_window_add(&w, ev[i].t_ms, ev[i].value);
+        }
+        uint64_t dt = mono_ns() - t0;
+        rolling_window_result(&w, &r);
+        if (r.count == 0) printf("janela vazia\n");
+        if ((double)dt / n < best) best = (double)dt / n;
+    }
+    free(ev);
+    return best;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 40000;
+    if (n < 1000) n = 1000;
+    bool failed = false;
+
+    printf("exatidao (verificacao a cada %u amostras, %d sub-intervalos por janela)\n", CHECK_EVERY, N);
+    for (int kind = 0; kind < SERIES_COUNT; kind++) {
+        for (size_t wi = 0; wi < WINDOW_COUNT; wi++) {
+            verify_result_t v;
+            verify_series((series_kind_t)kind, WINDOWS_S[wi], n, &v);
+            bool ok = v.wrong_count == 0 && v.wrong_mean == 0 && v.wrong_minmax == 0 && v.wrong_variance == 0;
+            printf("  %-11s janela=%4us verificacoes=%u contagem=%u media=%u minmax=%u variancia=%u "
+                   "pior_erro_variancia=%.2f pior_erro_desvio=%.3f %s\n",
+                   SERIES_NAMES[kind], WINDOWS_S[wi], v.checks, v.wrong_count, v.wrong_mean, v.wrong_minmax,
+                   v.wrong_variance, v.worst_variance_err, v.worst_stddev_err, ok ? "ok" : "FALHOU");
+            failed = failed || !ok;
+        }
+    }
+
+    printf("insercao (serie de luz, melhor de 5)\n");
+    const uint32_t bench_windows_s[] = { 10, 60, 300, 3600, 86400 };
+    for (size_t i = 0; i < sizeof(bench_windows_s) / sizeof(bench_windows_s[0]); i++) {
+        printf("  janela=%5us ns_por_amostra=%.1f\n", bench_windows_s[i], bench_insert(bench_windows_s[i], 200000));
+    }
+
+    if (failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,475 @@
+/*
+ * Log de amostras em flash (sample_log.c) com cortes de energia
+ *
+ * Roda o sample_log.c do firmware sobre uma imagem de flash em arquivo
+ * com a semântica de NOR (apagar deixa 0xFF, gravar só limpa bits). As
+ * amostras são sintéticas (ciclo diário com ruído e leituras inválidas
+ * de vez em quando), uma a cada STORAGE_SAMPLE_INTERVAL_MS como na
+ * task_storage, e o log dá mais de uma volta na região.
+ *
+ * Uma passada sem falhas conta as operações de gravação e apagamento;
+ * depois, para cada operação k, uma nova imagem é gravada até k e a
+ * energia cai no meio dela:
+ *
+ *   gravação   nada gravado, só parte do cabeçalho, metade do payload
+ *              ou tudo menos o último byte (página rasgada)
+ *   apagamento nenhuma página, metade do setor ou tudo menos a última
+ *
+ * A cada corte o log é reiniciado (boot 2) e verificado; depois grava
+ * mais algumas páginas, reinicia de novo (boot 3) e verifica outra vez:
+ *
+ *   - toda amostra de uma página gravada por completo e não descartada
+ *     por um apagamento aparece em sample_log_latest(), igual à gravada
+ *   - páginas rasgadas e amostras que só estavam em RAM não aparecem;
+ *     páginas de um setor com apagamento interrompido podem aparecer
+ *   - amostras em ordem (boot, instante), sem buracos dentro de um boot
+ *   - boot_id = maior boot gravado + 1
+ *
+ * Saída com código 1 se alguma verificação falhar.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Iinclude tools/replay/sample_log_test.c \
+ *       src/sample_log.c src/series_codec.c -o sample_log_test
+ *
+ * Uso:
+ *   ./sample_log_test [imagem, padrão: arquivo temporário]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sample_log.h"
+
+// Mesmo intervalo da task_storage
+#define STORAGE_SAMPLE_INTERVAL_MS 10000u
+
+#define REGION_SECTORS 4u
+#define REGION_SIZE (REGION_SECTORS * SAMPLE_LOG_SECTOR_SIZE)
+#define REGION_PAGES (REGION_SIZE / SAMPLE_LOG_PAGE_SIZE)
+
+// Amostras do primeiro boot (o log dá mais de uma volta) e dos seguintes
+#define BOOT1_ENTRIES 8000u
+#define BOOT2_ENTRIES 300u
+
+#define MAX_BOOTS 3
+#define MAX_PAGE_RECORDS 512
+#define MAX_OPS 512
+#define MAX_RECOVERED (REGION_PAGES * SAMPLE_LOG_PAGE_MAX_ENTRIES)
+
+// ============= AMOSTRAS =============
+
+static sample_log_entry_t g_entries[BOOT1_ENTRIES];
+
+static uint32_t g_rng = 7;
+
+static int32_t noise(int32_t amplitude) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return (int32_t)((g_rng >> 8) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+// Ciclo diário em rampa (mínimo à meia-noite, máximo ao meio-dia), ruído
+// de poucos centésimos e uma leitura inválida de vez em quando
+static void generate_entries(void) {
+    for (uint32_t i = 0; i < BOOT1_ENTRIES; i++) {
+        uint32_t t_s = i * (STORAGE_SAMPLE_INTERVAL_MS / 1000u);
+        int32_t phase = (int32_t)(t_s % 86400u);
+        int32_t ramp = phase < 43200 ? phase : 86400 - phase;   // 0..43200
+
+        sample_log_entry_t *e = &g_entries[i];
+        memset(e, 0, sizeof(*e));
+        e->t_ms = i * STORAGE_SAMPLE_INTERVAL_MS;
+        e->temp_humidity_valid = (i % 97u) != 96u;
+        if (e->temp_humidity_valid) {
+            e->temperature_centi = (int16_t)(1800 + ramp * 800 / 43200 + noise(5));
+            e->humidity_centi = (uint16_t)(7000 - ramp * 2000 / 43200 + noise(20));
+        }
+        e->luminosity_valid = (i % 131u) != 130u;
+        if (e->luminosity_valid) {
+            int32_t day = ramp > 10800 ? (ramp - 10800) * 6 : 0;   // 0 à noite
+            e->luminosity_centi = (uint32_t)(day + 50 + noise(50));
+        }
+    }
+}
+
+static bool same_entry(const sample_log_entry_t *a, const sample_log_entry_t *b) {
+    if (a->t_ms != b->t_ms || a->temp_humidity_valid != b->temp_humidity_valid ||
+        a->luminosity_valid != b->luminosity_valid) {
+        return false;
+    }
+    if (a->temp_humidity_valid &&
+        (a->temperature_centi != b->temperature_centi || a->humidity_centi != b->humidity_centi)) {
+        return false;
+    }
+    return !a->luminosity_valid || a->luminosity_centi == b->luminosity_centi;
+}
+
+// ============= FLASH EM ARQUIVO =============
+
+typedef enum {
+    PAGE_COMMITTED,       // Gravada por completo
+    PAGE_TORN,            // Corte no meio da gravação
+    PAGE_ERASE_TORN,      // Setor com apagamento interrompido (pode sobrar)
+    PAGE_ERASED,          // Descartada por um apagamento completo
+} page_state_t;
+
+// Páginas gravadas pelo log, para saber o que deve sobreviver
+typedef struct {
+    uint16_t boot;
+    uint32_t first;       // Índices em g_entries (o mesmo para todos os boots)
+    uint32_t last;
+    uint32_t offset;
+    page_state_t state;
+} page_record_t;
+
+typedef enum {
+    CUT_NONE,
+    CUT_PROGRAM_NOTHING,
+    CUT_PROGRAM_HEADER,
+    CUT_PROGRAM_HALF,
+    CUT_PROGRAM_ALL_BUT_LAST,
+    CUT_ERASE_NOTHING,
+    CUT_ERASE_HALF,
+    CUT_ERASE_ALL_BUT_LAST,
+} cut_kind_t;
+
+static const char *const CUT_NAMES[] = {
+    "nenhum", "grav_nada", "grav_cabecalho", "grav_metade", "grav_quase",
+    "apag_nada", "apag_metade", "apag_quase",
+};
+
+typedef struct {
+    FILE *file;
+    uint32_t ops;            // Gravações e apagamentos até agora
+    uint32_t cut_at;         // Operação em que a energia cai (0 = nunca)
+    cut_kind_t cut_kind;
+    bool power_off;
+
+    // Amostras da página que o log está gravando
+    uint16_t boot;
+    uint32_t pending_first;
+    uint32_t appending;
+
+    page_record_t pages[MAX_PAGE_RECORDS];
+    size_t page_count;
+
+    // Tipo de cada operação na passada sem corte
+    bool op_is_erase[MAX_OPS + 1];
+} flash_image_t;
+
+static bool file_read(flash_image_t *img, uint32_t offset, void *dst, size_t len) {
+    return fseek(img->file, (long)offset, SEEK_SET) == 0 && fread(dst, 1, len, img->file) == len;
+}
+
+static bool file_write(flash_image_t *img, uint32_t offset, const void *src, size_t len) {
+    return fseek(img->file, (long)offset, SEEK_SET) == 0 && fwrite(src, 1, len, img->file) == len &&
+           fflush(img->file) == 0;
+}
+
+static bool image_reset(flash_image_t *img) {
+    uint8_t blank[SAMPLE_LOG_SECTOR_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    for (uint32_t s = 0; s < REGION_SECTORS; s++) {
+        if (!file_write(img, s * SAMPLE_LOG_SECTOR_SIZE, blank, sizeof(blank))) return false;
+    }
+    img->ops = 0;
+    img->power_off = false;
+    img->page_count = 0;
+    return true;
+}
+
+static bool flash_read(void *ctx, uint32_t offset, void *dst, size_t len) {
+    flash_image_t *img = ctx;
+    if (offset > REGION_SIZE || len > REGION_SIZE - offset) return false;
+    return file_read(img, offset, dst, len);
+}
+
+// NOR: a gravação só leva bits de 1 para 0
+static bool nor_program(flash_image_t *img, uint32_t offset, const uint8_t *src, size_t len) {
+    uint8_t cur[SAMPLE_LOG_PAGE_SIZE];
+    if (len > sizeof(cur) || !file_read(img, offset, cur, len)) return false;
+    for (size_t i = 0; i < len; i++) cur[i] &= src[i];
+    return file_write(img, offset, cur, len);
+}
+
+static bool flash_program(void *ctx, uint32_t offset, const void *src, size_t len) {
+    flash_image_t *img = ctx;
+    if (img->power_off || offset % SAMPLE_LOG_PAGE_SIZE != 0 || len != SAMPLE_LOG_PAGE_SIZE) return false;
+
+    const uint8_t *data = src;
+    page_record_t *rec = &img->pages[img->page_count++];
+    rec->boot = img->boot;
+    rec->first = img->pending_first;
+    rec->last = img->appending - 1;   // A amostra em append abre a página seguinte
+    rec->offset = offset;
+    rec->state = PAGE_COMMITTED;
+    img->pending_first = img->appending;
+
+    size_t written = len;
+    if (++img->ops <= MAX_OPS && img->cut_at == 0) img->op_is_erase[img->ops] = false;
+    if (img->ops == img->cut_at) {
+        switch (img->cut_kind) {
+        case CUT_PROGRAM_NOTHING: written = 0; break;
+        case CUT_PROGRAM_HEADER: written = SAMPLE_LOG_HEADER_SIZE / 2; break;
+        case CUT_PROGRAM_HALF: written = SAMPLE_LOG_HEADER_SIZE + SAMPLE_LOG_PAYLOAD_SIZE / 2; break;
+        case CUT_PROGRAM_ALL_BUT_LAST: written = len - 1; break;
+        default: break;
+        }
+        img->power_off = true;
+
+        // O que faltou gravar só importa se não era 0xFF (o preenchimento)
+        for (size_t i = written; i < len; i++) {
+            if (data[i] != 0xFF) {
+                rec->state = PAGE_TORN;
+                break;
+            }
+        }
+    }
+    if (!nor_program(img, offset, data, written)) return false;
+    return !img->power_off;
+}
+
+static bool flash_erase(void *ctx, uint32_t offset, size_t len) {
+    flash_image_t *img = ctx;
+    if (img->power_off || offset % SAMPLE_LOG_SECTOR_SIZE != 0 || len % SAMPLE_LOG_SECTOR_SIZE != 0) {
+        return false;
+    }
+
+    size_t erased = len;
+    bool torn = false;
+    if (++img->ops <= MAX_OPS && img->cut_at == 0) img->op_is_erase[img->ops] = true;
+    if (img->ops == img->cut_at) {
+        switch (img->cut_kind) {
+        case CUT_ERASE_NOTHING: erased = 0; break;
+        case CUT_ERASE_HALF: erased = len / 2; break;
+        case CUT_ERASE_ALL_BUT_LAST: erased = len - SAMPLE_LOG_PAGE_SIZE; break;
+        default: break;
+        }
+        img->power_off = true;
+        torn = true;
+    }
+
+    for (size_t i = 0; i < img->page_count; i++) {
+        page_record_t *rec = &img->pages[i];
+        if (rec->offset < offset || rec->offset >= offset + len) continue;
+        if (rec->state == PAGE_COMMITTED || rec->state == PAGE_ERASE_TORN) {
+            rec->state = (torn && rec->offset >= offset + erased) ? PAGE_ERASE_TORN : PAGE_ERASED;
+        } else {
+            rec->state = PAGE_ERASED;
+        }
+    }
+
+    uint8_t blank[SAMPLE_LOG_SECTOR_SIZE];
+    memset(blank, 0xFF, sizeof(blank));
+    for (size_t done = 0; done < erased; done += SAMPLE_LOG_SECTOR_SIZE) {
+        size_t n = erased - done < sizeof(blank) ? erased - done : sizeof(blank);
+        if (!file_write(img, offset + (uint32_t)done, blank, n)) return false;
+    }
+    return !img->power_off;
+}
+
+// Grava amostras de g_entries[from..to) no boot atual até acabar ou a
+// energia cair
+static void run_boot(flash_image_t *img, sample_log_t *log, uint32_t from, uint32_t to) {
+    img->boot = log->boot_id;
+    img->pending_first = from;
+    for (uint32_t i = from; i < to && !img->power_off; i++) {
+        img->appending = i;
+        sample_log_append(log, &g_entries[i]);
+    }
+}
+
+// ============= VERIFICAÇÕES =============
+
+typedef struct {
+    uint32_t recovered;
+    uint32_t missing;        // Amostras de páginas completas que sumiram
+    uint32_t unexpected;     // De páginas rasgadas, descartadas ou só da RAM
+    uint32_t wrong;          // Conteúdo diferente do gravado
+    uint32_t out_of_order;
+    uint32_t bad_boot_id;
+} verify_result_t;
+
+static const page_record_t *page_of(const flash_image_t *img, uint16_t boot, uint32_t idx) {
+    for (size_t i = img->page_count; i-- > 0;) {
+        const page_record_t *rec = &img->pages[i];
+        if (rec->boot == boot && idx >= rec->first && idx <= rec->last) return rec;
+    }
+    return NULL;
+}
+
+static sample_log_entry_t g_recovered[MAX_RECOVERED];
+
+// Reinicia o log sobre a imagem e compara o que voltou com o modelo
+static void verify_boot(flash_image_t *img, sample_log_t *log, const sample_log_flash_t *flash,
+                        verify_result_t *r) {
+    if (!sample_log_init(log, flash)) {
+        r->bad_boot_id++;
+        return;
+    }
+
+    uint16_t newest_boot = 0;
+    for (size_t i = 0; i < img->page_count; i++) {
+        const page_record_t *rec = &img->pages[i];
+        if (rec->state == PAGE_COMMITTED && rec->boot > newest_boot) newest_boot = rec->boot;
+    }
+    if (log->boot_id != newest_boot + 1) r->bad_boot_id++;
+
+    size_t n = sample_log_latest(log, g_recovered, MAX_RECOVERED);
+    r->recovered += (uint32_t)n;
+
+    uint16_t last_boot = 0;
+    uint32_t last_idx = 0;
+    uint32_t found[MAX_BOOTS + 1] = { 0 };
+    for (size_t i = 0; i < n; i++) {
+        const sample_log_entry_t *e = &g_recovered[i];
+        uint32_t idx = e->t_ms / STORAGE_SAMPLE_INTERVAL_MS;
+        if (e->boot_id == 0 || e->boot_id > MAX_BOOTS || idx >= BOOT1_ENTRIES ||
+            e->t_ms % STORAGE_SAMPLE_INTERVAL_MS != 0) {
+            r->wrong++;
+            continue;
+        }
+        if (!same_entry(e, &g_entries[idx])) r->wrong++;
+
+        const page_record_t *rec = page_of(img, e->boot_id, idx);
+        if (!rec || rec->state == PAGE_TORN || rec->state == PAGE_ERASED) r->unexpected++;
+        if (rec && rec->state == PAGE_COMMITTED) found[e->boot_id]++;
+
+        // Estritamente crescente; dentro de um boot, sem buracos depois
+        // da primeira amostra (só o início pode ter sido descartado)
+        if (i > 0 && (e->boot_id < last_boot || (e->boot_id == last_boot && idx != last_idx + 1))) {
+            r->out_of_order++;
+        }
+        last_boot = e->boot_id;
+        last_idx = idx;
+    }
+
+    for (uint16_t b = 1; b <= MAX_BOOTS; b++) {
+        uint32_t expected = 0;
+        for (size_t i = 0; i < img->page_count; i++) {
+            const page_record_t *rec = &img->pages[i];
+            if (rec->boot == b && rec->state == PAGE_COMMITTED) expected += rec->last - rec->first + 1;
+        }
+        if (found[b] < expected) r->missing += expected - found[b];
+    }
+}
+
+typedef struct {
+    uint32_t runs;
+    uint32_t failed_runs;
+    verify_result_t total;
+} cut_summary_t;
+
+static bool g_failed;
+
+// Um ciclo completo: boot 1 até o corte, boot 2 recupera e grava mais,
+// boot 3 recupera tudo de novo
+static bool run_cut(flash_image_t *img, const sample_log_flash_t *flash, uint32_t cut_at, cut_kind_t kind,
+                    verify_result_t *r) {
+    static sample_log_t log;
+
+    if (!image_reset(img)) return false;
+    img->cut_at = cut_at;
+    img->cut_kind = kind;
+
+    sample_log_init(&log, flash);
+    run_boot(img, &log, 0, BOOT1_ENTRIES);
+
+    // Boot 2: energia de volta
+    memset(r, 0, sizeof(*r));
+    img->power_off = false;
+    img->cut_at = 0;
+    verify_boot(img, &log, flash, r);
+    run_boot(img, &log, 0, BOOT2_ENTRIES);
+
+    // Boot 3: a página em RAM do boot 2 se perde, as gravadas não
+    verify_boot(img, &log, flash, r);
+    return r->missing == 0 && r->unexpected == 0 && r->wrong == 0 && r->out_of_order == 0 &&
+           r->bad_boot_id == 0;
+}
+
+static void add_result(verify_result_t *total, const verify_result_t *r) {
+    total->recovered += r->recovered;
+    total->missing += r->missing;
+    total->unexpected += r->unexpected;
+    total->wrong += r->wrong;
+    total->out_of_order += r->out_of_order;
+    total->bad_boot_id += r->bad_boot_id;
+}
+
+int main(int argc, char **argv) {
+    static flash_image_t img;
+    img.file = argc > 1 ? fopen(argv[1], "w+b") : tmpfile();
+    if (!img.file) {
+        fprintf(stderr, "Falha ao criar a imagem da flash\n");
+        return 1;
+    }
+    const sample_log_flash_t flash = {
+        .read = flash_read,
+        .program = flash_program,
+        .erase = flash_erase,
+        .ctx = &img,
+        .size = REGION_SIZE,
+    };
+
+    generate_entries();
+
+    // Passada sem corte: conta as operações e confere a volta na região
+    verify_result_t clean;
+    bool ok = run_cut(&img, &flash, 0, CUT_NONE, &clean);
+    uint32_t total_ops = img.ops < MAX_OPS ? img.ops : MAX_OPS;
+    bool op_is_erase[MAX_OPS + 1];
+    memcpy(op_is_erase, img.op_is_erase, sizeof(op_is_erase));
+    uint32_t boot1_pages = 0;
+    for (size_t i = 0; i < img.page_count; i++) {
+        if (img.pages[i].boot == 1) boot1_pages++;
+    }
+    printf("imagem setores=%u paginas=%u amostras_boot1=%u paginas_boot1=%u (%.1f amostras/pagina) "
+           "operacoes=%u\n",
+           REGION_SECTORS, REGION_PAGES, BOOT1_ENTRIES, boot1_pages,
+           boot1_pages ? (double)BOOT1_ENTRIES / boot1_pages : 0.0, total_ops);
+    printf("sem_corte recuperadas=%u faltando=%u inesperadas=%u erradas=%u fora_de_ordem=%u boot_id_errado=%u\n",
+           clean.recovered, clean.missing, clean.unexpected, clean.wrong, clean.out_of_order,
+           clean.bad_boot_id);
+    if (!ok || boot1_pages <= REGION_PAGES) {
+        printf("FALHOU: passada sem corte%s\n", boot1_pages <= REGION_PAGES ? " (log nao deu a volta)" : "");
+        g_failed = true;
+    }
+
+    // Corte em cada operação, com cada forma que cabe nela
+    cut_summary_t summary[CUT_ERASE_ALL_BUT_LAST + 1];
+    memset(summary, 0, sizeof(summary));
+    for (uint32_t k = 1; k <= total_ops; k++) {
+        int first = op_is_erase[k] ? CUT_ERASE_NOTHING : CUT_PROGRAM_NOTHING;
+        int last = op_is_erase[k] ? CUT_ERASE_ALL_BUT_LAST : CUT_PROGRAM_ALL_BUT_LAST;
+        for (int kind = first; kind <= last; kind++) {
+            verify_result_t r;
+            bool run_ok = run_cut(&img, &flash, k, (cut_kind_t)kind, &r);
+            cut_summary_t *s = &summary[kind];
+            s->runs++;
+            add_result(&s->total, &r);
+            if (!run_ok) {
+                if (s->failed_runs == 0) printf("FALHOU: corte %s na operacao %u\n", CUT_NAMES[kind], k);
+                s->failed_runs++;
+                g_failed = true;
+            }
+        }
+    }
+
+    printf("cortes (uma linha por forma, somando todas as operacoes)\n");
+    for (int kind = CUT_PROGRAM_NOTHING; kind <= CUT_ERASE_ALL_BUT_LAST; kind++) {
+        const cut_summary_t *s = &summary[kind];
+        printf("  %-15s passadas=%u falhas=%u recuperadas=%u faltando=%u inesperadas=%u erradas=%u "
+               "fora_de_ordem=%u boot_id_errado=%u\n",
+               CUT_NAMES[kind], s->runs, s->failed_runs, s->total.recovered, s->total.missing,
+               s->total.unexpected, s->total.wrong, s->total.out_of_order, s->total.bad_boot_id);
+    }
+
+    fclose(img.file);
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
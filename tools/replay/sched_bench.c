@@ -0,0 +1,308 @@
+/*
+ * Escalonador por prazos com sensores simulados e relógio falso
+ *
+ * Roda o sensor_scheduler do firmware com sensores que só respondem
+ * depois do seu tempo real de conversão, num laço que imita a task de
+ * sensores: dorme até o próximo prazo e acorda com uma latência de
+ * 0 a SIM_WAKE_LATENCY_US (outras tasks, interrupções). Cenários:
+ *
+ *   multitaxa    luz a cada 200 ms (conversão 120 ms) e temperatura a cada
+ *                2 s (conversão 80 ms) por uma hora simulada; comparado
+ *                com o laço fixo antigo (leitura dos dois a cada passada
+ *                com a espera de 80 ms do AHT10 + vTaskDelay de 200 ms)
+ *   lento        sensor cuja conversão real passa da registrada: coleta
+ *                repetida a cada SENSOR_SCHED_RETRY_MS até ficar pronta
+ *   periodo      redução do período no meio da execução vale já para a
+ *                próxima amostra (reancorada no último disparo agendado)
+ *   atraso       uma passada atrasada em mais de um período ressincroniza
+ *                sem disparar uma rajada de amostras
+ *   sondagem     disparos marcados como sondagem ficam fora do jitter,
+ *                dos intervalos e das falhas
+ *
+ * Verificações (saída com código 1 se alguma falhar): período médio a
+ * menos de 1 ms do pedido, número de disparos sem deriva, p99 do jitter
+ * dentro da latência injetada (mais o erro do histograma), nenhuma coleta
+ * antes do fim da conversão e os comportamentos de cada cenário acima.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Iinclude tools/replay/sched_bench.c \
+ *       src/sensor_scheduler.c src/jitter_stats.c -o sched_bench
+ *
+ * Uso:
+ *   ./sched_bench [segundos simulados no cenário multitaxa, padrão 3600]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sensor_scheduler.h"
+
+// Latência máxima entre o prazo e o despertar da task
+#define SIM_WAKE_LATENCY_US 2000u
+
+// ============= RELÓGIO FALSO =============
+
+static uint64_t g_now_us;
+static uint32_t g_rng = 1;
+
+static uint64_t fake_clock(void) {
+    return g_now_us;
+}
+
+static uint32_t sim_rand(void) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+// ============= SENSORES SIMULADOS =============
+
+typedef struct {
+    uint32_t conversion_us;    // Conversão real (pode diferir da registrada)
+    uint64_t started_us;
+    bool converting;
+    bool fail_start;
+    uint32_t starts;
+    uint32_t early_collects;   // Coletas antes do fim nominal registrado
+    uint32_t busy_replies;     // Coletas com o sensor ainda convertendo
+    uint32_t registered_conversion_ms;
+} sim_sensor_t;
+
+static bool sim_start(void *ctx) {
+    sim_sensor_t *s = (sim_sensor_t *)ctx;
+    s->starts++;
+    if (s->fail_start) return false;
+    s->started_us = g_now_us;
+    s->converting = true;
+    g_now_us += 150;   // Comando no barramento
+    return true;
+}
+
+static sensor_sched_result_t sim_collect(void *ctx, bool last_attempt, uint64_t capture_us) {
+    sim_sensor_t *s = (sim_sensor_t *)ctx;
+    (void)capture_us;
+
+    if (g_now_us < s->started_us + (uint64_t)s->registered_conversion_ms * 1000u) {
+        s->early_collects++;
+    }
+    g_now_us += 300;   // Leitura do resultado
+    if (g_now_us < s->started_us + s->conversion_us) {
+        s->busy_replies++;
+        return last_attempt ? SENSOR_SCHED_FAIL : SENSOR_SCHED_RETRY;
+    }
+    s->converting = false;
+    return SENSOR_SCHED_OK;
+}
+
+static int add_sensor(sensor_scheduler_t *sched, sim_sensor_t *s, const char *name,
+                      uint32_t period_ms, uint32_t conversion_ms, uint32_t real_conversion_us) {
+    memset(s, 0, sizeof(*s));
+    s->conversion_us = real_conversion_us;
+    s->registered_conversion_ms = conversion_ms;
+    return sensor_scheduler_add(sched, name, period_ms, conversion_ms, sim_start, sim_collect, s);
+}
+
+// Laço da task: dorme até o prazo, acorda com latência e roda uma passada
+static void run_until(sensor_scheduler_t *sched, uint64_t end_us) {
+    uint64_t deadline = sensor_scheduler_run(sched);
+    while (deadline != SENSOR_SCHED_NO_DEADLINE && deadline < end_us) {
+        if (deadline > g_now_us) g_now_us = deadline;
+        g_now_us += sim_rand() % (SIM_WAKE_LATENCY_US + 1);
+        deadline = sensor_scheduler_run(sched);
+    }
+    if (g_now_us < end_us) g_now_us = end_us;
+}
+
+// ============= CENÁRIOS =============
+
+static bool g_failed;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FALHOU: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static void print_stats(const char *name, const sensor_sched_stats_t *st, uint32_t base_period_ms) {
+    printf("  %-6s disparos=%u amostras=%u falhas=%u sondagens=%u periodo_medio=%ums duty=%u.%u%% "
+           "jitter_medio=%uus jitter_p99=%uus jitter_max=%uus\n",
+           name, st->starts, st->samples, st->failures, st->probes, sensor_scheduler_avg_period_ms(st),
+           sensor_scheduler_duty_permille(st, base_period_ms) / 10,
+           sensor_scheduler_duty_permille(st, base_period_ms) % 10, jitter_stats_mean_us(&st->jitter),
+           jitter_stats_percentile_us(&st->jitter, 990), st->jitter.max_us);
+}
+
+// Período médio em µs, mais fino que o sensor_scheduler_avg_period_ms
+static uint64_t avg_period_us(const sensor_sched_stats_t *st) {
+    return st->intervals ? st->interval_sum_us / st->intervals : 0;
+}
+
+static void scenario_multirate(uint32_t duration_s) {
+    sensor_scheduler_t sched;
+    sim_sensor_t light, temp;
+
+    g_now_us = 0;
+    sensor_scheduler_init(&sched, fake_clock);
+    add_sensor(&sched, &light, "luz", 200, 120, 120000);
+    add_sensor(&sched, &temp, "temp", 2000, 80, 75000);
+
+    uint64_t end_us = (uint64_t)duration_s * 1000000u;
+    run_until(&sched, end_us);
+
+    sensor_sched_stats_t sl, st;
+    sensor_scheduler_get_stats(&sched, 0, &sl);
+    sensor_scheduler_get_stats(&sched, 1, &st);
+
+    printf("multitaxa (%us, latencia ate %uus)\n", duration_s, SIM_WAKE_LATENCY_US);
+    print_stats("luz", &sl, 200);
+    print_stats("temp", &st, 2000);
+
+    // Laço antigo: os dois sensores por passada, AHT10 bloqueante
+    uint32_t old_period_ms = 80 + 200;
+    printf("  antigo periodo=%ums (luz e temp) leituras_luz=%u leituras_temp=%u\n", old_period_ms,
+           duration_s * 1000u / old_period_ms, duration_s * 1000u / old_period_ms);
+
+    uint64_t p99_bound = SIM_WAKE_LATENCY_US + SIM_WAKE_LATENCY_US / 4 + 1000u;
+    check(sl.failures == 0 && st.failures == 0, "multitaxa sem falhas");
+    check(avg_period_us(&sl) + 1000 > 200000 && avg_period_us(&sl) < 201000, "periodo da luz");
+    check(avg_period_us(&st) + 1000 > 2000000 && avg_period_us(&st) < 2001000, "periodo da temp");
+    check(sl.starts >= duration_s * 5u && sl.starts <= duration_s * 5u + 1, "disparos da luz sem deriva");
+    check(st.starts >= duration_s / 2u && st.starts <= duration_s / 2u + 1, "disparos da temp sem deriva");
+    check(jitter_stats_percentile_us(&sl.jitter, 990) <= p99_bound, "jitter p99 da luz");
+    check(jitter_stats_percentile_us(&st.jitter, 990) <= p99_bound, "jitter p99 da temp");
+    check(light.early_collects == 0 && temp.early_collects == 0, "coleta antes da conversao");
+}
+
+static void scenario_slow(void) {
+    sensor_scheduler_t sched;
+    sim_sensor_t slow, too_slow;
+
+    g_now_us = 0;
+    sensor_scheduler_init(&sched, fake_clock);
+    // Registrado com 80 ms, converte em 105 ms: duas ou três novas
+    // tentativas, conforme a latência do despertar
+    add_sensor(&sched, &slow, "lento", 1000, 80, 105000);
+    // Passa de todas as tentativas: falha, sem travar a entrada
+    add_sensor(&sched, &too_slow, "travado", 1000, 80, 500000);
+    run_until(&sched, 60u * 1000000u);
+
+    sensor_sched_stats_t s0, s1;
+    sensor_scheduler_get_stats(&sched, 0, &s0);
+    sensor_scheduler_get_stats(&sched, 1, &s1);
+    printf("lento (60s)\n");
+    print_stats("lento", &s0, 1000);
+    print_stats("trav.", &s1, 1000);
+    printf("  respostas_ocupado lento=%u travado=%u\n", slow.busy_replies, too_slow.busy_replies);
+
+    check(s0.samples == s0.starts && s0.failures == 0, "sensor lento coletado nas novas tentativas");
+    check(slow.busy_replies >= s0.starts * 2 && slow.busy_replies <= s0.starts * 3,
+          "novas tentativas a cada SENSOR_SCHED_RETRY_MS");
+    check(s1.samples == 0 && s1.failures == s1.starts, "sensor travado contado como falha");
+    check(s1.starts >= 59, "sensor travado continua sendo disparado");
+}
+
+static void scenario_period_change(void) {
+    sensor_scheduler_t sched;
+    sim_sensor_t s;
+
+    g_now_us = 0;
+    sensor_scheduler_init(&sched, fake_clock);
+    add_sensor(&sched, &s, "temp", 2000, 80, 75000);
+    run_until(&sched, 10500000u);   // Último disparo em 10 s, próximo em 12 s
+
+    uint32_t before = s.starts;
+    sensor_scheduler_set_period(&sched, 0, 500);
+    run_until(&sched, 10600000u);   // Reancorado: 10 s + 500 ms já venceu
+    uint32_t after_change = s.starts;
+    run_until(&sched, 20400000u);   // Disparos em 11.0 s, 11.5 s, ..., 20.0 s
+
+    sensor_sched_stats_t st;
+    sensor_scheduler_get_stats(&sched, 0, &st);
+    printf("periodo (2000 -> 500 ms em 10.5s)\n");
+    printf("  disparos_ate_10.5s=%u disparo_imediato=%s disparos_ate_20.4s=%u\n", before,
+           after_change == before + 1 ? "sim" : "nao", s.starts);
+
+    check(after_change == before + 1, "reducao de periodo vale para a proxima amostra");
+    check(s.starts == before + 1 + 19, "periodo novo mantido sem deriva");
+}
+
+static void scenario_late_pass(void) {
+    sensor_scheduler_t sched;
+    sim_sensor_t s;
+
+    g_now_us = 0;
+    sensor_scheduler_init(&sched, fake_clock);
+    add_sensor(&sched, &s, "luz", 200, 0, 0);
+    run_until(&sched, 1000000u);
+
+    // Task presa 1 s (5 períodos): uma passada, um disparo
+    uint32_t before = s.starts;
+    g_now_us += 1000000u;
+    sensor_scheduler_run(&sched);
+    uint32_t burst = s.starts - before;
+    run_until(&sched, 3000000u);
+
+    sensor_sched_stats_t st;
+    sensor_scheduler_get_stats(&sched, 0, &st);
+    printf("atraso (task presa 1s)\n");
+    printf("  disparos_na_passada=%u disparos_total=%u jitter_max=%uus\n", burst, s.starts, st.jitter.max_us);
+
+    check(burst == 1, "atraso longo nao dispara rajada");
+    check(s.starts <= 5 + 1 + 5 + 1, "ressincroniza depois do atraso");
+}
+
+static void scenario_probing(void) {
+    sensor_scheduler_t sched;
+    sim_sensor_t s;
+
+    g_now_us = 0;
+    sensor_scheduler_init(&sched, fake_clock);
+    add_sensor(&sched, &s, "temp", 2000, 80, 75000);
+    run_until(&sched, 10000000u);
+
+    sensor_sched_stats_t before;
+    sensor_scheduler_get_stats(&sched, 0, &before);
+
+    // Fora do ar: sondagens a cada 7 s que falham
+    s.fail_start = true;
+    sensor_scheduler_set_probing(&sched, 0, true);
+    for (int i = 0; i < 5; i++) {
+        sensor_scheduler_defer(&sched, 0, g_now_us + 7000000u);
+        run_until(&sched, g_now_us + 7000000u + 10000u);
+    }
+
+    // De volta
+    s.fail_start = false;
+    sensor_scheduler_set_probing(&sched, 0, false);
+    run_until(&sched, g_now_us + 10000000u);
+
+    sensor_sched_stats_t after;
+    sensor_scheduler_get_stats(&sched, 0, &after);
+    printf("sondagem (5 sondagens com 7s de espera)\n");
+    print_stats("temp", &after, 2000);
+
+    check(after.probes == 5, "sondagens contadas");
+    check(after.failures == before.failures, "sondagens fora das falhas");
+    check(after.jitter.max_us <= SIM_WAKE_LATENCY_US + 1000u, "sondagens fora do jitter");
+    check(avg_period_us(&after) < 2001000, "sondagens fora dos intervalos");
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_s = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 3600;
+    if (duration_s < 10) duration_s = 10;
+
+    scenario_multirate(duration_s);
+    scenario_slow();
+    scenario_period_change();
+    scenario_late_pass();
+    scenario_probing();
+
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,250 @@
+/*
+ * Leituras de sensor_data_get() sem lock: cópias rasgadas e latência
+ *
+ * Compila o sensor_data.c do firmware no host (pthreads) e mede duas
+ * coisas:
+ *
+ *   rasgo      um escritor publica sem pausa enquanto dois leitores
+ *              chamam sensor_data_get(); a publicação k grava um padrão
+ *              derivado de k em todos os campos (inclusive os de 64 bits),
+ *              então uma cópia rasgada aparece como inconsistência
+ *   latencia   um escritor lento segura o mutex dos escritores por
+ *              HOLD_US a cada WRITER_PERIOD_US (notificação de inscritos,
+ *              task preemptada), e um leitor a cada 100 µs mede quanto
+ *              cada leitura demora: pela cópia sob o mesmo mutex (como
+ *              era antes) e por sensor_data_get(), que não toma o mutex
+ *
+ * Verificações (saída com código 1 se alguma falhar): nenhuma cópia
+ * inconsistente ou com versão voltando, e p99 da latência do
+ * sensor_data_get() abaixo de metade de HOLD_US (o leitor não espera
+ * pelo escritor).
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -pthread -Itools/replay/host -Iinclude -Idrivers \
+ *       tools/replay/seqlock_bench.c src/sensor_data.c src/rolling_stats.c -o seqlock_bench
+ *
+ * Uso:
+ *   ./seqlock_bench [milissegundos por medição, padrão 1000]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "sensor_data.h"
+
+#define HOLD_US 500u
+#define WRITER_PERIOD_US 2000u
+#define READER_PERIOD_US 100u
+#define MAX_LATENCY_SAMPLES 200000
+
+// ============= RELÓGIO =============
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+absolute_time_t get_absolute_time(void) { return mono_ns() / 1000u; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+uint64_t time_us_64(void) { return mono_ns() / 1000u; }
+uint32_t time_us_32(void) { return (uint32_t)(mono_ns() / 1000u); }
+void sleep_us(uint64_t us) {
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+    nanosleep(&ts, NULL);
+}
+void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000u); }
+
+// ============= PADRÃO DAS PUBLICAÇÕES =============
+
+// A publicação k (1, 2, ...) vira a versão k + 1: a versão 1 é a do init
+static void publish(uint32_t k) {
+    sensor_txn_t txn;
+    sensor_data_begin(&txn);
+    sensor_txn_set_luminosity(&txn, (int32_t)k, true);
+    sensor_txn_set_capture(&txn, SENSOR_FIELD_LUMINOSITY, ((uint64_t)k << 32) | k);
+    sensor_txn_set_temp_humidity(&txn, (int32_t)(k * 3u + 1u), (int32_t)(k ^ 0x5555u), (k & 1u) != 0);
+    sensor_txn_set_capture(&txn, SENSOR_FIELD_TEMP_HUMIDITY, ~(((uint64_t)k << 32) | k));
+    sensor_txn_set_led_state(&txn, true, (led_intensity_t)(k % 4u));
+    sensor_data_commit(&txn);
+}
+
+static bool data_consistent(const sensor_data_t *d) {
+    if (d->version <= 1) return true;   // Snapshot do init
+    uint32_t k = d->version - 1;
+    return d->luminosity_centi == (int32_t)k &&
+           d->luminosity_capture_us == (((uint64_t)k << 32) | k) &&
+           d->temperature_centi == (int32_t)(k * 3u + 1u) &&
+           d->humidity_centi == (int32_t)(k ^ 0x5555u) &&
+           d->temp_humidity_valid == ((k & 1u) != 0) &&
+           d->temp_humidity_capture_us == ~(((uint64_t)k << 32) | k) &&
+           d->led_intensity == (led_intensity_t)(k % 4u);
+}
+
+// ============= RASGO =============
+
+typedef struct {
+    uint64_t reads;
+    uint64_t inconsistent;
+    uint64_t went_back;
+} torn_reader_t;
+
+static volatile bool g_stop;
+
+static void *torn_writer_main(void *arg) {
+    uint32_t *publishes = (uint32_t *)arg;
+    uint32_t k = 1;
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)) {
+        publish(k++);
+    }
+    *publishes = k - 1;
+    return NULL;
+}
+
+static void *torn_reader_main(void *arg) {
+    torn_reader_t *r = (torn_reader_t *)arg;
+    uint32_t last_version = 0;
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)) {
+        sensor_data_t d = sensor_data_get();
+        if (!data_consistent(&d)) r->inconsistent++;
+        if (d.version < last_version) r->went_back++;
+        last_version = d.version;
+        r->reads++;
+    }
+    return NULL;
+}
+
+static bool run_torn(uint32_t duration_ms) {
+    torn_reader_t readers[2] = { { 0 }, { 0 } };
+    pthread_t rt[2], wt;
+    uint32_t publishes = 0;
+
+    sensor_data_init();
+    g_stop = false;
+    for (int i = 0; i < 2; i++) pthread_create(&rt[i], NULL, torn_reader_main, &readers[i]);
+    pthread_create(&wt, NULL, torn_writer_main, &publishes);
+    sleep_ms(duration_ms);
+    __atomic_store_n(&g_stop, true, __ATOMIC_RELEASE);
+    pthread_join(wt, NULL);
+    for (int i = 0; i < 2; i++) pthread_join(rt[i], NULL);
+
+    uint64_t reads = readers[0].reads + readers[1].reads;
+    uint64_t bad = readers[0].inconsistent + readers[1].inconsistent;
+    uint64_t back = readers[0].went_back + readers[1].went_back;
+    printf("rasgo      publicacoes=%u leituras=%llu inconsistentes=%llu versao_voltou=%llu\n", publishes,
+           (unsigned long long)reads, (unsigned long long)bad, (unsigned long long)back);
+    return bad == 0 && back == 0 && publishes > 0 && reads > 0;
+}
+
+// ============= LATÊNCIA =============
+
+// Mutex dos escritores (g_sensor_mutex no firmware) e, no modo antigo,
+// também dos leitores, com um snapshot único
+static pthread_mutex_t g_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sensor_data_t g_locked_snapshot;
+static bool g_locked_mode;
+
+static sensor_data_t locked_get(void) {
+    pthread_mutex_lock(&g_writer_mutex);
+    sensor_data_t copy = g_locked_snapshot;
+    pthread_mutex_unlock(&g_writer_mutex);
+    return copy;
+}
+
+static void *slow_writer_main(void *arg) {
+    (void)arg;
+    uint32_t k = 1;
+    while (!__atomic_load_n(&g_stop, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&g_writer_mutex);
+        sleep_us(HOLD_US);
+        if (g_locked_mode) {
+            g_locked_snapshot.version = k + 1;
+            g_locked_snapshot.luminosity_centi = (int32_t)k;
+        } else {
+            publish(k);
+        }
+        pthread_mutex_unlock(&g_writer_mutex);
+        k++;
+        sleep_us(WRITER_PERIOD_US - HOLD_US);
+    }
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+    size_t reads;
+    uint32_t inconsistent;
+} latency_t;
+
+static latency_t run_latency(bool locked, uint32_t duration_ms) {
+    static uint32_t samples[MAX_LATENCY_SAMPLES];
+    latency_t r = { 0 };
+    pthread_t wt;
+
+    sensor_data_init();
+    memset(&g_locked_snapshot, 0, sizeof(g_locked_snapshot));
+    g_locked_mode = locked;
+    g_stop = false;
+    pthread_create(&wt, NULL, slow_writer_main, NULL);
+
+    uint64_t end = mono_ns() + (uint64_t)duration_ms * 1000000u;
+    while (mono_ns() < end && r.reads < MAX_LATENCY_SAMPLES) {
+        uint64_t t0 = mono_ns();
+        sensor_data_t d = locked ? locked_get() : sensor_data_get();
+        uint64_t dt = mono_ns() - t0;
+        if (!locked && !data_consistent(&d)) r.inconsistent++;
+        samples[r.reads++] = dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt;
+        sleep_us(READER_PERIOD_US);
+    }
+
+    __atomic_store_n(&g_stop, true, __ATOMIC_RELEASE);
+    pthread_join(wt, NULL);
+
+    qsort(samples, r.reads, sizeof(samples[0]), cmp_u32);
+    if (r.reads > 0) {
+        r.p50_ns = samples[r.reads / 2];
+        r.p99_ns = samples[(r.reads * 99) / 100];
+        r.max_ns = samples[r.reads - 1];
+    }
+    return r;
+}
+
+static void print_latency(const char *name, const latency_t *l) {
+    printf("  %-8s leituras=%zu p50=%.2fus p99=%.2fus max=%.2fus\n", name, l->reads, l->p50_ns / 1000.0,
+           l->p99_ns / 1000.0, l->max_ns / 1000.0);
+}
+
+int main(int argc, char **argv) {
+    uint32_t duration_ms = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 1000;
+    if (duration_ms < 100) duration_ms = 100;
+
+    bool ok = run_torn(duration_ms);
+
+    latency_t locked = run_latency(true, duration_ms);
+    latency_t seqlock = run_latency(false, duration_ms);
+    printf("latencia   escritor segura o mutex %uus a cada %uus, leitura a cada %uus\n", HOLD_US,
+           WRITER_PERIOD_US, READER_PERIOD_US);
+    print_latency("mutex", &locked);
+    print_latency("seqlock", &seqlock);
+
+    ok = ok && seqlock.inconsistent == 0 && seqlock.p99_ns < HOLD_US * 1000u / 2;
+    if (!ok) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Replay de traces de sensores no host
+ *
+ * Roda o mesmo ciclo de aquisição da task_sensors (drivers, escalonador,
+ * detector de anomalias, sensor_data, série temporal) sobre um trace
+ * gravado com "TRACE ON" na UART ou gerado sinteticamente, e mede o
+ * custo de cada passada. Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Itools/replay -Iinclude -Idrivers \
+ *       tools/replay/trace_replay.c tools/replay/replay_backend.c \
+ *       src/sensor_pipeline.c src/sensor_registry.c src/sensor_health.c src/sensor_data.c src/sensor_units.c \
+ *       src/sensor_scheduler.c src/jitter_stats.c src/anomaly_detector.c \
+ *       src/comfort_metrics.c src/adaptive_rate.c src/timeseries.c src/rolling_stats.c \
+ *       drivers/aht10.c drivers/bh1750.c drivers/led_matrix.c drivers/sensor_trace.c \
+ *       -o trace_replay
+ *
+ * Uso:
+ *   ./trace_replay captura.log          (log serial com linhas TRC)
+ *   ./trace_replay -g 3600 -w sint.trc  (gera 1 h sintética e salva)
+ *   ./trace_replay -s 10 captura.log    (10x o tempo real; padrão: sem espera)
+ *   ./trace_replay -f captura.log       (taxa fixa, sem amostragem adaptativa)
+ *   ./trace_replay -x 0x38:600:1800     (AHT10 desconectado de 600 s a 1800 s;
+ *                                        repetível, outros endereços: 0x23 BH1750)
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "aht10.h"
+#include "bh1750.h"
+#include "replay_backend.h"
+#include "sensor_pipeline.h"
+#include "sensor_registry.h"
+#include "sensor_data.h"
+#include "sensor_units.h"
+#include "timeseries.h"
+
+// Mesmo teto de espera da task_sensors
+#define REPLAY_MAX_SLEEP_MS 1000
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [-f] [-s velocidade] [-g segundos] [-w saida.trc] [-x end:inicio_s:fim_s] [trace]\n", prog);
+}
+
+static void print_metric(const char *label, ts_metric_t metric, int32_t value, const anomaly_detector_t *det) {
+    char text[SENSOR_UNITS_STR_MAX];
+    anomaly_stats_t stats;
+    anomaly_detector_get_stats(det, metric, &stats);
+    sensor_units_format(text, sizeof(text), value, 2);
+    printf("%-4s final=%s amostras=%lu zscore=%lu taxa=%lu rejeitadas=%lu patamares=%lu pontos_1min=%lu\n",
+           label, text,
+           (unsigned long)stats.samples,
+           (unsigned long)stats.flagged_zscore,
+           (unsigned long)stats.flagged_rate,
+           (unsigned long)stats.rejected,
+           (unsigned long)stats.rebaselines,
+           (unsigned long)timeseries_count(TS_RES_1MIN));
+}
+
+int main(int argc, char **argv) {
+    double speed = 0;
+    uint32_t generate_s = 0;
+    const char *save_path = NULL;
+    const char *trace_path = NULL;
+    bool adaptive = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0) {
+            adaptive = false;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            generate_s = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+            unsigned addr, start_s, end_s;
+            if (sscanf(argv[++i], "%i:%u:%u", (int *)&addr, &start_s, &end_s) != 3 ||
+                !replay_add_fault((uint8_t)addr, start_s * 1000u, end_s * 1000u)) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (argv[i][0] != '-' && !trace_path) {
+            trace_path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (trace_path) {
+        if (!replay_load_file(trace_path)) {
+            fprintf(stderr, "Nenhum quadro TRC em %s\n", trace_path);
+            return 1;
+        }
+    } else {
+        replay_generate(generate_s ? generate_s : 3600, 1);
+    }
+    if (save_path && !replay_save_file(save_path)) {
+        fprintf(stderr, "Falha ao gravar %s\n", save_path);
+        return 1;
+    }
+
+    replay_set_speed(speed);
+    replay_rewind();
+
+    // Mesmos drivers e ordem de inicialização do firmware
+    static bh1750_t light_sensor;
+    static aht10_t temp_sensor;
+    static led_matrix_t led_matrix;
+    static volatile bool led_enabled = true;
+    static anomaly_detector_t detector;
+
+    light_sensor.i2c_port = i2c0;
+    light_sensor.address = BH1750_ADDR_LOW;
+    temp_sensor.i2c_port = i2c0;
+    temp_sensor.address = AHT10_I2C_ADDR;
+
+    sensor_registry_init();
+    sensor_registry_add(&bh1750_driver, &light_sensor);
+    sensor_registry_add(&aht10_driver, &temp_sensor);
+    led_matrix_init(&led_matrix, 7);
+    sensor_data_init();
+    timeseries_init();
+
+    app_context_t ctx = {
+        .led_matrix = &led_matrix,
+        .led_matrix_enabled = &led_enabled,
+    };
+    sensor_pipeline_set_adaptive(adaptive);
+    sensor_pipeline_init(&ctx, &detector);
+    const sensor_scheduler_t *sched = sensor_registry_scheduler();
+
+    uint32_t end_ms = replay_end_ms();
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint32_t steps = 0;
+
+    while (to_ms_since_boot(get_absolute_time()) <= end_ms) {
+        uint64_t t0 = host_ns();
+        uint64_t deadline_us = sensor_pipeline_step();
+        uint64_t dt = host_ns() - t0;
+
+        total_ns += dt;
+        if (dt > max_ns) max_ns = dt;
+        steps++;
+
+        // Equivale ao alarme da task_sensors, com o mesmo teto de espera
+        uint64_t now_us = time_us_64();
+        uint64_t wait_us = deadline_us > now_us ? deadline_us - now_us : 1;
+        if (wait_us > REPLAY_MAX_SLEEP_MS * 1000u) wait_us = REPLAY_MAX_SLEEP_MS * 1000u;
+        sleep_us(wait_us);
+    }
+
+    sensor_data_t data = sensor_data_get();
+    printf("\nREPLAY quadros=%lu duracao=%lus passadas=%lu commits=%lu leituras=%lu sem_quadro=%lu\n",
+           (unsigned long)replay_frame_count(),
+           (unsigned long)(end_ms / 1000),
+           (unsigned long)steps,
+           (unsigned long)data.version,
+           (unsigned long)replay_reads(),
+           (unsigned long)replay_misses());
+    printf("CUSTO por passada: medio=%luns max=%luns\n",
+           (unsigned long)(steps ? total_ns / steps : 0),
+           (unsigned long)max_ns);
+    printf("FALHAS acessos_recusados=%lu\n", (unsigned long)replay_fault_hits());
+
+    print_metric("TEMP", TS_METRIC_TEMPERATURE, data.temperature_centi, &detector);
+    print_metric("HUM", TS_METRIC_HUMIDITY, data.humidity_centi, &detector);
+    print_metric("LUX", TS_METRIC_LUX, data.luminosity_centi, &detector);
+
+    for (size_t i = 0; i < sched->count; i++) {
+        sensor_sched_stats_t stats;
+        adaptive_stats_t adapt;
+        sensor_scheduler_get_stats(sched, i, &stats);
+        sensor_pipeline_get_adaptive_stats(i, &adapt);
+        uint32_t duty = sensor_scheduler_duty_permille(&stats, sched->entries[i].base_period_ms);
+        printf("SCHED %s ok=%lu falhas=%lu sondagens=%lu periodo_medio=%lums duty=%lu.%lu%% subidas=%lu jitter_p99=%luus\n",
+               sched->entries[i].name,
+               (unsigned long)stats.samples,
+               (unsigned long)stats.failures,
+               (unsigned long)stats.probes,
+               (unsigned long)sensor_scheduler_avg_period_ms(&stats),
+               (unsigned long)(duty / 10),
+               (unsigned long)(duty % 10),
+               (unsigned long)adapt.triggers,
+               (unsigned long)jitter_stats_percentile_us(&stats.jitter, 990));
+    }
+
+    for (size_t i = 0; i < sensor_registry_count(); i++) {
+        sensor_status_t st;
+        sensor_registry_get_status((int)i, &st);
+        printf("HEALTH %s estado=%s falhas=%lu quedas=%lu sondagens=%lu recuperacoes=%lu espera=%lums\n",
+               st.name,
+               sensor_health_state_name(st.health.state),
+               (unsigned long)st.health.failures,
+               (unsigned long)st.health.outages,
+               (unsigned long)st.health.probes,
+               (unsigned long)st.health.recoveries,
+               (unsigned long)st.health.backoff_ms);
+    }
+    return 0;
+}
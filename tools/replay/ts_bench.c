@@ -0,0 +1,357 @@
+/*
+ * Série temporal em camadas (timeseries.c): exatidão, custo e memória
+ *
+ * Insere amostras sintéticas como as do firmware (luz a cada 200 ms,
+ * temperatura e umidade a cada 2 s, com ruído e uma falta de 10 min de
+ * todos os sensores perto do fim) por 50 horas simuladas e compara cada ponto
+ * guardado nas camadas 1s/1min/1h com um modelo de referência calculado
+ * direto das amostras brutas:
+ *
+ *   - número de amostras, mínimo e máximo exatos por grandeza
+ *   - média a menos de 1 centésimo por nível de agregação (cada camada
+ *     trunca a média da anterior)
+ *   - camada bruta igual às últimas TIMESERIES_RAW_LEN inserções
+ *   - intervalos sem nenhuma amostra não viram pontos
+ *   - consultas por intervalo devolvem exatamente os pontos com início
+ *     em [from, to], em ordem
+ *
+ * Depois repete as verificações com 4 horas que atravessam 2^32 ms
+ * (~49,7 dias de boot), onde um instante de 32 bits daria a volta.
+ *
+ * Também mede o custo por inserção (médio e o pior, quando as três
+ * camadas fecham juntas), o custo de uma consulta conforme o número de
+ * pontos devolvidos e a memória estática contra TIMESERIES_RAM_BUDGET.
+ * Saída com código 1 se alguma verificação falhar.
+ *
+ * Compilação (na raiz do repositório):
+ *
+ *   gcc -O2 -std=c11 -Itools/replay/host -Iinclude \
+ *       tools/replay/ts_bench.c src/timeseries.c -o ts_bench
+ *
+ * Uso:
+ *   ./ts_bench [horas simuladas, padrão 50]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "timeseries.h"
+
+#define LUX_PERIOD_MS 200u
+#define TEMP_PERIOD_MS 2000u
+
+// Falta de todos os sensores (10 min) 40 min antes do fim, dentro da
+// janela da camada de 1 min
+#define GAP_LEN_MS (10u * 60000u)
+#define GAP_BEFORE_END_MS (40u * 60000u)
+
+// Segunda rodada: termina 50 s depois de 2^32 ms, então todas as camadas
+// (inclusive a bruta) guardam pontos dos dois lados da volta
+#define WRAP_HOURS 4u
+#define WRAP_START_MS (((UINT64_C(1) << 32) + 50000u - WRAP_HOURS * 3600000u) / TEMP_PERIOD_MS * TEMP_PERIOD_MS)
+
+static uint64_t g_gap_start_ms;
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t g_rng = 12345;
+
+static uint32_t sim_rand(void) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+// ============= MODELO DE REFERÊNCIA =============
+
+typedef struct {
+    uint32_t n[TS_METRIC_COUNT];
+    int32_t min[TS_METRIC_COUNT];
+    int32_t max[TS_METRIC_COUNT];
+    int64_t sum[TS_METRIC_COUNT];
+} ref_bucket_t;
+
+static const uint32_t TIER_WIDTH_MS[TS_RES_COUNT] = { 0, 1000u, 60000u, 3600000u };
+
+static ref_bucket_t *g_ref[TS_RES_COUNT];
+static size_t g_ref_len[TS_RES_COUNT];
+static uint64_t g_ref_base[TS_RES_COUNT];    // Intervalo do início da rodada
+
+// Intervalo "bucket" do modelo, ou NULL fora da rodada
+static ref_bucket_t *ref_at(int res, uint64_t bucket) {
+    if (bucket < g_ref_base[res] || bucket - g_ref_base[res] >= g_ref_len[res]) return NULL;
+    return &g_ref[res][bucket - g_ref_base[res]];
+}
+
+static void ref_add(uint64_t t_ms, const int32_t *values, uint8_t mask) {
+    for (int res = TS_RES_1S; res < TS_RES_COUNT; res++) {
+        ref_bucket_t *rb = ref_at(res, t_ms / TIER_WIDTH_MS[res]);
+        if (!rb) continue;
+        for (int m = 0; m < TS_METRIC_COUNT; m++) {
+            if (!(mask & (1u << m))) continue;
+            if (rb->n[m] == 0 || values[m] < rb->min[m]) rb->min[m] = values[m];
+            if (rb->n[m] == 0 || values[m] > rb->max[m]) rb->max[m] = values[m];
+            rb->sum[m] += values[m];
+            rb->n[m]++;
+        }
+    }
+}
+
+static bool ref_empty(const ref_bucket_t *rb) {
+    for (int m = 0; m < TS_METRIC_COUNT; m++) {
+        if (rb->n[m]) return false;
+    }
+    return true;
+}
+
+// ============= AMOSTRAS =============
+
+typedef struct {
+    uint64_t t_ms;
+    int32_t values[TS_METRIC_COUNT];
+    uint8_t mask;
+} sample_t;
+
+// Próxima amostra do firmware: luz a cada 200 ms e, a cada 2 s, também
+// temperatura e umidade no mesmo instante
+static bool next_sample(uint64_t t_ms, sample_t *s) {
+    if (t_ms >= g_gap_start_ms && t_ms < g_gap_start_ms + GAP_LEN_MS) return false;
+
+    s->t_ms = t_ms;
+    s->mask = 1u << TS_METRIC_LUX;
+    s->values[TS_METRIC_LUX] = 30000 + (int32_t)(sim_rand() % 4000u) - 2000;
+    s->values[TS_METRIC_TEMPERATURE] = 0;
+    s->values[TS_METRIC_HUMIDITY] = 0;
+    if (t_ms % TEMP_PERIOD_MS == 0) {
+        uint32_t minute = (uint32_t)(t_ms / 60000u);
+        s->values[TS_METRIC_TEMPERATURE] = 2300 + (int32_t)(minute % 120u) - 60 + (int32_t)(sim_rand() % 21u) - 10;
+        s->values[TS_METRIC_HUMIDITY] = 5500 - (int32_t)(minute % 90u) + (int32_t)(sim_rand() % 41u) - 20;
+        s->mask |= (1u << TS_METRIC_TEMPERATURE) | (1u << TS_METRIC_HUMIDITY);
+    }
+    return true;
+}
+
+// ============= VERIFICAÇÕES =============
+
+static bool g_failed;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FALHOU: %s\n", what);
+        g_failed = true;
+    }
+}
+
+static ts_point_t g_points[TIMESERIES_RAW_LEN > 512 ? TIMESERIES_RAW_LEN : 512];
+
+// Compara todos os pontos guardados numa camada com o modelo. open_bucket
+// é o intervalo ainda aberto (não guardado); devolve o instante do ponto
+// mais novo, que define o intervalo aberto da camada seguinte.
+static uint64_t verify_tier(ts_resolution_t res, uint64_t open_bucket) {
+    size_t n = timeseries_latest(res, g_points, sizeof(g_points) / sizeof(g_points[0]));
+    size_t wrong_n = 0, wrong_minmax = 0, wrong_mean = 0, bad_time = 0;
+    int32_t worst_mean_err = 0;
+    int level = (int)res;   // 1s = 1 nível, 1min = 2, 1h = 3
+
+    for (size_t i = 0; i < n; i++) {
+        const ts_point_t *p = &g_points[i];
+        uint64_t b = p->t_ms / TIER_WIDTH_MS[res];
+        const ref_bucket_t *rb = ref_at(res, b);
+        if (p->t_ms % TIER_WIDTH_MS[res] != 0 || b >= open_bucket || !rb ||
+            (i > 0 && p->t_ms <= g_points[i - 1].t_ms)) {
+            bad_time++;
+            continue;
+        }
+        for (int m = 0; m < TS_METRIC_COUNT; m++) {
+            if (p->samples[m] != rb->n[m]) wrong_n++;
+            if (rb->n[m] == 0) continue;
+            if (p->min[m] != rb->min[m] || p->max[m] != rb->max[m]) wrong_minmax++;
+            double exact = (double)rb->sum[m] / rb->n[m];
+            double err = p->mean[m] - exact;
+            if (err < 0) err = -err;
+            if (err >= level) wrong_mean++;
+            if ((int32_t)(err + 0.999) > worst_mean_err) worst_mean_err = (int32_t)(err + 0.999);
+        }
+    }
+
+    // Os intervalos fechados e não vazios mais recentes, até a capacidade
+    size_t expected = 0;
+    size_t skipped_empty = 0;
+    bool same = true;
+    for (uint64_t b = open_bucket; b-- > g_ref_base[res] && expected < n;) {
+        if (ref_empty(ref_at(res, b))) {
+            skipped_empty++;
+            continue;
+        }
+        expected++;
+        same = same && g_points[n - expected].t_ms == b * TIER_WIDTH_MS[res];
+    }
+    same = same && expected == n && n > 0;
+
+    printf("  %-5s pontos=%zu intervalos=%s vazios_pulados=%zu contagem_errada=%zu minmax_errado=%zu "
+           "media_fora=%zu pior_erro_media=%d instante_errado=%zu\n",
+           timeseries_resolution_name(res), n, same ? "ok" : "ERRADOS", skipped_empty, wrong_n, wrong_minmax,
+           wrong_mean, worst_mean_err, bad_time);
+    check(same, "pontos nos intervalos nao vazios mais recentes");
+    check(wrong_n == 0 && wrong_minmax == 0 && wrong_mean == 0 && bad_time == 0, "pontos iguais ao modelo");
+    return n > 0 ? g_points[n - 1].t_ms : 0;
+}
+
+static void verify_raw(const sample_t *tail, size_t tail_len) {
+    size_t n = timeseries_latest(TS_RES_RAW, g_points, TIMESERIES_RAW_LEN);
+    size_t wrong = 0;
+    for (size_t i = 0; i < n && i < tail_len; i++) {
+        const ts_point_t *p = &g_points[i];
+        const sample_t *s = &tail[(tail_len - n) + i];
+        if (p->t_ms != s->t_ms || p->valid_mask != s->mask) {
+            wrong++;
+            continue;
+        }
+        for (int m = 0; m < TS_METRIC_COUNT; m++) {
+            if ((s->mask & (1u << m)) && p->mean[m] != s->values[m]) wrong++;
+        }
+    }
+    printf("  raw   pontos=%zu diferentes=%zu\n", n, wrong);
+    check(n == TIMESERIES_RAW_LEN && wrong == 0, "camada bruta igual as ultimas insercoes");
+}
+
+// Consultas por intervalo contra uma varredura de timeseries_latest
+static void verify_queries(void) {
+    static ts_point_t all[TIMESERIES_RAW_LEN];
+    size_t wrong = 0;
+
+    for (int res = 0; res < TS_RES_COUNT; res++) {
+        size_t total = timeseries_latest((ts_resolution_t)res, all, TIMESERIES_RAW_LEN);
+        if (total == 0) continue;
+        for (int q = 0; q < 200; q++) {
+            uint64_t span = all[total - 1].t_ms - all[0].t_ms + 1;
+            uint64_t a = all[0].t_ms + sim_rand() % span;
+            uint64_t b = all[0].t_ms + sim_rand() % span;
+            if (a > b) { uint64_t t = a; a = b; b = t; }
+
+            size_t got = timeseries_query((ts_resolution_t)res, a, b, g_points, TIMESERIES_RAW_LEN);
+            size_t k = 0;
+            for (size_t i = 0; i < total; i++) {
+                if (all[i].t_ms < a || all[i].t_ms > b) continue;
+                if (k >= got || g_points[k].t_ms != all[i].t_ms) wrong++;
+                k++;
+            }
+            if (k != got) wrong++;
+        }
+    }
+    printf("  consultas=%d diferentes=%zu\n", 4 * 200, wrong);
+    check(wrong == 0, "consulta devolve exatamente o intervalo");
+}
+
+// ============= CUSTO =============
+
+static void bench_queries(void) {
+    const int reps = 20000;
+    size_t sizes[] = { 1, 8, 64, 256 };
+    size_t total = timeseries_latest(TS_RES_RAW, g_points, TIMESERIES_RAW_LEN);
+
+    printf("consulta (camada bruta, %zu pontos guardados)\n", total);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t k = sizes[s];
+        // Intervalo no meio da camada com exatamente k pontos
+        uint64_t from = g_points[total / 4].t_ms;
+        uint64_t to = g_points[total / 4 + k - 1].t_ms;
+        static ts_point_t out[512];
+        size_t got = 0;
+        uint64_t t0 = mono_ns();
+        for (int r = 0; r < reps; r++) {
+            got += timeseries_query(TS_RES_RAW, from, to, out, 512);
+        }
+        uint64_t dt = mono_ns() - t0;
+        printf("  pontos=%-4zu ns_por_consulta=%.0f ns_por_ponto=%.1f\n", got / reps, (double)dt / reps,
+               (double)dt / (double)got);
+    }
+}
+
+// ============= RODADA =============
+
+// Insere "hours" horas a partir de start_ms e confere todas as camadas;
+// com measure, também mede inserção, memória e consultas
+static void run(uint64_t start_ms, uint32_t hours, bool measure) {
+    uint64_t end_ms = start_ms + (uint64_t)hours * 3600000u;
+    g_gap_start_ms = end_ms - GAP_BEFORE_END_MS;
+
+    for (int res = TS_RES_1S; res < TS_RES_COUNT; res++) {
+        g_ref_base[res] = start_ms / TIER_WIDTH_MS[res];
+        g_ref_len[res] = (size_t)(end_ms / TIER_WIDTH_MS[res] - g_ref_base[res]) + 2;
+        g_ref[res] = calloc(g_ref_len[res], sizeof(ref_bucket_t));
+        if (!g_ref[res]) exit(1);
+    }
+    size_t tail_len = TIMESERIES_RAW_LEN;
+    sample_t *tail = calloc(tail_len, sizeof(sample_t));
+    if (!tail) exit(1);
+    size_t tail_head = 0, inserted = 0;
+
+    timeseries_init();
+
+    uint64_t total_ns = 0, worst_ns = 0;
+    for (uint64_t t = start_ms; t < end_ms; t += LUX_PERIOD_MS) {
+        sample_t s;
+        if (!next_sample(t, &s)) continue;
+
+        uint64_t t0 = mono_ns();
+        timeseries_insert(s.t_ms, s.values, s.mask);
+        uint64_t dt = mono_ns() - t0;
+        total_ns += dt;
+        if (dt > worst_ns) worst_ns = dt;
+
+        ref_add(s.t_ms, s.values, s.mask);
+        tail[tail_head] = s;
+        tail_head = (tail_head + 1) % tail_len;
+        inserted++;
+    }
+
+    // Reordena o anel das últimas inserções
+    sample_t *ordered = malloc(tail_len * sizeof(sample_t));
+    if (!ordered) exit(1);
+    for (size_t i = 0; i < tail_len; i++) ordered[i] = tail[(tail_head + i) % tail_len];
+
+    if (measure) {
+        printf("insercao amostras=%zu horas=%u ns_medio=%.1f ns_pior=%llu\n", inserted, hours,
+               (double)total_ns / (double)inserted, (unsigned long long)worst_ns);
+        printf("memoria bytes=%zu orcamento=%u\n", timeseries_memory_bytes(), TIMESERIES_RAM_BUDGET);
+        check(timeseries_memory_bytes() <= TIMESERIES_RAM_BUDGET, "memoria dentro do orcamento");
+    }
+
+    printf("camadas de %llu a %llu ms (falta de %u min sem amostras)\n", (unsigned long long)start_ms,
+           (unsigned long long)end_ms, GAP_LEN_MS / 60000u);
+    verify_raw(ordered, tail_len);
+    // Cada camada fecha um ponto quando a anterior fecha um de outro intervalo
+    uint64_t last_t = verify_tier(TS_RES_1S, ordered[tail_len - 1].t_ms / TIER_WIDTH_MS[TS_RES_1S]);
+    last_t = verify_tier(TS_RES_1MIN, last_t / TIER_WIDTH_MS[TS_RES_1MIN]);
+    verify_tier(TS_RES_1H, last_t / TIER_WIDTH_MS[TS_RES_1H]);
+    verify_queries();
+    if (measure) bench_queries();
+
+    for (int res = TS_RES_1S; res < TS_RES_COUNT; res++) free(g_ref[res]);
+    free(tail);
+    free(ordered);
+}
+
+int main(int argc, char **argv) {
+    uint32_t hours = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 50;
+    if (hours < 3) hours = 3;
+    if (hours > 1000) hours = 1000;
+
+    run(0, hours, true);
+    // Volta dos 32 bits no meio da rodada: camadas e consultas contínuas
+    run(WRAP_START_MS, WRAP_HOURS, false);
+
+    if (g_failed) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    return 0;
+}
@@ -96,37 +96,16 @@ const char *auth_get_username(void) {
     return g_username;
 }
 
-bool auth_is_authenticated_request(const char *request) {
+bool auth_is_authenticated_session(const char *token, size_t len) {
     if (!g_session_valid || g_session_token[0] == '\0') {
         return false;
     }
 
-    const char *cookie = strstr(request, "Cookie:");
-    if (!cookie) {
+    if (len == 0 || len >= sizeof(g_session_token)) {
         return false;
     }
 
-    const char *line_end = strstr(cookie, "\r\n");
-    if (!line_end) {
-        return false;
-    }
-
-    const char *session = strstr(cookie, "session=");
-    if (!session || session > line_end) {
-        return false;
-    }
-
-    session += strlen("session=");
-    size_t token_len = 0;
-    while (session + token_len < line_end && session[token_len] != ';' && session[token_len] != '\r') {
-        token_len++;
-    }
-
-    if (token_len == 0 || token_len >= sizeof(g_session_token)) {
-        return false;
-    }
-
-    return (strncmp(session, g_session_token, token_len) == 0 && g_session_token[token_len] == '\0');
+    return (strncmp(token, g_session_token, len) == 0 && g_session_token[len] == '\0');
 }
 
 bool auth_try_login(const char *body, size_t len, char *set_cookie_out, size_t out_len) {
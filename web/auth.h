@@ -9,7 +9,7 @@
 #define AUTH_TOKEN_MAX 63
 
 void auth_init(void);
-bool auth_is_authenticated_request(const char *request);
+bool auth_is_authenticated_session(const char *token, size_t len);
 bool auth_try_login(const char *body, size_t len, char *set_cookie_out, size_t out_len);
 void auth_logout(void);
 bool auth_update_credentials(const char *body, size_t len, char *message_out, size_t out_len);
@@ -0,0 +1,593 @@
+#include "http_parser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Maior Content-Length representável antes de virar 413 (evita estouro)
+#define HTTP_PARSER_LENGTH_LIMIT 1000000u
+
+typedef enum {
+    ST_METHOD,
+    ST_PATH,
+    ST_QUERY,
+    ST_VERSION,
+    ST_HEADER_START,
+    ST_HEADER_NAME,
+    ST_HEADER_VALUE,
+    ST_BODY,
+    ST_DONE,
+    ST_ERROR
+} parser_state_t;
+
+// Cabeçalhos que o servidor usa; os demais são pulados
+typedef enum {
+    HDR_OTHER,
+    HDR_HOST,
+    HDR_ORIGIN,
+    HDR_COOKIE,
+    HDR_CONTENT_LENGTH,
+    HDR_CONNECTION,
+    HDR_UPGRADE,
+    HDR_TRANSFER_ENCODING,
+    HDR_WS_KEY,
+    HDR_WS_VERSION
+} header_id_t;
+
+typedef struct {
+    const char *name;
+    uint8_t len;
+} header_name_t;
+
+#define HEADER(id, text) [id] = { text, sizeof(text) - 1 }
+
+static const header_name_t HEADER_NAMES[] = {
+    HEADER(HDR_HOST, "host"),
+    HEADER(HDR_ORIGIN, "origin"),
+    HEADER(HDR_COOKIE, "cookie"),
+    HEADER(HDR_CONTENT_LENGTH, "content-length"),
+    HEADER(HDR_CONNECTION, "connection"),
+    HEADER(HDR_UPGRADE, "upgrade"),
+    HEADER(HDR_TRANSFER_ENCODING, "transfer-encoding"),
+    HEADER(HDR_WS_KEY, "sec-websocket-key"),
+    HEADER(HDR_WS_VERSION, "sec-websocket-version"),
+};
+
+// Cookie: procura "session=" no início de cada par nome=valor
+typedef enum {
+    COOKIE_NAME,
+    COOKIE_VALUE,
+    COOKIE_SKIP,
+    COOKIE_FOUND
+} cookie_state_t;
+
+static const char SESSION_PREFIX[] = "session=";
+
+// Minúscula ASCII: nomes e tokens HTTP não têm acentos, e tolower() consulta o locale
+static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+static http_parse_result_t fail(http_parser_t *p, uint16_t status) {
+    p->state = ST_ERROR;
+    p->status = status;
+    return HTTP_PARSE_ERROR;
+}
+
+// Acrescenta c ao campo; se não couber, marca estouro e para de copiar
+static void field_append(http_parser_t *p, char *field, size_t max, char c) {
+    if (p->field_len + 1u >= max) {
+        p->field_overflow = true;
+        return;
+    }
+    field[p->field_len++] = c;
+    field[p->field_len] = '\0';
+}
+
+// Remove espaços no fim do campo (o valor vai até o fim da linha)
+static void field_trim(char *field, uint8_t *len) {
+    while (*len > 0 && (field[*len - 1] == ' ' || field[*len - 1] == '\t')) {
+        field[--*len] = '\0';
+    }
+}
+
+static void begin_field(http_parser_t *p) {
+    p->field_len = 0;
+    p->field_overflow = false;
+}
+
+// Compara o tamanho antes: a maioria dos cabeçalhos de um navegador não é nenhum destes
+static header_id_t identify_header(const http_parser_t *p) {
+    if (p->field_overflow) return HDR_OTHER;
+    for (size_t i = 1; i < sizeof(HEADER_NAMES) / sizeof(HEADER_NAMES[0]); i++) {
+        if (HEADER_NAMES[i].len == p->field_len && memcmp(p->name, HEADER_NAMES[i].name, p->field_len) == 0) {
+            return (header_id_t)i;
+        }
+    }
+    return HDR_OTHER;
+}
+
+// Item de uma lista separada por vírgulas em Connection
+static void connection_token(http_parser_t *p) {
+    field_trim(p->token, &p->field_len);
+    if (!p->field_overflow) {
+        if (strcmp(p->token, "close") == 0) p->connection_close = true;
+        else if (strcmp(p->token, "keep-alive") == 0) p->connection_keep_alive = true;
+        else if (strcmp(p->token, "upgrade") == 0) p->connection_upgrade = true;
+    }
+    begin_field(p);
+    p->token[0] = '\0';
+}
+
+static void cookie_char(http_parser_t *p, char c) {
+    switch ((cookie_state_t)p->cookie_state) {
+        case COOKIE_NAME:
+            if (c == ' ' && p->field_len == 0) return;
+            if (c == SESSION_PREFIX[p->field_len]) {
+                if (++p->field_len == sizeof(SESSION_PREFIX) - 1) {
+                    p->cookie_state = COOKIE_VALUE;
+                    begin_field(p);
+                }
+                return;
+            }
+            p->cookie_state = c == ';' ? COOKIE_NAME : COOKIE_SKIP;
+            p->field_len = 0;
+            return;
+
+        case COOKIE_VALUE:
+            if (c == ';' || c == ' ') {
+                p->cookie_state = COOKIE_FOUND;
+                return;
+            }
+            field_append(p, p->session, sizeof(p->session), c);
+            return;
+
+        case COOKIE_SKIP:
+            if (c == ';') {
+                p->cookie_state = COOKIE_NAME;
+                p->field_len = 0;
+            }
+            return;
+
+        case COOKIE_FOUND:
+            return;
+    }
+}
+
+// Um caractere do valor de um cabeçalho conhecido
+static http_parse_result_t value_char(http_parser_t *p, char c) {
+    switch ((header_id_t)p->header) {
+        case HDR_HOST:
+            field_append(p, p->host, sizeof(p->host), c);
+            break;
+        case HDR_ORIGIN:
+            field_append(p, p->origin, sizeof(p->origin), c);
+            break;
+        case HDR_WS_KEY:
+            field_append(p, p->ws_key, sizeof(p->ws_key), c);
+            break;
+        case HDR_COOKIE:
+            cookie_char(p, c);
+            break;
+        case HDR_CONTENT_LENGTH:
+            // Um único número: "1 2" somaria 12 e deslocaria a fronteira do corpo
+            if (c == ' ' || c == '\t') {
+                p->length_ended = true;
+                break;
+            }
+            if (c < '0' || c > '9' || p->length_ended) return fail(p, 400);
+            if (p->field_len < UINT8_MAX) p->field_len++;
+            p->content_length = p->content_length * 10u + (uint32_t)(c - '0');
+            if (p->content_length > HTTP_PARSER_LENGTH_LIMIT) return fail(p, 413);
+            break;
+        case HDR_CONNECTION:
+            if (c == ',') {
+                connection_token(p);
+            } else if (p->field_len > 0 || c != ' ') {
+                field_append(p, p->token, sizeof(p->token), lower(c));
+            }
+            break;
+        case HDR_UPGRADE:
+        case HDR_WS_VERSION:
+            field_append(p, p->token, sizeof(p->token), lower(c));
+            break;
+        case HDR_TRANSFER_ENCODING:
+        case HDR_OTHER:
+            break;
+    }
+    return HTTP_PARSE_INCOMPLETE;
+}
+
+// Fim da linha de um cabeçalho conhecido
+static http_parse_result_t end_header(http_parser_t *p) {
+    switch ((header_id_t)p->header) {
+        case HDR_HOST:
+            field_trim(p->host, &p->field_len);
+            if (p->field_overflow) p->host[0] = '\0';
+            break;
+        case HDR_ORIGIN:
+            field_trim(p->origin, &p->field_len);
+            // Origin longo demais nunca confere com o Host
+            if (p->field_overflow) p->origin[0] = '\0';
+            p->has_origin = true;
+            break;
+        case HDR_WS_KEY:
+            field_trim(p->ws_key, &p->field_len);
+            if (p->field_overflow) p->ws_key[0] = '\0';
+            break;
+        case HDR_COOKIE:
+            if (p->cookie_state == COOKIE_VALUE) p->cookie_state = COOKIE_FOUND;
+            // Token maior que o aceito: sessão inválida; o primeiro "session" vale
+            if (p->cookie_state == COOKIE_FOUND) {
+                if (p->field_overflow) p->session[0] = '\0';
+                return HTTP_PARSE_INCOMPLETE;
+            }
+            p->cookie_state = COOKIE_NAME;
+            break;
+        case HDR_CONNECTION:
+            connection_token(p);
+            break;
+        case HDR_UPGRADE:
+            field_trim(p->token, &p->field_len);
+            p->upgrade_websocket = !p->field_overflow && strcmp(p->token, "websocket") == 0;
+            break;
+        case HDR_WS_VERSION:
+            field_trim(p->token, &p->field_len);
+            p->ws_version = p->field_overflow ? 0 : (uint8_t)atoi(p->token);
+            break;
+        case HDR_TRANSFER_ENCODING:
+            // Corpo em chunks não é suportado: sem Content-Length o fluxo perderia o sincronismo
+            return fail(p, 411);
+        case HDR_CONTENT_LENGTH:
+            if (p->field_len == 0) return fail(p, 400);
+            break;
+        case HDR_OTHER:
+            break;
+    }
+    return HTTP_PARSE_INCOMPLETE;
+}
+
+// Zera só os escalares e o primeiro byte de cada texto: field_append() mantém
+// o terminador, e a estrutura inteira (corpo incluso) custaria um memset por requisição
+void http_parser_reset(http_parser_t *p) {
+    p->state = ST_METHOD;
+    p->header = HDR_OTHER;
+    p->field_len = 0;
+    p->cookie_state = COOKIE_NAME;
+    p->value_started = false;
+    p->field_overflow = false;
+    p->length_seen = false;
+    p->length_ended = false;
+    p->header_bytes = 0;
+    p->name[0] = '\0';
+    p->token[0] = '\0';
+
+    p->status = 0;
+    p->method[0] = '\0';
+    p->path[0] = '\0';
+    p->query[0] = '\0';
+    p->http_minor = 0;
+    p->connection_close = false;
+    p->connection_keep_alive = false;
+    p->connection_upgrade = false;
+    p->upgrade_websocket = false;
+    p->ws_version = 0;
+    p->has_origin = false;
+    p->session[0] = '\0';
+    p->host[0] = '\0';
+    p->origin[0] = '\0';
+    p->ws_key[0] = '\0';
+    p->content_length = 0;
+    p->body_len = 0;
+    p->body[0] = '\0';
+}
+
+// Valor que o servidor não lê: cabeçalho desconhecido, Transfer-Encoding
+// (recusado no fim da linha) ou o resto de Cookie depois da sessão
+static bool skip_value(const http_parser_t *p) {
+    return p->header == HDR_OTHER || p->header == HDR_TRANSFER_ENCODING ||
+           (p->header == HDR_COOKIE && p->cookie_state == COOKIE_FOUND);
+}
+
+// Classes de caractere que encerram um trecho copiado ou pulado
+enum {
+    C_SPACE = 1,
+    C_EOL = 2,
+    C_COLON = 4,
+    C_QUERY = 8,
+    C_SEMI = 16,
+    C_COMMA = 32,
+    C_TAB = 64
+};
+
+static const uint8_t CHAR_CLASS[256] = {
+    [' '] = C_SPACE, ['\r'] = C_EOL, ['\n'] = C_EOL, [':'] = C_COLON, ['?'] = C_QUERY, [';'] = C_SEMI, [','] = C_COMMA,
+    ['\t'] = C_TAB,
+};
+
+// Copia até um byte de "stop" em contadores locais (escrever char pelo ponteiro
+// obrigaria o compilador a reler o parser a cada byte); campo cheio marca estouro
+static size_t copy_run(http_parser_t *p, char *field, size_t max, const char *data, size_t len, uint8_t stop,
+                       bool fold) {
+    size_t n = p->field_len;
+    bool overflow = p->field_overflow;
+    size_t i = 0;
+    for (; i < len; i++) {
+        char c = data[i];
+        if (CHAR_CLASS[(uint8_t)c] & stop) break;
+        if (n + 1 < max) {
+            field[n++] = fold ? lower(c) : c;
+        } else {
+            overflow = true;
+        }
+    }
+    field[n] = '\0';
+    p->field_len = (uint8_t)n;
+    p->field_overflow = overflow;
+    return i;
+}
+
+// Cookie de outro nome: até o próximo ';' na mesma linha
+static size_t skip_cookie(const char *data, size_t len) {
+    const char *nl = memchr(data, '\n', len);
+    size_t line = nl ? (size_t)(nl - data) : len;
+    const char *semi = memchr(data, ';', line);
+    return semi ? (size_t)(semi - data) : line;
+}
+
+// Bytes consumidos de uma vez no estado atual; delimitadores ficam para o switch
+static size_t bulk_run(http_parser_t *p, const char *data, size_t len) {
+    switch ((parser_state_t)p->state) {
+        case ST_METHOD:
+            return copy_run(p, p->method, sizeof(p->method), data, len, C_SPACE | C_EOL, false);
+        case ST_PATH:
+            return copy_run(p, p->path, sizeof(p->path), data, len, C_SPACE | C_EOL | C_QUERY, false);
+        case ST_QUERY:
+            return copy_run(p, p->query, sizeof(p->query), data, len, C_SPACE | C_EOL, false);
+        case ST_VERSION:
+            return copy_run(p, p->token, sizeof(p->token), data, len, C_EOL, false);
+        case ST_HEADER_NAME:
+            return copy_run(p, p->name, sizeof(p->name), data, len, C_COLON | C_EOL | C_SPACE | C_TAB, true);
+        case ST_HEADER_VALUE:
+            break;
+        default:
+            return 0;
+    }
+
+    if (skip_value(p)) {
+        const char *nl = memchr(data, '\n', len);
+        return nl ? (size_t)(nl - data) : len;
+    }
+    // Espaços antes do valor passam pelo switch
+    if (!p->value_started) return 0;
+
+    switch ((header_id_t)p->header) {
+        case HDR_HOST:
+            return copy_run(p, p->host, sizeof(p->host), data, len, C_EOL, false);
+        case HDR_ORIGIN:
+            return copy_run(p, p->origin, sizeof(p->origin), data, len, C_EOL, false);
+        case HDR_WS_KEY:
+            return copy_run(p, p->ws_key, sizeof(p->ws_key), data, len, C_EOL, false);
+        case HDR_CONNECTION:
+            if (p->field_len == 0 && data[0] == ' ') return 0;
+            return copy_run(p, p->token, sizeof(p->token), data, len, C_COMMA | C_EOL, true);
+        case HDR_UPGRADE:
+        case HDR_WS_VERSION:
+            return copy_run(p, p->token, sizeof(p->token), data, len, C_EOL, true);
+        case HDR_COOKIE:
+            if (p->cookie_state == COOKIE_SKIP) return skip_cookie(data, len);
+            if (p->cookie_state == COOKIE_VALUE) {
+                return copy_run(p, p->session, sizeof(p->session), data, len, C_SEMI | C_SPACE | C_EOL, false);
+            }
+            // "session=" inteiro no mesmo pbuf; partido, segue byte a byte
+            if (p->cookie_state == COOKIE_NAME && p->field_len == 0 && len >= sizeof(SESSION_PREFIX) - 1 &&
+                memcmp(data, SESSION_PREFIX, sizeof(SESSION_PREFIX) - 1) == 0) {
+                p->cookie_state = COOKIE_VALUE;
+                begin_field(p);
+                return sizeof(SESSION_PREFIX) - 1;
+            }
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+http_parse_result_t http_parser_feed(http_parser_t *p, const char *data, size_t len, size_t *consumed) {
+    size_t i = 0;
+    http_parse_result_t result = HTTP_PARSE_INCOMPLETE;
+
+    while (i < len && result == HTTP_PARSE_INCOMPLETE) {
+        if (p->state == ST_BODY) {
+            // Corpo: cópia direta do que falta
+            size_t want = p->content_length - p->body_len;
+            size_t n = len - i < want ? len - i : want;
+            memcpy(p->body + p->body_len, data + i, n);
+            p->body_len = (uint16_t)(p->body_len + n);
+            p->body[p->body_len] = '\0';
+            i += n;
+            if (p->body_len == p->content_length) {
+                p->state = ST_DONE;
+                result = HTTP_PARSE_DONE;
+            }
+            break;
+        }
+        if (p->state == ST_DONE) {
+            result = HTTP_PARSE_DONE;
+            break;
+        }
+        if (p->state == ST_ERROR) {
+            result = HTTP_PARSE_ERROR;
+            break;
+        }
+
+        // Trechos sem delimitador: copiados ou pulados de uma vez
+        size_t run = bulk_run(p, data + i, len - i);
+        if (run > 0) {
+            if (p->header_bytes + run > HTTP_PARSER_HEADERS_MAX) {
+                result = fail(p, 431);
+                break;
+            }
+            p->header_bytes = (uint16_t)(p->header_bytes + run);
+            i += run;
+            if (i == len) break;
+        }
+
+        char c = data[i++];
+        if (++p->header_bytes > HTTP_PARSER_HEADERS_MAX) {
+            result = fail(p, 431);
+            break;
+        }
+
+        switch ((parser_state_t)p->state) {
+            case ST_METHOD:
+                // Linhas vazias entre requisições são ignoradas (RFC 9112, 2.2)
+                if ((c == '\r' || c == '\n') && p->field_len == 0) break;
+                if (c == ' ') {
+                    if (p->field_len == 0 || p->field_overflow) {
+                        result = fail(p, 400);
+                        break;
+                    }
+                    begin_field(p);
+                    p->state = ST_PATH;
+                } else if (c == '\r' || c == '\n') {
+                    result = fail(p, 400);
+                } else {
+                    field_append(p, p->method, sizeof(p->method), c);
+                }
+                break;
+
+            case ST_PATH:
+            case ST_QUERY:
+                if (c == ' ') {
+                    if (p->field_overflow || (p->state == ST_PATH && p->field_len == 0)) {
+                        result = fail(p, p->field_overflow ? 414 : 400);
+                        break;
+                    }
+                    begin_field(p);
+                    p->state = ST_VERSION;
+                } else if (c == '\r' || c == '\n') {
+                    result = fail(p, 400);
+                } else if (c == '?' && p->state == ST_PATH) {
+                    if (p->field_overflow) {
+                        result = fail(p, 414);
+                        break;
+                    }
+                    begin_field(p);
+                    p->state = ST_QUERY;
+                } else if (p->state == ST_PATH) {
+                    field_append(p, p->path, sizeof(p->path), c);
+                } else {
+                    field_append(p, p->query, sizeof(p->query), c);
+                }
+                break;
+
+            case ST_VERSION:
+                if (c == '\r') break;
+                if (c == '\n') {
+                    if (p->field_overflow || strncmp(p->token, "HTTP/1.", 7) != 0 || p->field_len != 8 ||
+                        p->token[7] < '0' || p->token[7] > '9') {
+                        result = fail(p, 400);
+                        break;
+                    }
+                    p->http_minor = (uint8_t)(p->token[7] - '0');
+                    p->state = ST_HEADER_START;
+                } else {
+                    field_append(p, p->token, sizeof(p->token), c);
+                }
+                break;
+
+            case ST_HEADER_START:
+                if (c == '\r') break;
+                if (c == '\n') {
+                    // Fim dos cabeçalhos
+                    if (p->content_length > HTTP_PARSER_BODY_MAX) {
+                        result = fail(p, 413);
+                    } else if (p->content_length > 0) {
+                        p->state = ST_BODY;
+                    } else {
+                        p->state = ST_DONE;
+                        result = HTTP_PARSE_DONE;
+                    }
+                    break;
+                }
+                // obs-fold: continuação do cabeçalho anterior, recusada (RFC 9112, 5.2)
+                if (c == ' ' || c == '\t') {
+                    result = fail(p, 400);
+                    break;
+                }
+                begin_field(p);
+                p->state = ST_HEADER_NAME;
+                field_append(p, p->name, sizeof(p->name), lower(c));
+                break;
+
+            case ST_HEADER_NAME:
+                if (c == ':') {
+                    p->header = (uint8_t)identify_header(p);
+                    if (p->header == HDR_CONTENT_LENGTH) {
+                        // Dois Content-Length (mesmo iguais): qual vale é ambíguo (RFC 9112, 6.3)
+                        if (p->length_seen) {
+                            result = fail(p, 400);
+                            break;
+                        }
+                        p->length_seen = true;
+                    }
+                    begin_field(p);
+                    p->value_started = false;
+                    p->token[0] = '\0';
+                    p->state = ST_HEADER_VALUE;
+                } else if (c == '\n' || c == ' ' || c == '\t') {
+                    // Espaço no nome ou antes do ':' (RFC 9112, 5.1)
+                    result = fail(p, 400);
+                } else {
+                    field_append(p, p->name, sizeof(p->name), lower(c));
+                }
+                break;
+
+            case ST_HEADER_VALUE:
+                if (c == '\r') break;
+                if (c == '\n') {
+                    result = end_header(p);
+                    if (result == HTTP_PARSE_INCOMPLETE) p->state = ST_HEADER_START;
+                    break;
+                }
+                // Espaços antes do valor
+                if (!p->value_started && (c == ' ' || c == '\t')) break;
+                p->value_started = true;
+                result = value_char(p, c);
+                break;
+
+            case ST_BODY:
+            case ST_DONE:
+            case ST_ERROR:
+                break;
+        }
+    }
+
+    if (consumed) *consumed = i;
+    return result;
+}
+
+http_parse_result_t http_parser_feed_pbuf(http_parser_t *p, const struct pbuf *chain, uint16_t offset,
+                                          uint16_t *consumed) {
+    uint16_t used = 0;
+    http_parse_result_t result = HTTP_PARSE_INCOMPLETE;
+
+    for (const struct pbuf *q = chain; q && result == HTTP_PARSE_INCOMPLETE; q = q->next) {
+        if (offset >= q->len) {
+            offset = (uint16_t)(offset - q->len);
+            continue;
+        }
+        size_t n = 0;
+        result = http_parser_feed(p, (const char *)q->payload + offset, (size_t)(q->len - offset), &n);
+        used = (uint16_t)(used + n);
+        offset = 0;
+    }
+
+    if (consumed) *consumed = used;
+    return result;
+}
+
+bool http_parser_keep_alive(const http_parser_t *p) {
+    if (p->connection_close) return false;
+    if (p->connection_keep_alive) return true;
+    return p->http_minor >= 1;
+}
@@ -0,0 +1,109 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lwip/pbuf.h"
+
+/**
+ * @brief Limites dos campos extraídos (com terminador)
+ *
+ * Só o que o servidor usa é copiado; os demais cabeçalhos são percorridos
+ * no próprio pbuf e descartados.
+ */
+#define HTTP_PARSER_METHOD_MAX  8
+#define HTTP_PARSER_PATH_MAX    64
+#define HTTP_PARSER_QUERY_MAX   64
+#define HTTP_PARSER_SESSION_MAX 64      // Cookie "session" (AUTH_TOKEN_MAX + 1)
+#define HTTP_PARSER_HOST_MAX    48
+#define HTTP_PARSER_ORIGIN_MAX  64
+#define HTTP_PARSER_WS_KEY_MAX  32
+
+/**
+ * @brief Maior corpo aceito (formulários de login e configurações)
+ */
+#define HTTP_PARSER_BODY_MAX 256
+
+/**
+ * @brief Maior soma de linha de requisição + cabeçalhos (acima disso: 431)
+ */
+#define HTTP_PARSER_HEADERS_MAX 4096
+
+/**
+ * @brief Resultado de uma chamada de http_parser_feed*()
+ */
+typedef enum {
+    HTTP_PARSE_INCOMPLETE,      // Faltam bytes: chamar de novo no próximo recv
+    HTTP_PARSE_DONE,            // Requisição completa (cabeçalhos e corpo)
+    HTTP_PARSE_ERROR            // Requisição inválida: responder com "status" e fechar
+} http_parse_result_t;
+
+/**
+ * @brief Estado do parser e campos da requisição
+ *
+ * Memória fixa, um por conexão: uma requisição pode chegar partida em
+ * vários pbufs e em vários callbacks de recv.
+ */
+typedef struct {
+    // Estado interno (não usar fora de http_parser.c)
+    uint8_t state;
+    uint8_t header;             // Cabeçalho em análise
+    uint8_t field_len;          // Bytes no campo em montagem
+    uint8_t cookie_state;
+    bool value_started;
+    bool field_overflow;
+    bool length_seen;           // Content-Length já apareceu (repetido: 400)
+    bool length_ended;          // Espaço depois dos dígitos: outro dígito é 400
+    uint16_t header_bytes;
+    char name[24];              // Nome do cabeçalho em minúsculas
+    char token[16];             // Valor curto (Connection, Upgrade, versão)
+
+    // Resultado
+    uint16_t status;            // Status HTTP do erro (400, 411, 413, 414, 431)
+    char method[HTTP_PARSER_METHOD_MAX];
+    char path[HTTP_PARSER_PATH_MAX];
+    char query[HTTP_PARSER_QUERY_MAX];          // Sem o '?'; vazia se ausente
+    uint8_t http_minor;                         // 0 = HTTP/1.0, 1 = HTTP/1.1
+    bool connection_close;
+    bool connection_keep_alive;
+    bool connection_upgrade;
+    bool upgrade_websocket;
+    uint8_t ws_version;                         // Sec-WebSocket-Version
+    bool has_origin;
+    char session[HTTP_PARSER_SESSION_MAX];      // Valor do cookie "session"; vazio se ausente
+    char host[HTTP_PARSER_HOST_MAX];
+    char origin[HTTP_PARSER_ORIGIN_MAX];
+    char ws_key[HTTP_PARSER_WS_KEY_MAX];        // Sec-WebSocket-Key
+    uint32_t content_length;
+    uint16_t body_len;
+    char body[HTTP_PARSER_BODY_MAX + 1];
+} http_parser_t;
+
+/**
+ * @brief Prepara o parser para uma nova requisição
+ */
+void http_parser_reset(http_parser_t *p);
+
+/**
+ * @brief Consome bytes de uma requisição
+ *
+ * Para no fim da requisição: bytes seguintes (próxima requisição ou
+ * quadros WebSocket) não são consumidos.
+ *
+ * @param consumed Bytes usados desta chamada
+ */
+http_parse_result_t http_parser_feed(http_parser_t *p, const char *data, size_t len, size_t *consumed);
+
+/**
+ * @brief Consome uma cadeia de pbufs a partir de "offset", lendo cada payload no lugar
+ */
+http_parse_result_t http_parser_feed_pbuf(http_parser_t *p, const struct pbuf *chain, uint16_t offset,
+                                          uint16_t *consumed);
+
+/**
+ * @brief Conexão persistente: padrão no HTTP/1.1, só com "keep-alive" no HTTP/1.0
+ */
+bool http_parser_keep_alive(const http_parser_t *p);
+
+#endif // HTTP_PARSER_H
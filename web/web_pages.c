@@ -8,7 +8,6 @@ int web_pages_generate_dashboard(char *buffer, size_t max_size, const sensor_dat
     const char *html_template =
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: text/html\r\n"
-        "Connection: close\r\n"
         "\r\n"
         "<!DOCTYPE html>"
         "<html><head>"
@@ -21,51 +20,315 @@ int web_pages_generate_dashboard(char *buffer, size_t max_size, const sensor_dat
         "</style>"
         "</head><body>"
         "<h2>Monitor Ambiental</h2>"
-        "<p>Temperatura: <strong id='temp'>%.1f C</strong></p>"
-        "<p>Umidade: <strong id='humidity'>%.1f %%</strong></p>"
-        "<p>Luminosidade: <strong id='lux'>%.1f lux</strong></p>"
-        "<p>Matriz de LEDs: <strong id='led'>%s</strong></p>"
-        "<p>Atualiza a cada 0.5s.</p>"
+        "<p>Temperatura: <strong id='temp'>%s C</strong></p>"
+        "<p>Umidade: <strong id='humidity'>%s %%</strong></p>"
+        "<p>Luminosidade: <strong id='lux'>%s lux</strong></p>"
+        "<p>Matriz de LEDs: <strong id='led'>%s</strong> "
+        "<button id='led_on' onclick=\"send('LED ON')\" disabled>Ligar</button> "
+        "<button id='led_off' onclick=\"send('LED OFF')\" disabled>Desligar</button></p>"
+        "<p>Atualiza a cada nova amostra.</p>"
         "<form method='GET' action='/logout' style='margin-top:12px;'>"
         "<button type='submit'>Sair</button>"
         "</form>"
         "<script>"
-        "async function refreshData(){"
-        "try{"
-        "const res=await fetch('/data');"
-        "if(!res.ok)return;"
-        "const data=await res.json();"
+        "let version=0,ws=null;"
+        "function show(data){"
+        "version=data.version;"
         "document.getElementById('temp').textContent=data.temp.toFixed(1)+' C';"
-        "document.getElementById('humidity').textContent=data.humidity.toFixed(1)+' %';"
+        "document.getElementById('humidity').textContent=data.humidity.toFixed(1)+' %%';"
         "document.getElementById('lux').textContent=data.lux.toFixed(1)+' lux';"
         "document.getElementById('led').textContent=data.led?'Ligado':'Desligado';"
+        "}"
+        "async function refreshData(){"
+        "try{"
+        "const res=await fetch('/data?since='+version);"
+        "if(!res.ok)return;"
+        "show(await res.json());"
         "}catch(e){}"
         "}"
+        "function controls(on){"
+        "document.getElementById('led_on').disabled=!on;"
+        "document.getElementById('led_off').disabled=!on;"
+        "}"
+        "function send(cmd){if(ws&&ws.readyState===1)ws.send(cmd);}"
+        // Sem WebSocket: eventos empurrados pelo servidor; sem EventSource, consulta a cada 0.5 s
+        "function fallback(){"
+        "if(window.EventSource){"
+        "new EventSource('/events').onmessage=function(e){show(JSON.parse(e.data));};"
+        "}else{"
         "setInterval(refreshData,500);"
+        "}"
+        "}"
+        // WebSocket: amostras empurradas e comandos no mesmo canal; respostas {"ok":..} não têm versão
+        "if(window.WebSocket){"
+        "ws=new WebSocket('ws://'+location.host+'/ws');"
+        "ws.onopen=function(){controls(true);};"
+        "ws.onmessage=function(e){const d=JSON.parse(e.data);if(d.version!==undefined)show(d);};"
+        "ws.onclose=function(){controls(false);ws=null;fallback();};"
+        "}else{"
+        "fallback();"
+        "}"
         "</script>"
         "</body></html>";
 
+    char temp[SENSOR_UNITS_STR_MAX], hum[SENSOR_UNITS_STR_MAX], lux[SENSOR_UNITS_STR_MAX];
+    sensor_units_format(temp, sizeof(temp), data->temperature_centi, 1);
+    sensor_units_format(hum, sizeof(hum), data->humidity_centi, 1);
+    sensor_units_format(lux, sizeof(lux), data->luminosity_centi, 1);
+
     return snprintf(buffer, max_size, html_template,
-                    data->temperature_c,
-                    data->humidity_percent,
-                    data->luminosity_lux,
+                    temp,
+                    hum,
+                    lux,
                     data->led_matrix_enabled ? "Ligado" : "Desligado");
 }
 
-int web_pages_generate_json(char *buffer, size_t max_size, const sensor_data_t *data) {
+int web_pages_generate_json(char *buffer, size_t max_size, const sensor_data_t *data, const sensor_stats_t *stats,
+                            const sensor_status_t *sensors, size_t sensor_count) {
+    static const char *const keys[TS_METRIC_COUNT] = { "temp", "humidity", "lux" };
+
     const char *json_template =
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: application/json\r\n"
-        "Connection: close\r\n"
         "\r\n"
-        "{\"temp\":%.1f,\"humidity\":%.1f,\"lux\":%.1f,\"led\":%s,\"uptime\":%lu}";
+        "{\"temp\":%s,\"humidity\":%s,\"lux\":%s,\"led\":%s,\"uptime\":%lu,\"version\":%lu";
+
+    char temp[SENSOR_UNITS_STR_MAX], hum[SENSOR_UNITS_STR_MAX], lux[SENSOR_UNITS_STR_MAX];
+    sensor_units_format(temp, sizeof(temp), data->temperature_centi, 1);
+    sensor_units_format(hum, sizeof(hum), data->humidity_centi, 1);
+    sensor_units_format(lux, sizeof(lux), data->luminosity_centi, 1);
+
+    int len = snprintf(buffer, max_size, json_template,
+                       temp,
+                       hum,
+                       lux,
+                       data->led_matrix_enabled ? "true" : "false",
+                       (unsigned long)(to_ms_since_boot(get_absolute_time()) / 1000),
+                       (unsigned long)data->version);
+    if (len < 0 || (size_t)len >= max_size) return len;
+
+    // Marcas ANOMALY_FLAG_* da última amostra de cada grandeza
+    len += snprintf(buffer + len, max_size - (size_t)len,
+                    ",\"anomaly\":{\"temp\":%u,\"humidity\":%u,\"lux\":%u}",
+                    data->anomaly_flags[TS_METRIC_TEMPERATURE],
+                    data->anomaly_flags[TS_METRIC_HUMIDITY],
+                    data->anomaly_flags[TS_METRIC_LUX]);
+    if ((size_t)len >= max_size) return len;
+
+    // Métricas de conforto derivadas (ponto de orvalho e índice de calor em °C, umidade absoluta em g/m³)
+    if (data->temp_humidity_valid) {
+        char dew[SENSOR_UNITS_STR_MAX], abs_hum[SENSOR_UNITS_STR_MAX], heat[SENSOR_UNITS_STR_MAX];
+        sensor_units_format(dew, sizeof(dew), data->comfort.dew_point_centi, 1);
+        sensor_units_format(abs_hum, sizeof(abs_hum), data->comfort.abs_humidity_centi, 1);
+        sensor_units_format(heat, sizeof(heat), data->comfort.heat_index_centi, 1);
+        len += snprintf(buffer + len, max_size - (size_t)len,
+                        ",\"dew_point\":%s,\"abs_humidity\":%s,\"heat_index\":%s",
+                        dew, abs_hum, heat);
+        if ((size_t)len >= max_size) return len;
+    }
+
+    // Saúde de cada sensor registrado (falhas, sondagens e espera atual)
+    len += snprintf(buffer + len, max_size - (size_t)len, ",\"sensors\":[");
+    for (size_t i = 0; i < sensor_count && (size_t)len < max_size; i++) {
+        const sensor_health_t *h = &sensors[i].health;
+        len += snprintf(buffer + len, max_size - (size_t)len,
+                        "%s{\"name\":\"%s\",\"state\":\"%s\",\"failures\":%lu,\"probes\":%lu,\"recoveries\":%lu,\"backoff_ms\":%lu}",
+                        i ? "," : "",
+                        sensors[i].name,
+                        sensor_health_state_name(h->state),
+                        (unsigned long)h->failures,
+                        (unsigned long)h->probes,
+                        (unsigned long)h->recoveries,
+                        (unsigned long)h->backoff_ms);
+    }
+    if ((size_t)len < max_size) {
+        len += snprintf(buffer + len, max_size - (size_t)len, "]");
+    }
+    if ((size_t)len >= max_size) return len;
+
+    // Estatísticas por janela: [media,min,max,variancia,amostras] em inteiros escalados
+    len += snprintf(buffer + len, max_size - (size_t)len,
+                    ",\"stats\":{\"scale\":%d,\"windows\":[%lu,%lu,%lu]",
+                    TIMESERIES_SCALE,
+                    (unsigned long)stats->window_s[0],
+                    (unsigned long)stats->window_s[1],
+                    (unsigned long)stats->window_s[2]);
+    for (int m = 0; m < TS_METRIC_COUNT && (size_t)len < max_size; m++) {
+        len += snprintf(buffer + len, max_size - (size_t)len, ",\"%s\":[", keys[m]);
+        for (int w = 0; w < SENSOR_STATS_WINDOW_COUNT && (size_t)len < max_size; w++) {
+            const rolling_result_t *r = &stats->metric[m][w];
+            len += snprintf(buffer + len, max_size - (size_t)len, "%s[%ld,%ld,%ld,%lld,%lu]",
+                            w ? "," : "",
+                            (long)r->mean, (long)r->min, (long)r->max,
+                            (long long)r->variance, (unsigned long)r->count);
+        }
+        if ((size_t)len < max_size) {
+            len += snprintf(buffer + len, max_size - (size_t)len, "]");
+        }
+    }
+    if ((size_t)len < max_size) {
+        len += snprintf(buffer + len, max_size - (size_t)len, "}}");
+    }
+    return len;
+}
+
+int web_pages_generate_event_stream(char *buffer, size_t max_size) {
+    const char *response =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
 
-    return snprintf(buffer, max_size, json_template,
-                    data->temperature_c,
-                    data->humidity_percent,
-                    data->luminosity_lux,
+    return snprintf(buffer, max_size, "%s", response);
+}
+
+int web_pages_generate_sample(char *buffer, size_t max_size, const sensor_data_t *data) {
+    char temp[SENSOR_UNITS_STR_MAX], hum[SENSOR_UNITS_STR_MAX], lux[SENSOR_UNITS_STR_MAX];
+    sensor_units_format(temp, sizeof(temp), data->temperature_centi, 1);
+    sensor_units_format(hum, sizeof(hum), data->humidity_centi, 1);
+    sensor_units_format(lux, sizeof(lux), data->luminosity_centi, 1);
+
+    // Mesmas chaves do /data
+    return snprintf(buffer, max_size,
+                    "{\"temp\":%s,\"humidity\":%s,\"lux\":%s,\"led\":%s,\"version\":%lu}",
+                    temp,
+                    hum,
+                    lux,
                     data->led_matrix_enabled ? "true" : "false",
-                    (unsigned long)(to_ms_since_boot(get_absolute_time()) / 1000));
+                    (unsigned long)data->version);
+}
+
+int web_pages_generate_event(char *buffer, size_t max_size, const sensor_data_t *data) {
+    // "id" vira o Last-Event-ID numa reconexão
+    int len = snprintf(buffer, max_size, "id: %lu\ndata: ", (unsigned long)data->version);
+    if (len < 0 || (size_t)len >= max_size) return len;
+
+    len += web_pages_generate_sample(buffer + len, max_size - (size_t)len, data);
+    if ((size_t)len >= max_size) return len;
+
+    len += snprintf(buffer + len, max_size - (size_t)len, "\n\n");
+    return len;
+}
+
+int web_pages_generate_ws_accept(char *buffer, size_t max_size, const char *accept_key) {
+    const char *template =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: %s\r\n"
+        "\r\n";
+
+    return snprintf(buffer, max_size, template, accept_key);
+}
+
+int web_pages_generate_not_modified(char *buffer, size_t max_size) {
+    const char *response =
+        "HTTP/1.1 304 Not Modified\r\n"
+        "\r\n";
+
+    return snprintf(buffer, max_size, "%s", response);
+}
+
+int web_pages_generate_history(char *buffer, size_t max_size, const sensor_sample_t *samples, size_t count) {
+    int len = snprintf(buffer, max_size,
+                       "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/json\r\n"
+                       "\r\n"
+                       "[");
+    if (len < 0 || (size_t)len >= max_size) return len;
+
+    for (size_t i = 0; i < count; i++) {
+        const sensor_sample_t *s = &samples[i];
+        char temp[SENSOR_UNITS_STR_MAX], hum[SENSOR_UNITS_STR_MAX], lux[SENSOR_UNITS_STR_MAX];
+        sensor_units_format(temp, sizeof(temp), s->data.temperature_centi, 1);
+        sensor_units_format(hum, sizeof(hum), s->data.humidity_centi, 1);
+        sensor_units_format(lux, sizeof(lux), s->data.luminosity_centi, 1);
+        int n = snprintf(buffer + len, max_size - (size_t)len,
+                         "%s{\"seq\":%lu,\"t\":%lu,\"temp\":%s,\"humidity\":%s,\"lux\":%s}",
+                         i ? "," : "",
+                         (unsigned long)s->seq,
+                         (unsigned long)s->timestamp_ms,
+                         temp,
+                         hum,
+                         lux);
+        if (n < 0 || (size_t)(len + n) >= max_size - 1) break;
+        len += n;
+    }
+
+    len += snprintf(buffer + len, max_size - (size_t)len, "]");
+    return len;
+}
+
+int web_pages_generate_metrics(char *buffer, size_t max_size, const sensor_metric_value_t *metrics,
+                               size_t count, uint64_t now_us) {
+    int len = snprintf(buffer, max_size,
+                       "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/json\r\n"
+                       "\r\n"
+                       "{\"metrics\":[");
+    if (len < 0 || (size_t)len >= max_size) return len;
+
+    // Uma entrada por grandeza do registro, na ordem de registro dos sensores
+    for (size_t i = 0; i < count; i++) {
+        const sensor_metric_value_t *mv = &metrics[i];
+        char value[SENSOR_UNITS_STR_MAX];
+        if (mv->valid) {
+            sensor_units_format(value, sizeof(value), mv->value, mv->desc->decimals);
+        } else {
+            snprintf(value, sizeof(value), "null");
+        }
+
+        int n = snprintf(buffer + len, max_size - (size_t)len,
+                         "%s{\"sensor\":\"%s\",\"key\":\"%s\",\"unit\":\"%s\",\"value\":%s,\"flags\":%u,\"age_ms\":%lu}",
+                         i ? "," : "",
+                         mv->sensor_name,
+                         mv->desc->key,
+                         mv->desc->unit,
+                         value,
+                         mv->flags,
+                         (unsigned long)(mv->capture_us ? (now_us - mv->capture_us) / 1000u : 0));
+        if (n < 0 || (size_t)(len + n) >= max_size - 2) break;
+        len += n;
+    }
+
+    len += snprintf(buffer + len, max_size - (size_t)len, "]}");
+    return len;
+}
+
+int web_pages_generate_series(char *buffer, size_t max_size, const char *resolution,
+                              const ts_point_t *points, size_t count) {
+    static const char *const keys[TS_METRIC_COUNT] = { "temp", "humidity", "lux" };
+
+    int len = snprintf(buffer, max_size,
+                       "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: application/json\r\n"
+                       "\r\n"
+                       "{\"res\":\"%s\",\"scale\":%d,\"points\":[",
+                       resolution, TIMESERIES_SCALE);
+    if (len < 0 || (size_t)len >= max_size) return len;
+
+    // Valores inteiros escalados: [min,media,max] por grandeza presente
+    for (size_t i = 0; i < count; i++) {
+        const ts_point_t *pt = &points[i];
+        char point[160];
+        int n = snprintf(point, sizeof(point), "%s{\"t\":%llu", i ? "," : "", (unsigned long long)pt->t_ms);
+        for (int m = 0; m < TS_METRIC_COUNT && n > 0 && (size_t)n < sizeof(point); m++) {
+            if (!(pt->valid_mask & (1u << m))) continue;
+            n += snprintf(point + n, sizeof(point) - (size_t)n, ",\"%s\":[%ld,%ld,%ld]",
+                          keys[m], (long)pt->min[m], (long)pt->mean[m], (long)pt->max[m]);
+        }
+        if (n < 0 || (size_t)n >= sizeof(point) - 1) break;
+        point[n++] = '}';
+        point[n] = '\0';
+
+        if ((size_t)(len + n) >= max_size - 2) break;
+        memcpy(buffer + len, point, (size_t)n + 1);
+        len += n;
+    }
+
+    len += snprintf(buffer + len, max_size - (size_t)len, "]}");
+    return len;
 }
 
 int web_pages_generate_login(char *buffer, size_t max_size, const char *message) {
@@ -73,7 +336,6 @@ int web_pages_generate_login(char *buffer, size_t max_size, const char *message)
     const char *html_template =
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: text/html\r\n"
-        "Connection: close\r\n"
         "\r\n"
         "<!DOCTYPE html>"
         "<html><head>"
@@ -123,7 +385,6 @@ int web_pages_generate_settings(char *buffer, size_t max_size, const char *messa
     const char *html_template =
         "HTTP/1.1 200 OK\r\n"
         "Content-Type: text/html\r\n"
-        "Connection: close\r\n"
         "\r\n"
         "<!DOCTYPE html>"
         "<html><head>"
@@ -181,19 +442,83 @@ int web_pages_generate_redirect(char *buffer, size_t max_size, const char *locat
         "HTTP/1.1 302 Found\r\n"
         "Location: %s\r\n"
         "%s"
-        "Connection: close\r\n"
         "\r\n";
 
     return snprintf(buffer, max_size, template, location, extra_headers);
 }
 
+int web_pages_generate_400(char *buffer, size_t max_size) {
+    const char *response =
+        "HTTP/1.1 400 Bad Request\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n"
+        "400 - Requisicao invalida";
+
+    return snprintf(buffer, max_size, "%s", response);
+}
+
+int web_pages_generate_error(char *buffer, size_t max_size, int status) {
+    const char *reason;
+    switch (status) {
+        case 411: reason = "Length Required"; break;
+        case 413: reason = "Payload Too Large"; break;
+        case 414: reason = "URI Too Long"; break;
+        case 431: reason = "Request Header Fields Too Large"; break;
+        default:
+            status = 400;
+            reason = "Bad Request";
+            break;
+    }
+
+    return snprintf(buffer, max_size,
+                    "HTTP/1.1 %d %s\r\n"
+                    "Content-Type: text/plain\r\n"
+                    "\r\n"
+                    "%d - %s",
+                    status, reason, status, reason);
+}
+
+int web_pages_generate_500(char *buffer, size_t max_size) {
+    const char *response =
+        "HTTP/1.1 500 Internal Server Error\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n"
+        "500 - Resposta maior que o buffer";
+
+    return snprintf(buffer, max_size, "%s", response);
+}
+
 int web_pages_generate_404(char *buffer, size_t max_size) {
     const char *response =
         "HTTP/1.1 404 Not Found\r\n"
         "Content-Type: text/plain\r\n"
-        "Connection: close\r\n"
         "\r\n"
         "404 - Pagina nao encontrada";
 
     return snprintf(buffer, max_size, "%s", response);
 }
+
+int web_pages_finish_response(char *buffer, size_t max_size, int len, bool keep_alive) {
+    // Resposta truncada pelo gerador: o Content-Length seria falso
+    if (len < 0 || (size_t)len >= max_size) return -1;
+
+    const char *blank = strstr(buffer, "\r\n\r\n");
+    if (!blank) return -1;
+
+    // Cabeçalhos extras entram antes da linha em branco
+    size_t head_len = (size_t)(blank - buffer) + 2;
+    size_t body_len = (size_t)len - head_len - 2;
+    bool no_body = strncmp(buffer + 9, "304", 3) == 0;
+
+    char extra[64];
+    int n = 0;
+    if (!no_body) {
+        n = snprintf(extra, sizeof(extra), "Content-Length: %u\r\n", (unsigned)body_len);
+    }
+    n += snprintf(extra + n, sizeof(extra) - (size_t)n, "Connection: %s\r\n", keep_alive ? "keep-alive" : "close");
+    if ((size_t)len + (size_t)n >= max_size) return -1;
+
+    memmove(buffer + head_len + n, buffer + head_len, (size_t)len - head_len + 1);
+    memcpy(buffer + head_len, extra, (size_t)n);
+    return len + n;
+}
@@ -1,14 +1,46 @@
 #ifndef WEB_PAGES_H
 #define WEB_PAGES_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include "sensor_data.h"
+#include "sensor_registry.h"
+#include "timeseries.h"
 
 int web_pages_generate_dashboard(char *buffer, size_t max_size, const sensor_data_t *data);
-int web_pages_generate_json(char *buffer, size_t max_size, const sensor_data_t *data);
+int web_pages_generate_json(char *buffer, size_t max_size, const sensor_data_t *data, const sensor_stats_t *stats,
+                            const sensor_status_t *sensors, size_t sensor_count);
+int web_pages_generate_not_modified(char *buffer, size_t max_size);
+
+// Amostra atual em JSON, sem cabeçalhos: corpo dos eventos SSE e das
+// mensagens WebSocket
+int web_pages_generate_sample(char *buffer, size_t max_size, const sensor_data_t *data);
+
+// Server-Sent Events: cabeçalhos do fluxo /events (sem Content-Length, a
+// conexão fica aberta) e um evento com a amostra atual
+int web_pages_generate_event_stream(char *buffer, size_t max_size);
+int web_pages_generate_event(char *buffer, size_t max_size, const sensor_data_t *data);
+
+// WebSocket: resposta 101 do handshake em /ws (a conexão passa a trocar quadros)
+int web_pages_generate_ws_accept(char *buffer, size_t max_size, const char *accept_key);
+int web_pages_generate_history(char *buffer, size_t max_size, const sensor_sample_t *samples, size_t count);
+int web_pages_generate_metrics(char *buffer, size_t max_size, const sensor_metric_value_t *metrics,
+                               size_t count, uint64_t now_us);
+int web_pages_generate_series(char *buffer, size_t max_size, const char *resolution,
+                              const ts_point_t *points, size_t count);
 int web_pages_generate_login(char *buffer, size_t max_size, const char *message);
 int web_pages_generate_settings(char *buffer, size_t max_size, const char *message, const char *current_user);
 int web_pages_generate_redirect(char *buffer, size_t max_size, const char *location, const char *extra_headers);
+int web_pages_generate_400(char *buffer, size_t max_size);
 int web_pages_generate_404(char *buffer, size_t max_size);
+int web_pages_generate_500(char *buffer, size_t max_size);
+
+// Erro de uma requisição que o parser recusou (400, 411, 413, 414, 431)
+int web_pages_generate_error(char *buffer, size_t max_size, int status);
+
+// Completa os cabeçalhos de uma resposta gerada acima com Content-Length e
+// Connection (keep-alive ou close). Retorna o novo tamanho, ou -1 se a
+// resposta foi truncada pelo buffer ou se não cabe com os cabeçalhos.
+int web_pages_finish_response(char *buffer, size_t max_size, int len, bool keep_alive);
 
 #endif // WEB_PAGES_H
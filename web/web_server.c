@@ -2,9 +2,14 @@
 #include "sensor_data.h"
 #include "auth.h"
 #include "web_pages.h"
+#include "http_parser.h"
+#include "websocket.h"
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
 #include "lwip/tcp.h"
 #include "lwip/err.h"
 
@@ -12,174 +17,764 @@
 static struct tcp_pcb *server_pcb = NULL;
 static web_server_state_t server_state = WEB_SERVER_STOPPED;
 static uint32_t request_count = 0;
+static uint32_t not_modified_count = 0;
+static uint32_t connection_count = 0;
+static uint32_t peak_connections = 0;
+static uint32_t refused_count = 0;
+static uint32_t deferred_count = 0;
+static uint32_t sse_event_count = 0;
+static uint32_t sse_dropped_count = 0;
+static uint32_t sse_version = 0;        // Última versão empurrada aos inscritos
+static uint32_t ws_command_count = 0;
+static uint32_t ws_dropped_count = 0;
+static web_control_handler_t control_handler = NULL;
 
-// Buffer estático para construir respostas e requests
-static char response_buffer[WEB_SERVER_BUFFER_SIZE];
-static char request_buffer[WEB_SERVER_BUFFER_SIZE];
+// tcp_poll conta em ticks do timer lento do lwIP (500 ms): 2 = 1 s
+#define WEB_CONN_POLL_INTERVAL 2
 
-static int parse_request_line(const char *request, char *method_out, size_t method_len, char *path_out, size_t path_len) {
-    const char *space = strchr(request, ' ');
-    if (!space) return 0;
+// Códigos de fechamento da RFC 6455 usados pelo servidor
+#define WS_STATUS_PROTOCOL_ERROR 1002
+#define WS_STATUS_UNSUPPORTED 1003
 
-    size_t mlen = (size_t)(space - request);
-    if (mlen + 1 > method_len) return 0;
-    memcpy(method_out, request, mlen);
-    method_out[mlen] = '\0';
+// Protocolo em uso numa conexão
+typedef enum {
+    WEB_CONN_HTTP,          // Requisição/resposta, fechada após WEB_SERVER_TIMEOUT_S ociosa
+    WEB_CONN_SSE,           // Inscrita em /events: sem timeout, recebe os eventos
+    WEB_CONN_WS             // WebSocket em /ws: recebe as amostras e envia comandos
+} web_conn_mode_t;
 
-    const char *path_start = space + 1;
-    const char *path_end = strchr(path_start, ' ');
-    if (!path_end) return 0;
+// Resposta montada e ainda não aceita inteira por tcp_write
+typedef struct {
+    bool in_use;
+    uint16_t len;
+    uint16_t sent;          // Cursor: bytes já copiados para a fila de envio
+    char data[WEB_SERVER_BUFFER_SIZE];
+} web_response_t;
 
-    size_t plen = (size_t)(path_end - path_start);
-    if (plen + 1 > path_len) return 0;
-    memcpy(path_out, path_start, plen);
-    path_out[plen] = '\0';
+// Conexão persistente: um slot por conexão aceita
+typedef struct {
+    struct tcp_pcb *pcb;    // NULL = slot livre
+    uint8_t idle_s;         // Segundos desde a última requisição (ou quadro enviado)
+    uint32_t requests;      // Requisições atendidas nesta conexão
+    web_conn_mode_t mode;
+    http_parser_t parser;   // Requisição em andamento (pode chegar em vários recv)
+    http_parse_result_t ready;  // Requisição completa (ou inválida) ainda sem resposta
+    bool deferred;          // ...esperando um buffer de resposta livre
+    // Resposta saindo aos poucos pelo tcp_sent (cliente lento ou heap do lwIP cheio)
+    web_response_t *response;
+    bool close_after;       // Fecha quando a resposta terminar de sair
+    // Recebido e ainda não processado: a próxima requisição espera a resposta atual
+    struct pbuf *rx;
+    uint16_t rx_offset;     // Bytes de rx já processados
+    uint16_t rx_acked;      // ...e já devolvidos à janela com tcp_recved
+    // Só em /ws: quadro do cliente ainda incompleto e comando à espera de web_server_poll()
+    uint8_t ws_rx[WEBSOCKET_MAX_CLIENT_FRAME];
+    uint8_t ws_rx_len;
+    volatile bool ws_command_pending;   // Enquanto true, o callback não toca em ws_command
+    char ws_command[WEBSOCKET_MAX_CLIENT_PAYLOAD + 1];
+} web_conn_t;
 
-    char *query = strchr(path_out, '?');
-    if (query) {
-        *query = '\0';
-    }
+static web_conn_t connections[WEB_SERVER_MAX_CONNECTIONS];
 
-    return 1;
-}
+// Amostras devolvidas por /history (cabem no buffer de resposta)
+#define WEB_HISTORY_SAMPLES 8
+
+// Pontos devolvidos por /series
+#define WEB_SERIES_POINTS 8
+
+// Buffers de resposta, emprestados a uma conexão só enquanto a resposta sai
+static web_response_t responses[WEB_SERVER_RESPONSE_BUFFERS];
+
+// Menor trecho tentado quando o heap do lwIP recusa a resposta inteira
+#define WEB_RESPONSE_MIN_CHUNK 128
 
-static const char *find_body(const char *request) {
-    const char *body = strstr(request, "\r\n\r\n");
-    if (!body) return NULL;
-    return body + 4;
+// Evento SSE montado uma vez por amostra e copiado para cada inscrito
+static char event_buffer[WEB_SSE_EVENT_SIZE];
+
+// Idem para o quadro WebSocket (cabeçalho de até 4 bytes + JSON da amostra)
+static uint8_t ws_frame_buffer[4 + WEB_SSE_EVENT_SIZE];
+
+// Versão informada em "since=<n>" (0 se ausente)
+static uint32_t parse_since_version(const char *query) {
+    const char *since = strstr(query, "since=");
+    if (!since) return 0;
+    return (uint32_t)strtoul(since + 6, NULL, 10);
 }
 
 static void build_expire_cookie(char *buffer, size_t max_len) {
     snprintf(buffer, max_len, "Set-Cookie: session=; Path=/; Max-Age=0\r\n");
 }
 
+// Origin "http://host[:porta]" igual ao Host: outra página não usa o cookie de sessão para mandar comandos
+static bool ws_same_origin(const char *origin, const char *host) {
+    const char *authority = strstr(origin, "://");
+    if (!authority || host[0] == '\0') return false;
+    authority += 3;
+
+    size_t len = strlen(authority);
+    if (len != strlen(host)) return false;
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)authority[i]) != tolower((unsigned char)host[i])) return false;
+    }
+    return true;
+}
+
+// Handshake de /ws (RFC 6455, seção 4.2): monta o 101 ou devolve 0 se o pedido não for válido
+static int ws_handshake(const http_parser_t *req, char *out, size_t max_len) {
+    if (!req->upgrade_websocket || req->ws_version != 13 || req->ws_key[0] == '\0') {
+        return 0;
+    }
+
+    // Clientes fora do navegador não mandam Origin
+    if (req->has_origin && !ws_same_origin(req->origin, req->host)) {
+        return 0;
+    }
+
+    char accept[WEBSOCKET_ACCEPT_LEN];
+    if (!websocket_accept_key(req->ws_key, strlen(req->ws_key), accept)) {
+        return 0;
+    }
+    return web_pages_generate_ws_accept(out, max_len, accept);
+}
+
+// Amostra num quadro de texto; devolve o tamanho do quadro ou -1 se não couber
+static int ws_build_sample(uint8_t *out, size_t max_len, const sensor_data_t *data) {
+    if (max_len <= 4) return -1;
+
+    // O JSON é montado após o espaço do maior cabeçalho e encostado no cabeçalho real
+    int len = web_pages_generate_sample((char *)out + 4, max_len - 4, data);
+    if (len <= 0 || (size_t)len >= max_len - 4) return -1;
+
+    uint8_t header[4];
+    size_t header_len = websocket_frame_header(header, WEBSOCKET_OP_TEXT, (size_t)len);
+    memmove(out + header_len, out + 4, (size_t)len);
+    memcpy(out, header, header_len);
+    return (int)header_len + len;
+}
+
+// Envia um quadro inteiro ou nada (a fila de envio precisa comportá-lo)
+static err_t ws_send(struct tcp_pcb *tpcb, websocket_opcode_t opcode, const void *payload, size_t len) {
+    uint8_t header[4];
+    size_t header_len = websocket_frame_header(header, opcode, len);
+    if (tcp_sndbuf(tpcb) < header_len + len) {
+        return ERR_MEM;
+    }
+
+    err_t err = tcp_write(tpcb, header, (uint16_t)header_len, TCP_WRITE_FLAG_COPY | (len ? TCP_WRITE_FLAG_MORE : 0));
+    if (err == ERR_OK && len) {
+        err = tcp_write(tpcb, payload, (uint16_t)len, TCP_WRITE_FLAG_COPY);
+    }
+    if (err == ERR_OK) {
+        tcp_output(tpcb);
+    }
+    return err;
+}
+
+// Libera o slot: devolve o buffer de resposta e descarta o que o cliente mandou e não foi lido
+static void release_connection(web_conn_t *conn) {
+    if (conn->response) {
+        conn->response->in_use = false;
+        conn->response = NULL;
+    }
+    if (conn->rx) {
+        pbuf_free(conn->rx);
+        conn->rx = NULL;
+    }
+    conn->rx_offset = 0;
+    conn->rx_acked = 0;
+    conn->deferred = false;
+    conn->pcb = NULL;
+}
+
 /**
- * @brief Callback quando a conexão é fechada
+ * @brief Fecha a conexão e libera o slot
+ *
+ * @return ERR_ABRT se o PCB teve de ser abortado (repassar ao lwIP se
+ * chamado de dentro de um callback deste PCB), ERR_OK caso contrário
  */
-static err_t tcp_close_callback(void *arg, struct tcp_pcb *tpcb) {
+static err_t close_connection(web_conn_t *conn, struct tcp_pcb *tpcb) {
     tcp_arg(tpcb, NULL);
     tcp_sent(tpcb, NULL);
     tcp_recv(tpcb, NULL);
     tcp_err(tpcb, NULL);
     tcp_poll(tpcb, NULL, 0);
-    tcp_close(tpcb);
+    if (conn) {
+        release_connection(conn);
+    }
+    if (tcp_close(tpcb) != ERR_OK) {
+        // Sem memória para o FIN: derruba com RST
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
     return ERR_OK;
 }
 
+// Quadro de close com o código de status, seguido do fechamento do TCP
+static err_t ws_close(web_conn_t *conn, struct tcp_pcb *tpcb, uint16_t status) {
+    uint8_t payload[2] = { (uint8_t)(status >> 8), (uint8_t)status };
+    ws_send(tpcb, WEBSOCKET_OP_CLOSE, payload, sizeof(payload));
+    return close_connection(conn, tpcb);
+}
+
 /**
- * @brief Callback quando dados são recebidos
+ * @brief Trata um quadro do cliente de /ws
+ *
+ * Comandos de texto ficam no slot até web_server_poll() executá-los; ping
+ * é respondido aqui. Se a conexão foi fechada, conn->pcb fica NULL.
  */
-static err_t tcp_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    if (!p) {
-        // Conexão fechada pelo cliente
-        tcp_close_callback(arg, tpcb);
+static err_t ws_handle_frame(web_conn_t *conn, struct tcp_pcb *tpcb, const websocket_frame_t *frame) {
+    conn->idle_s = 0;
+
+    // Comandos cabem num quadro: fragmentação e binário ficam de fora
+    if (!frame->fin) {
+        return ws_close(conn, tpcb, WS_STATUS_UNSUPPORTED);
+    }
+
+    switch (frame->opcode) {
+        case WEBSOCKET_OP_TEXT:
+            if (conn->ws_command_pending) {
+                // Um comando por vez: o cliente espera a resposta do anterior
+                static const char busy[] = "{\"ok\":false}";
+                ws_dropped_count++;
+                ws_send(tpcb, WEBSOCKET_OP_TEXT, busy, sizeof(busy) - 1);
+                return ERR_OK;
+            }
+            memcpy(conn->ws_command, frame->payload, frame->payload_len);
+            conn->ws_command[frame->payload_len] = '\0';
+            conn->ws_command_pending = true;
+            return ERR_OK;
+
+        case WEBSOCKET_OP_PING:
+            ws_send(tpcb, WEBSOCKET_OP_PONG, frame->payload, frame->payload_len);
+            return ERR_OK;
+
+        case WEBSOCKET_OP_PONG:
+            return ERR_OK;
+
+        case WEBSOCKET_OP_CLOSE:
+            // Devolve o código recebido e fecha o TCP (o servidor fecha primeiro)
+            ws_send(tpcb, WEBSOCKET_OP_CLOSE, frame->payload, frame->payload_len < 2 ? 0 : 2);
+            return close_connection(conn, tpcb);
+
+        default:
+            return ws_close(conn, tpcb, WS_STATUS_UNSUPPORTED);
+    }
+}
+
+// Junta os pbufs (a partir de offset) no buffer do slot e trata cada quadro completo
+static err_t ws_receive(web_conn_t *conn, struct tcp_pcb *tpcb, struct pbuf *p, uint16_t offset) {
+    while (offset < p->tot_len) {
+        // Um quadro válido sempre cabe no buffer: nunca falta espaço com um quadro pela metade
+        uint16_t room = (uint16_t)(sizeof(conn->ws_rx) - conn->ws_rx_len);
+        uint16_t chunk = (uint16_t)(p->tot_len - offset) < room ? (uint16_t)(p->tot_len - offset) : room;
+        pbuf_copy_partial(p, conn->ws_rx + conn->ws_rx_len, chunk, offset);
+        conn->ws_rx_len += chunk;
+        offset += chunk;
+
+        websocket_frame_t frame;
+        int used;
+        while ((used = websocket_parse_frame(conn->ws_rx, conn->ws_rx_len, &frame)) > 0) {
+            err_t err = ws_handle_frame(conn, tpcb, &frame);
+            if (!conn->pcb) {
+                return err;
+            }
+            conn->ws_rx_len -= (uint8_t)used;
+            memmove(conn->ws_rx, conn->ws_rx + used, conn->ws_rx_len);
+        }
+        if (used < 0) {
+            return ws_close(conn, tpcb, WS_STATUS_PROTOCOL_ERROR);
+        }
+    }
+    return ERR_OK;
+}
+
+// Slot livre ou, com todos ocupados, o da conexão ociosa há mais tempo
+static web_conn_t *alloc_connection(void) {
+    web_conn_t *idlest = NULL;
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        web_conn_t *conn = &connections[i];
+        if (!conn->pcb) return conn;
+        // Fluxos /events e /ws nunca estão ociosos: o painel depende deles;
+        // nem quem tem resposta saindo ou requisição à espera de buffer
+        if (conn->mode != WEB_CONN_HTTP || conn->response || conn->deferred) continue;
+        if (!idlest || conn->idle_s > idlest->idle_s) idlest = conn;
+    }
+
+    // Todas ativas no último segundo: recusa a nova
+    if (!idlest || idlest->idle_s == 0) return NULL;
+    close_connection(idlest, idlest->pcb);
+    return idlest;
+}
+
+/**
+ * @brief Callback de erro: o lwIP já liberou o PCB (RST ou abort)
+ */
+static void tcp_err_callback(void *arg, err_t err) {
+    (void)err;
+    web_conn_t *conn = (web_conn_t *)arg;
+    if (conn) {
+        release_connection(conn);
+    }
+}
+
+static web_response_t *response_alloc(void) {
+    for (int i = 0; i < WEB_SERVER_RESPONSE_BUFFERS; i++) {
+        if (!responses[i].in_use) {
+            responses[i].in_use = true;
+            return &responses[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Copia para a fila de envio o que couber da resposta pendente
+ *
+ * Cabendo tudo, devolve o buffer e, se a requisição pediu, fecha a conexão;
+ * senão o resto sai no tcp_sent (ou no tcp_poll, se nada estava em voo).
+ *
+ * @return ERR_ABRT se o PCB foi abortado; se a conexão foi fechada, conn->pcb fica NULL
+ */
+static err_t send_response(web_conn_t *conn, struct tcp_pcb *tpcb) {
+    web_response_t *response = conn->response;
+    uint16_t len = (uint16_t)(response->len - response->sent);
+    if (len > tcp_sndbuf(tpcb)) {
+        len = tcp_sndbuf(tpcb);
+    }
+
+    // Heap do lwIP sem espaço para o trecho inteiro: tenta metades
+    err_t err = ERR_OK;
+    while (len > 0) {
+        err = tcp_write(tpcb, response->data + response->sent, len, TCP_WRITE_FLAG_COPY);
+        if (err != ERR_MEM || len / 2 < WEB_RESPONSE_MIN_CHUNK) break;
+        len /= 2;
+    }
+    if (err == ERR_OK && len > 0) {
+        response->sent = (uint16_t)(response->sent + len);
+        tcp_output(tpcb);
+    } else if (err != ERR_OK && err != ERR_MEM) {
+        return close_connection(conn, tpcb);
+    }
+
+    if (response->sent < response->len) {
         return ERR_OK;
     }
-    
-    // Marca dados como recebidos
-    tcp_recved(tpcb, p->tot_len);
-    
-    int response_len = 0;
+    response->in_use = false;
+    conn->response = NULL;
+
+    // HTTP/1.0 ou "Connection: close": o FIN sai depois do que está na fila
+    if (conn->close_after) {
+        return close_connection(conn, tpcb);
+    }
+    return ERR_OK;
+}
 
-    // Copia request para buffer local com terminador
-    size_t req_len = p->tot_len < (sizeof(request_buffer) - 1) ? p->tot_len : (sizeof(request_buffer) - 1);
-    memcpy(request_buffer, p->payload, req_len);
-    request_buffer[req_len] = '\0';
+/**
+ * @brief Responde a uma requisição completa (ou ao erro do parser)
+ *
+ * @return ERR_ABRT se o PCB foi abortado; se a conexão foi fechada, conn->pcb fica NULL
+ */
+static err_t handle_request(web_conn_t *conn, struct tcp_pcb *tpcb, web_response_t *response, const http_parser_t *req,
+                            bool parse_error) {
+    int response_len = 0;
+    bool start_stream = false;
+    bool start_ws = false;
+    bool keep_alive = false;
+    const char *method = req->method;
+    const char *path = req->path;
+    const char *query = req->query;
 
-    char method[8];
-    char path[64];
-    if (parse_request_line(request_buffer, method, sizeof(method), path, sizeof(path)) == 0) {
-        response_len = web_pages_generate_404(response_buffer, sizeof(response_buffer));
+    if (parse_error) {
+        // Requisição malformada ou grande demais: o fluxo perdeu o sincronismo
+        response_len = web_pages_generate_error(response->data, sizeof(response->data), req->status);
     } else {
+        keep_alive = http_parser_keep_alive(req);
         request_count++;
 
-        const char *body = find_body(request_buffer);
-        size_t body_len = 0;
-        if (body && body >= request_buffer && body < request_buffer + req_len) {
-            body_len = (size_t)(request_buffer + req_len - body);
-        }
-
-        bool is_authenticated = auth_is_authenticated_request(request_buffer);
+        const char *body = req->body;
+        size_t body_len = req->body_len;
+        bool is_authenticated = auth_is_authenticated_session(req->session, strlen(req->session));
 
         if (strcmp(method, "GET") == 0) {
             if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
                 if (!is_authenticated) {
-                    response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/login", NULL);
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
                 } else {
                     sensor_data_t data = sensor_data_get();
-                    response_len = web_pages_generate_dashboard(response_buffer, sizeof(response_buffer), &data);
+                    response_len = web_pages_generate_dashboard(response->data, sizeof(response->data), &data);
                 }
             } else if (strcmp(path, "/login") == 0) {
-                response_len = web_pages_generate_login(response_buffer, sizeof(response_buffer), NULL);
+                response_len = web_pages_generate_login(response->data, sizeof(response->data), NULL);
             } else if (strcmp(path, "/logout") == 0) {
                 char cookie_header[96];
                 auth_logout();
                 build_expire_cookie(cookie_header, sizeof(cookie_header));
-                response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/login", cookie_header);
+                response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", cookie_header);
             } else if (strcmp(path, "/settings") == 0) {
                 if (!is_authenticated) {
-                    response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/login", NULL);
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
                 } else {
-                    response_len = web_pages_generate_settings(response_buffer, sizeof(response_buffer), NULL, auth_get_username());
+                    response_len = web_pages_generate_settings(response->data, sizeof(response->data), NULL, auth_get_username());
                 }
             } else if (strcmp(path, "/data") == 0) {
                 if (!is_authenticated) {
-                    response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/login", NULL);
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
+                } else {
+                    // Cliente já tem a versão atual: responde 304 sem montar o JSON
+                    uint32_t since = parse_since_version(query);
+                    if (since != 0 && !sensor_data_changed_since(since)) {
+                        not_modified_count++;
+                        response_len = web_pages_generate_not_modified(response->data, sizeof(response->data));
+                    } else {
+                        sensor_data_t data = sensor_data_get();
+                        sensor_stats_t stats;
+                        sensor_data_get_stats(&stats);
+                        // Estáticos: o callback roda com a pilha curta do contexto do lwIP
+                        static sensor_status_t sensors[SENSOR_REGISTRY_MAX_SENSORS];
+                        size_t sensor_count = 0;
+                        for (size_t i = 0; i < sensor_registry_count(); i++) {
+                            if (sensor_registry_get_status((int)i, &sensors[sensor_count])) sensor_count++;
+                        }
+                        response_len = web_pages_generate_json(response->data, sizeof(response->data), &data, &stats,
+                                                               sensors, sensor_count);
+                    }
+                }
+            } else if (strcmp(path, "/events") == 0) {
+                if (!is_authenticated) {
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
                 } else {
+                    // Cabeçalhos do fluxo e a amostra atual; as próximas vêm de web_server_poll()
                     sensor_data_t data = sensor_data_get();
-                    response_len = web_pages_generate_json(response_buffer, sizeof(response_buffer), &data);
+                    response_len = web_pages_generate_event_stream(response->data, sizeof(response->data));
+                    response_len += web_pages_generate_event(response->data + response_len,
+                                                             sizeof(response->data) - (size_t)response_len, &data);
+                    start_stream = true;
+                }
+            } else if (strcmp(path, "/ws") == 0) {
+                if (!is_authenticated) {
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
+                } else {
+                    response_len = ws_handshake(req, response->data, sizeof(response->data));
+                    if (response_len > 0) {
+                        // A amostra atual segue no primeiro quadro; as próximas vêm de web_server_poll()
+                        sensor_data_t data = sensor_data_get();
+                        int frame_len = ws_build_sample((uint8_t *)response->data + response_len,
+                                                        sizeof(response->data) - (size_t)response_len, &data);
+                        if (frame_len > 0) {
+                            response_len += frame_len;
+                        }
+                        start_ws = true;
+                    } else {
+                        response_len = web_pages_generate_400(response->data, sizeof(response->data));
+                    }
+                }
+            } else if (strcmp(path, "/history") == 0) {
+                if (!is_authenticated) {
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
+                } else {
+                    // Estático: fora da pilha do callback do lwIP
+                    static sensor_sample_t samples[WEB_HISTORY_SAMPLES];
+                    size_t count = sensor_data_history_latest(samples, WEB_HISTORY_SAMPLES);
+                    response_len = web_pages_generate_history(response->data, sizeof(response->data), samples, count);
+                }
+            } else if (strcmp(path, "/metrics") == 0) {
+                if (!is_authenticated) {
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
+                } else {
+                    static sensor_metric_value_t metrics[SENSOR_REGISTRY_MAX_METRICS];
+                    size_t count = 0;
+                    for (size_t i = 0; i < sensor_registry_metric_count(); i++) {
+                        if (sensor_registry_get_metric(i, &metrics[count])) count++;
+                    }
+                    response_len = web_pages_generate_metrics(response->data, sizeof(response->data),
+                                                              metrics, count, time_us_64());
+                }
+            } else if (strcmp(path, "/series") == 0) {
+                ts_resolution_t res = TS_RES_1S;
+                const char *res_arg = strstr(query, "res=");
+                char res_name[8] = "1s";
+                if (res_arg) {
+                    sscanf(res_arg + 4, "%7[^&]", res_name);
+                }
+
+                if (!is_authenticated) {
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
+                } else if (!timeseries_parse_resolution(res_name, &res)) {
+                    response_len = web_pages_generate_404(response->data, sizeof(response->data));
+                } else {
+                    static ts_point_t points[WEB_SERIES_POINTS];
+                    size_t count = timeseries_latest(res, points, WEB_SERIES_POINTS);
+                    response_len = web_pages_generate_series(response->data, sizeof(response->data),
+                                                             timeseries_resolution_name(res), points, count);
                 }
             } else {
-                response_len = web_pages_generate_404(response_buffer, sizeof(response_buffer));
+                response_len = web_pages_generate_404(response->data, sizeof(response->data));
             }
         } else if (strcmp(method, "POST") == 0) {
             if (strcmp(path, "/login") == 0) {
                 char set_cookie[96];
-                if (auth_try_login(body ? body : "", body_len, set_cookie, sizeof(set_cookie))) {
-                    response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/", set_cookie);
+                if (auth_try_login(body, body_len, set_cookie, sizeof(set_cookie))) {
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/", set_cookie);
                 } else {
-                    response_len = web_pages_generate_login(response_buffer, sizeof(response_buffer), "Credenciais invalidas.");
+                    response_len = web_pages_generate_login(response->data, sizeof(response->data), "Credenciais invalidas.");
                 }
             } else if (strcmp(path, "/settings") == 0) {
                 if (!is_authenticated) {
-                    response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/login", NULL);
+                    response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", NULL);
                 } else {
                     char message[128];
                     message[0] = '\0';
 
-                    if (body && strstr(body, "action=reset")) {
+                    if (strstr(body, "action=reset")) {
                         char cookie_header[96];
                         auth_reset_credentials();
                         build_expire_cookie(cookie_header, sizeof(cookie_header));
-                        response_len = web_pages_generate_redirect(response_buffer, sizeof(response_buffer), "/login", cookie_header);
+                        response_len = web_pages_generate_redirect(response->data, sizeof(response->data), "/login", cookie_header);
                     } else {
-                        auth_update_credentials(body ? body : "", body_len, message, sizeof(message));
-                        response_len = web_pages_generate_settings(response_buffer, sizeof(response_buffer), message, auth_get_username());
+                        auth_update_credentials(body, body_len, message, sizeof(message));
+                        response_len = web_pages_generate_settings(response->data, sizeof(response->data), message, auth_get_username());
                     }
                 }
             } else {
-                response_len = web_pages_generate_404(response_buffer, sizeof(response_buffer));
+                response_len = web_pages_generate_404(response->data, sizeof(response->data));
             }
         } else {
-            response_len = web_pages_generate_404(response_buffer, sizeof(response_buffer));
+            response_len = web_pages_generate_404(response->data, sizeof(response->data));
         }
     }
 
-    // Envia resposta
-    if (response_len > 0) {
-        tcp_write(tpcb, response_buffer, response_len, TCP_WRITE_FLAG_COPY);
-        tcp_output(tpcb);
+    // Content-Length permite reaproveitar a conexão para a próxima requisição
+    if (start_stream || start_ws) {
+        keep_alive = true;
+    } else {
+        response_len = web_pages_finish_response(response->data, sizeof(response->data), response_len, keep_alive);
+    }
+    if (response_len < 0) {
+        response_len = web_pages_generate_500(response->data, sizeof(response->data));
+        response_len = web_pages_finish_response(response->data, sizeof(response->data), response_len, keep_alive);
+    }
+
+    conn->response = response;
+    response->len = response_len > 0 ? (uint16_t)response_len : 0;
+    response->sent = 0;
+    conn->close_after = !keep_alive;
+    conn->idle_s = 0;
+    conn->requests++;
+    conn->mode = start_stream ? WEB_CONN_SSE : (start_ws ? WEB_CONN_WS : WEB_CONN_HTTP);
+    return send_response(conn, tpcb);
+}
+
+/**
+ * @brief Processa o que o cliente mandou e ainda está em conn->rx
+ *
+ * Uma requisição por vez: a seguinte (pipelining) fica em rx até a resposta
+ * atual sair inteira, e só o que foi processado volta à janela TCP, o que
+ * segura um cliente que manda mais rápido do que lê. Após o handshake de
+ * /ws, o restante são quadros.
+ *
+ * @return ERR_ABRT se o PCB foi abortado; se a conexão foi fechada, conn->pcb fica NULL
+ */
+static err_t process_input(web_conn_t *conn, struct tcp_pcb *tpcb) {
+    err_t result = ERR_OK;
+    while (!conn->response && conn->mode == WEB_CONN_HTTP) {
+        if (conn->ready == HTTP_PARSE_INCOMPLETE) {
+            if (!conn->rx || conn->rx_offset >= conn->rx->tot_len) break;
+            uint16_t used = 0;
+            conn->ready = http_parser_feed_pbuf(&conn->parser, conn->rx, conn->rx_offset, &used);
+            conn->rx_offset = (uint16_t)(conn->rx_offset + used);
+            if (conn->ready == HTTP_PARSE_INCOMPLETE) break;
+        }
+
+        // Todos os buffers com clientes lentos: espera um voltar (tcp_sent ou tcp_poll)
+        web_response_t *response = response_alloc();
+        if (!response) {
+            if (!conn->deferred) {
+                deferred_count++;
+                conn->deferred = true;
+                conn->idle_s = 0;
+            }
+            break;
+        }
+        conn->deferred = false;
+
+        result = handle_request(conn, tpcb, response, &conn->parser, conn->ready == HTTP_PARSE_ERROR);
+        if (!conn->pcb) return result;
+        conn->ready = HTTP_PARSE_INCOMPLETE;
+        http_parser_reset(&conn->parser);
+    }
+
+    // Quadros que o cliente mandou logo atrás do handshake
+    if (!conn->response && conn->mode == WEB_CONN_WS && conn->rx && conn->rx_offset < conn->rx->tot_len) {
+        result = ws_receive(conn, tpcb, conn->rx, conn->rx_offset);
+        if (!conn->pcb) return result;
+        conn->rx_offset = conn->rx->tot_len;
+    }
+
+    if (conn->rx) {
+        if (conn->rx_offset > conn->rx_acked) {
+            tcp_recved(tpcb, (uint16_t)(conn->rx_offset - conn->rx_acked));
+            conn->rx_acked = conn->rx_offset;
+        }
+        if (conn->rx_offset >= conn->rx->tot_len) {
+            pbuf_free(conn->rx);
+            conn->rx = NULL;
+            conn->rx_offset = 0;
+            conn->rx_acked = 0;
+        }
+    }
+    return result;
+}
+
+// Resposta pendente: mais um trecho e, terminada, a próxima requisição já recebida
+static err_t continue_response(web_conn_t *conn, struct tcp_pcb *tpcb) {
+    err_t result = send_response(conn, tpcb);
+    if (conn->pcb && !conn->response) {
+        result = process_input(conn, tpcb);
+    }
+    return result;
+}
+
+// Buffer de resposta devolvido fora de uma requisição: atende quem esperava por um
+// ACK em qualquer conexão devolve heap do lwIP e pode liberar um buffer:
+// primeiro as respostas paradas (já seguram buffer), depois as requisições
+// à espera. Começa num slot diferente a cada vez para ninguém ficar sempre
+// por último, e pula "skip" (quem recebeu o ACK vai depois dos outros).
+static void wake_waiting(const web_conn_t *skip) {
+    static uint8_t start = 0;
+    start = (uint8_t)((start + 1) % WEB_SERVER_MAX_CONNECTIONS);
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int n = 0; n < WEB_SERVER_MAX_CONNECTIONS; n++) {
+            web_conn_t *conn = &connections[(start + n) % WEB_SERVER_MAX_CONNECTIONS];
+            if (conn == skip || !conn->pcb) {
+                continue;
+            }
+            if (pass == 0 && conn->response) {
+                continue_response(conn, conn->pcb);
+            } else if (pass == 1 && conn->deferred) {
+                process_input(conn, conn->pcb);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Callback de dados confirmados pelo cliente: continua a resposta pendente
+ */
+static err_t tcp_sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    (void)len;
+    web_conn_t *conn = (web_conn_t *)arg;
+    if (!conn) {
+        return ERR_OK;
+    }
+
+    wake_waiting(conn);
+    if (conn->response) {
+        conn->idle_s = 0;
+        return continue_response(conn, tpcb);
+    }
+    if (conn->deferred) {
+        return process_input(conn, tpcb);
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief Callback periódico (1 s): fecha conexões ociosas
+ */
+static err_t tcp_poll_callback(void *arg, struct tcp_pcb *tpcb) {
+    web_conn_t *conn = (web_conn_t *)arg;
+    if (!conn) {
+        return close_connection(NULL, tpcb);
+    }
+
+    if (conn->idle_s < UINT8_MAX) {
+        conn->idle_s++;
+    }
+
+    // Resposta parada sem nada em voo (o tcp_sent não virá) ou requisição à espera de buffer
+    if (conn->response || conn->deferred) {
+        err_t err = conn->response ? continue_response(conn, tpcb) : process_input(conn, tpcb);
+        if (!conn->pcb) {
+            wake_waiting(NULL);
+            return err;
+        }
+        if (conn->response) {
+            // Cliente que não confirma nada: vale o mesmo timeout das ociosas
+            if (conn->idle_s > WEB_SERVER_TIMEOUT_S) {
+                err = close_connection(conn, tpcb);
+                wake_waiting(NULL);
+                return err;
+            }
+        }
+        // Ainda à espera de buffer: a culpa é nossa, não vale o timeout de ociosa
+        return ERR_OK;
+    }
+
+    // WebSocket parado: um ping mantém NAT/navegador e detecta cliente morto
+    if (conn->mode == WEB_CONN_WS) {
+        if (conn->idle_s >= WEB_WS_PING_S) {
+            if (ws_send(tpcb, WEBSOCKET_OP_PING, NULL, 0) != ERR_OK) {
+                return close_connection(conn, tpcb);
+            }
+            conn->idle_s = 0;
+        }
+        return ERR_OK;
+    }
+
+    // Fluxo SSE parado: idem, com um comentário
+    if (conn->mode == WEB_CONN_SSE) {
+        if (conn->idle_s >= WEB_SSE_KEEPALIVE_S) {
+            static const char ping[] = ":\n\n";
+            if (tcp_write(tpcb, ping, sizeof(ping) - 1, 0) != ERR_OK) {
+                return close_connection(conn, tpcb);
+            }
+            tcp_output(tpcb);
+            conn->idle_s = 0;
+        }
+        return ERR_OK;
+    }
+
+    // O primeiro tick pode vir logo após a requisição: ">" garante o timeout inteiro
+    if (conn->idle_s > WEB_SERVER_TIMEOUT_S) {
+        return close_connection(conn, tpcb);
     }
-    
-    // Libera buffer
-    pbuf_free(p);
-    
-    // Fecha conexão
-    tcp_close_callback(arg, tpcb);
-    
     return ERR_OK;
 }
 
+/**
+ * @brief Callback quando dados são recebidos
+ */
+static err_t tcp_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    web_conn_t *conn = (web_conn_t *)arg;
+    if (!p) {
+        // Conexão fechada pelo cliente
+        return close_connection(conn, tpcb);
+    }
+
+    if (!conn) {
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        return close_connection(NULL, tpcb);
+    }
+
+    // Fluxo /events só envia: o que o cliente mandar depois é descartado
+    if (conn->mode == WEB_CONN_SSE) {
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        return ERR_OK;
+    }
+
+    // Requisições lidas direto dos pbufs; uma pode vir em vários recv e um
+    // recv pode trazer várias (pipelining)
+    if (conn->rx) {
+        pbuf_cat(conn->rx, p);
+    } else {
+        conn->rx = p;
+    }
+    return process_input(conn, tpcb);
+}
+
 /**
  * @brief Callback quando nova conexão é aceita
  */
@@ -187,11 +782,35 @@ static err_t tcp_accept_callback(void *arg, struct tcp_pcb *client_pcb, err_t er
     if (err != ERR_OK || client_pcb == NULL) {
         return ERR_VAL;
     }
+
+    web_conn_t *conn = alloc_connection();
+    if (!conn) {
+        refused_count++;
+        tcp_abort(client_pcb);
+        return ERR_ABRT;
+    }
+    conn->pcb = client_pcb;
+    conn->idle_s = 0;
+    conn->requests = 0;
+    conn->mode = WEB_CONN_HTTP;
+    http_parser_reset(&conn->parser);
+    conn->ready = HTTP_PARSE_INCOMPLETE;
+    conn->close_after = false;
+    conn->ws_rx_len = 0;
+    conn->ws_command_pending = false;
+    connection_count++;
+
+    uint32_t active = web_server_get_active_connections();
+    if (active > peak_connections) {
+        peak_connections = active;
+    }
     
     // Configura callbacks para essa conexão
-    tcp_arg(client_pcb, NULL);
+    tcp_arg(client_pcb, conn);
     tcp_recv(client_pcb, tcp_recv_callback);
-    tcp_err(client_pcb, NULL);
+    tcp_sent(client_pcb, tcp_sent_callback);
+    tcp_err(client_pcb, tcp_err_callback);
+    tcp_poll(client_pcb, tcp_poll_callback, WEB_CONN_POLL_INTERVAL);
     
     return ERR_OK;
 }
@@ -243,6 +862,11 @@ bool web_server_init(uint16_t port) {
 }
 
 void web_server_deinit(void) {
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        if (connections[i].pcb) {
+            close_connection(&connections[i], connections[i].pcb);
+        }
+    }
     if (server_pcb) {
         tcp_close(server_pcb);
         server_pcb = NULL;
@@ -259,11 +883,166 @@ web_server_state_t web_server_get_state(void) {
     return server_state;
 }
 
+void web_server_set_control_handler(web_control_handler_t handler) {
+    control_handler = handler;
+}
+
+// Comandos recebidos por /ws: executados aqui, fora do callback do lwIP,
+// porque mudar o estado publicado toma o mutex dos dados
+static void ws_run_commands(void) {
+    static const char reply_ok[] = "{\"ok\":true}";
+    static const char reply_fail[] = "{\"ok\":false}";
+
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        web_conn_t *conn = &connections[i];
+        if (!conn->ws_command_pending) continue;
+
+        cyw43_arch_lwip_begin();
+        struct tcp_pcb *pcb = conn->mode == WEB_CONN_WS ? conn->pcb : NULL;
+        cyw43_arch_lwip_end();
+
+        bool ok = false;
+        if (pcb) {
+            ok = control_handler && control_handler(conn->ws_command);
+            ws_command_count++;
+        }
+
+        cyw43_arch_lwip_begin();
+        // A conexão pode ter caído enquanto o comando rodava
+        if (pcb && conn->pcb == pcb) {
+            const char *reply = ok ? reply_ok : reply_fail;
+            if (conn->response || ws_send(pcb, WEBSOCKET_OP_TEXT, reply, strlen(reply)) != ERR_OK) {
+                ws_dropped_count++;
+            }
+        }
+        conn->ws_command_pending = false;
+        cyw43_arch_lwip_end();
+    }
+}
+
 void web_server_poll(void) {
-    // Com lwip_threadsafe_background, o polling é automático
-    // Esta função fica vazia mas pode ser usada para estatísticas futuras
+    // Com lwip_threadsafe_background, o polling do lwIP é automático; aqui
+    // rodam os comandos de /ws e as amostras novas são empurradas aos
+    // inscritos em /events e /ws
+    ws_run_commands();
+
+    uint32_t version = sensor_data_version();
+    if (version == sse_version) {
+        return;
+    }
+
+    // Evento e quadro são montados uma única vez, fora da trava do lwIP
+    sensor_data_t data = sensor_data_get();
+    int event_len = web_pages_generate_event(event_buffer, sizeof(event_buffer), &data);
+    if (event_len <= 0 || (size_t)event_len >= sizeof(event_buffer)) {
+        event_len = 0;
+    }
+    int frame_len = ws_build_sample(ws_frame_buffer, sizeof(ws_frame_buffer), &data);
+    sse_version = data.version;
+
+    bool sent = false;
+    cyw43_arch_lwip_begin();
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        web_conn_t *conn = &connections[i];
+        if (!conn->pcb) continue;
+
+        if (conn->mode == WEB_CONN_SSE && event_len > 0) {
+            // Fila de envio cheia (cliente lento) ou cabeçalhos do fluxo ainda saindo:
+            // o próximo evento traz o estado completo
+            if (conn->response || tcp_sndbuf(conn->pcb) < (uint16_t)event_len ||
+                tcp_write(conn->pcb, event_buffer, (uint16_t)event_len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+                sse_dropped_count++;
+                continue;
+            }
+            sent = true;
+        } else if (conn->mode == WEB_CONN_WS && frame_len > 0) {
+            // Idem: um quadro vai inteiro ou não vai
+            if (conn->response || tcp_sndbuf(conn->pcb) < (uint16_t)frame_len ||
+                tcp_write(conn->pcb, ws_frame_buffer, (uint16_t)frame_len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+                ws_dropped_count++;
+                continue;
+            }
+        } else {
+            continue;
+        }
+        tcp_output(conn->pcb);
+        conn->idle_s = 0;
+    }
+    cyw43_arch_lwip_end();
+
+    if (sent) {
+        sse_event_count++;
+    }
 }
 
 uint32_t web_server_get_request_count(void) {
     return request_count;
 }
+
+uint32_t web_server_get_connection_count(void) {
+    return connection_count;
+}
+
+uint32_t web_server_get_active_connections(void) {
+    uint32_t active = 0;
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        if (connections[i].pcb) active++;
+    }
+    return active;
+}
+
+uint32_t web_server_get_peak_connections(void) {
+    return peak_connections;
+}
+
+uint32_t web_server_get_refused_count(void) {
+    return refused_count;
+}
+
+uint32_t web_server_get_pending_responses(void) {
+    uint32_t pending = 0;
+    for (int i = 0; i < WEB_SERVER_RESPONSE_BUFFERS; i++) {
+        if (responses[i].in_use) pending++;
+    }
+    return pending;
+}
+
+uint32_t web_server_get_deferred_count(void) {
+    return deferred_count;
+}
+
+uint32_t web_server_get_sse_clients(void) {
+    uint32_t clients = 0;
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        if (connections[i].pcb && connections[i].mode == WEB_CONN_SSE) clients++;
+    }
+    return clients;
+}
+
+uint32_t web_server_get_sse_event_count(void) {
+    return sse_event_count;
+}
+
+uint32_t web_server_get_sse_dropped_count(void) {
+    return sse_dropped_count;
+}
+
+uint32_t web_server_get_ws_clients(void) {
+    uint32_t clients = 0;
+    for (int i = 0; i < WEB_SERVER_MAX_CONNECTIONS; i++) {
+        if (connections[i].pcb && connections[i].mode == WEB_CONN_WS) clients++;
+    }
+    return clients;
+}
+
+uint32_t web_server_get_ws_command_count(void) {
+    return ws_command_count;
+}
+
+uint32_t web_server_get_ws_dropped_count(void) {
+    return ws_dropped_count;
+}
+
+uint32_t web_server_get_not_modified_count(void) {
+    return not_modified_count;
+}
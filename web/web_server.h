@@ -10,19 +10,62 @@
 #define WEB_SERVER_PORT 80
 
 /**
- * @brief Timeout para conexões HTTP em segundos
+ * @brief Tempo máximo sem requisições antes de fechar uma conexão persistente (segundos)
  */
 #define WEB_SERVER_TIMEOUT_S 5
 
 /**
- * @brief Tamanho do buffer para requisições/respostas HTTP
+ * @brief Tamanho do buffer de respostas HTTP (o painel tem ~1,2 KB e o
+ * /data cresce com o número de sensores registrados)
  */
-#define WEB_SERVER_BUFFER_SIZE 1024
+#define WEB_SERVER_BUFFER_SIZE 3072
 
 /**
- * @brief Número máximo de conexões simultâneas
+ * @brief Número máximo de conexões simultâneas (slots de conexão persistente)
+ *
+ * Com todos os slots ocupados, uma nova conexão toma o slot da conexão
+ * ociosa há mais tempo; se nenhuma estiver ociosa, é recusada.
  */
-#define WEB_SERVER_MAX_CONNECTIONS 2
+#ifndef WEB_SERVER_MAX_CONNECTIONS
+#define WEB_SERVER_MAX_CONNECTIONS 4
+#endif
+
+/**
+ * @brief Buffers de resposta (WEB_SERVER_BUFFER_SIZE cada) emprestados às conexões
+ *
+ * Uma conexão só segura um buffer enquanto sua resposta não couber inteira
+ * na fila de envio do lwIP (cliente lento ou heap do lwIP cheio); o resto
+ * sai no tcp_sent. Com todos emprestados, a próxima requisição espera um
+ * deles voltar, sem fechar a conexão.
+ */
+#ifndef WEB_SERVER_RESPONSE_BUFFERS
+#define WEB_SERVER_RESPONSE_BUFFERS 2
+#endif
+
+/**
+ * @brief Intervalo do comentário de keepalive num fluxo /events parado (segundos)
+ */
+#define WEB_SSE_KEEPALIVE_S 15
+
+/**
+ * @brief Tamanho máximo de um evento SSE de amostra
+ */
+#define WEB_SSE_EVENT_SIZE 192
+
+/**
+ * @brief Intervalo do ping numa conexão /ws parada (segundos)
+ */
+#define WEB_WS_PING_S 15
+
+/**
+ * @brief Executa um comando de controle recebido por /ws ("LED ON", "RATE 500"...)
+ *
+ * Chamado por web_server_poll(), no contexto da task que o chama, nunca no
+ * callback do lwIP: o comando pode tomar mutexes do FreeRTOS.
+ *
+ * @return true se o comando foi aceito
+ */
+typedef bool (*web_control_handler_t)(const char *command);
 
 /**
  * @brief Estado do servidor web
@@ -60,11 +103,21 @@ bool web_server_is_running(void);
  */
 web_server_state_t web_server_get_state(void);
 
+/**
+ * @brief Registra quem executa os comandos recebidos por /ws
+ *
+ * Sem handler, todo comando é respondido com {"ok":false}.
+ */
+void web_server_set_control_handler(web_control_handler_t handler);
+
 /**
  * @brief Processa conexões pendentes (deve ser chamado no loop)
  * 
- * Esta função é não-bloqueante e deve ser chamada periodicamente
- * para processar requisições HTTP.
+ * Esta função é não-bloqueante e deve ser chamada periodicamente. Se
+ * uma amostra nova foi publicada desde a última chamada, monta um único
+ * evento e o envia a todos os inscritos em /events, e um único quadro
+ * para as conexões /ws. Também executa os comandos recebidos por /ws e
+ * responde a cada um com {"ok":true|false}.
  */
 void web_server_poll(void);
 
@@ -75,4 +128,81 @@ void web_server_poll(void);
  */
 uint32_t web_server_get_request_count(void);
 
+/**
+ * @brief Obtém o número de conexões TCP aceitas
+ *
+ * Com keep-alive, requisições/conexões mostra o reaproveitamento.
+ *
+ * @return Conexões aceitas desde o início
+ */
+uint32_t web_server_get_connection_count(void);
+
+/**
+ * @brief Obtém o número de conexões abertas no momento
+ *
+ * @return Slots de conexão em uso (até WEB_SERVER_MAX_CONNECTIONS)
+ */
+uint32_t web_server_get_active_connections(void);
+
+/**
+ * @brief Obtém o maior número de conexões abertas ao mesmo tempo
+ */
+uint32_t web_server_get_peak_connections(void);
+
+/**
+ * @brief Obtém o número de conexões recusadas com todos os slots ativos
+ */
+uint32_t web_server_get_refused_count(void);
+
+/**
+ * @brief Obtém o número de buffers de resposta emprestados no momento
+ *
+ * @return Respostas ainda saindo pelo tcp_sent (até WEB_SERVER_RESPONSE_BUFFERS)
+ */
+uint32_t web_server_get_pending_responses(void);
+
+/**
+ * @brief Obtém o número de requisições que esperaram um buffer de resposta livre
+ */
+uint32_t web_server_get_deferred_count(void);
+
+/**
+ * @brief Obtém o número de clientes inscritos em /events
+ */
+uint32_t web_server_get_sse_clients(void);
+
+/**
+ * @brief Obtém o número de eventos SSE montados e enviados
+ *
+ * Cada evento é montado uma vez e copiado para todos os inscritos.
+ */
+uint32_t web_server_get_sse_event_count(void);
+
+/**
+ * @brief Obtém o número de envios SSE descartados por fila de envio cheia
+ */
+uint32_t web_server_get_sse_dropped_count(void);
+
+/**
+ * @brief Obtém o número de conexões /ws abertas
+ */
+uint32_t web_server_get_ws_clients(void);
+
+/**
+ * @brief Obtém o número de comandos recebidos por /ws e executados
+ */
+uint32_t web_server_get_ws_command_count(void);
+
+/**
+ * @brief Obtém o número de quadros /ws descartados (fila de envio cheia ou comando em andamento)
+ */
+uint32_t web_server_get_ws_dropped_count(void);
+
+/**
+ * @brief Obtém o número de consultas a /data respondidas com 304
+ * 
+ * @return Respostas sem mudança desde a versão informada pelo cliente
+ */
+uint32_t web_server_get_not_modified_count(void);
+
 #endif // WEB_SERVER_H
@@ -0,0 +1,185 @@
+#include "websocket.h"
+
+#include <string.h>
+
+// GUID fixo da RFC 6455 (seção 1.3)
+static const char WEBSOCKET_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// Chave do cliente: 16 bytes em base64 (24 caracteres); folga para clientes fora do padrão
+#define WEBSOCKET_MAX_KEY_LEN 64
+
+// ============= SHA-1 (só para o handshake) =============
+
+typedef struct {
+    uint32_t h[5];
+    uint8_t block[64];
+    size_t block_len;
+    uint64_t total_len;
+} sha1_t;
+
+static uint32_t rol32(uint32_t x, unsigned n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+// Agenda de mensagem em anel de 16 palavras: roda na pilha curta do callback do lwIP
+static void sha1_block(sha1_t *s) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)s->block[i * 4] << 24) | ((uint32_t)s->block[i * 4 + 1] << 16) |
+               ((uint32_t)s->block[i * 4 + 2] << 8) | (uint32_t)s->block[i * 4 + 3];
+    }
+
+    uint32_t a = s->h[0], b = s->h[1], c = s->h[2], d = s->h[3], e = s->h[4];
+    for (int i = 0; i < 80; i++) {
+        if (i >= 16) {
+            w[i & 15] = rol32(w[(i - 3) & 15] ^ w[(i - 8) & 15] ^ w[(i - 14) & 15] ^ w[i & 15], 1);
+        }
+
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t t = rol32(a, 5) + f + e + k + w[i & 15];
+        e = d;
+        d = c;
+        c = rol32(b, 30);
+        b = a;
+        a = t;
+    }
+
+    s->h[0] += a;
+    s->h[1] += b;
+    s->h[2] += c;
+    s->h[3] += d;
+    s->h[4] += e;
+}
+
+static void sha1_init(sha1_t *s) {
+    s->h[0] = 0x67452301;
+    s->h[1] = 0xEFCDAB89;
+    s->h[2] = 0x98BADCFE;
+    s->h[3] = 0x10325476;
+    s->h[4] = 0xC3D2E1F0;
+    s->block_len = 0;
+    s->total_len = 0;
+}
+
+static void sha1_update(sha1_t *s, const uint8_t *data, size_t len) {
+    s->total_len += len;
+    for (size_t i = 0; i < len; i++) {
+        s->block[s->block_len++] = data[i];
+        if (s->block_len == 64) {
+            sha1_block(s);
+            s->block_len = 0;
+        }
+    }
+}
+
+static void sha1_final(sha1_t *s, uint8_t digest[20]) {
+    uint64_t bits = s->total_len * 8;
+    uint8_t pad = 0x80;
+    sha1_update(s, &pad, 1);
+    pad = 0;
+    while (s->block_len != 56) {
+        sha1_update(s, &pad, 1);
+    }
+    for (int i = 7; i >= 0; i--) {
+        s->block[s->block_len++] = (uint8_t)(bits >> (i * 8));
+    }
+    sha1_block(s);
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = (uint8_t)(s->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(s->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(s->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)s->h[i];
+    }
+}
+
+// ============= BASE64 =============
+
+static size_t base64_encode(const uint8_t *in, size_t len, char *out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < len) v |= in[i + 2];
+        out[o++] = alphabet[(v >> 18) & 0x3F];
+        out[o++] = alphabet[(v >> 12) & 0x3F];
+        out[o++] = i + 1 < len ? alphabet[(v >> 6) & 0x3F] : '=';
+        out[o++] = i + 2 < len ? alphabet[v & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+// ============= API PÚBLICA =============
+
+bool websocket_accept_key(const char *key, size_t key_len, char out[WEBSOCKET_ACCEPT_LEN]) {
+    if (key_len == 0 || key_len > WEBSOCKET_MAX_KEY_LEN) {
+        return false;
+    }
+
+    sha1_t sha;
+    uint8_t digest[20];
+    sha1_init(&sha);
+    sha1_update(&sha, (const uint8_t *)key, key_len);
+    sha1_update(&sha, (const uint8_t *)WEBSOCKET_GUID, sizeof(WEBSOCKET_GUID) - 1);
+    sha1_final(&sha, digest);
+
+    base64_encode(digest, sizeof(digest), out);
+    return true;
+}
+
+size_t websocket_frame_header(uint8_t out[4], websocket_opcode_t opcode, size_t payload_len) {
+    out[0] = (uint8_t)(0x80 | opcode);
+    if (payload_len < 126) {
+        out[1] = (uint8_t)payload_len;
+        return 2;
+    }
+    out[1] = 126;
+    out[2] = (uint8_t)(payload_len >> 8);
+    out[3] = (uint8_t)payload_len;
+    return 4;
+}
+
+int websocket_parse_frame(uint8_t *buf, size_t len, websocket_frame_t *frame) {
+    if (len < 2) {
+        return 0;
+    }
+
+    // Bits reservados sem extensão negociada, quadro sem máscara ou
+    // tamanho estendido: nada disso vem de um cliente deste painel
+    bool masked = (buf[1] & 0x80) != 0;
+    size_t payload_len = buf[1] & 0x7F;
+    if ((buf[0] & 0x70) || !masked || payload_len > WEBSOCKET_MAX_CLIENT_PAYLOAD) {
+        return -1;
+    }
+
+    size_t frame_len = 2 + 4 + payload_len;
+    if (len < frame_len) {
+        return 0;
+    }
+
+    frame->fin = (buf[0] & 0x80) != 0;
+    frame->opcode = (websocket_opcode_t)(buf[0] & 0x0F);
+    frame->payload = buf + 6;
+    frame->payload_len = payload_len;
+
+    const uint8_t *mask = buf + 2;
+    for (size_t i = 0; i < payload_len; i++) {
+        frame->payload[i] ^= mask[i & 3];
+    }
+    return (int)frame_len;
+}
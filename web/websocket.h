@@ -0,0 +1,74 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maior payload aceito do cliente (comandos curtos: cabe num
+ * quadro com tamanho de 7 bits, como os quadros de controle)
+ */
+#define WEBSOCKET_MAX_CLIENT_PAYLOAD 125
+
+/**
+ * @brief Maior quadro do cliente: 2 bytes + máscara (4) + payload
+ */
+#define WEBSOCKET_MAX_CLIENT_FRAME (2 + 4 + WEBSOCKET_MAX_CLIENT_PAYLOAD)
+
+/**
+ * @brief Tamanho de Sec-WebSocket-Accept (base64 de 20 bytes, com terminador)
+ */
+#define WEBSOCKET_ACCEPT_LEN 29
+
+/**
+ * @brief Opcodes da RFC 6455
+ */
+typedef enum {
+    WEBSOCKET_OP_CONTINUATION = 0x0,
+    WEBSOCKET_OP_TEXT = 0x1,
+    WEBSOCKET_OP_BINARY = 0x2,
+    WEBSOCKET_OP_CLOSE = 0x8,
+    WEBSOCKET_OP_PING = 0x9,
+    WEBSOCKET_OP_PONG = 0xA
+} websocket_opcode_t;
+
+/**
+ * @brief Quadro decodificado (o payload fica no próprio buffer, já sem máscara)
+ */
+typedef struct {
+    websocket_opcode_t opcode;
+    bool fin;
+    uint8_t *payload;
+    size_t payload_len;
+} websocket_frame_t;
+
+/**
+ * @brief Calcula Sec-WebSocket-Accept: base64(SHA-1(chave + GUID da RFC))
+ *
+ * @param key Valor de Sec-WebSocket-Key enviado pelo cliente
+ * @param key_len Tamanho da chave (24 caracteres num cliente conforme)
+ * @param out Saída com terminador
+ * @return false se a chave for vazia ou longa demais
+ */
+bool websocket_accept_key(const char *key, size_t key_len, char out[WEBSOCKET_ACCEPT_LEN]);
+
+/**
+ * @brief Escreve o cabeçalho de um quadro do servidor (FIN, sem máscara)
+ *
+ * @return Bytes do cabeçalho (2 ou 4; payloads até 65535 bytes)
+ */
+size_t websocket_frame_header(uint8_t out[4], websocket_opcode_t opcode, size_t payload_len);
+
+/**
+ * @brief Decodifica um quadro do cliente no início do buffer
+ *
+ * Remove a máscara no lugar, sem cópia. Quadros do cliente precisam vir
+ * mascarados e ter no máximo WEBSOCKET_MAX_CLIENT_PAYLOAD bytes.
+ *
+ * @return Bytes consumidos pelo quadro, 0 se ainda incompleto ou -1 se
+ * violar o protocolo (fechar a conexão)
+ */
+int websocket_parse_frame(uint8_t *buf, size_t len, websocket_frame_t *frame);
+
+#endif // WEBSOCKET_H